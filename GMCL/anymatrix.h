@@ -0,0 +1,489 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "AnyMatrix.h"                        */
+/*                                                                            */
+/*                                                                            */
+/*  Category:   Operations                                                    */
+/*                                                                            */
+/*  Meta-Functions:                                                           */
+/*  - MATRIX_REDUCTION                                                        */
+/*                                                                            */
+/*  Classes:                                                                  */
+/*  - SumReduction, AbsMaxReduction, SquareSumReduction                       */
+/*  - SparseReduction, BandReduction                                          */
+/*  - AnyMatrixHolder                                                         */
+/*  - AnyMatrixModel                                                          */
+/*  - AnyMatrix                                                               */
+/*                                                                            */
+/*                                                                            */
+/*  AnyMatrix is a handle to a matrix of any type produced by the matrix      */
+/*  generator. The type of the matrix is chosen at runtime (e.g. from a       */
+/*  configuration file) by create<MatrixType>(), and handles to matrices of   */
+/*  different types can be kept in one container. Only the element type and   */
+/*  the index type of the vectors and dense matrices exchanged with the       */
+/*  handle are fixed.                                                         */
+/*  The handle dispatches whole operations: each SpMV, product, assignment    */
+/*  or reduction costs one virtual call, after which the operation runs on    */
+/*  the concrete matrix type with the algorithm chosen by the generator       */
+/*  (MATRIX_SPMV, MATRIX_SPMM, MATRIX_ASSIGNMENT, MATRIX_REDUCTION). No       */
+/*  element access goes through a virtual function.                           */
+/*  Copies of a handle share the matrix (the matrices themselves cannot be    */
+/*  copied); assign() copies the elements of another matrix into it, so the   */
+/*  change is seen through every handle sharing the matrix. The handles may   */
+/*  be copied and destroyed by several threads at once.                       */
+/*                                                                            */
+/*                                                                            */
+/* (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                 */
+/*                       Ulrich Eisenecker, Johannes Knaupp                   */
+/*                                                                            */
+/******************************************************************************/
+
+#ifndef DB_MATRIX_ANYMATRIX_H
+#define DB_MATRIX_ANYMATRIX_H
+
+#include <math.h>
+#include <typeinfo>
+
+//********************************* reductions *********************************
+
+// The reductions combine the stored elements of a matrix. The multiplicity n
+// is 2 for an element of a sparse symmetric matrix standing for itself and
+// its mirror image.
+
+struct matrix_reductions
+{
+   enum { sum_op,
+          abs_max_op,
+          square_sum_op
+        };
+};
+
+struct SumReduction
+{
+   template<class ResultType>
+   static void combine(ResultType& r, const ResultType& v, int n)
+   {
+      r+= ResultType(n)*v;
+   }
+};
+
+struct AbsMaxReduction
+{
+   template<class ResultType>
+   static void combine(ResultType& r, const ResultType& v, int)
+   {
+      const ResultType a= v<ResultType(0) ? ResultType(-v) : v;
+      if (r<a) r= a;
+   }
+};
+
+struct SquareSumReduction
+{
+   template<class ResultType>
+   static void combine(ResultType& r, const ResultType& v, int n)
+   {
+      r+= ResultType(n)*v*v;
+   }
+};
+
+// reduction using the iterator of a sparse matrix; the iterator of a
+// symmetric matrix yields the lower triangle only
+struct SparseReduction
+{
+   template<class MatrixType, class ResultType, class Reduction>
+   static void reduce(const MatrixType& A, ResultType& r, Reduction)
+   {
+      typedef MatrixType::Config::DSLFeatures::Shape Shape;
+      typedef MatrixType::Config::IndexType          IndexType;
+      typedef MatrixType::Config::ElementType        ElementType;
+      enum {mirror= EQUAL<Shape::id, Shape::symm_id>::RET};
+
+      MatrixType::IteratorType iter(A);
+      ElementType v;
+      IndexType   i, j;
+      while (!iter.end())
+      {
+         iter.getNext(i, j, v);
+         Reduction::combine(r, ResultType(v), mirror && i!=j ? 2 : 1);
+      }
+   }
+};
+
+// reduction over the band of any matrix
+struct BandReduction
+{
+   template<class MatrixType, class ResultType, class Reduction>
+   static void reduce(const MatrixType& A, ResultType& r, Reduction)
+   {
+      typedef MatrixType::Config::SignedIndexType SignedIndexType;
+
+      const SignedIndexType maxColsIndex= A.cols()-1;
+      SignedIndexType i, j, stop_j;
+
+      for (i= 0; i<SignedIndexType(A.rows()); ++i)
+      {
+         stop_j= Min(i + A.lastDiag(), maxColsIndex);
+         for (j= Max(SignedIndexType(i + A.firstDiag()), 0); j<=stop_j; ++j)
+            Reduction::combine(r, ResultType(A.getElementUnchecked(i, j)), 1);
+      }
+   }
+};
+
+template<class MatrixType>
+struct MATRIX_REDUCTION
+{
+   typedef MatrixType::Config::DSLFeatures::Density Density;
+
+   typedef IF<EQUAL<Density::id, Density::sparse_id>::RET,
+                  SparseReduction,
+                  BandReduction>::RET RET;
+};
+
+
+//********************************* any matrix *********************************
+
+// AnyMatrixHolder is the interface through which AnyMatrix reaches the
+// matrix. Its functions are the coarse-grained operations; the vectors and
+// dense matrices passed to them have the types given by the handle.
+template<class ElementType, class IndexType>
+class AnyMatrixHolder
+{
+   public:
+      typedef SolverVector<ElementType, IndexType>   VectorType;
+      typedef MATRIX_GENERATOR<
+                 matrix< ElementType,
+                         structure< rect< dyn_val<>, dyn_val<>,
+                                          array<fortran_like<> > >,
+                                    dense<>
+                         >,
+                         speed<>,
+                         unspecified_DSL_feature,
+                         unspecified_DSL_feature,
+                         unspecified_DSL_feature,
+                         IndexType
+                 >
+              >::RET DenseType;
+      typedef MATRIX_GENERATOR<
+                 matrix< ElementType,
+                         structure< rect< dyn_val<>, dyn_val<>, CSR<> >,
+                                    sparse<>
+                         >,
+                         speed<>,
+                         unspecified_DSL_feature,
+                         unspecified_DSL_feature,
+                         unspecified_DSL_feature,
+                         IndexType
+                 >
+              >::RET SparseType;
+      typedef SparseType::Config::OffsetType         OffsetType;
+      typedef CompressedRows<ElementType, IndexType, OffsetType> RowsType;
+
+      AnyMatrixHolder() : refs_(1) {}
+      virtual ~AnyMatrixHolder() {}
+
+      // reference counting of the handles sharing the matrix; the handles
+      // may be copied by several threads, so the count is changed in a
+      // critical section (atomic capture is not available in OpenMP 2.0)
+      void attach()
+      {
+         #pragma omp critical (db_matrix_anymatrix_refs)
+         ++refs_;
+      }
+
+      bool detach()
+      {
+         int refs;
+         #pragma omp critical (db_matrix_anymatrix_refs)
+         refs= --refs_;
+         return refs == 0;
+      }
+
+      virtual const type_info& type() const= 0;
+
+      virtual IndexType rows() const= 0;
+      virtual IndexType cols() const= 0;
+
+      // y= A*x
+      virtual void multiply(const VectorType& x, VectorType& y,
+                                                      bool parallel) const= 0;
+
+      // Y= A*X
+      virtual void multiplyMultiple(const DenseType& X, DenseType& Y,
+                                                      bool parallel) const= 0;
+
+      // C= A*B
+      virtual void multiply(const AnyMatrixHolder& B, DenseType& C,
+                                                      bool parallel) const= 0;
+
+      // A= B
+      virtual void assign(const AnyMatrixHolder& B)= 0;
+
+      virtual void copyTo(DenseType& D) const= 0;
+      virtual void copyTo(SparseType& S) const= 0;
+      virtual void extractRows(RowsType& rows) const= 0;
+
+      virtual ElementType reduce(int op) const= 0;
+
+   private:
+      AnyMatrixHolder(const AnyMatrixHolder&);
+      AnyMatrixHolder& operator=(const AnyMatrixHolder&);
+
+      int refs_;
+};
+
+template<class MatrixType, class ElementType, class IndexType>
+class AnyMatrixModel : public AnyMatrixHolder<ElementType, IndexType>
+{
+      typedef AnyMatrixHolder<ElementType, IndexType> Holder;
+      typedef MatrixType::Config::IndexType           MatrixIndexType;
+      typedef MatrixType::Config::ElementType         MatrixElementType;
+
+   public:
+      typedef Holder::VectorType VectorType;
+      typedef Holder::RowsType   RowsType;
+      typedef Holder::DenseType  DenseType;
+      typedef Holder::SparseType SparseType;
+
+      AnyMatrixModel(const MatrixIndexType& rows, const MatrixIndexType& cols,
+                     const MatrixIndexType& diags,
+                                             const MatrixElementType& initElem)
+         : m_(rows, cols, diags, initElem)
+      {}
+
+      MatrixType&       matrix()       {return m_;}
+      const MatrixType& matrix() const {return m_;}
+
+      const type_info& type() const {return typeid(MatrixType);}
+
+      IndexType rows() const {return m_.rows();}
+      IndexType cols() const {return m_.cols();}
+
+      void multiply(const VectorType& x, VectorType& y, bool parallel) const
+      {
+         assert(x.size()==m_.cols()); assert(y.size()==m_.rows());
+         MATRIX_SPMV<MatrixType>::RET::multiply(m_, x, y, parallel);
+      }
+
+      void multiplyMultiple(const DenseType& X, DenseType& Y,
+                                                          bool parallel) const
+      {
+         assert(X.rows()==m_.cols()); assert(Y.rows()==m_.rows());
+         assert(Y.cols()==X.cols());
+         MATRIX_SPMM<MatrixType>::RET::multiply(m_, X, Y, parallel);
+      }
+
+      // B is copied into a dense matrix, whose columns are then multiplied
+      void multiply(const Holder& B, DenseType& C, bool parallel) const
+      {
+         DenseType X(B.rows(), B.cols());
+         B.copyTo(X);
+         multiplyMultiple(X, C, parallel);
+      }
+
+      // a matrix of the same type is assigned directly, any other one through
+      // a CSR copy, so that the format of this matrix is filled by its own
+      // conversion (chosen by MATRIX_ASSIGNMENT) instead of element by element
+      void assign(const Holder& B)
+      {
+         if (&B == this) return;
+         assert(B.rows()==m_.rows()); assert(B.cols()==m_.cols());
+         if (B.type() == typeid(MatrixType))
+         {
+            MATRIX_ASSIGNMENT<MatrixType>::RET::assign(&m_,
+                                  &static_cast<const AnyMatrixModel&>(B).m_);
+            return;
+         }
+
+         SparseType S(B.rows(), B.cols());
+         B.copyTo(S);
+         MATRIX_ASSIGNMENT<SparseType>::RET::assign(&m_, &S);
+      }
+
+      void copyTo(DenseType& D) const
+      {
+         assert(D.rows()==m_.rows()); assert(D.cols()==m_.cols());
+         MATRIX_ASSIGNMENT<MatrixType>::RET::assign(&D, &m_);
+      }
+
+      void copyTo(SparseType& S) const
+      {
+         assert(S.rows()==m_.rows()); assert(S.cols()==m_.cols());
+         MATRIX_ASSIGNMENT<MatrixType>::RET::assign(&S, &m_);
+      }
+
+      void extractRows(RowsType& rows) const
+      {
+         MATRIX_ROWS_EXTRACTION<MatrixType>::RET::extract(m_, rows);
+      }
+
+      ElementType reduce(int op) const
+      {
+         typedef MATRIX_REDUCTION<MatrixType>::RET Reduction;
+
+         ElementType r= ElementType(0);
+         switch (op)
+         {
+            case matrix_reductions::sum_op:
+               Reduction::reduce(m_, r, SumReduction());
+               break;
+            case matrix_reductions::abs_max_op:
+               Reduction::reduce(m_, r, AbsMaxReduction());
+               break;
+            case matrix_reductions::square_sum_op:
+               Reduction::reduce(m_, r, SquareSumReduction());
+               break;
+            default:
+               assert(false);
+         }
+         return r;
+      }
+
+   private:
+      MatrixType m_;
+};
+
+
+// AnyMatrix is the handle. A default constructed handle is empty; create()
+// allocates a matrix of the given type:
+//
+//  AnyMatrix<double> a;
+//  if (format == "CSR") a.create<CSRDoubleMatrix>(n, n);
+//  else                 a.create<RectCDoubleMatrix>(n, n);
+//  a.multiply(x, y);
+//
+// get() gives access to the matrix if its type is known (e.g. for filling it
+// or for using it in matrix expressions).
+
+template<class ElementType, class IndexType= unsigned int>
+class AnyMatrix
+{
+      typedef AnyMatrixHolder<ElementType, IndexType> Holder;
+
+   public:
+      typedef Holder::VectorType VectorType;
+      typedef Holder::RowsType   RowsType;
+      typedef Holder::DenseType  DenseType;
+
+      AnyMatrix() : holder_(NULL) {}
+
+      AnyMatrix(const AnyMatrix& a) : holder_(a.holder_)
+      {
+         if (holder_) holder_->attach();
+      }
+
+      ~AnyMatrix() {release();}
+
+      // the handle refers to the matrix of a afterwards (it is shared, not
+      // copied; see assign() for copying the elements)
+      AnyMatrix& operator=(const AnyMatrix& a)
+      {
+         if (a.holder_) a.holder_->attach();
+         release();
+         holder_= a.holder_;
+         return *this;
+      }
+
+      template<class MatrixType>
+      MatrixType& create(const MatrixType::Config::IndexType& rows,
+                         const MatrixType::Config::IndexType& cols= 0,
+                         const MatrixType::Config::IndexType& diags= 1)
+      {
+         typedef MatrixType::Config::ElementType MatrixElementType;
+         typedef AnyMatrixModel<MatrixType, ElementType, IndexType> Model;
+
+         Model* model= new Model(rows, cols, diags, MatrixElementType(0));
+         release();
+         holder_= model;
+         return model->matrix();
+      }
+
+      // the matrix if it is of type MatrixType, NULL otherwise
+      template<class MatrixType>
+      MatrixType* get() const
+      {
+         typedef AnyMatrixModel<MatrixType, ElementType, IndexType> Model;
+
+         if (!holder_ || holder_->type() != typeid(MatrixType)) return NULL;
+         return &static_cast<Model*>(holder_)->matrix();
+      }
+
+      bool empty() const {return holder_ == NULL;}
+      const type_info& type() const {assert(holder_); return holder_->type();}
+
+      IndexType rows() const {assert(holder_); return holder_->rows();}
+      IndexType cols() const {assert(holder_); return holder_->cols();}
+
+      // y= A*x
+      void multiply(const VectorType& x, VectorType& y,
+                                                   bool parallel= false) const
+      {
+         assert(holder_);
+         holder_->multiply(x, y, parallel);
+      }
+
+      // Y= A*X; the columns of X and Y are the vectors
+      void multiplyMultiple(const DenseType& X, DenseType& Y,
+                                                   bool parallel= false) const
+      {
+         assert(holder_);
+         holder_->multiplyMultiple(X, Y, parallel);
+      }
+
+      // C= A*B
+      void multiply(const AnyMatrix& B, DenseType& C,
+                                                   bool parallel= false) const
+      {
+         assert(holder_); assert(B.holder_);
+         assert(B.rows()==cols());
+         assert(C.rows()==rows()); assert(C.cols()==B.cols());
+         holder_->multiply(*B.holder_, C, parallel);
+      }
+
+      // copies the elements of B (which must be representable in this
+      // matrix, e.g. B must not be rectangular if this matrix is symmetric);
+      // the matrix keeps its type, and all handles sharing it see the new
+      // elements
+      void assign(const AnyMatrix& B)
+      {
+         assert(holder_); assert(B.holder_);
+         holder_->assign(*B.holder_);
+      }
+
+      void copyTo(DenseType& D) const
+      {
+         assert(holder_);
+         holder_->copyTo(D);
+      }
+
+      void extractRows(RowsType& rows) const
+      {
+         assert(holder_);
+         holder_->extractRows(rows);
+      }
+
+      ElementType reduce(int op) const
+      {
+         assert(holder_);
+         return holder_->reduce(op);
+      }
+
+      ElementType    sum() const {return reduce(matrix_reductions::sum_op);}
+      ElementType absMax() const {return reduce(matrix_reductions::abs_max_op);}
+      ElementType  normF() const
+      {
+         return ElementType(sqrt(double(
+                                  reduce(matrix_reductions::square_sum_op))));
+      }
+
+   private:
+      void release()
+      {
+         if (holder_ && holder_->detach()) delete holder_;
+         holder_= NULL;
+      }
+
+      Holder* holder_;
+};
+
+
+#endif   // DB_MATRIX_ANYMATRIX_H
@@ -7,15 +7,19 @@
 /*                                                                            */
 /*  Classes:                                                                  */
 /*  - BoundsChecker                                                           */
+/*  - RangeChecker                                                            */
+/*  - EmptyRangeChecker                                                       */
 /*                                                                            */
 /*                                                                            */
 /*  class BoundsChecker provides bounds checking for read and write access    */
-/*  to a matrix. An exception is thrown upon index out of bounds . To change  */
-/*  this error behaviour simply nodify the member function checkBounds().     */
-/*  If you need a different error handler an analogous BoundsChecker class    */
-/*  with an altered checkBounds() or different handling of read and write     */
-/*  access (methods getElement() and setElement()) can be created.            */
-/*  Parameterizing the error reporting is possible, too.                      */    
+/*  to a matrix. Index out of bounds is passed to Config::ErrorReporter,      */
+/*  which is selected by the ErrorPolicy DSL feature (see ErrorReporters.h).  */
+/*  If the reporter returns, setElement() ignores the element and             */
+/*  getElement() returns zero.                                                */
+/*  Bulk operations (assignment, kernels) check their index range once with   */
+/*  the RangeChecker and then access the wrapped matrix without checks (see   */
+/*  Matrix::getElementUnchecked()). EmptyRangeChecker is used if bounds       */
+/*  checking is switched off.                                                 */
 /*                                                                            */
 /*                                                                            */
 /*  (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                */
@@ -40,6 +44,7 @@ class BoundsChecker : public OptSymmetricMatrix
       typedef OptSymmetricMatrix::Config  Config;
       typedef Config::ElementType         ElementType;
       typedef Config::IndexType           IndexType;
+      typedef Config::ErrorReporter       ErrorReporter;
 
       BoundsChecker(const IndexType& r, const IndexType& c, const IndexType& d,
                     const ElementType& initElem)
@@ -49,25 +54,65 @@ class BoundsChecker : public OptSymmetricMatrix
       void setElement(const IndexType& i, const IndexType& j,
                                                            const ElementType& v)
       {
-         checkBounds(i, j);
-         OptSymmetricMatrix::setElement(i, j, v);
+         if (checkBounds(i, j)) OptSymmetricMatrix::setElement(i, j, v);
+      }
+
+      void addToElement(const IndexType& i, const IndexType& j,
+                        const ElementType& v, bool keepZero= false)
+      {
+         if (checkBounds(i, j))
+            OptSymmetricMatrix::addToElement(i, j, v, keepZero);
       }
 
       ElementType getElement(const IndexType& i, const IndexType& j) const
       {
-         checkBounds(i, j);
-         return OptSymmetricMatrix::getElement(i, j);
+         return checkBounds(i, j) ? OptSymmetricMatrix::getElement(i, j)
+                                  : ElementType(0);
       }
 
    protected:
-      void checkBounds(const IndexType & i, const IndexType & j) const
+      bool checkBounds(const IndexType & i, const IndexType & j) const
+                               DB_MATRIX_NOEXCEPT_IF(!ErrorReporter::throws)
       {
-         if (i >= rows() || j >= cols())
-            throw "subscripts out of bounds";
+         if (i < rows() && j < cols()) return true;
+         ErrorReporter::report(matrix_errors::subscripts_out_of_bounds);
+         return false;
       }
 };
 
 
+// RangeChecker validates the index range of a bulk operation once, so that
+// its loops can access the elements without checking every subscript.
+template<class Generator>
+struct RangeChecker
+{
+   typedef Generator::Config::IndexType     IndexType;
+   typedef Generator::Config::ErrorReporter ErrorReporter;
+
+   // [0, r) x [0, c) must lie inside m
+   template<class M>
+   static bool checkRange(const M& m, const IndexType& r, const IndexType& c)
+                               DB_MATRIX_NOEXCEPT_IF(!ErrorReporter::throws)
+   {
+      if (r <= m.rows() && c <= m.cols()) return true;
+      ErrorReporter::report(
+                                       matrix_errors::subscripts_out_of_bounds);
+      return false;
+   }
+};
+
+template<class Generator>
+struct EmptyRangeChecker
+{
+   typedef Generator::Config::IndexType IndexType;
+
+   template<class M>
+   static bool checkRange(const M&, const IndexType&, const IndexType&)
+                                                             DB_MATRIX_NOEXCEPT
+   {return true;}
+};
+
+
 }  // namespace MatrixICCL
 
 #endif   // DB_MATRIX_BOUNDSCHECKER_H
@@ -0,0 +1,19 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "CommonMatrixTypes.cpp"              */
+/*                                                                            */
+/*                                                                            */
+/*  This file contains the explicit instantiations of the matrix types and    */
+/*  their kernels declared in "CommonMatrixTypes.h". It is the only source    */
+/*  file of the static library project "GMCL Lib"; programs using the         */
+/*  common types link against this library instead of instantiating them in   */
+/*  every translation unit.                                                   */
+/*                                                                            */
+/*                                                                            */
+/* (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                 */
+/*                       Ulrich Eisenecker, Johannes Knaupp                   */
+/*                                                                            */
+/******************************************************************************/
+
+#define DB_MATRIX_INSTANTIATE_COMMON_TYPES
+#include "CommonMatrixTypes.h"
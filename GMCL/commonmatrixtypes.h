@@ -0,0 +1,243 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "CommonMatrixTypes.h"                */
+/*                                                                            */
+/*                                                                            */
+/*  Category:   Precompiled matrix types                                      */
+/*                                                                            */
+/*  Types:                                                                    */
+/*  - RectCDoubleMatrix, RectFDoubleMatrix                                    */
+/*  - RectCFloatMatrix, RectFFloatMatrix                                      */
+/*  - CSRDoubleMatrix, CSCDoubleMatrix                                        */
+/*  - SymmSKYDoubleMatrix                                                     */
+/*  - BandDIADoubleMatrix                                                     */
+/*                                                                            */
+/*                                                                            */
+/*  This file defines the most frequently used matrix configurations and      */
+/*  declares their component classes (format, symmetry wrapper, bounds        */
+/*  checker and top wrapper) and the algorithms selected for them             */
+/*  (assignment, SpMV, product element and fused gemm) as 'extern template'.  */
+/*  A translation unit including this file does not instantiate these member  */
+/*  functions but links against the explicit instantiations in                */
+/*  "CommonMatrixTypes.cpp", which is compiled once into the GMCL library     */
+/*  (project "GMCL Lib"). Inline functions may still be expanded in place.    */
+/*  Other configurations are generated as usual.                              */
+/*                                                                            */
+/*                                                                            */
+/* (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                 */
+/*                       Ulrich Eisenecker, Johannes Knaupp                   */
+/*                                                                            */
+/******************************************************************************/
+
+#ifndef DB_MATRIX_COMMONMATRIXTYPES_H
+#define DB_MATRIX_COMMONMATRIXTYPES_H
+
+#include "GenerativeMatrix.h"
+
+// CommonMatrixTypes.cpp defines DB_MATRIX_INSTANTIATE_COMMON_TYPES before
+// including this file and so turns the declarations below into the explicit
+// instantiations
+#ifdef DB_MATRIX_INSTANTIATE_COMMON_TYPES
+#define DB_MATRIX_COMMON_TEMPLATE template
+#else
+#define DB_MATRIX_COMMON_TEMPLATE extern template
+#endif
+
+
+//************************* dense rectangular matrices *************************
+
+typedef MATRIX_GENERATOR<
+           matrix< double,
+                   structure< rect< dyn_val<>, dyn_val<>, array<c_like<> > >,
+                              dense<>
+                   >
+           >
+        >::RET RectCDoubleMatrix;
+
+typedef MATRIX_GENERATOR<
+           matrix< double,
+                   structure< rect< dyn_val<>, dyn_val<>,
+                                    array<fortran_like<> > >,
+                              dense<>
+                   >
+           >
+        >::RET RectFDoubleMatrix;
+
+typedef MATRIX_GENERATOR<
+           matrix< float,
+                   structure< rect< dyn_val<>, dyn_val<>, array<c_like<> > >,
+                              dense<>
+                   >
+           >
+        >::RET RectCFloatMatrix;
+
+typedef MATRIX_GENERATOR<
+           matrix< float,
+                   structure< rect< dyn_val<>, dyn_val<>,
+                                    array<fortran_like<> > >,
+                              dense<>
+                   >
+           >
+        >::RET RectFFloatMatrix;
+
+typedef RectCDoubleMatrix::Config RectCDoubleConfig;
+typedef RectFDoubleMatrix::Config RectFDoubleConfig;
+typedef  RectCFloatMatrix::Config  RectCFloatConfig;
+typedef  RectFFloatMatrix::Config  RectFFloatConfig;
+
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::ArrFormat<RectCDoubleConfig::Ext,
+                  RectCDoubleConfig::Diags, RectCDoubleConfig::Arr>;
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::BoundsChecker<
+                                           RectCDoubleConfig::UncheckedMatrix>;
+DB_MATRIX_COMMON_TEMPLATE struct MatrixICCL::Matrix<
+                                             RectCDoubleConfig::CheckedMatrix>;
+
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::ArrFormat<RectFDoubleConfig::Ext,
+                  RectFDoubleConfig::Diags, RectFDoubleConfig::Arr>;
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::BoundsChecker<
+                                           RectFDoubleConfig::UncheckedMatrix>;
+DB_MATRIX_COMMON_TEMPLATE struct MatrixICCL::Matrix<
+                                             RectFDoubleConfig::CheckedMatrix>;
+
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::ArrFormat<RectCFloatConfig::Ext,
+                  RectCFloatConfig::Diags, RectCFloatConfig::Arr>;
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::BoundsChecker<
+                                            RectCFloatConfig::UncheckedMatrix>;
+DB_MATRIX_COMMON_TEMPLATE struct MatrixICCL::Matrix<
+                                              RectCFloatConfig::CheckedMatrix>;
+
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::ArrFormat<RectFFloatConfig::Ext,
+                  RectFFloatConfig::Diags, RectFFloatConfig::Arr>;
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::BoundsChecker<
+                                            RectFFloatConfig::UncheckedMatrix>;
+DB_MATRIX_COMMON_TEMPLATE struct MatrixICCL::Matrix<
+                                              RectFFloatConfig::CheckedMatrix>;
+
+
+//************************ sparse rectangular matrices *************************
+
+typedef MATRIX_GENERATOR<
+           matrix< double,
+                   structure< rect< dyn_val<>, dyn_val<>, CSR<> >,
+                              sparse<>
+                   >
+           >
+        >::RET CSRDoubleMatrix;
+
+typedef MATRIX_GENERATOR<
+           matrix< double,
+                   structure< rect< dyn_val<>, dyn_val<>, CSC<> >,
+                              sparse<>
+                   >
+           >
+        >::RET CSCDoubleMatrix;
+
+typedef CSRDoubleMatrix::Config CSRDoubleConfig;
+typedef CSCDoubleMatrix::Config CSCDoubleConfig;
+
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::CSRFormat<CSRDoubleConfig::Ext,
+                  CSRDoubleConfig::IndexVec, CSRDoubleConfig::OffsetVec,
+                                                     CSRDoubleConfig::ElemVec>;
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::BoundsChecker<
+                                             CSRDoubleConfig::UncheckedMatrix>;
+DB_MATRIX_COMMON_TEMPLATE struct MatrixICCL::Matrix<
+                                               CSRDoubleConfig::CheckedMatrix>;
+
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::CSCFormat<CSCDoubleConfig::Ext,
+                  CSCDoubleConfig::IndexVec, CSCDoubleConfig::OffsetVec,
+                                                     CSCDoubleConfig::ElemVec>;
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::BoundsChecker<
+                                             CSCDoubleConfig::UncheckedMatrix>;
+DB_MATRIX_COMMON_TEMPLATE struct MatrixICCL::Matrix<
+                                               CSCDoubleConfig::CheckedMatrix>;
+
+
+//************************** symmetric skyline matrix **************************
+
+typedef MATRIX_GENERATOR<
+           matrix< double,
+                   structure< symm< dyn_val<>, SKY<> >
+                   >
+           >
+        >::RET SymmSKYDoubleMatrix;
+
+typedef SymmSKYDoubleMatrix::Config SymmSKYDoubleConfig;
+
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::LoSKYFormat<
+                  SymmSKYDoubleConfig::Ext, SymmSKYDoubleConfig::Diags,
+                  SymmSKYDoubleConfig::OffsetVec, SymmSKYDoubleConfig::ElemVec>;
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::Symm<SymmSKYDoubleConfig::Format>;
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::BoundsChecker<
+                                         SymmSKYDoubleConfig::UncheckedMatrix>;
+DB_MATRIX_COMMON_TEMPLATE struct MatrixICCL::Matrix<
+                                           SymmSKYDoubleConfig::CheckedMatrix>;
+
+
+//***************************** band matrix in DIA *****************************
+
+typedef MATRIX_GENERATOR<
+           matrix< double,
+                   structure< band_diag< dyn_val<>, dyn_val<>, DIA<> >
+                   >
+           >
+        >::RET BandDIADoubleMatrix;
+
+typedef BandDIADoubleMatrix::Config BandDIADoubleConfig;
+
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::DIAFormat<BandDIADoubleConfig::Ext,
+                  BandDIADoubleConfig::Diags, BandDIADoubleConfig::Arr>;
+DB_MATRIX_COMMON_TEMPLATE class MatrixICCL::BoundsChecker<
+                                         BandDIADoubleConfig::UncheckedMatrix>;
+DB_MATRIX_COMMON_TEMPLATE struct MatrixICCL::Matrix<
+                                           BandDIADoubleConfig::CheckedMatrix>;
+
+
+//******************************* common kernels *******************************
+
+// The algorithms are static member templates of the algorithm classes, which
+// the class declarations above do not cover. DB_MATRIX_COMMON_KERNELS
+// declares the assignment from a matrix of the same type (MATRIX_ASSIGNMENT)
+// and the SpMV with SolverVectors of the element type (MATRIX_SPMV) of T;
+// DB_MATRIX_COMMON_DENSE_KERNELS adds the element of a product T*T
+// (MATRIX_MULTIPLY_GET_ELEMENT) and the fused gemm of the dense types.
+
+#define DB_MATRIX_COMMON_KERNELS(T)                                           \
+   DB_MATRIX_COMMON_TEMPLATE void MATRIX_ASSIGNMENT<T>::RET::                 \
+                                                  assign(T*, const T*);       \
+   DB_MATRIX_COMMON_TEMPLATE void MATRIX_SPMV<T>::RET::multiply(const T&,     \
+      const SolverVector<T::Config::ElementType, T::Config::IndexType>&,      \
+            SolverVector<T::Config::ElementType, T::Config::IndexType>&, bool);
+
+#define DB_MATRIX_COMMON_DENSE_KERNELS(T)                                     \
+   DB_MATRIX_COMMON_TEMPLATE MultiplicationExpression<T, T>::ElementType      \
+   MATRIX_MULTIPLY_GET_ELEMENT<T, T>::RET::getElement(                        \
+      const MultiplicationExpression<T, T>::IndexType&,                       \
+      const MultiplicationExpression<T, T>::IndexType&,                       \
+      const MultiplicationExpression<T, T>*, const T&, const T&,              \
+      CACHE_MATRIX_TYPE<T>::RET*, CACHE_MATRIX_TYPE<T>::RET*);                \
+   DB_MATRIX_COMMON_TEMPLATE void FusedKernels::gemm(T*,                      \
+      const T::Config::ElementType&, const T&, const T&);                     \
+   DB_MATRIX_COMMON_TEMPLATE void FusedKernels::gemm(T*,                      \
+      const T::Config::ElementType&, const T&, const T&,                      \
+      const T::Config::ElementType&, const T&);
+
+DB_MATRIX_COMMON_KERNELS(RectCDoubleMatrix)
+DB_MATRIX_COMMON_KERNELS(RectFDoubleMatrix)
+DB_MATRIX_COMMON_KERNELS(RectCFloatMatrix)
+DB_MATRIX_COMMON_KERNELS(RectFFloatMatrix)
+DB_MATRIX_COMMON_KERNELS(CSRDoubleMatrix)
+DB_MATRIX_COMMON_KERNELS(CSCDoubleMatrix)
+DB_MATRIX_COMMON_KERNELS(SymmSKYDoubleMatrix)
+DB_MATRIX_COMMON_KERNELS(BandDIADoubleMatrix)
+
+DB_MATRIX_COMMON_DENSE_KERNELS(RectCDoubleMatrix)
+DB_MATRIX_COMMON_DENSE_KERNELS(RectFDoubleMatrix)
+DB_MATRIX_COMMON_DENSE_KERNELS(RectCFloatMatrix)
+DB_MATRIX_COMMON_DENSE_KERNELS(RectFFloatMatrix)
+
+
+#undef DB_MATRIX_COMMON_DENSE_KERNELS
+#undef DB_MATRIX_COMMON_KERNELS
+#undef DB_MATRIX_COMMON_TEMPLATE
+
+#endif   // DB_MATRIX_COMMONMATRIXTYPES_H
@@ -12,7 +12,8 @@
 /*                                                                            */
 /*  These classes provide (CompatChecker) or do not provide (EmptyCompat-     */
 /*  Checker)compatibility checking for addition, subtraction and multiplica-  */
-/*  tion, depending on the DSL description.                                   */
+/*  tion, depending on the DSL description. Errors are passed to the          */
+/*  Config::ErrorReporter; the checks return false if it returns.             */
 /*                                                                            */
 /*                                                                            */
 /*  (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                */
@@ -33,20 +34,24 @@ template<class Generator>
 struct EmptyCompatChecker
 {
    template<class Res, class A1, class A2>
-   static void MultiplicationCheck(const Matrix<Res>&, const A1&, const A2&)
-   {}
+   static bool MultiplicationCheck(const Matrix<Res>&, const A1&, const A2&)
+                                                             DB_MATRIX_NOEXCEPT
+   {return true;}
 
    template<class A1, class A2>
-   static void MultiplicationParameterCheck(const A1&, const A2&)
-   {}
+   static bool MultiplicationParameterCheck(const A1&, const A2&)
+                                                             DB_MATRIX_NOEXCEPT
+   {return true;}
 
    template<class Res, class A1, class A2>
-   static void AdditionCheck(const Matrix<Res>&, const A1&, const A2&)
-   {}
+   static bool AdditionCheck(const Matrix<Res>&, const A1&, const A2&)
+                                                             DB_MATRIX_NOEXCEPT
+   {return true;}
 
    template<class A1, class A2>
-   static void AdditionParameterCheck(const A1&, const A2&)
-   {}
+   static bool AdditionParameterCheck(const A1&, const A2&)
+                                                             DB_MATRIX_NOEXCEPT
+   {return true;}
 };
 
 // CompatChecker
@@ -65,36 +70,54 @@ struct CompatChecker
    // types, MultiplicationParameterCheck and AdditionParameterCheck only check
    // the operands.
 
+   typedef Generator::Config::ErrorReporter ErrorReporter;
+
    template<class Res, class A1, class A2>
-   static void
+   static bool
    MultiplicationCheck(const Matrix<Res>& res, const A1& m1, const A2& m2)
+                               DB_MATRIX_NOEXCEPT_IF(!ErrorReporter::throws)
    {
-      MultiplicationParameterCheck( m1, m2 );
+      if (!MultiplicationParameterCheck( m1, m2 )) return false;
       if (res.rows() != m1.rows() || res.cols() != m2.cols())
-         throw "result matrix is incompatible";
+         return fail(matrix_errors::incompatible_result);
+      return true;
    }
 
    template<class A1, class A2>
-   static void MultiplicationParameterCheck(const A1& m1, const A2& m2)
+   static bool MultiplicationParameterCheck(const A1& m1, const A2& m2)
+                               DB_MATRIX_NOEXCEPT_IF(!ErrorReporter::throws)
    {
       if (m1.cols() != m2.rows())
-         throw "argument matrices are incompatible";
+         return fail(matrix_errors::incompatible_arguments);
+      return true;
    }
 
    template<class Res, class A1, class A2>
-   static void AdditionCheck(const Matrix<Res>& res, const A1& m1, const A2& m2)
+   static bool AdditionCheck(const Matrix<Res>& res, const A1& m1, const A2& m2)
+                               DB_MATRIX_NOEXCEPT_IF(!ErrorReporter::throws)
    {
-      AdditionParameterCheck( m1, m2 );
+      if (!AdditionParameterCheck( m1, m2 )) return false;
       if (m1.cols() != res.cols() || m1.rows() != res.rows())
-         throw "argument and result matrices are incompatible";
+         return fail(matrix_errors::incompatible_argument_and_result);
+      return true;
    }
 
    template<class A1, class A2>
-   static void AdditionParameterCheck(const A1& m1, const A2& m2)
+   static bool AdditionParameterCheck(const A1& m1, const A2& m2)
+                               DB_MATRIX_NOEXCEPT_IF(!ErrorReporter::throws)
    {
       if (m1.cols() != m2.cols() || m1.rows() != m2.rows())
-         throw "argument matrices are incompatible";
+         return fail(matrix_errors::incompatible_arguments);
+      return true;
    }
+
+   private:
+      static bool fail(const int& code)
+                               DB_MATRIX_NOEXCEPT_IF(!ErrorReporter::throws)
+      {
+         ErrorReporter::report(code);
+         return false;
+      }
 };
 
 
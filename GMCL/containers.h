@@ -16,6 +16,8 @@
 /*                                                                            */
 /*  The container classes are used for various purposes: to store matrix      */
 /*  elements, indices, hash vectors etc.                                      */
+/*  The positions in a one-dimensional container have the OffsetType of the   */
+/*  configuration, so that it may hold more elements than an index can count. */
 /*  The elements are stored in one (1D) or two (2D) dimensional arrays with   */
 /*  static (fix) or dynamic (Dyn) memory allocation. Two-dimensional con-     */
 /*  tainers use C style (row-wise) or fortran style (column-wise) ordering    */
@@ -41,7 +43,7 @@ class Fix1DContainer
 {
    public:
       typedef Generator::Config Config;
-      typedef Config::IndexType IndexType;
+      typedef Config::OffsetType IndexType;   // positions are offsets
       typedef ValueType ElementType;
 
       Fix1DContainer(const IndexType& initial_n)
@@ -119,17 +121,26 @@ class Dyn1DContainer
 {
    public:
       typedef Generator::Config Config;
-      typedef Config::IndexType IndexType;
+      typedef Config::OffsetType IndexType;   // positions are offsets
       typedef Config::MallocErrorChecker MallocErrorChecker;
+      typedef Config::Instrumentation Instrumentation;
       typedef ValueType ElementType;
 
+   private:
+      typedef CheckHeapAllocation<Generator>::RET CheckHeapAllocation_;
+
+   public:
       Dyn1DContainer(const IndexType& initial_n)
          : count_(initial_n), size_(initial_n),
            growth_(initial_n*Growing::Value())
       {
          pContainer= new ElementType[size()];
-         MallocErrorChecker::ensure(pContainer != NULL);
-         assert(pContainer != NULL);
+         if (!MallocErrorChecker::ensure(pContainer != NULL))
+         {
+            count_= size_= growth_= 0;   // left empty
+            return;
+         }
+         Instrumentation::allocate(size()*sizeof(ElementType));
       }
 
       Dyn1DContainer(const IndexType & initial_n, const IndexType & max_n)
@@ -137,8 +148,12 @@ class Dyn1DContainer
            growth_(max_n*Growing::Value())
       {
          pContainer= new ElementType[size()];
-         MallocErrorChecker::ensure(pContainer != NULL);
-         assert(pContainer != NULL);
+         if (!MallocErrorChecker::ensure(pContainer != NULL))
+         {
+            count_= size_= growth_= 0;   // left empty
+            return;
+         }
+         Instrumentation::allocate(size()*sizeof(ElementType));
          assert(count()<= size());
       }
 
@@ -147,8 +162,7 @@ class Dyn1DContainer
       IndexType addElement(const ElementType& v= zero())
       {
          if (count()==size())
-            if (growth()>0) grow();
-            else return size();
+            if (growth()<=0 || !grow()) return size();
          pContainer[count_++]= v;
          return count();
       }
@@ -194,17 +208,19 @@ class Dyn1DContainer
          assert(i>=0); assert(i<count());
       }
 
-      void grow()
+      // false if the allocation failed; the container is unchanged then
+      bool grow()
       {
+         ElementType* newContainer= new ElementType[size()+growth()];
+         if (!MallocErrorChecker::ensure(newContainer != NULL)) return false;
          size_+= growth();
-         ElementType* newContainer= new ElementType[size()];
-         MallocErrorChecker::ensure(newContainer != NULL);
-         assert(newContainer != NULL);
+         Instrumentation::grow(size()*sizeof(ElementType));
 
          for (IndexType i= 0; i<count(); ++i)
             newContainer[i]= pContainer[i];
          delete [] pContainer;
          pContainer= newContainer;
+         return true;
       }
 
       IndexType count_, size_, growth_;
@@ -256,6 +272,12 @@ class Fix2DCContainer
 
       static const ElementType & zero() {return eNull;}
 
+      // raw access to the storage lines (rows, or columns in the F variant)
+      IndexType            lines() const {return r;}
+      IndexType       lineLength() const {return c;}
+      ElementType*       line(const IndexType& l)       {return elements[l];}
+      const ElementType* line(const IndexType& l) const {return elements[l];}
+
    protected:
       void checkBounds(const IndexType& i, const IndexType& j) const
       {
@@ -310,13 +332,24 @@ class Dyn2DCContainer
       typedef Config::IndexType IndexType;
       typedef Config::MallocErrorChecker MallocErrorChecker;
 
+   private:
+      typedef CheckHeapAllocation<Generator>::RET CheckHeapAllocation_;
+
+   public:
       Dyn2DCContainer(const IndexType& r, const IndexType& c)
          : r_(r), c_(c)
       {
          elements_= new ElementType[rows()*cols()];
-         MallocErrorChecker::ensure(elements_ != NULL); assert(elements_ != NULL);
-         rows_= new ElementType*[rows()];
-         MallocErrorChecker::ensure(rows_     != NULL); assert(rows_     != NULL);
+         rows_= elements_ == NULL ? NULL : new ElementType*[rows()];
+         if (!MallocErrorChecker::ensure(elements_ != NULL && rows_ != NULL))
+         {
+            delete [] elements_;   // left as a 0 x 0 matrix
+            elements_= NULL;
+            r_= c_= 0;
+            return;
+         }
+         Config::Instrumentation::allocate(rows()*cols()*sizeof(ElementType) +
+                                           rows()*sizeof(ElementType*));
          ElementType* p= elements_;
          for (IndexType i= 0; i<r; i++, p+= c) rows_[i]= p;
      }
@@ -352,6 +385,12 @@ class Dyn2DCContainer
 
       static const ElementType & zero() {return eNull;}
 
+      // raw access to the storage lines (rows, or columns in the F variant)
+      IndexType            lines() const {return r_;}
+      IndexType       lineLength() const {return c_;}
+      ElementType*       line(const IndexType& l)       {return rows_[l];}
+      const ElementType* line(const IndexType& l) const {return rows_[l];}
+
    protected:
       void checkBounds(const IndexType& i, const IndexType& j) const
       {
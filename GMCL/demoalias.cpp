@@ -0,0 +1,118 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "DemoAlias.cpp"                      */
+/*                                                                            */
+/*                                                                            */
+/*                                                                            */
+/*  This file times the assignment of an expression to a matrix which is an   */
+/*  operand of it against the assignment to a separate result. A product      */
+/*  R= A*B reads A and B at other positions than the one being written, so    */
+/*  A= A*B is evaluated into a pooled temporary which is copied back, while   */
+/*  R= A*B is evaluated in place. A sum is read at the position being         */
+/*  written only, so A= A+B is evaluated in place like R= A+B. Both paths are */
+/*  timed for dense matrices of two orders, and their results are compared.   */
+/*  The times are written to "ResultAlias.txt".                               */
+/*                                                                            */
+/*  The file has a main() of its own and is compiled on its own; it is        */
+/*  excluded from the build of project "GMCL".                                */
+/*                                                                            */
+/*                                                                            */
+/* (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                 */
+/*                       Ulrich Eisenecker, Johannes Knaupp                   */
+/*                                                                            */
+/******************************************************************************/
+
+#include "GenerativeMatrix.h" // generative matrix includes
+#include <fstream>          // file stream operations
+#include <ctime>            // clock()
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect<> >
+                >
+            >::RET RectMatrixType;
+
+// true if a and b have the same elements
+template<class A, class B>
+bool equalElements(const A& a, const B& b)
+{
+   for (int i= 0; i<a.rows(); ++i)
+      for (int j= 0; j<a.cols(); ++j)
+         if (a.getElement(i, j)!=b.getElement(i, j)) return false;
+   return true;
+}
+
+// milliseconds per repetition
+double msPerRep(clock_t start, int reps)
+{
+   return 1000.0*(clock() - start)/CLOCKS_PER_SEC/reps;
+}
+
+// times reps assignments A= A*B and R= A*B, each after resetting A to A0,
+// and the same for the sum; the reset is part of both times
+template<class MatrixType>
+bool timeAll(ostream& out, const char* name, const MatrixType& A0,
+             const MatrixType& B, int reps)
+{
+   MatrixType A(A0.rows(), A0.cols()), R(A0.rows(), A0.cols()),
+              P(A0.rows(), A0.cols());
+   clock_t    start;
+   double     aliased, separate;
+   int        k;
+   bool       ok;
+
+   // untimed, so that the pool holds its temporary when the timing starts
+   A= A0;
+   A= A*B;
+   R= A*B;
+
+   start= clock();
+   for (k= 0; k<reps; ++k) { A= A0; R= A*B; }
+   separate= msPerRep(start, reps);
+   start= clock();
+   for (k= 0; k<reps; ++k) { A= A0; A= A*B; }
+   aliased= msPerRep(start, reps);
+   ok= equalElements(A, R);
+   out << name << " product:  R= A*B " << separate << " ms,  A= A*B "
+       << aliased << " ms  " << (ok ? "ok" : "FAILED") << endl;
+
+   start= clock();
+   for (k= 0; k<reps; ++k) { A= A0; R= A+B; }
+   separate= msPerRep(start, reps);
+   start= clock();
+   for (k= 0; k<reps; ++k) { A= A0; A= A+B; }
+   aliased= msPerRep(start, reps);
+   P= A0+B;
+   const bool sumOk= equalElements(A, P) && equalElements(R, P);
+   out << name << " sum:      R= A+B " << separate << " ms,  A= A+B "
+       << aliased << " ms  " << (sumOk ? "ok" : "FAILED") << endl;
+   return ok && sumOk;
+}
+
+// operands with elements -3..3 and -2..2
+void fill(RectMatrixType& A, RectMatrixType& B)
+{
+   for (int i= 0; i<A.rows(); ++i)
+      for (int j= 0; j<A.cols(); ++j)
+      {
+         A.setElement(i, j, (i + 2*j) % 7 - 3);
+         B.setElement(i, j, (3*i + j) % 5 - 2);
+      }
+}
+
+void main()
+{
+   // Output file
+   ofstream fout("ResultAlias.txt");
+   bool ok= true;
+
+   RectMatrixType A(60, 60), B(60, 60);
+   fill(A, B);
+   ok= timeAll(fout, "60 x 60", A, B, 200) && ok;
+
+   RectMatrixType C(240, 240), D(240, 240);
+   fill(C, D);
+   ok= timeAll(fout, "240 x 240", C, D, 10) && ok;
+
+   fout << endl << (ok ? "ok" : "FAILED") << endl;
+}
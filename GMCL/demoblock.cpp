@@ -0,0 +1,105 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "DemoBlock.cpp"                      */
+/*                                                                            */
+/*                                                                            */
+/*                                                                            */
+/*  This file demonstrates the assignment of sparse matrices to a block of a  */
+/*  sparse matrix: a CSR and a COO matrix are assigned to block() of a CSR    */
+/*  matrix, which keeps its elements outside the block. The results are       */
+/*  compared with the same assignments to a dense matrix and written to       */
+/*  "ResultBlock.txt".                                                        */
+/*                                                                            */
+/*  The file has a main() of its own and is compiled on its own; it is        */
+/*  excluded from the build of project "GMCL".                                */
+/*                                                                            */
+/*                                                                            */
+/* (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                 */
+/*                       Ulrich Eisenecker, Johannes Knaupp                   */
+/*                                                                            */
+/******************************************************************************/
+
+#include "GenerativeMatrix.h" // generative matrix includes
+#include <fstream>          // file stream operations
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect< dyn_val<>, dyn_val<>, CSR<> >,
+                                   sparse<>
+                        >
+                >
+            >::RET CSRMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        // the buckets of the default hash dictionary
+                        // have no room for a matrix as small as C
+                        structure< rect< dyn_val<>, dyn_val<>,
+                                         COO< sorted_dict<> > >,
+                                   sparse<>
+                        >
+                >
+            >::RET COOMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect<> >
+                >
+            >::RET RectMatrixType;
+
+// true if a and b have the same elements
+template<class A, class B>
+bool equalElements(const A& a, const B& b)
+{
+   if (a.rows()!=b.rows() || a.cols()!=b.cols()) return false;
+   for (int i= 0; i<a.rows(); ++i)
+      for (int j= 0; j<a.cols(); ++j)
+         if (a.getElement(i, j)!=b.getElement(i, j)) return false;
+   return true;
+}
+
+void main()
+{
+   // Output file
+   ofstream fout("ResultBlock.txt");
+
+   CSRMatrixType A(5, 5), S(2, 3);
+   COOMatrixType C(2, 3);
+   RectMatrixType D(5, 5), T(2, 3);
+
+   // A and D hold the same elements, S, C and T as well; the elements of A
+   // inside the block are overwritten by zeros and by the elements of S
+   D=  1, 0, 0, 2, 0,
+       0, 3, 4, 0, 0,
+       0, 0, 5, 0, 6,
+       7, 0, 0, 8, 0,
+       0, 9, 0, 0, 10;
+   A= D;
+
+   T=  0, 11, 0,
+      12,  0, 13;
+   S= T;
+   C= T;
+
+   // block [1, 3) x [2, 5) of A
+   block(A, 1, 2, 2, 3)= S;
+   block(D, 1, 2, 2, 3)= S;
+   fout << "A after assigning the CSR matrix S to a block = " << endl
+        << A << endl;
+   fout << (equalElements(A, D) ? "ok" : "FAILED") << endl << endl;
+
+   // the same block, now from a COO matrix; the elements are the same, so A
+   // must not change
+   block(A, 1, 2, 2, 3)= C;
+   fout << "A after assigning the COO matrix C to the block = " << endl
+        << A << endl;
+   fout << (equalElements(A, D) ? "ok" : "FAILED") << endl << endl;
+
+   // a block of A which overlaps the assigned one is evaluated into a
+   // temporary first
+   block(A, 0, 0, 2, 3)= block(A, 1, 2, 2, 3);
+   block(D, 0, 0, 2, 3)= block(D, 1, 2, 2, 3);
+   fout << "A after assigning an overlapping block of itself = " << endl
+        << A << endl;
+   fout << (equalElements(A, D) ? "ok" : "FAILED") << endl;
+}
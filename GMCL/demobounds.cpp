@@ -0,0 +1,171 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "DemoBounds.cpp"                     */
+/*                                                                            */
+/*                                                                            */
+/*                                                                            */
+/*  This file times the bulk operations of dense matrices with and without    */
+/*  bounds checking. The assignment R= A (RectAssignment) and the product     */
+/*  R= A*B (FusedKernels::gemm) check their range once and then access the    */
+/*  elements unchecked, so a matrix with check_bounds<> should be as fast as  */
+/*  one with no_bounds_checking<>. For comparison the same operations are     */
+/*  written as loops over the checked getElement() and setElement(), which    */
+/*  is what every element access of the bulk operations used to cost. The     */
+/*  results of all variants are compared. The times are written to            */
+/*  "ResultBounds.txt".                                                       */
+/*                                                                            */
+/*  The file has a main() of its own and is compiled on its own; it is        */
+/*  excluded from the build of project "GMCL".                                */
+/*                                                                            */
+/*                                                                            */
+/* (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                 */
+/*                       Ulrich Eisenecker, Johannes Knaupp                   */
+/*                                                                            */
+/******************************************************************************/
+
+#include "GenerativeMatrix.h" // generative matrix includes
+#include <fstream>          // file stream operations
+#include <ctime>            // clock()
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect<> >,
+                        unspecified_DSL_feature, unspecified_DSL_feature,
+                        check_bounds<>
+                >
+            >::RET CheckedMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect<> >,
+                        unspecified_DSL_feature, unspecified_DSL_feature,
+                        no_bounds_checking<>
+                >
+            >::RET UncheckedMatrixType;
+
+// true if a and b have the same elements
+template<class A, class B>
+bool equalElements(const A& a, const B& b)
+{
+   for (int i= 0; i<a.rows(); ++i)
+      for (int j= 0; j<a.cols(); ++j)
+         if (a.getElement(i, j)!=b.getElement(i, j)) return false;
+   return true;
+}
+
+// the fastest of several timings, in milliseconds per repetition
+struct Timing
+{
+   double best;
+
+   Timing() : best(-1) {}
+
+   void add(clock_t start, int reps)
+   {
+      const double t= 1000.0*(clock() - start)/CLOCKS_PER_SEC/reps;
+      if (best<0 || t<best) best= t;
+   }
+};
+
+// R= A with the checked access to every element
+template<class MatrixType>
+void elementwiseAssign(MatrixType& R, const MatrixType& A)
+{
+   for (int i= A.rows(); i--;)
+      for (int j= A.cols(); j--;)
+         R.setElement(i, j, A.getElement(i, j));
+}
+
+// R= A*B with the checked access to every element
+template<class MatrixType>
+void elementwiseMultiply(MatrixType& R, const MatrixType& A,
+                         const MatrixType& B)
+{
+   const int n= A.cols();
+   for (int i= A.rows(); i--;)
+      for (int j= B.cols(); j--;)
+      {
+         double sum= 0;
+         for (int k= 0; k<n; ++k) sum+= A.getElement(i, k)*B.getElement(k, j);
+         R.setElement(i, j, sum);
+      }
+}
+
+// operands with elements -3..3 and -2..2
+template<class MatrixType>
+void fill(MatrixType& A, MatrixType& B)
+{
+   for (int i= 0; i<A.rows(); ++i)
+      for (int j= 0; j<A.cols(); ++j)
+      {
+         A.setElement(i, j, (i + 2*j) % 7 - 3);
+         B.setElement(i, j, (3*i + j) % 5 - 2);
+      }
+}
+
+void main()
+{
+   // Output file
+   ofstream fout("ResultBounds.txt");
+   bool    ok= true;
+   clock_t start;
+   int     k, round;
+
+   // the variants take turns, so that each sees the same state of the
+   // caches and of the processor clock; the fastest of 5 rounds is reported
+   const int rounds= 5;
+
+   const int na= 500, reps= 100;
+   CheckedMatrixType   CA(na, na), CB(na, na), CR(na, na), CL(na, na);
+   UncheckedMatrixType UA(na, na), UB(na, na), UR(na, na);
+   Timing              loopAssign, checkedAssign, uncheckedAssign;
+   fill(CA, CB);
+   fill(UA, UB);
+
+   for (round= 0; round<rounds; ++round)
+   {
+      start= clock();
+      for (k= 0; k<reps; ++k) elementwiseAssign(CL, CA);
+      loopAssign.add(start, reps);
+      start= clock();
+      for (k= 0; k<reps; ++k) CR= CA;
+      checkedAssign.add(start, reps);
+      start= clock();
+      for (k= 0; k<reps; ++k) UR= UA;
+      uncheckedAssign.add(start, reps);
+   }
+   fout << "R= A, " << na << " x " << na << ":" << endl
+        << "   checked loop          " << loopAssign.best << " ms" << endl
+        << "   check_bounds<>        " << checkedAssign.best << " ms" << endl
+        << "   no_bounds_checking<>  " << uncheckedAssign.best << " ms" << endl;
+   ok= equalElements(CL, CA) && equalElements(CR, CA) &&
+       equalElements(UR, CA) && ok;
+
+   const int np= 150, preps= 5;
+   CheckedMatrixType   CP(np, np), CQ(np, np), CS(np, np), CT(np, np);
+   UncheckedMatrixType UP(np, np), UQ(np, np), US(np, np);
+   Timing              loopProduct, checkedProduct, uncheckedProduct;
+   fill(CP, CQ);
+   fill(UP, UQ);
+
+   for (round= 0; round<rounds; ++round)
+   {
+      start= clock();
+      for (k= 0; k<preps; ++k) elementwiseMultiply(CT, CP, CQ);
+      loopProduct.add(start, preps);
+      start= clock();
+      for (k= 0; k<preps; ++k) CS= CP*CQ;
+      checkedProduct.add(start, preps);
+      start= clock();
+      for (k= 0; k<preps; ++k) US= UP*UQ;
+      uncheckedProduct.add(start, preps);
+   }
+   fout << "R= A*B, " << np << " x " << np << ":" << endl
+        << "   checked loop          " << loopProduct.best << " ms" << endl
+        << "   check_bounds<>        " << checkedProduct.best << " ms" << endl
+        << "   no_bounds_checking<>  " << uncheckedProduct.best << " ms"
+        << endl;
+   ok= equalElements(CS, CT) && equalElements(US, CT) && ok;
+
+   fout << endl << (ok ? "ok" : "FAILED") << endl;
+}
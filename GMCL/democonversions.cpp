@@ -0,0 +1,235 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "DemoConversions.cpp"                */
+/*                                                                            */
+/*                                                                            */
+/*                                                                            */
+/*  This file cross-checks the conversions between the sparse formats: a      */
+/*  fixed band matrix is stored in CSR, CSC, COO (with a sorted and with a    */
+/*  hash dictionary), DIA, BSR and SELL, and every one of these is assigned   */
+/*  to every other. A symmetric band matrix stored in symmetric SKY and its   */
+/*  lower triangle stored in lower triangular SKY are converted to and from   */
+/*  the general formats as well. Each result is compared element-wise with    */
+/*  a dense matrix holding the same elements. The results are written to      */
+/*  "ResultConversions.txt".                                                  */
+/*                                                                            */
+/*  The file has a main() of its own and is compiled on its own; it is        */
+/*  excluded from the build of project "GMCL".                                */
+/*                                                                            */
+/*                                                                            */
+/* (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                 */
+/*                       Ulrich Eisenecker, Johannes Knaupp                   */
+/*                                                                            */
+/******************************************************************************/
+
+#include "GenerativeMatrix.h" // generative matrix includes
+#include <fstream>          // file stream operations
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect< dyn_val<>, dyn_val<>, CSR<> >,
+                                   sparse<>
+                        >
+                >
+            >::RET CSRMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect< dyn_val<>, dyn_val<>, CSC<> >,
+                                   sparse<>
+                        >
+                >
+            >::RET CSCMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect< dyn_val<>, dyn_val<>,
+                                         COO< sorted_dict<> > >,
+                                   sparse<>
+                        >
+                >
+            >::RET SortedCOOMatrixType;
+
+// the buckets of the default hash dictionary (1013 of them) would have no
+// room for a matrix as small as the ones below
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect< dyn_val<>, dyn_val<>,
+                                         COO< hash_dict< int_number<int, 4> > >
+                                   >,
+                                   sparse<>
+                        >
+                >
+            >::RET HashCOOMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< band_diag< dyn_val<>, dyn_val<>, DIA<> >
+                        >
+                >
+            >::RET DIAMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect< dyn_val<>, dyn_val<>,
+                                         BSR< int_number<int, 2> > >,
+                                   sparse<>
+                        >
+                >
+            >::RET BSRMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect< dyn_val<>, dyn_val<>, SELL<> >,
+                                   sparse<>
+                        >
+                >
+            >::RET SELLMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< symm< dyn_val<>, SKY<> >
+                        >
+                >
+            >::RET SymmSKYMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< lower_triang< dyn_val<>, SKY<> >
+                        >
+                >
+            >::RET LowerSKYMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect<> >
+                >
+            >::RET RectMatrixType;
+
+// order and number of diagonals of the matrices
+const int n= 8, diags= 5;
+
+// true if a and b have the same elements
+template<class A, class B>
+bool equalElements(const A& a, const B& b)
+{
+   if (a.rows()!=b.rows() || a.cols()!=b.cols()) return false;
+   for (int i= 0; i<a.rows(); ++i)
+      for (int j= 0; j<a.cols(); ++j)
+         if (a.getElement(i, j)!=b.getElement(i, j)) return false;
+   return true;
+}
+
+// copies the nonzero elements of d to m; only the lower triangle if lower
+// is set (for symmetric and lower triangular m)
+template<class M>
+void fill(M& m, const RectMatrixType& d, bool lower)
+{
+   for (int i= 0; i<n; ++i)
+      for (int j= 0; j<=(lower ? i : n-1); ++j)
+         if (d.getElement(i, j)!=0) m.setElement(i, j, d.getElement(i, j));
+}
+
+// assigns s to a new matrix of type T and compares the result with d
+template<class T, class S>
+bool convert(ostream& out, const char* name, T*, const S& s,
+             const RectMatrixType& d)
+{
+   T t(n, n, diags);
+   t= s;
+   const bool ok= equalElements(t, d);
+   out << "   " << name << (ok ? " ok" : " FAILED");
+   return ok;
+}
+
+// assigns s to each of the general formats
+template<class S>
+bool convertToGeneral(ostream& out, const char* name, const S& s,
+                      const RectMatrixType& d)
+{
+   bool ok= equalElements(s, d);
+   out << name << (ok ? " ok" : " FAILED") << " ->";
+   ok= convert(out, "CSR",  (CSRMatrixType*)NULL,       s, d) && ok;
+   ok= convert(out, "CSC",  (CSCMatrixType*)NULL,       s, d) && ok;
+   ok= convert(out, "COO",  (SortedCOOMatrixType*)NULL, s, d) && ok;
+   ok= convert(out, "hash", (HashCOOMatrixType*)NULL,   s, d) && ok;
+   ok= convert(out, "DIA",  (DIAMatrixType*)NULL,       s, d) && ok;
+   ok= convert(out, "BSR",  (BSRMatrixType*)NULL,       s, d) && ok;
+   ok= convert(out, "SELL", (SELLMatrixType*)NULL,      s, d) && ok;
+   return ok;
+}
+
+// a general matrix of type S holding the elements of d, converted to the
+// general formats and, if d is lower triangular, to lower triangular SKY
+template<class S>
+bool checkGeneral(ostream& out, const char* name, S*, const RectMatrixType& d,
+                  bool lower)
+{
+   S s(n, n, diags);
+   fill(s, d, false);
+   bool ok= convertToGeneral(out, name, s, d);
+   if (lower)
+      ok= convert(out, "lower SKY", (LowerSKYMatrixType*)NULL, s, d) && ok;
+   out << endl;
+   return ok;
+}
+
+void main()
+{
+   // Output file
+   ofstream fout("ResultConversions.txt");
+
+   // G is a band matrix with two diagonals on each side and some zeros
+   // inside the band, S is symmetric, L is the lower triangle of S
+   RectMatrixType G(n, n), S(n, n), L(n, n);
+   int i, j;
+
+   for (i= 0; i<n; ++i)
+      for (j= 0; j<n; ++j)
+         if (j-i<=diags/2 && i-j<=diags/2 && (i*7 + j*3) % 5 != 0)
+         {
+            G.setElement(i, j, 10*i + j + 1);
+            S.setElement(i, j, i<j ? 10*j + i + 1 : 10*i + j + 1);
+            if (j<=i) L.setElement(i, j, 10*i + j + 1);
+         }
+   for (i= 0; i<n; ++i) S.setElement(i, i, 100 + i);   // full diagonal
+   for (i= 0; i<n; ++i) L.setElement(i, i, 100 + i);
+
+   fout << "G = " << endl << G << endl;
+   fout << "S = " << endl << S << endl;
+
+   bool ok= true;
+
+   fout << "general sources of G:" << endl;
+   ok= checkGeneral(fout, "CSR",  (CSRMatrixType*)NULL,       G, false) && ok;
+   ok= checkGeneral(fout, "CSC",  (CSCMatrixType*)NULL,       G, false) && ok;
+   ok= checkGeneral(fout, "COO",  (SortedCOOMatrixType*)NULL, G, false) && ok;
+   ok= checkGeneral(fout, "hash", (HashCOOMatrixType*)NULL,   G, false) && ok;
+   ok= checkGeneral(fout, "DIA",  (DIAMatrixType*)NULL,       G, false) && ok;
+   ok= checkGeneral(fout, "BSR",  (BSRMatrixType*)NULL,       G, false) && ok;
+   ok= checkGeneral(fout, "SELL", (SELLMatrixType*)NULL,      G, false) && ok;
+
+   // the symmetric source contributes both triangles to general results
+   fout << endl << "symmetric source S:" << endl;
+   SymmSKYMatrixType symm(n, n, diags);
+   fill(symm, S, true);
+   ok= convertToGeneral(fout, "symm SKY", symm, S) && ok;
+   ok= convert(fout, "symm SKY", (SymmSKYMatrixType*)NULL, symm, S) && ok;
+   fout << endl;
+
+   // the triangular results take the profile from the source
+   fout << endl << "general sources of L:" << endl;
+   ok= checkGeneral(fout, "CSR",  (CSRMatrixType*)NULL,       L, true) && ok;
+   ok= checkGeneral(fout, "CSC",  (CSCMatrixType*)NULL,       L, true) && ok;
+   ok= checkGeneral(fout, "COO",  (SortedCOOMatrixType*)NULL, L, true) && ok;
+   ok= checkGeneral(fout, "SELL", (SELLMatrixType*)NULL,      L, true) && ok;
+
+   fout << endl << "lower triangular source L:" << endl;
+   LowerSKYMatrixType lower(n, n, diags);
+   fill(lower, L, true);
+   ok= convertToGeneral(fout, "lower SKY", lower, L) && ok;
+   ok= convert(fout, "lower SKY", (LowerSKYMatrixType*)NULL, lower, L) && ok;
+   fout << endl;
+
+   fout << endl << (ok ? "ok" : "FAILED") << endl;
+}
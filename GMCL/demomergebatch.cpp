@@ -0,0 +1,257 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "DemoMergeBatch.cpp"                 */
+/*                                                                            */
+/*                                                                            */
+/*                                                                            */
+/*  This file checks the batch insertion of the sorted list dictionary        */
+/*  (SortedListDictionary::addElements(), which sorts a batch of triplets     */
+/*  and merges it into the list). Batches with duplicate positions, with      */
+/*  sums cancelling against the stored entries and within the batch, and      */
+/*  with new positions while the pattern is frozen are added to COO matrices  */
+/*  with the row major and with the Morton order of the entries. Each result  */
+/*  is compared with a dense matrix to which the same triplets are added one  */
+/*  by one; the number and the order of the stored entries are checked as     */
+/*  well. The results are written to "ResultMergeBatch.txt".                  */
+/*                                                                            */
+/*  The file has a main() of its own and is compiled on its own; it is        */
+/*  excluded from the build of project "GMCL".                                */
+/*                                                                            */
+/*                                                                            */
+/* (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                 */
+/*                       Ulrich Eisenecker, Johannes Knaupp                   */
+/*                                                                            */
+/******************************************************************************/
+
+#include "GenerativeMatrix.h" // generative matrix includes
+#include <fstream>          // file stream operations
+
+// a frozen pattern is reported by an error code instead of an exception
+// (MatrixDSL:: tells error_code<> from std::error_code)
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect< dyn_val<>, dyn_val<>,
+                                         COO< sorted_dict< row_major_key<> > >
+                                   >,
+                                   sparse<>
+                        >,
+                        unspecified_DSL_feature, unspecified_DSL_feature,
+                        unspecified_DSL_feature, unspecified_DSL_feature,
+                        unspecified_DSL_feature,
+                        MatrixDSL::error_code<>
+                >
+            >::RET RowMajorMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect< dyn_val<>, dyn_val<>,
+                                         COO< sorted_dict< morton_key<> > >
+                                   >,
+                                   sparse<>
+                        >,
+                        unspecified_DSL_feature, unspecified_DSL_feature,
+                        unspecified_DSL_feature, unspecified_DSL_feature,
+                        unspecified_DSL_feature,
+                        MatrixDSL::error_code<>
+                >
+            >::RET MortonMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect<> >
+                >
+            >::RET RectMatrixType;
+
+// order of the matrices
+const int n= 8;
+
+// a batch of triplets as read by addElements()
+template<class MatrixType>
+class Triplets
+{
+   public:
+      typedef MatrixType::Config::IndexType   IndexType;
+      typedef MatrixType::Config::ElementType ElementType;
+
+      Triplets(const int* i, const int* j, const double* v, int count)
+         : i_(i), j_(j), v_(v), n_(count), k_(0)
+      {}
+
+      void getNext(IndexType& i, IndexType& j, ElementType& v)
+      {
+         i= i_[k_];
+         j= j_[k_];
+         v= v_[k_++];
+      }
+
+      void reset() {k_= 0;}
+
+      bool end() const {return k_ >= n_;}
+
+   private:
+      const int    *i_, *j_;
+      const double *v_;
+      int           n_, k_;
+};
+
+// true if m stores count entries, in the order of its dictionary, and has
+// the elements of d
+template<class MatrixType>
+bool check(const MatrixType& m, const RectMatrixType& d, int count)
+{
+   typedef MatrixType::Config::IndexType IndexType;
+   typedef MatrixType::Config::ElementType ElementType;
+   typedef IF<IS_MORTON_COO_MATRIX<MatrixType>::RET,
+              MortonOrder<IndexType>,
+              RowMajorOrder<IndexType> >::RET EntryOrder;
+
+   MatrixType::IteratorType iter(m);
+   IndexType   i, j, pi= 0, pj= 0;
+   ElementType v;
+   int         stored= 0;
+
+   while (!iter.end())
+   {
+      iter.getNext(i, j, v);
+      if (stored++ > 0 && !EntryOrder::less(pi, pj, i, j)) return false;
+      pi= i;
+      pj= j;
+   }
+   for (i= 0; i<n; ++i)
+      for (j= 0; j<n; ++j)
+         if (m.getElement(i, j) != d.getElement(i, j)) return false;
+   return stored == count;
+}
+
+// adds the batch to m by addElements() and to d one by one and compares
+// them; error is the error code expected. A position stored before stays
+// stored unless the batch cancels it while the pattern is not frozen, a new
+// one is stored if its sum is not zero and the pattern is not frozen.
+template<class MatrixType>
+bool merge(ostream& out, const char* name, MatrixType& m, RectMatrixType& d,
+           const int* bi, const int* bj, const double* bv, int b,
+           int error= matrix_errors::no_error)
+{
+   typedef MatrixType::Config::IndexType IndexType;
+   typedef MatrixType::Config::ElementType ElementType;
+   typedef MatrixType::Config::ErrorReporter ErrorReporter;
+
+   bool        stored[n][n], inBatch[n][n];
+   IndexType   i, j;
+   ElementType v;
+   int         k, count= 0;
+
+   for (i= 0; i<n; ++i)
+      for (j= 0; j<n; ++j) stored[i][j]= inBatch[i][j]= false;
+   MatrixType::IteratorType iter(m);
+   while (!iter.end())
+   {
+      iter.getNext(i, j, v);
+      stored[i][j]= true;
+   }
+
+   const bool frozen= m.patternFrozen();
+   for (k= 0; k<b; ++k)
+      if (stored[bi[k]][bj[k]] || !frozen)
+      {
+         d.setElement(bi[k], bj[k], d.getElement(bi[k], bj[k]) + bv[k]);
+         inBatch[bi[k]][bj[k]]= true;
+      }
+   for (i= 0; i<n; ++i)
+      for (j= 0; j<n; ++j)
+         if (stored[i][j] ? frozen || !inBatch[i][j] || d.getElement(i, j)!=0
+                          : d.getElement(i, j)!=0)
+            ++count;
+
+   Triplets<MatrixType> batch(bi, bj, bv, b);
+   ErrorReporter::clearError();
+   m.addElements(batch);
+
+   const bool ok= check(m, d, count) && ErrorReporter::lastError() == error;
+   out << "   " << name << ": " << count << " entries"
+       << (ok ? "   ok" : "   FAILED") << endl;
+   return ok;
+}
+
+// all batches for one order of the entries
+template<class MatrixType>
+bool checkAll(ostream& out, MatrixType*)
+{
+   MatrixType     m(n, n);
+   RectMatrixType d(n, n);
+   bool           ok= true;
+   int            k, r;
+
+   const int    i0[]= {0, 2, 5, 5, 7};
+   const int    j0[]= {0, 3, 5, 1, 6};
+   const double v0[]= {1, 2, 3, 4, 5};
+   ok= merge(out, "initial entries", m, d, i0, j0, v0, 5) && ok;
+
+   // duplicates of a new and of a stored position, in reverse order
+   const int    i1[]= {4, 7, 4, 0, 6, 4, 0};
+   const int    j1[]= {1, 7, 1, 0, 7, 1, 0};
+   const double v1[]= {1, 1, 2, 5, 1, 3, 1};
+   ok= merge(out, "duplicates", m, d, i1, j1, v1, 7) && ok;
+
+   // (2, 3) and (5, 1) cancel against the stored entries, (6, 2) cancels
+   // within the batch, (5, 5) keeps its value and (1, 1) is a zero
+   const int    i2[]= {2, 6, 5, 6, 5, 5, 1, 3};
+   const int    j2[]= {3, 2, 5, 2, 5, 1, 1, 4};
+   const double v2[]= {-2, 4, 1, -4, -1, -4, 0, 9};
+   ok= merge(out, "cancelling sums", m, d, i2, j2, v2, 8) && ok;
+
+   // every entry of the list cancels
+   const int    i3[]= {0, 3, 4, 7, 5, 6, 7};
+   const int    j3[]= {0, 4, 1, 6, 5, 7, 7};
+   const double v3[]= {-7, -9, -6, -5, -3, -1, -1};
+   ok= merge(out, "all cancelled", m, d, i3, j3, v3, 7) && ok;
+
+   // a batch larger than the list, with duplicates spread over the matrix
+   int    i4[40], j4[40];
+   double v4[40];
+   for (k= 0, r= 7; k<40; ++k)
+   {
+      r= (r*37 + 11) % 97;
+      i4[k]= r % (n*n) / n;
+      j4[k]= r % n;
+      v4[k]= k % 3 + 1;
+   }
+   ok= merge(out, "large batch", m, d, i4, j4, v4, 40) && ok;
+   ok= merge(out, "large batch again", m, d, i4, j4, v4, 20) && ok;
+
+   // a free position
+   for (r= 0; d.getElement(r / n, r % n) != 0; ++r);
+
+   // while the pattern is frozen, a sum of zero stays stored and a new
+   // position is dropped and reported; a zero at a new position is not
+   m.freezePattern();
+   const int    i5[]= {i4[1], r / n, i4[0], i4[1], r / n};
+   const int    j5[]= {j4[1], r % n, j4[0], j4[1], r % n};
+   const double v5[]= {1, 0, -d.getElement(i4[0], j4[0]), 2, 0};
+   ok= merge(out, "frozen, stored positions", m, d, i5, j5, v5, 5) && ok;
+
+   const int    i6[]= {i4[0], r / n, r / n};
+   const int    j6[]= {j4[0], r % n, r % n};
+   const double v6[]= {1, 2, 3};
+   ok= merge(out, "frozen, new position", m, d, i6, j6, v6, 3,
+                                         matrix_errors::pattern_frozen) && ok;
+
+   // after thawing, the new position is stored and the zero stays stored
+   m.freezePattern(false);
+   ok= merge(out, "thawed, new position", m, d, i6+1, j6+1, v6+1, 2) && ok;
+   return ok;
+}
+
+void main()
+{
+   // Output file
+   ofstream fout("ResultMergeBatch.txt");
+   bool ok= true;
+
+   fout << "row major order:" << endl;
+   ok= checkAll(fout, (RowMajorMatrixType*)NULL) && ok;
+   fout << endl << "Morton order:" << endl;
+   ok= checkAll(fout, (MortonMatrixType*)NULL) && ok;
+
+   fout << endl << (ok ? "ok" : "FAILED") << endl;
+}
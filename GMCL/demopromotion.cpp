@@ -0,0 +1,218 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "DemoPromotion.cpp"                  */
+/*                                                                            */
+/*                                                                            */
+/*                                                                            */
+/*  This file writes the results of the type computations of the generator    */
+/*  to "ResultPromotion.txt": the shape promoted by MULTIPLY_PROMOTE_SHAPE,   */
+/*  ADD_PROMOTE_SHAPE and SUBTRACT_PROMOTE_SHAPE for all 121 pairs of the 11  */
+/*  shapes and by TRANSPOSE_PROMOTE_SHAPE for each shape, the DSL features    */
+/*  of the matrix configurations used by the other demos (computed by         */
+/*  MATRIX_DSL_ASSIGN_DEFAULTS), and the DSL features of the product and of   */
+/*  the sum of each pair of these configurations.                             */
+/*                                                                            */
+/*  The file serves two purposes. Its output depends on nothing but the       */
+/*  metafunctions, so a change to them which is meant to keep their results   */
+/*  can be checked by comparing the output before and after the change. And   */
+/*  most of its compile time is spent in these metafunctions, so it measures  */
+/*  what a change to them costs at compile time.                              */
+/*                                                                            */
+/*  The file has a main() of its own and is compiled on its own; it is        */
+/*  excluded from the build of project "GMCL".                                */
+/*                                                                            */
+/*                                                                            */
+/* (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                 */
+/*                       Ulrich Eisenecker, Johannes Knaupp                   */
+/*                                                                            */
+/******************************************************************************/
+
+#include "GenerativeMatrix.h" // generative matrix includes
+#include "DSLTypeInfo.h"      // DSL type information
+#include <fstream>          // file stream operations
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect<> >
+                >
+            >::RET RectMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< symm<> >
+                >
+            >::RET SymmMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< lower_triang<> >
+                >
+            >::RET LowerMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect< dyn_val<>, dyn_val<>, CSR<> >,
+                                   sparse<>
+                        >
+                >
+            >::RET CSRMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect< dyn_val<>, dyn_val<>, CSC<> >,
+                                   sparse<>
+                        >
+                >
+            >::RET CSCMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect< dyn_val<>, dyn_val<>,
+                                         COO< hash_dict< int_number<int, 4> > >
+                                   >,
+                                   sparse<>
+                        >
+                >
+            >::RET COOMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< band_diag< dyn_val<>, dyn_val<>, DIA<> >
+                        >
+                >
+            >::RET DIAMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect< dyn_val<>, dyn_val<>,
+                                         BSR< int_number<int, 2> > >,
+                                   sparse<>
+                        >
+                >
+            >::RET BSRMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect< dyn_val<>, dyn_val<>, SELL<> >,
+                                   sparse<>
+                        >
+                >
+            >::RET SELLMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< symm< dyn_val<>, SKY<> >
+                        >
+                >
+            >::RET SymmSKYMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< lower_triang< dyn_val<>, SKY<> >
+                        >
+                >
+            >::RET LowerSKYMatrixType;
+
+
+//******************************* shape promotion ******************************
+
+template<class Shape1, class Shape2>
+void promoteShapes(ostream& out, Shape1*, Shape2*)
+{
+   out << typeid(Shape1).name() << ", " << typeid(Shape2).name() << endl
+       << "   *  " << typeid(MULTIPLY_PROMOTE_SHAPE<Shape1, Shape2>::RET).name()
+       << endl
+       << "   +  " << typeid(ADD_PROMOTE_SHAPE<Shape1, Shape2>::RET).name()
+       << endl
+       << "   -  " << typeid(SUBTRACT_PROMOTE_SHAPE<Shape1, Shape2>::RET).name()
+       << endl;
+}
+
+// the promotions of Shape with each shape
+template<class Shape>
+void promoteShapes(ostream& out, Shape* s)
+{
+   promoteShapes(out, s, (rect<>*)NULL);
+   promoteShapes(out, s, (diag<>*)NULL);
+   promoteShapes(out, s, (scalar<>*)NULL);
+   promoteShapes(out, s, (ident<>*)NULL);
+   promoteShapes(out, s, (zero<>*)NULL);
+   promoteShapes(out, s, (lower_triang<>*)NULL);
+   promoteShapes(out, s, (upper_triang<>*)NULL);
+   promoteShapes(out, s, (symm<>*)NULL);
+   promoteShapes(out, s, (band_diag<>*)NULL);
+   promoteShapes(out, s, (lower_band_triang<>*)NULL);
+   promoteShapes(out, s, (upper_band_triang<>*)NULL);
+   out << typeid(Shape).name() << " transposed" << endl
+       << "      " << typeid(TRANSPOSE_PROMOTE_SHAPE<Shape>::RET).name()
+       << endl;
+}
+
+
+//***************************** type promotion *********************************
+
+template<class MatrixType1, class MatrixType2>
+void promoteTypes(ostream& out, const char* name1, MatrixType1*,
+                  const char* name2, MatrixType2*)
+{
+   typedef MULTIPLY_RESULT_TYPE<MatrixType1, MatrixType2>::RET ProductType;
+   typedef ADD_RESULT_TYPE<MatrixType1, MatrixType2>::RET SumType;
+
+   out << name1 << " * " << name2 << ":" << endl
+       << DSLFeaturesInfo<ProductType::Config::DSLFeatures>() << endl
+       << name1 << " + " << name2 << ":" << endl
+       << DSLFeaturesInfo<SumType::Config::DSLFeatures>() << endl;
+}
+
+// the features of MatrixType and the promotions with each configuration
+template<class MatrixType>
+void promoteTypes(ostream& out, const char* name, MatrixType* m)
+{
+   out << name << ":" << endl
+       << DSLFeaturesInfo<MatrixType::Config::DSLFeatures>() << endl;
+   promoteTypes(out, name, m, "rect",      (RectMatrixType*)NULL);
+   promoteTypes(out, name, m, "symm",      (SymmMatrixType*)NULL);
+   promoteTypes(out, name, m, "lower",     (LowerMatrixType*)NULL);
+   promoteTypes(out, name, m, "CSR",       (CSRMatrixType*)NULL);
+   promoteTypes(out, name, m, "CSC",       (CSCMatrixType*)NULL);
+   promoteTypes(out, name, m, "COO",       (COOMatrixType*)NULL);
+   promoteTypes(out, name, m, "DIA",       (DIAMatrixType*)NULL);
+   promoteTypes(out, name, m, "BSR",       (BSRMatrixType*)NULL);
+   promoteTypes(out, name, m, "SELL",      (SELLMatrixType*)NULL);
+   promoteTypes(out, name, m, "symm SKY",  (SymmSKYMatrixType*)NULL);
+   promoteTypes(out, name, m, "lower SKY", (LowerSKYMatrixType*)NULL);
+}
+
+
+void main()
+{
+   // Output file
+   ofstream fout("ResultPromotion.txt");
+
+   promoteShapes(fout, (rect<>*)NULL);
+   promoteShapes(fout, (diag<>*)NULL);
+   promoteShapes(fout, (scalar<>*)NULL);
+   promoteShapes(fout, (ident<>*)NULL);
+   promoteShapes(fout, (zero<>*)NULL);
+   promoteShapes(fout, (lower_triang<>*)NULL);
+   promoteShapes(fout, (upper_triang<>*)NULL);
+   promoteShapes(fout, (symm<>*)NULL);
+   promoteShapes(fout, (band_diag<>*)NULL);
+   promoteShapes(fout, (lower_band_triang<>*)NULL);
+   promoteShapes(fout, (upper_band_triang<>*)NULL);
+   fout << endl;
+
+   promoteTypes(fout, "rect",      (RectMatrixType*)NULL);
+   promoteTypes(fout, "symm",      (SymmMatrixType*)NULL);
+   promoteTypes(fout, "lower",     (LowerMatrixType*)NULL);
+   promoteTypes(fout, "CSR",       (CSRMatrixType*)NULL);
+   promoteTypes(fout, "CSC",       (CSCMatrixType*)NULL);
+   promoteTypes(fout, "COO",       (COOMatrixType*)NULL);
+   promoteTypes(fout, "DIA",       (DIAMatrixType*)NULL);
+   promoteTypes(fout, "BSR",       (BSRMatrixType*)NULL);
+   promoteTypes(fout, "SELL",      (SELLMatrixType*)NULL);
+   promoteTypes(fout, "symm SKY",  (SymmSKYMatrixType*)NULL);
+   promoteTypes(fout, "lower SKY", (LowerSKYMatrixType*)NULL);
+
+   fout << "ok" << endl;
+}
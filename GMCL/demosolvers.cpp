@@ -0,0 +1,117 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "DemoSolvers.cpp"                    */
+/*                                                                            */
+/*                                                                            */
+/*                                                                            */
+/*  This file demonstrates the iterative solvers: a small symmetric positive  */
+/*  definite system (the five-point Laplacian of a 5 x 8 grid plus a shift)   */
+/*  is solved in CSR and in dense form by CG, BiCGSTAB and GMRES, each with   */
+/*  a Jacobi and an ILU(0) preconditioner, with the serial and with the       */
+/*  parallel SpMV. The right-hand side is A*(1, ..., 1). For every solve the  */
+/*  true residual ||b - A*x|| is computed and compared with the tolerance of  */
+/*  SolverControl. The results are written to "ResultSolvers.txt".            */
+/*                                                                            */
+/*  The file has a main() of its own and is compiled on its own; it is        */
+/*  excluded from the build of project "GMCL".                                */
+/*                                                                            */
+/*                                                                            */
+/* (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                 */
+/*                       Ulrich Eisenecker, Johannes Knaupp                   */
+/*                                                                            */
+/******************************************************************************/
+
+#include "GenerativeMatrix.h" // generative matrix includes
+#include <fstream>          // file stream operations
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect< dyn_val<>, dyn_val<>, CSR<> >,
+                                   sparse<>
+                        >
+                >
+            >::RET CSRMatrixType;
+
+typedef MATRIX_GENERATOR<
+                matrix< double,
+                        structure< rect<> >
+                >
+            >::RET RectMatrixType;
+
+// solves A*x= A*(1, ..., 1) from x= 0 and checks the true residual against
+// the tolerance of control
+template<class Solver, class MatrixType, class Preconditioner>
+bool check(ostream& out, const char* name, const Solver&, const MatrixType& A,
+           const Preconditioner& M, const SolverControl& control)
+{
+   typedef SOLVER_VECTOR<MatrixType>::RET Vector;
+   const MatrixType::Config::IndexType n= A.rows();
+   Vector e(n, 1), b(n), x(n), r(n);
+
+   multiply(A, e, b, control.parallel());
+   SolverStats stats(control.maxIterations());
+   const bool converged= Solver::solve(A, b, x, M, control, stats);
+
+   multiply(A, x, r, control.parallel());
+   for (MatrixType::Config::IndexType i= 0; i<n; ++i) r[i]= b[i] - r[i];
+   const double residual = KrylovKernels::norm2(r);
+   const double tolerance= control.tolerance(KrylovKernels::norm2(b));
+   const bool ok= converged && residual<=tolerance;
+
+   out << name << (control.parallel() ? ", parallel SpMV: " : ": ")
+       << stats.iterations() << " iterations, residual " << residual
+       << ", tolerance " << tolerance << "   " << (ok ? "ok" : "FAILED")
+       << endl;
+   return ok;
+}
+
+// all solvers and preconditioners for A
+template<class MatrixType>
+bool checkAll(ostream& out, const MatrixType& A, const SolverControl& control)
+{
+   JacobiPreconditioner<MatrixType> jacobi(A);
+   ILU0Preconditioner<MatrixType>   ilu(A);
+   bool ok= true;
+
+   ok= check(out, "CG, Jacobi", ConjugateGradient(), A, jacobi, control) && ok;
+   ok= check(out, "CG, ILU(0)", ConjugateGradient(), A, ilu, control) && ok;
+   ok= check(out, "BiCGSTAB, Jacobi", BiCGSTAB(), A, jacobi, control) && ok;
+   ok= check(out, "BiCGSTAB, ILU(0)", BiCGSTAB(), A, ilu, control) && ok;
+   ok= check(out, "GMRES, Jacobi", GMRES(), A, jacobi, control) && ok;
+   ok= check(out, "GMRES, ILU(0)", GMRES(), A, ilu, control) && ok;
+   return ok;
+}
+
+void main()
+{
+   // Output file
+   ofstream fout("ResultSolvers.txt");
+
+   // the grid has nx x ny points, numbered row by row
+   const int nx= 5, ny= 8, n= nx*ny;
+   CSRMatrixType  A(n, n);
+   RectMatrixType D(n, n);
+
+   for (int i= 0; i<n; ++i)
+   {
+      D.setElement(i, i, 4.5);
+      if (i%nx > 0)    D.setElement(i, i-1,  -1);
+      if (i%nx < nx-1) D.setElement(i, i+1,  -1);
+      if (i >= nx)     D.setElement(i, i-nx, -1);
+      if (i <  n-nx)   D.setElement(i, i+nx, -1);
+   }
+   A= D;
+
+   const SolverControl serial  (200, 1e-10, 0.0, 20, false);
+   const SolverControl parallel(200, 1e-10, 0.0, 20, true);
+   bool ok= true;
+
+   fout << "CSR matrix" << endl;
+   ok= checkAll(fout, A, serial) && ok;
+   ok= checkAll(fout, A, parallel) && ok;
+   fout << endl << "dense matrix" << endl;
+   ok= checkAll(fout, D, serial) && ok;
+   ok= checkAll(fout, D, parallel) && ok;
+
+   fout << endl << (ok ? "ok" : "FAILED") << endl;
+}
@@ -7,7 +7,9 @@
 /*                                                                            */
 /*  Classes:                                                                  */
 /*  - HashDictionary                                                          */
+/*  - FixHashDictionary                                                       */
 /*  - ListDictionary                                                          */
+/*  - SortedListDictionary                                                    */
 /*                                                                            */
 /*                                                                            */
 /*  These classes are used as dictionary data structures for the sparse       */
@@ -16,6 +18,21 @@
 /*  HashDictionary takes a horizontal container, a vertical container and a   */
 /*  hash function as parameters to build the hash structure. The horizontal   */
 /*  container has to be a dictionary itself.                                  */
+/*  FixHashDictionary is the hash dictionary of matrices with static memory   */
+/*  allocation: the buckets are chains of entries in containers of the        */
+/*  dictionary, so that no bucket is allocated on the heap.                   */
+/*  appendElement() stores an entry which is known to be new without looking  */
+/*  it up; the format conversions fill a cleared dictionary this way.         */
+/*  addToElement() adds to an entry with a single lookup; it may keep the     */
+/*  entries whose sum is zero.                                                */
+/*  While the pattern of a dictionary is frozen (freezePattern()), zeros are  */
+/*  stored explicitly and no entry is inserted or removed; refillValues()     */
+/*  then replaces the values of the stored entries in place. A nonzero        */
+/*  outside the frozen pattern is reported to Config::ErrorReporter and       */
+/*  dropped.                                                                  */
+/*  SortedListDictionary keeps its entries sorted by rows or along the        */
+/*  Z-order curve, finds them by binary search and inserts batches of         */
+/*  entries by a merge (addElements()).                                       */
 /*                                                                            */
 /*                                                                            */
 /*                                                                            */
@@ -45,6 +62,7 @@ class HashIterator
    private:
       typedef Format::SecondaryVectorType ScndFormat;
       typedef ScndFormat::IteratorType    ScndIteratorType;
+      typedef CheckHeapAllocation<Format>::RET CheckHeapAllocation_;
 
    public:
       HashIterator(const Format& c) :format_(c), scndIter(NULL)
@@ -88,7 +106,8 @@ class HashIterator
          else
          {
             scndIter= new ScndIteratorType(*pntr);
-            MallocErrorChecker::ensure(scndIter!=NULL); assert(scndIter!=NULL);
+            if (!MallocErrorChecker::ensure(scndIter!=NULL))
+               indx= format_.hashVector.count();   // ends the iteration
          }
          if (scndIter!=NULL && scndIter->end()) nextScndIter();
       }
@@ -118,9 +137,13 @@ class HashDictionary
                            HorizontalContainer, HashFunction_> > IteratorType;
       friend IteratorType;
 
+   private:
+      typedef CheckHeapAllocation<HorizontalContainer>::RET
+                                                         CheckHeapAllocation_;
 
    public:
-      HashDictionary(const IndexType& size) : size_(size), hashVector(hashWidth())
+      HashDictionary(const IndexType& size)
+         : size_(size), hashVector(hashWidth()), frozen_(false)
       {
          hashVector.initElements();
       }
@@ -140,16 +163,64 @@ class HashDictionary
 
          if (!validIndex(primIndx))
          {
+            if (v == zero()) return;
+            if (frozen_)
+            {
+               Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+               return;
+            }
             SecondaryVectorType* pntr=
                                    new SecondaryVectorType(size_ / hashWidth());
-            MallocErrorChecker::ensure(pntr != NULL);
-            assert(pntr != NULL);
+            if (!MallocErrorChecker::ensure(pntr != NULL)) return;
             pntr->initElements();
             hashVector.setElement(primIndx, pntr);
          }
          hashVector.getElement(primIndx)->setElement(i, j, v);
       }
 
+      // stores v (!= zero()) at (i, j), which must not be stored yet, without
+      // looking it up within its bucket
+      void appendElement(const IndexType& i, const IndexType& j,
+                                                           const ElementType& v)
+      {
+         IndexType primIndx= getIndex(i, j);
+
+         if (!validIndex(primIndx))
+         {
+            SecondaryVectorType* pntr=
+                                   new SecondaryVectorType(size_ / hashWidth());
+            if (!MallocErrorChecker::ensure(pntr != NULL)) return;
+            pntr->initElements();
+            hashVector.setElement(primIndx, pntr);
+         }
+         hashVector.getElement(primIndx)->appendElement(i, j, v);
+      }
+
+      // adds v to the element (i, j) with a single lookup in its bucket; an
+      // element whose sum is zero is removed, and a zero v is not inserted,
+      // unless keepZero is set
+      void addToElement(const IndexType& i, const IndexType& j,
+                               const ElementType& v, bool keepZero= false)
+      {
+         IndexType primIndx= getIndex(i, j);
+
+         if (!validIndex(primIndx))
+         {
+            if (v == zero() && (!keepZero || frozen_)) return;
+            if (frozen_)
+            {
+               Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+               return;
+            }
+            SecondaryVectorType* pntr=
+                                   new SecondaryVectorType(size_ / hashWidth());
+            if (!MallocErrorChecker::ensure(pntr != NULL)) return;
+            pntr->initElements();
+            hashVector.setElement(primIndx, pntr);
+         }
+         hashVector.getElement(primIndx)->addToElement(i, j, v, keepZero);
+      }
+
       ElementType getElement(const IndexType & i, const IndexType & j) const
       {
          IndexType primIndx= getIndex(i, j);
@@ -165,6 +236,38 @@ class HashDictionary
          hashVector.initElements();
       }
 
+      // the buckets follow the state of the dictionary
+      void freezePattern(bool frozen= true)
+      {
+         frozen_= frozen;
+         for (IndexType i= 0; i<hashVector.count(); i++)
+            if (validIndex(i)) hashVector.getElement(i)->freezePattern(frozen);
+      }
+
+      bool patternFrozen() const {return frozen_;}
+
+      void clearValues()
+      {
+         for (IndexType i= 0; i<hashVector.count(); i++)
+            if (validIndex(i)) hashVector.getElement(i)->clearValues();
+      }
+
+      // replaces the values by the sums of the triplets read from s; the
+      // stored entries without a triplet become zero
+      template<class Stream>
+      void refillValues(Stream& s)
+      {
+         IndexType   i, j;
+         ElementType v;
+
+         clearValues();
+         while (!s.end())
+         {
+            s.getNext(i, j, v);
+            if (v != zero()) addToElement(i, j, v, true);
+         }
+      }
+
       static const ElementType & zero() {return eNull;}
 
 
@@ -183,6 +286,7 @@ class HashDictionary
    private:
       const IndexType   size_;
       PrimaryVectorType hashVector;
+      bool              frozen_;  // no entry is inserted or removed
       static const ElementType eNull;
 };
 
@@ -194,6 +298,247 @@ HashDictionary<VerticalContainer, HorizontalContainer, HashFunction_>::
                                                                ElementType(0);
 
 
+template<class FixHashFormat_>
+class FixHashIterator
+{
+   public:
+      typedef FixHashFormat_        Format;
+      typedef Format::ElementType   ElementType;
+      typedef Format::IndexType     IndexType;
+      typedef Format::OffsetType    OffsetType;
+
+      FixHashIterator(const Format& c) : format_(c), pos_(0) {}
+
+      void getNext(IndexType& i, IndexType& j, ElementType& v)
+      {
+         assert(!end());
+         v= format_.m_Val. getElement(pos_);
+         i= format_.m_Indx.getElement(pos_);
+         j= format_.m_Jndx.getElement(pos_);
+         ++pos_;
+      }
+
+      void reset()
+      {
+         pos_= 0;
+      }
+
+      bool end() const {return pos_ >= format_.m_Val.count();}
+
+   private:
+      const Format& format_;
+      OffsetType pos_;
+};
+
+// The entries of all buckets are stored in the containers m_Val, m_Indx and
+// m_Jndx, whose capacity is the static size of the matrix. heads_ holds the
+// position of the first entry of each bucket and next_ the position of the
+// following entry of the same bucket (none() ends a chain).
+template<class HeadVector, class IndexVector, class OffsetVector,
+                                 class ElementVector, class HashFunction_>
+class FixHashDictionary
+{
+   public:
+      typedef ElementVector::Config          Config;
+      typedef Config::IndexType              IndexType;
+      typedef Config::SignedIndexType        SignedIndexType;
+      typedef Config::OffsetType             OffsetType;
+      typedef Config::ElementType            ElementType;
+      typedef HashFunction_                  HashFunction;
+      typedef HashFunction::HashWidth        HashWidth;
+
+      typedef FixHashIterator<FixHashDictionary<HeadVector, IndexVector,
+                 OffsetVector, ElementVector, HashFunction_> > IteratorType;
+      friend IteratorType;
+
+      FixHashDictionary(const IndexType&)
+         : heads_(hashWidth()), next_(0), m_Val(0), m_Indx(0), m_Jndx(0),
+           frozen_(false)
+      {
+         heads_.initElements(none());
+      }
+
+      static IndexType hashWidth() {return HashWidth::value;}
+
+      void setElement(const IndexType& i, const IndexType& j,
+                                                           const ElementType& v)
+      {
+         const IndexType  h  = getIndex(i, j);
+         const OffsetType pos= find(h, i, j);
+
+         if (v == zero() && !frozen_)
+         {
+            if (pos != none()) remove(h, pos);
+         }
+         else if (pos != none()) m_Val.setElement(pos, v);
+         else if (v != zero())
+         {
+            if (frozen_)
+               Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+            else insert(h, i, j, v);
+         }
+      }
+
+      // stores v (!= zero()) at (i, j), which must not be stored yet, without
+      // looking it up within its bucket
+      void appendElement(const IndexType& i, const IndexType& j,
+                                                           const ElementType& v)
+      {
+         assert(v != zero());
+         insert(getIndex(i, j), i, j, v);
+      }
+
+      // adds v to the element (i, j) with a single lookup in its bucket; an
+      // element whose sum is zero is removed, and a zero v is not inserted,
+      // unless keepZero is set or the pattern is frozen
+      void addToElement(const IndexType& i, const IndexType& j,
+                               const ElementType& v, bool keepZero= false)
+      {
+         const IndexType  h  = getIndex(i, j);
+         const OffsetType pos= find(h, i, j);
+
+         if (pos != none())
+         {
+            const ElementType sum= m_Val.getElement(pos) + v;
+            if (sum != zero() || keepZero || frozen_)
+               m_Val.setElement(pos, sum);
+            else remove(h, pos);
+         }
+         else if (v != zero() || (keepZero && !frozen_))
+         {
+            if (frozen_)
+               Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+            else insert(h, i, j, v);
+         }
+      }
+
+      ElementType getElement(const IndexType & i, const IndexType & j) const
+      {
+         const OffsetType pos= find(getIndex(i, j), i, j);
+         return pos != none() ? m_Val.getElement(pos) : zero();
+      }
+
+      void initElements()
+      {
+         heads_.initElements(none());
+         next_. clear();
+         m_Val. clear();
+         m_Indx.clear();
+         m_Jndx.clear();
+      }
+
+      void freezePattern(bool frozen= true) {frozen_= frozen;}
+      bool patternFrozen() const {return frozen_;}
+
+      void clearValues()
+      {
+         for (OffsetType pos= 0; pos<m_Val.count(); ++pos)
+            m_Val.setElement(pos, zero());
+      }
+
+      // replaces the values by the sums of the triplets read from s; the
+      // stored entries without a triplet become zero
+      template<class Stream>
+      void refillValues(Stream& s)
+      {
+         IndexType   i, j;
+         ElementType v;
+
+         clearValues();
+         while (!s.end())
+         {
+            s.getNext(i, j, v);
+            if (v != zero()) addToElement(i, j, v, true);
+         }
+      }
+
+      static const ElementType & zero() {return eNull;}
+
+   protected:
+      static OffsetType none() {return OffsetType(-1);}
+
+      IndexType getIndex(const IndexType& i, const IndexType& j) const
+      {
+         return HashFunction::getHashValue(i, j);
+      }
+
+      OffsetType find(const IndexType& h, const IndexType& i,
+                                                     const IndexType& j) const
+      {
+         OffsetType pos= heads_.getElement(h);
+         while (pos != none() &&
+                (m_Indx.getElement(pos) != i || m_Jndx.getElement(pos) != j))
+            pos= next_.getElement(pos);
+         return pos;
+      }
+
+      // inserts the entry in front of its bucket h
+      void insert(const IndexType& h, const IndexType& i, const IndexType& j,
+                                                           const ElementType& v)
+      {
+         assert(!m_Val.full());
+         m_Val. addElement(v);
+         m_Indx.addElement(i);
+         m_Jndx.addElement(j);
+         next_. addElement(heads_.getElement(h));
+         heads_.setElement(h, m_Val.count()-1);
+      }
+
+      // replaces the link to pos in the chain of bucket h by link
+      void relink(const IndexType& h, const OffsetType& pos,
+                                                       const OffsetType& link)
+      {
+         if (heads_.getElement(h) == pos)
+         {
+            heads_.setElement(h, link);
+            return;
+         }
+         OffsetType p= heads_.getElement(h);
+         while (next_.getElement(p) != pos) p= next_.getElement(p);
+         next_.setElement(p, link);
+      }
+
+      // unlinks the entry at pos, and moves the last entry into its place
+      void remove(const IndexType& h, const OffsetType& pos)
+      {
+         const OffsetType last= m_Val.count()-1;
+
+         relink(h, pos, next_.getElement(pos));
+         if (pos != last)
+         {
+            relink(getIndex(m_Indx.getElement(last), m_Jndx.getElement(last)),
+                                                                    last, pos);
+            m_Val. setElement(pos, m_Val. getElement(last));
+            m_Indx.setElement(pos, m_Indx.getElement(last));
+            m_Jndx.setElement(pos, m_Jndx.getElement(last));
+            next_. setElement(pos, next_. getElement(last));
+         }
+         m_Val. removeLastElement();
+         m_Indx.removeLastElement();
+         m_Jndx.removeLastElement();
+         next_. removeLastElement();
+      }
+
+   private:
+      HeadVector    heads_;
+      OffsetVector  next_;
+      ElementVector m_Val;
+      IndexVector   m_Indx;
+      IndexVector   m_Jndx;
+      bool          frozen_;  // no entry is inserted or removed
+      static const ElementType eNull;
+};
+
+template<class HeadVector, class IndexVector, class OffsetVector,
+                                 class ElementVector, class HashFunction_>
+FixHashDictionary<HeadVector, IndexVector, OffsetVector, ElementVector,
+                                               HashFunction_>::ElementType const
+FixHashDictionary<HeadVector, IndexVector, OffsetVector, ElementVector,
+                                                         HashFunction_>::eNull=
+FixHashDictionary<HeadVector, IndexVector, OffsetVector, ElementVector,
+                                                 HashFunction_>::ElementType(0);
+
+
 template<class ListFormat_>
 class ListIterator
 {
@@ -201,8 +546,9 @@ class ListIterator
       typedef ListFormat_ Format;
       typedef Format::ElementType ElementType;
       typedef Format::IndexType IndexType;
+      typedef Format::OffsetType OffsetType;
 
-      ListIterator(const Format& c) :_format(c), indx(0) {}
+      ListIterator(const Format& c) :format_(c), indx(0) {}
 
       void getNext(IndexType& i, IndexType& j, ElementType& v)
       {
@@ -222,7 +568,7 @@ class ListIterator
 
    private:
       const Format& format_;
-      IndexType indx;
+      OffsetType indx;
 };
 
 template<class IndexVector, class ElementVector>
@@ -233,31 +579,21 @@ class ListDictionary
       typedef Config::ElementType ElementType;
       typedef Config::IndexType IndexType;
       typedef Config::SignedIndexType SignedIndexType;
+      typedef Config::OffsetType OffsetType;
       typedef ListIterator<ListDictionary<IndexVector, ElementVector> >
                                                                    IteratorType;
       friend IteratorType;
 
       ListDictionary(const IndexType& size)
-         : m_Val(0, size), m_Indx(0, size), m_Jndx(0, size)
+         : m_Val(0, size), m_Indx(0, size), m_Jndx(0, size), frozen_(false)
       {}
 
       void setElement( const IndexType & i, const IndexType & j,
                                                          const ElementType & v )
       {
-         IndexType indx= getIndex(i, j);
-         if (v == zero())
-            if (validIndex(indx))
-            {  // Element lschen
-               for (IndexType ii= indx; ii<m_Val.count(); ++ii)
-               {
-                  m_Val. setElement(ii, m_Val. getElement(ii+1));
-                  m_Indx.setElement(ii, m_Indx.getElement(ii+1));
-                  m_Jndx.setElement(ii, m_Jndx.getElement(ii+1));
-               }
-               m_Val. removeLastElement();
-               m_Indx.removeLastElement();
-               m_Jndx.removeLastElement();
-            }
+         OffsetType indx= getIndex(i, j);
+         if (v == zero() && !frozen_)
+            if (validIndex(indx)) remove(indx);
             else;
          else if (validIndex(indx))
          {  // Element ndern
@@ -265,19 +601,48 @@ class ListDictionary
             m_Indx.setElement(indx, i);
             m_Jndx.setElement(indx, j);
          }
-         else
-         {  // insert element
-            assert(!m_Val. full());
-            assert(!m_Jndx.full());
-            m_Val. addElement(v);
-            m_Indx.addElement(i);
-            m_Jndx.addElement(j);
+         else if (v != zero())
+         {
+            if (frozen_)
+               Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+            else insert(i, j, v);
+         }
+      }
+
+      // adds v to the element (i, j) with a single search of the list; an
+      // element whose sum is zero is removed, and a zero v is not inserted,
+      // unless keepZero is set or the pattern is frozen
+      void addToElement(const IndexType & i, const IndexType & j,
+                              const ElementType & v, bool keepZero= false)
+      {
+         OffsetType indx= getIndex(i, j);
+         if (validIndex(indx))
+         {
+            const ElementType sum= m_Val.getElement(indx) + v;
+            if (sum != zero() || keepZero || frozen_)
+               m_Val.setElement(indx, sum);
+            else remove(indx);
          }
+         else if (v != zero() || (keepZero && !frozen_))
+         {
+            if (frozen_)
+               Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+            else insert(i, j, v);
+         }
+      }
+
+      // stores v (!= zero()) at (i, j), which must not be stored yet, without
+      // searching the list
+      void appendElement(const IndexType & i, const IndexType & j,
+                                                         const ElementType & v)
+      {
+         assert(v != zero());
+         insert(i, j, v);
       }
 
       ElementType getElement( const IndexType & i, const IndexType & j ) const
       {
-         IndexType indx= getIndex(i, j);
+         OffsetType indx= getIndex(i, j);
          return validIndex(indx) ? m_Val.getElement(indx) : zero();
       }
 
@@ -288,26 +653,95 @@ class ListDictionary
          m_Jndx.clear();
       }
 
+      void freezePattern(bool frozen= true) {frozen_= frozen;}
+      bool patternFrozen() const {return frozen_;}
+
+      void clearValues()
+      {
+         for (OffsetType indx= 0; indx<m_Val.count(); ++indx)
+            m_Val.setElement(indx, zero());
+      }
+
+      // replaces the values by the sums of the triplets read from s; the
+      // stored entries without a triplet become zero. Each triplet is looked
+      // for at and behind the entry of the previous one first, so that a
+      // stream in the order of the iterator takes O(nnz).
+      template<class Stream>
+      void refillValues(Stream& s)
+      {
+         IndexType   i, j;
+         OffsetType  indx= 0;
+         ElementType v;
+
+         clearValues();
+         while (!s.end())
+         {
+            s.getNext(i, j, v);
+            if (!stored(indx, i, j) && !stored(++indx, i, j))
+               indx= getIndex(i, j);
+            if (validIndex(indx))
+               m_Val.setElement(indx, m_Val.getElement(indx) + v);
+            else if (v != zero())
+            {
+               if (frozen_)
+                  Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+               else insert(i, j, v);
+            }
+         }
+      }
+
       static const ElementType & zero() {return eNull;}
 
    protected:
-      bool validIndex(const IndexType& i) const
+      bool validIndex(const OffsetType& indx) const
       {
-         return i<m_Val.count();
+         return indx<m_Val.count();
       }
 
-      IndexType getIndex(const IndexType& i, const IndexType& j) const
+      // true if (i, j) is stored at indx
+      bool stored(const OffsetType& indx, const IndexType& i,
+                                                     const IndexType& j) const
+      {
+         return validIndex(indx) && m_Indx.getElement(indx)==i &&
+                                    m_Jndx.getElement(indx)==j;
+      }
+
+      OffsetType getIndex(const IndexType& i, const IndexType& j) const
       {
-         for (IndexType indx= 0; indx<m_Val.count(); ++indx)
+         for (OffsetType indx= 0; indx<m_Val.count(); ++indx)
             if (m_Indx.getElement(indx)==i && m_Jndx.getElement(indx)==j)
                return indx;
          return m_Val.count();
       }
 
+      void insert(const IndexType& i, const IndexType& j, const ElementType& v)
+      {
+         assert(!m_Val. full());
+         assert(!m_Jndx.full());
+         m_Val. addElement(v);
+         m_Indx.addElement(i);
+         m_Jndx.addElement(j);
+      }
+
+      // Element lschen
+      void remove(const OffsetType& indx)
+      {
+         for (OffsetType ii= indx; ii+1<m_Val.count(); ++ii)
+         {
+            m_Val. setElement(ii, m_Val. getElement(ii+1));
+            m_Indx.setElement(ii, m_Indx.getElement(ii+1));
+            m_Jndx.setElement(ii, m_Jndx.getElement(ii+1));
+         }
+         m_Val. removeLastElement();
+         m_Indx.removeLastElement();
+         m_Jndx.removeLastElement();
+      }
+
    private:
       ElementVector  m_Val;// values
       IndexVector m_Indx;  // m_Indx[pos] holds the column index of m_Val[pos]
       IndexVector m_Jndx;  // m_Jndx[pos] holds the column index of m_Val[pos]
+      bool        frozen_; // no entry is inserted or removed
       static const ElementType eNull;
 };
 
@@ -316,6 +750,368 @@ ListDictionary<IndexVector, ElementVector>::ElementType const
 ListDictionary<IndexVector, ElementVector>::eNull=
 ListDictionary<IndexVector, ElementVector>::ElementType(0);
 
+// The entries are kept sorted by EntryOrder (RowMajorOrder or MortonOrder)
+// in the containers m_Val, m_Indx and m_Jndx, so that an element is found by
+// binary search and the iterator (ListIterator) streams in sorted order.
+// Inserting a single entry shifts the entries behind it; addElements()
+// inserts a batch by sorting it and merging it into the list.
+template<class IndexVector, class ElementVector, class EntryOrder_>
+class SortedListDictionary
+{
+   public:
+      typedef ElementVector::Config Config;
+      typedef Config::ElementType ElementType;
+      typedef Config::IndexType IndexType;
+      typedef Config::SignedIndexType SignedIndexType;
+      typedef Config::OffsetType OffsetType;
+      typedef Config::MallocErrorChecker MallocErrorChecker;
+      typedef EntryOrder_ EntryOrder;
+      typedef ListIterator<SortedListDictionary<IndexVector, ElementVector,
+                                                 EntryOrder_> > IteratorType;
+      friend IteratorType;
+
+      SortedListDictionary(const IndexType& size)
+         : m_Val(0, size), m_Indx(0, size), m_Jndx(0, size), frozen_(false)
+      {}
+
+      void setElement(const IndexType & i, const IndexType & j,
+                                                         const ElementType & v)
+      {
+         const OffsetType indx= lowerBound(i, j);
+         if (stored(indx, i, j))
+            if (v != zero() || frozen_) m_Val.setElement(indx, v);
+            else remove(indx);
+         else if (v != zero())
+         {
+            if (frozen_)
+               Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+            else insert(indx, i, j, v);
+         }
+      }
+
+      // adds v to the element (i, j) with a single binary search; an
+      // element whose sum is zero is removed, and a zero v is not inserted,
+      // unless keepZero is set or the pattern is frozen
+      void addToElement(const IndexType & i, const IndexType & j,
+                              const ElementType & v, bool keepZero= false)
+      {
+         const OffsetType indx= lowerBound(i, j);
+         if (stored(indx, i, j))
+         {
+            const ElementType sum= m_Val.getElement(indx) + v;
+            if (sum != zero() || keepZero || frozen_)
+               m_Val.setElement(indx, sum);
+            else remove(indx);
+         }
+         else if (v != zero() || (keepZero && !frozen_))
+         {
+            if (frozen_)
+               Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+            else insert(indx, i, j, v);
+         }
+      }
+
+      // stores v (!= zero()) at (i, j), which must not be stored yet; an
+      // entry behind the last one (e.g. from the conversions, which append
+      // in the order of the rows) is appended without searching the list
+      void appendElement(const IndexType & i, const IndexType & j,
+                                                         const ElementType & v)
+      {
+         assert(v != zero());
+         const OffsetType n= m_Val.count();
+         insert(n==0 || less(n-1, i, j) ? n : lowerBound(i, j), i, j, v);
+      }
+
+      ElementType getElement(const IndexType & i, const IndexType & j) const
+      {
+         const OffsetType indx= lowerBound(i, j);
+         return stored(indx, i, j) ? m_Val.getElement(indx) : zero();
+      }
+
+      void initElements()
+      {
+         m_Val. clear();
+         m_Indx.clear();
+         m_Jndx.clear();
+      }
+
+      void freezePattern(bool frozen= true) {frozen_= frozen;}
+      bool patternFrozen() const {return frozen_;}
+
+      void clearValues()
+      {
+         for (OffsetType indx= 0; indx<m_Val.count(); ++indx)
+            m_Val.setElement(indx, zero());
+      }
+
+      // replaces the values by the sums of the triplets read from s; the
+      // stored entries without a triplet become zero. A stream in sorted
+      // order takes O(nnz), any other O(nnz log(nnz)).
+      template<class Stream>
+      void refillValues(Stream& s)
+      {
+         IndexType   i, j;
+         OffsetType  indx= 0;
+         ElementType v;
+
+         clearValues();
+         while (!s.end())
+         {
+            s.getNext(i, j, v);
+            if (!stored(indx, i, j) && !stored(++indx, i, j))
+               indx= lowerBound(i, j);
+            if (stored(indx, i, j))
+               m_Val.setElement(indx, m_Val.getElement(indx) + v);
+            else addToElement(i, j, v);
+         }
+      }
+
+      // adds the triplets read from s like addToElement(); s is read twice,
+      // so it must provide reset() in addition to end() and getNext(). The
+      // b triplets are sorted and merged with the n entries of the list in
+      // O(n + b log(b)) instead of O(n*b) for b single insertions. A
+      // position whose sum becomes zero is removed (or not inserted), unless
+      // the pattern is frozen; zeros stored before are kept. The batch is
+      // buffered on the heap.
+      template<class Stream>
+      void addElements(Stream& s)
+      {
+         typedef CheckHeapAllocation<ElementVector>::RET CheckHeapAllocation_;
+         IndexType   i, j;
+         OffsetType  k, b= 0;
+         ElementType v;
+
+         while (!s.end())
+         {
+            s.getNext(i, j, v);
+            if (v != zero()) ++b;
+         }
+         if (b == 0) return;
+
+         // the second halves of the arrays are the buffer of the merge sort
+         IndexType*   bi= new IndexType  [2*b];
+         IndexType*   bj= new IndexType  [2*b];
+         ElementType* bv= new ElementType[2*b];
+         if (!MallocErrorChecker::ensure(bi!=NULL && bj!=NULL && bv!=NULL))
+         {
+            delete [] bi;
+            delete [] bj;
+            delete [] bv;
+            return;
+         }
+
+         s.reset();
+         for (k= 0; !s.end();)
+         {
+            s.getNext(i, j, v);
+            if (v == zero()) continue;
+            bi[k]= i;
+            bj[k]= j;
+            bv[k++]= v;
+         }
+         assert(k == b);
+
+         k= sortBatch(bi, bj, bv, b);
+         const bool dropped=
+            mergeBatch(bi+k, bj+k, bv+k, combineBatch(bi+k, bj+k, bv+k, b));
+
+         delete [] bi;
+         delete [] bj;
+         delete [] bv;
+         if (dropped)
+            Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+      }
+
+      static const ElementType & zero() {return eNull;}
+
+   protected:
+      bool validIndex(const OffsetType& indx) const
+      {
+         return indx<m_Val.count();
+      }
+
+      // true if (i, j) is stored at indx
+      bool stored(const OffsetType& indx, const IndexType& i,
+                                                     const IndexType& j) const
+      {
+         return validIndex(indx) && m_Indx.getElement(indx)==i &&
+                                    m_Jndx.getElement(indx)==j;
+      }
+
+      // true if the entry at indx comes before (i, j)
+      bool less(const OffsetType& indx, const IndexType& i,
+                                                     const IndexType& j) const
+      {
+         return EntryOrder::less(m_Indx.getElement(indx),
+                                 m_Jndx.getElement(indx), i, j);
+      }
+
+      // the position of the first entry which does not come before (i, j)
+      OffsetType lowerBound(const IndexType& i, const IndexType& j) const
+      {
+         OffsetType lo= 0, hi= m_Val.count();
+         while (lo<hi)
+         {
+            const OffsetType mid= lo + (hi-lo)/2;
+            if (less(mid, i, j)) lo= mid+1;
+               else              hi= mid;
+         }
+         return lo;
+      }
+
+      void move(const OffsetType& from, const OffsetType& to)
+      {
+         m_Val. setElement(to, m_Val. getElement(from));
+         m_Indx.setElement(to, m_Indx.getElement(from));
+         m_Jndx.setElement(to, m_Jndx.getElement(from));
+      }
+
+      void grow()
+      {
+         assert(!m_Val. full());
+         assert(!m_Jndx.full());
+         m_Val. addElement();
+         m_Indx.addElement();
+         m_Jndx.addElement();
+      }
+
+      // inserts the entry at indx
+      void insert(const OffsetType& indx, const IndexType& i,
+                                  const IndexType& j, const ElementType& v)
+      {
+         grow();
+         for (OffsetType ii= m_Val.count()-1; ii>indx; --ii)
+            move(ii-1, ii);
+         m_Val. setElement(indx, v);
+         m_Indx.setElement(indx, i);
+         m_Jndx.setElement(indx, j);
+      }
+
+      void remove(const OffsetType& indx)
+      {
+         for (OffsetType ii= indx; ii+1<m_Val.count(); ++ii)
+            move(ii+1, ii);
+         m_Val. removeLastElement();
+         m_Indx.removeLastElement();
+         m_Jndx.removeLastElement();
+      }
+
+      // sorts the b triplets at the beginning of the arrays, which have
+      // room for 2*b, by a stable bottom-up merge sort; returns the offset
+      // (0 or b) of the sorted triplets
+      static OffsetType sortBatch(IndexType* bi, IndexType* bj,
+                                       ElementType* bv, const OffsetType& b)
+      {
+         OffsetType from= 0, to= b, width, lo;
+
+         for (width= 1; width<b; width*= 2)
+         {
+            for (lo= 0; lo<b; lo+= 2*width)
+            {
+               const OffsetType mid= Min(lo+width, b), hi= Min(lo+2*width, b);
+               OffsetType p= lo, q= mid, w= lo;
+               while (w<hi)
+               {
+                  const OffsetType r= q<hi && (p==mid ||
+                     EntryOrder::less(bi[from+q], bj[from+q],
+                                      bi[from+p], bj[from+p])) ? q++ : p++;
+                  bi[to+w]  = bi[from+r];
+                  bj[to+w]  = bj[from+r];
+                  bv[to+w++]= bv[from+r];
+               }
+            }
+            const OffsetType t= from;
+            from= to;
+            to  = t;
+         }
+         return from;
+      }
+
+      // sums the sorted triplets at the same position; returns the number
+      // of the positions
+      static OffsetType combineBatch(IndexType* bi, IndexType* bj,
+                                       ElementType* bv, const OffsetType& b)
+      {
+         OffsetType k, d= 1;
+         for (k= 1; k<b; ++k)
+            if (bi[k]==bi[d-1] && bj[k]==bj[d-1]) bv[d-1]= bv[d-1] + bv[k];
+            else
+            {
+               bi[d]  = bi[k];
+               bj[d]  = bj[k];
+               bv[d++]= bv[k];
+            }
+         return d;
+      }
+
+      // merges the d sorted positions of a batch into the list from the
+      // back, after the list has grown by the number of the new positions;
+      // the positions whose sum is zero are skipped, which leaves a gap in
+      // front of the merged entries that is closed afterwards. While the
+      // pattern is frozen, the new positions are dropped; returns true then.
+      bool mergeBatch(const IndexType* bi, const IndexType* bj,
+                               const ElementType* bv, const OffsetType& d)
+      {
+         const OffsetType n= m_Val.count();
+         OffsetType e, k, w, m= 0;
+
+         for (e= 0, k= 0; k<d;)
+            if (e<n && less(e, bi[k], bj[k])) ++e;
+            else
+            {
+               if (!stored(e, bi[k], bj[k])) ++m;
+               ++k;
+            }
+         const bool dropped= frozen_ && m > 0;
+         if (frozen_) m= 0;
+         for (k= 0; k<m; ++k) grow();
+
+         for (e= n, k= d, w= n+m; k>0;)
+            if (e>0 && stored(e-1, bi[k-1], bj[k-1]))
+            {
+               const ElementType sum= m_Val.getElement(--e) + bv[--k];
+               if (sum == zero() && !frozen_) continue;
+               m_Val. setElement(--w, sum);
+               m_Indx.setElement(w, bi[k]);
+               m_Jndx.setElement(w, bj[k]);
+            }
+            else if (e>0 && !less(e-1, bi[k-1], bj[k-1])) move(--e, --w);
+            else
+            {
+               if (bv[--k] == zero() || frozen_) continue;
+               m_Val. setElement(--w, bv[k]);
+               m_Indx.setElement(w, bi[k]);
+               m_Jndx.setElement(w, bj[k]);
+            }
+
+         // the first e entries are untouched; w == e unless a sum was zero
+         if (w > e)
+         {
+            for (k= w; k<m_Val.count(); ++k) move(k, e++);
+            while (m_Val.count() > e)
+            {
+               m_Val. removeLastElement();
+               m_Indx.removeLastElement();
+               m_Jndx.removeLastElement();
+            }
+         }
+         return dropped;
+      }
+
+   private:
+      ElementVector  m_Val;// values
+      IndexVector m_Indx;  // m_Indx[pos] holds the row index of m_Val[pos]
+      IndexVector m_Jndx;  // m_Jndx[pos] holds the column index of m_Val[pos]
+      bool        frozen_; // no entry is inserted or removed
+      static const ElementType eNull;
+};
+
+template<class IndexVector, class ElementVector, class EntryOrder_>
+SortedListDictionary<IndexVector, ElementVector, EntryOrder_>::
+                                                               ElementType const
+SortedListDictionary<IndexVector, ElementVector, EntryOrder_>::eNull=
+SortedListDictionary<IndexVector, ElementVector, EntryOrder_>::ElementType(0);
+
 }  // namespace MatrixICCL
 
 #endif   // DB_MATRIX_DICTIONARIES_H
@@ -38,8 +38,12 @@ using namespace MatrixICCL;
 struct ELEMENT_TYPE {};
 struct INDEX_TYPE {};
 struct SIGNED_INDEX_TYPE {};
+struct OFFSET_TYPE {};
+struct ACCUMULATION_TYPE {};
 struct MALLOC_ERROR_CHECKER {};
 struct COMPATIBILITY_CHECKER {};
+struct ERROR_REPORTER {};
+struct INSTRUMENTATION {};
 struct BAND_WIDTH {};
 struct ROWS {};
 struct COLS {};
@@ -52,6 +56,7 @@ struct SCALAR_VALUE {};
 struct DIAGS {};
 struct EXT {};
 struct INDEX_VEC {};
+struct OFFSET_VEC {};
 struct ELEM_VEC {};
 struct VERTICAL_CONTAINER {};
 struct DICT {};
@@ -137,6 +142,33 @@ class MATRIX_ASSEMBLE_COMPONENTS
    typedef CheckICCLFeature<SignedIndexType, SIGNED_INDEX_TYPE>::RET 
                                                           CheckSignedIndexType_;
 
+   // OffsetType
+   typedef DSLFeatures::OffsetType OffsetType;
+   typedef CheckICCLFeature<OffsetType, OFFSET_TYPE>::RET CheckOffsetType_;
+
+   // AccumulationType
+   typedef DSLFeatures::AccumulationType AccumulationType;
+   typedef CheckICCLFeature<AccumulationType, ACCUMULATION_TYPE>::RET
+                                                      CheckAccumulationType_;
+
+   // ErrorReporter
+   typedef
+      IF<EQUAL<DSLFeatures::ErrorPolicy::id,
+                             DSLFeatures::ErrorPolicy::throw_on_error_id>::RET,
+            ThrowingErrorReporter<Generator>,
+      IF<EQUAL<DSLFeatures::ErrorPolicy::id,
+                             DSLFeatures::ErrorPolicy::    error_code_id>::RET,
+            ErrorCodeReporter<Generator>,
+      IF<EQUAL<DSLFeatures::ErrorPolicy::id,
+                             DSLFeatures::ErrorPolicy::abort_on_error_id>::RET,
+            AbortingErrorReporter<Generator>,
+      IF<EQUAL<DSLFeatures::ErrorPolicy::id,
+                             DSLFeatures::ErrorPolicy::error_callback_id>::RET,
+            CallbackErrorReporter<Generator>,
+            invalid_ICCL_feature>::RET>::RET>::RET>::RET ErrorReporter;
+   typedef CheckICCLFeature<ErrorReporter, ERROR_REPORTER>::RET
+                                                           CheckErrorReporter_;
+
    // MallocErrorChecker
    typedef
       IF<EQUAL<DSLFeatures::MallocErrChecking::id, 
@@ -161,6 +193,18 @@ class MATRIX_ASSEMBLE_COMPONENTS
    typedef CheckICCLFeature<CompatibilityChecker, COMPATIBILITY_CHECKER>::RET 
                                                      CheckCompatibilityChecker_;
 
+   // Instrumentation
+   typedef
+      IF<EQUAL<DSLFeatures::Instrumentation::id,
+                           DSLFeatures::Instrumentation::instrument_id>::RET,
+            Instrumentation<Generator>,
+      IF<EQUAL<DSLFeatures::Instrumentation::id,
+                   DSLFeatures::Instrumentation::no_instrumentation_id>::RET,
+            EmptyInstrumentation<Generator>,
+            invalid_ICCL_feature>::RET>::RET InstrumentationType;
+   typedef CheckICCLFeature<InstrumentationType, INSTRUMENTATION>::RET
+                                                      CheckInstrumentation_;
+
    // BandWidth
    typedef IF<EQUAL<DSLShape::id, DSLShape::  diag_id>::RET ||
               EQUAL<DSLShape::id, DSLShape::scalar_id>::RET ||
@@ -236,6 +280,20 @@ class MATRIX_ASSEMBLE_COMPONENTS
    typedef DSLFeatures::HashWidth HashWidth;
    typedef CheckICCLFeature<HashWidth, HASH_WIDTH>::RET CheckHashWidth_;
 
+   // BlockRows, BlockCols (completed in the DSL Format of BSR matrices)
+   typedef IF<EQUAL<DSLFormat::id, DSLFormat::BSR_id>::RET,
+                  DSLFormat,
+                  BSR<> >::RET BSRFormat_;
+   typedef BSRFormat_::block_rows BlockRows;
+   typedef BSRFormat_::block_cols BlockCols;
+
+   // ChunkSize, SortWindow (completed in the DSL Format of SELL matrices)
+   typedef IF<EQUAL<DSLFormat::id, DSLFormat::SELL_id>::RET,
+                  DSLFormat,
+                  SELL<> >::RET SELLFormat_;
+   typedef SELLFormat_::chunk_size  ChunkSize;
+   typedef SELLFormat_::sort_window SortWindow;
+
    // Ratio
    typedef DSLFeatures::Ratio Ratio;
    typedef CheckICCLFeature<Ratio, RATIO>::RET CheckRatio_;
@@ -322,6 +380,14 @@ class MATRIX_ASSEMBLE_COMPONENTS
                Dyn1DContainer<IndexType, Ratio, Growing, Generator>,
            invalid_ICCL_feature>::RET>::RET IndexVec;
    typedef CheckICCLFeature<IndexVec, INDEX_VEC>::RET CheckIndexVec_;
+
+   // OffsetVec
+   typedef IF<EQUAL<DSLFeatures::Malloc::id, DSLFeatures::Malloc::fix_id>::RET,
+               Fix1DContainer<OffsetType, Size, Generator>,
+           IF<EQUAL<DSLFeatures::Malloc::id, DSLFeatures::Malloc::dyn_id>::RET,
+               Dyn1DContainer<OffsetType, Ratio, Growing, Generator>,
+           invalid_ICCL_feature>::RET>::RET OffsetVec;
+   typedef CheckICCLFeature<OffsetVec, OFFSET_VEC>::RET CheckOffsetVec_;
    
    // ElementVec
    typedef IF<EQUAL<DSLFeatures::Malloc::id, DSLFeatures::Malloc::fix_id>::RET,
@@ -350,15 +416,38 @@ class MATRIX_ASSEMBLE_COMPONENTS
    // (no error checking necessary)
    typedef SimpleHashFunction<HashWidth> HashFunction;
 
+   // HeadVec (bucket heads of the hash dictionary of static matrices)
+   // (no error checking necessary)
+   typedef Fix1DContainer<OffsetType, HashWidth, Generator> HeadVec;
+
+   // EntryOrder (of the sorted dictionary; the key order is completed in
+   // the DSL DictFormat)
+   // (no error checking necessary)
+   typedef IF<EQUAL<DSLFeatures::DictFormat::id,
+                                  DSLFeatures::DictFormat::sorted_dict_id>::RET,
+                  DSLFeatures::DictFormat,
+                  sorted_dict<row_major_key<> > >::RET SortedDict_;
+   typedef IF<EQUAL<SortedDict_::key_order::id,
+                                  SortedDict_::key_order::morton_key_id>::RET,
+                  MortonOrder<IndexType>,
+                  RowMajorOrder<IndexType> >::RET EntryOrder;
+
    // Dict
    typedef IF<EQUAL<DSLFeatures::DictFormat::id,
                                     DSLFeatures::DictFormat::hash_dict_id>::RET,
-                  HashDictionary<VerticalContainer, HorizontalContainer,
-                                                                  HashFunction>,
+               IF<EQUAL<DSLFeatures::Malloc::id,
+                                       DSLFeatures::Malloc::fix_id>::RET,
+                     FixHashDictionary<HeadVec, IndexVec, OffsetVec, ElemVec,
+                                                                 HashFunction>,
+                     HashDictionary<VerticalContainer, HorizontalContainer,
+                                                         HashFunction> >::RET,
            IF<EQUAL<DSLFeatures::DictFormat::id,
                                     DSLFeatures::DictFormat::list_dict_id>::RET,
                   ListDictionary<IndexVec, ElemVec>,
-                  invalid_ICCL_feature>::RET>::RET Dict;
+           IF<EQUAL<DSLFeatures::DictFormat::id,
+                                  DSLFeatures::DictFormat::sorted_dict_id>::RET,
+                  SortedListDictionary<IndexVec, ElemVec, EntryOrder>,
+                  invalid_ICCL_feature>::RET>::RET>::RET Dict;
    typedef CheckICCLFeature<Dict, DICT>::RET CheckDict_;
 
    // Arr
@@ -387,11 +476,17 @@ class MATRIX_ASSEMBLE_COMPONENTS
            IF<EQUAL<DSLFormat::id, DSLFormat::array_id>::RET, 
                   ArrFormat<Ext, Diags, Arr>,
            IF<EQUAL<DSLFormat::id, DSLFormat::CSR_id>::RET, 
-                  CSRFormat<Ext, IndexVec, ElemVec>,
+                  CSRFormat<Ext, IndexVec, OffsetVec, ElemVec>,
            IF<EQUAL<DSLFormat::id, DSLFormat::CSC_id>::RET, 
-                  CSCFormat<Ext, IndexVec, ElemVec>,
+                  CSCFormat<Ext, IndexVec, OffsetVec, ElemVec>,
            IF<EQUAL<DSLFormat::id, DSLFormat::COO_id>::RET, 
                   COOFormat<Ext, Dict>,
+           IF<EQUAL<DSLFormat::id, DSLFormat::BSR_id>::RET,
+                  BSRFormat<Ext, BlockRows, BlockCols, IndexVec, OffsetVec,
+                                                                      ElemVec>,
+           IF<EQUAL<DSLFormat::id, DSLFormat::SELL_id>::RET,
+                  SELLFormat<Ext, ChunkSize, SortWindow, IndexVec, OffsetVec,
+                                                                      ElemVec>,
            IF<EQUAL<DSLFormat::id, DSLFormat::vector_id>::RET, 
                   VecFormat<Ext, Diags, ElemVec>,
            IF<EQUAL<DSLFormat::id, DSLFormat::DIA_id>::RET, 
@@ -400,13 +495,13 @@ class MATRIX_ASSEMBLE_COMPONENTS
                IF<EQUAL<DSLShape::id, DSLShape::lower_triang_id>::RET ||
                   EQUAL<DSLShape::id, DSLShape::symm_id>::RET ||
                   EQUAL<DSLShape::id, DSLShape::lower_band_triang_id>::RET,
-                     LoSKYFormat<Ext, Diags, IndexVec, ElemVec>,
+                     LoSKYFormat<Ext, Diags, OffsetVec, ElemVec>,
                IF<EQUAL<DSLShape::id, DSLShape::upper_triang_id>::RET ||
                   EQUAL<DSLShape::id, DSLShape::upper_band_triang_id>::RET,
-                     UpSKYFormat<Ext, Diags, IndexVec, ElemVec>,
+                     UpSKYFormat<Ext, Diags, OffsetVec, ElemVec>,
                      invalid_ICCL_feature>::RET>::RET,
                invalid_ICCL_feature>::RET>::RET>::RET>::RET>::RET>::RET>::RET
-           >::RET>::RET Format;
+           >::RET>::RET>::RET>::RET Format;
    typedef CheckICCLFeature<Format, FORMAT>::RET CheckFormat_;
    
    // OptSymmetricMatrix
@@ -415,12 +510,26 @@ class MATRIX_ASSEMBLE_COMPONENTS
                   Symm<Format>,
                   Format>::RET OptSymmetricMatrix;
 
+   // OptInstrumentedMatrix
+   // (no error checking necessary)
+   typedef IF<EQUAL<DSLFeatures::Instrumentation::id,
+                           DSLFeatures::Instrumentation::instrument_id>::RET,
+                  Instrumenter<OptSymmetricMatrix>,
+                  OptSymmetricMatrix>::RET OptInstrumentedMatrix;
+
    // OptBoundsCheckedMatrix
    // (no error checking necessary)
    typedef IF<EQUAL<DSLFeatures::BoundsChecking::id,
                              DSLFeatures::BoundsChecking::check_bounds_id>::RET,
-                  BoundsChecker<OptSymmetricMatrix>,
-                  OptSymmetricMatrix>::RET OptBoundsCheckedMatrix;
+                  BoundsChecker<OptInstrumentedMatrix>,
+                  OptInstrumentedMatrix>::RET OptBoundsCheckedMatrix;
+
+   // RangeChecker
+   // (no error checking necessary)
+   typedef IF<EQUAL<DSLFeatures::BoundsChecking::id,
+                             DSLFeatures::BoundsChecking::check_bounds_id>::RET,
+                  RangeChecker<Generator>,
+                  EmptyRangeChecker<Generator> >::RET RangeCheckerType;
 
    // MatrixType;
    // (no error checking necessary)
@@ -450,15 +559,34 @@ public:
       typedef ElementType           ElementType;
       typedef IndexType             IndexType;
       typedef SignedIndexType       SignedIndexType;
+      typedef OffsetType            OffsetType;
+      typedef AccumulationType      AccumulationType;
       typedef ScalarValue           ScalarValue;   // @@                
 
       // ICCL components
       typedef Ext                   Ext;
       typedef Diags                 Diags;
+      typedef IndexVec              IndexVec;
+      typedef OffsetVec             OffsetVec;
+      typedef ElemVec               ElemVec;
+      typedef Arr                   Arr;
+      typedef Format                Format;
       typedef MallocErrorChecker    MallocErrorChecker;
       typedef CompatibilityChecker  CompatibilityChecker;
+      typedef RangeCheckerType      RangeChecker;
+      typedef ErrorReporter         ErrorReporter;
+      typedef InstrumentationType   Instrumentation;
       typedef CommaInitializer      CommaInitializer;
       typedef MatrixType            MatrixType;
+
+      // the matrix below the bounds checker, used after checkRange()
+      typedef OptInstrumentedMatrix UncheckedMatrix;
+
+      // the matrix below the top wrapper
+      typedef OptBoundsCheckedMatrix CheckedMatrix;
+
+      // compile-time cost descriptor of the chosen format
+      typedef MATRIX_COST<DSLFeatures> Cost;
    };
 
    typedef MatrixType RET;
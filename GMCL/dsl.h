@@ -33,13 +33,25 @@
 namespace MatrixDSL {
 
 // Matrix :      matrix [ ElementType, Structure, OptFlag, ErrFlag,
-//                        BoundsChecking, CompatCheckingDSL, IndexType ]
+//                        BoundsChecking, CompatCheckingDSL, IndexType,
+//                        ErrorPolicy, OffsetType, AccumulationType,
+//                        Instrumentation ]
 template<class ElementType, class Structure, class OptFlag, class ErrFlag,
-         class BoundsChecking, class CompatChecking, class IndexType>
+         class BoundsChecking, class CompatChecking, class IndexType,
+         class ErrorPolicy, class OffsetType, class AccumulationType,
+         class Instrumentation>
 struct matrix;
 
 // ElementType : float | double | long double | short | int | long |
-//               unsigned short | unsigned int | unsigned long
+//               unsigned short | unsigned int | unsigned long |
+//               bfloat16 | half                  (see ReducedPrecision.h)
+
+// AccumulationType : the same types as ElementType (must not be less precise)
+//               Sums of products (matrix products, SpMV, triangular solves)
+//               are accumulated in the AccumulationType, and the solver
+//               vectors have it, so that the elements can be stored in a
+//               smaller type than the one the arithmetic is done in.
+//               Defaults to ElementType.
 
 // Structure :   structure [ Shape, Density, Malloc ]
 template<class Shape, class Density, class Malloc> struct structure;
@@ -69,11 +81,14 @@ struct lower_band_triang;
 template<class Order, class Diags, class UpperBandTriangFormat>
 struct upper_band_triang;
 
-// RectFormat    :   array[ArrOrder] | CSR | CSC | COO[DictFormat]
+// RectFormat    :   array[ArrOrder] | CSR | CSC | COO[DictFormat] |
+//                   BSR[BlockRows, BlockCols] | SELL[ChunkSize, SortWindow]
 template<class ArrOrder  > struct array;
 template<class Dummy     > struct CSR;
 template<class Dummy     > struct CSC;
 template<class DictFormat> struct COO;
+template<class BlockRows, class BlockCols> struct BSR;
+template<class ChunkSize, class SortWindow> struct SELL;
 
 // LowerTriangFormat :   vector | array[ArrOrder] | DIA | SKY
 template<class Dummy> struct vector;
@@ -90,9 +105,15 @@ template<class Dummy> struct SKY;
 template<class Dummy> struct c_like;
 template<class Dummy> struct fortran_like;
 
-// DictFormat:   hashDictionary[HashWidth] | listDictionary
+// DictFormat:   hashDictionary[HashWidth] | listDictionary |
+//               sortedDictionary[KeyOrder]
 template<class HashWidth> struct hash_dict;
 template<class Dummy    > struct list_dict;
+template<class KeyOrder > struct sorted_dict;
+
+// KeyOrder:     rowMajorKey | mortonKey
+template<class Dummy> struct row_major_key;
+template<class Dummy> struct morton_key;
 
 // Density:      dense | sparse[Ratio, Growing]
 template<class Dummy               > struct dense;
@@ -122,9 +143,24 @@ template<class Dummy> struct no_bounds_checking;
 template<class Dummy> struct check_compat;
 template<class Dummy> struct no_compat_checking;
 
+// Instrumentation : instrument | noInstrumentation      (see Instrumentation.h)
+template<class Dummy> struct instrument;
+template<class Dummy> struct no_instrumentation;
+
 // IndexType :   char | short | int | long | unsigned char | unsigned short |
 //               unsigned int | unsigned long | signed char
 
+// OffsetType :  the same types as IndexType (must not be smaller)
+//               The positions in the element storage of the sparse formats
+//               (e.g. the row pointers of CSR) have the OffsetType, the row
+//               and column indices the IndexType. Defaults to IndexType.
+
+// ErrorPolicy : throwOnError | errorCode | abortOnError | errorCallback[Handler]
+template<class Dummy  > struct throw_on_error;
+template<class Dummy  > struct error_code;
+template<class Dummy  > struct abort_on_error;
+template<class Handler> struct error_callback;
+
 // Rows:             stat_val[RowsNumber]  | dyn_val
 // Cols:             stat_val[ColsNumber]  | dyn_val
 // Order:            stat_val[OrderNumber] | dyn_val
@@ -183,6 +219,8 @@ struct unspecified_DSL_feature
       CSR_id,
       CSC_id,
       COO_id,
+      BSR_id,
+      SELL_id,
       DIA_id,
       SKY_id,
 
@@ -193,6 +231,11 @@ struct unspecified_DSL_feature
       // Dictionary IDs
       hash_dict_id,
       list_dict_id,
+      sorted_dict_id,
+
+      // KeyOrder IDs
+      row_major_key_id,
+      morton_key_id,
 
       // Density IDs
       dense_id,
@@ -222,6 +265,16 @@ struct unspecified_DSL_feature
       check_compat_id,
       no_compat_checking_id,
 
+      // Instrumentation IDs
+      instrument_id,
+      no_instrumentation_id,
+
+      // ErrorPolicy IDs
+      throw_on_error_id,
+      error_code_id,
+      abort_on_error_id,
+      error_callback_id,
+
       // Rows, Cols, Order, Diags and ScalarValue IDs
       stat_val_id,
       dyn_val_id,
@@ -239,24 +292,34 @@ struct unspecified_DSL_feature
 //*********************** DSL features implementation **************************
 
 // Matrix :      matrix [ ElementType, Structure, OptFlag, ErrFlag,
-//                                   BoundsChecking, CompatChecking, IndexType ]
+//                        BoundsChecking, CompatChecking, IndexType,
+//                        ErrorPolicy, OffsetType, AccumulationType,
+//                        Instrumentation ]
 template<
-   class ElementType    = unspecified_DSL_feature,
-   class Structure      = unspecified_DSL_feature,
-   class OptFlag        = unspecified_DSL_feature,
-   class ErrFlag        = unspecified_DSL_feature,
-   class BoundsChecking = unspecified_DSL_feature,
-   class CompatChecking = unspecified_DSL_feature,
-   class IndexType      = unspecified_DSL_feature>
+   class ElementType      = unspecified_DSL_feature,
+   class Structure        = unspecified_DSL_feature,
+   class OptFlag          = unspecified_DSL_feature,
+   class ErrFlag          = unspecified_DSL_feature,
+   class BoundsChecking   = unspecified_DSL_feature,
+   class CompatChecking   = unspecified_DSL_feature,
+   class IndexType        = unspecified_DSL_feature,
+   class ErrorPolicy      = unspecified_DSL_feature,
+   class OffsetType       = unspecified_DSL_feature,
+   class AccumulationType = unspecified_DSL_feature,
+   class Instrumentation  = unspecified_DSL_feature>
 struct matrix
 {
-   typedef ElementType     elementType;
-   typedef Structure       structure;
-   typedef OptFlag         optFlag;
-   typedef ErrFlag         errFlag;
-   typedef BoundsChecking  boundsChecking;
-   typedef CompatChecking  compatChecking;
-   typedef IndexType       indexType;
+   typedef ElementType      elementType;
+   typedef Structure        structure;
+   typedef OptFlag          optFlag;
+   typedef ErrFlag          errFlag;
+   typedef BoundsChecking   boundsChecking;
+   typedef CompatChecking   compatChecking;
+   typedef IndexType        indexType;
+   typedef ErrorPolicy      errorPolicy;
+   typedef OffsetType       offsetType;
+   typedef AccumulationType accumulationType;
+   typedef Instrumentation  instrumentation;
 };
 
 // Structure :   structure [ Shape, Density, Malloc ]
@@ -390,7 +453,8 @@ struct upper_band_triang : unspecified_DSL_feature
    typedef UpperBandTriangFormat   format;
 };
 
-// RectFormat    :   array[ArrOrder] | CSR | CSC | COO[Dict]
+// RectFormat    :   array[ArrOrder] | CSR | CSC | COO[Dict] |
+//                   BSR[BlockRows, BlockCols] | SELL[ChunkSize, SortWindow]
 template<class ArrOrder= unspecified_DSL_feature>
 struct array : unspecified_DSL_feature
 {
@@ -417,6 +481,29 @@ struct COO : unspecified_DSL_feature
    typedef DictFormat dict;
 };
 
+// block sparse rows; the block sizes are int_numbers (default see
+// DSLFeatureDefaults), BlockCols defaults to BlockRows
+template<class BlockRows = unspecified_DSL_feature,
+         class BlockCols = unspecified_DSL_feature>
+struct BSR : unspecified_DSL_feature
+{
+   enum { id= BSR_id };
+   typedef BlockRows block_rows;
+   typedef BlockCols block_cols;
+};
+
+// sliced ELLPACK; ChunkSize (the number of rows processed in lockstep, i.e.
+// the SIMD width) and SortWindow (a multiple of ChunkSize) are int_numbers
+// (defaults see DSLFeatureDefaults)
+template<class ChunkSize  = unspecified_DSL_feature,
+         class SortWindow = unspecified_DSL_feature>
+struct SELL : unspecified_DSL_feature
+{
+   enum { id= SELL_id };
+   typedef ChunkSize  chunk_size;
+   typedef SortWindow sort_window;
+};
+
 // LowerTriangFormat :   vector | array[ArrOrder] | DIA | SKY
 template<class dummy= unspecified_DSL_feature>
 struct vector : unspecified_DSL_feature
@@ -456,7 +543,7 @@ struct fortran_like : unspecified_DSL_feature
 };
 
 
-// DictFormat:   hashDictionary | listDictionary
+// DictFormat:   hashDictionary | listDictionary | sortedDictionary[KeyOrder]
 template<class HashWidth= unspecified_DSL_feature>
 struct hash_dict : unspecified_DSL_feature
 {
@@ -470,6 +557,32 @@ struct list_dict : unspecified_DSL_feature
    enum {id= list_dict_id};
 };
 
+// the entries are kept sorted by KeyOrder (default see DSLFeatureDefaults),
+// so that an element is found by binary search
+template<class KeyOrder= unspecified_DSL_feature>
+struct sorted_dict : unspecified_DSL_feature
+{
+   enum {id= sorted_dict_id};
+   typedef KeyOrder key_order;
+};
+
+// KeyOrder:     rowMajorKey | mortonKey
+// row_major_key orders the entries by rows and within a row by columns;
+// morton_key orders them along the Z-order curve, which interleaves the bits
+// of the row and column indices and keeps neighbouring entries in small
+// square blocks of the matrix
+template<class dummy= unspecified_DSL_feature>
+struct row_major_key : unspecified_DSL_feature
+{
+   enum {id= row_major_key_id};
+};
+
+template<class dummy= unspecified_DSL_feature>
+struct morton_key : unspecified_DSL_feature
+{
+   enum {id= morton_key_id};
+};
+
 // Density:      dense | sparse[Ratio, Growing]
 template<class dummy = unspecified_DSL_feature>
 struct dense : unspecified_DSL_feature
@@ -568,6 +681,46 @@ struct no_compat_checking : unspecified_DSL_feature
    enum { id=no_compat_checking_id };
 };
 
+// Instrumentation : instrument | noInstrumentation
+template<class dummy = unspecified_DSL_feature>
+struct instrument : unspecified_DSL_feature
+{
+   enum { id=instrument_id };
+};
+
+template<class dummy = unspecified_DSL_feature>
+struct no_instrumentation : unspecified_DSL_feature
+{
+   enum { id=no_instrumentation_id };
+};
+
+// ErrorPolicy : throwOnError | errorCode | abortOnError | errorCallback[Handler]
+// (Handler must provide static void handle(int code, const char* message))
+template<class dummy = unspecified_DSL_feature>
+struct throw_on_error : unspecified_DSL_feature
+{
+   enum { id=throw_on_error_id };
+};
+
+template<class dummy = unspecified_DSL_feature>
+struct error_code : unspecified_DSL_feature
+{
+   enum { id=error_code_id };
+};
+
+template<class dummy = unspecified_DSL_feature>
+struct abort_on_error : unspecified_DSL_feature
+{
+   enum { id=abort_on_error_id };
+};
+
+template<class Handler = unspecified_DSL_feature>
+struct error_callback : unspecified_DSL_feature
+{
+   enum { id=error_callback_id };
+   typedef Handler handler;
+};
+
 // Rows:          statValue[RowsNumber]  | dynVal
 // Cols:          statValue[ColsNumber]  | dynVal
 // Order:         statValue[OrderNumber] | dynVal
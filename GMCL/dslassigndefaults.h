@@ -12,6 +12,7 @@
 /*  Meta-Functions:                                                           */
 /*  - MATRIX_DSL_ASSIGN_DEFAULTS                                              */
 /*  - IS_INT_TYPE                                                             */
+/*  - FORMAT_OF_ID                                                            */
 /*                                                                            */
 /*                                                                            */
 /*  The metafunction MATRIX_DSL_ASSIGN_DEFAULTS analyses a parsed DSL-        */
@@ -23,6 +24,9 @@
 /*  tions.                                                                    */
 /*  IS_INT_TYPE is a helper function that returns 'true' if its argument is   */
 /*  a built in integral type. It can be extended for individual purposes      */
+/*  FORMAT_OF_ID maps a format ID to the format with default parameters; the  */
+/*  default format is computed as an ID by one constant expression and looked */
+/*  up there, which instantiates far fewer templates than a chain of IFs.     */
 /*                                                                            */
 /*                                                                            */
 /*  (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                */
@@ -61,6 +65,8 @@ struct EmptyParsedDSLDescription
    typedef unspecified_DSL_feature OptFlag;
    typedef unspecified_DSL_feature ErrFlag;
    typedef unspecified_DSL_feature IndexType;
+   typedef unspecified_DSL_feature OffsetType;
+   typedef unspecified_DSL_feature AccumulationType;
    typedef unspecified_DSL_feature Rows;
    typedef unspecified_DSL_feature Cols;
    typedef unspecified_DSL_feature Order;
@@ -78,6 +84,8 @@ struct EmptyParsedDSLDescription
    typedef unspecified_DSL_feature MallocErrChecking;
    typedef unspecified_DSL_feature BoundsChecking;
    typedef unspecified_DSL_feature CompatChecking;
+   typedef unspecified_DSL_feature ErrorPolicy;
+   typedef unspecified_DSL_feature Instrumentation;
    typedef unspecified_DSL_feature Format;
 };
 
@@ -94,10 +102,13 @@ struct DSLFeatureDefaults
    typedef rect<>                      Shape;
    typedef c_like<>                    ArrOrder;
    typedef hash_dict<>                 DictFormat;
+   typedef row_major_key<>             KeyOrder;
    typedef dense<>                     Density;
    typedef dyn<>                       Malloc;
    typedef space<>                     OptFlag;
    typedef check_as_default<>          ErrFlag;
+   typedef throw_on_error<>            ErrorPolicy;
+   typedef no_instrumentation<>        Instrumentation;
    typedef unsigned                    IndexType;
    typedef dyn_val<>                   Rows;
    typedef dyn_val<>                   Cols;
@@ -109,6 +120,9 @@ struct DSLFeatureDefaults
    typedef float_number<double, 250>   Growing;                        // float#
 
    enum {HashWidthValue= 1013};
+   enum {BSRBlockSizeValue= 3};
+   enum {SELLChunkSizeValue= 8};
+   enum {SELLSortWindowValue= 256};
 };
 
 
@@ -124,6 +138,9 @@ struct DSL_FEATURE_OK
    typedef nil WRONG_FORMAT_SHAPE_COMBINATION;
    typedef nil WRONG_DICT_FORMAT;
    typedef nil WRONG_HASH_WIDTH;
+   typedef nil WRONG_KEY_ORDER;
+   typedef nil WRONG_BLOCK_SIZE;
+   typedef nil WRONG_SLICE_SIZE;
    typedef nil WRONG_ARR_ORDER;
    typedef nil WRONG_DENSITY;
    typedef nil WRONG_MALLOC;
@@ -132,6 +149,10 @@ struct DSL_FEATURE_OK
    typedef nil WRONG_ERR_FLAG;
    typedef nil WRONG_BOUNDS_CHECKING;
    typedef nil WRONG_COMPAT_CHECKING;
+   typedef nil WRONG_ERROR_POLICY;
+   typedef nil WRONG_INSTRUMENTATION;
+   typedef nil WRONG_OFFSET_TYPE;
+   typedef nil WRONG_ACCUMULATION_TYPE;
    typedef nil WRONG_ROWS;
    typedef nil WRONG_COLS;
    typedef nil WRONG_ORDER;
@@ -187,6 +208,8 @@ struct CheckFormat
                EQUAL<Format::id, Format::CSR_id   >::RET ||
                EQUAL<Format::id, Format::CSC_id   >::RET ||
                EQUAL<Format::id, Format::COO_id   >::RET ||
+               EQUAL<Format::id, Format::BSR_id   >::RET ||
+               EQUAL<Format::id, Format::SELL_id  >::RET ||
                EQUAL<Format::id, Format::DIA_id   >::RET ||
                EQUAL<Format::id, Format::SKY_id   >::RET ||
                EQUAL<Format::id, Format::unspecified_DSL_feature_id>::RET,
@@ -202,7 +225,9 @@ struct CheckFormatShapeCombination
               (EQUAL<Format::id, Format::array_id>::RET   ||
                EQUAL<Format::id, Format::CSR_id  >::RET   ||
                EQUAL<Format::id, Format::CSC_id  >::RET   ||
-               EQUAL<Format::id, Format::COO_id  >::RET)) ||
+               EQUAL<Format::id, Format::COO_id  >::RET   ||
+               EQUAL<Format::id, Format::BSR_id  >::RET   ||
+               EQUAL<Format::id, Format::SELL_id >::RET)) ||
 
              ((EQUAL<Shape::id,  Shape::diag_id  >::RET   ||
                EQUAL<Shape::id,  Shape::scalar_id>::RET   ||
@@ -240,11 +265,22 @@ template<class DictFormat>
 struct CheckDictFormat
 {
    typedef IF<EQUAL<DictFormat::id, DictFormat::hash_dict_id>::RET ||
-              EQUAL<DictFormat::id, DictFormat::list_dict_id>::RET,
+              EQUAL<DictFormat::id, DictFormat::list_dict_id>::RET ||
+              EQUAL<DictFormat::id, DictFormat::sorted_dict_id>::RET,
                   DSL_FEATURE_OK,
                   DSL_FEATURE_ERROR>::RET::WRONG_DICT_FORMAT RET;
 };
 
+template<class DictFormat, class KeyOrder>
+struct CheckKeyOrder
+{
+   typedef IF<EQUAL<DictFormat::id, DictFormat::sorted_dict_id>::RET &&
+            !(EQUAL<KeyOrder::id, KeyOrder::row_major_key_id>::RET ||
+              EQUAL<KeyOrder::id, KeyOrder::morton_key_id>::RET),
+                  DSL_FEATURE_ERROR,
+                  DSL_FEATURE_OK>::RET::WRONG_KEY_ORDER RET;
+};
+
 template<class DictFormat, class HashWidth>
 struct CheckHashWidth
 {
@@ -254,6 +290,24 @@ struct CheckHashWidth
                   DSL_FEATURE_OK>::RET::WRONG_HASH_WIDTH RET;
 };
 
+template<class Format, class BlockSize>
+struct CheckBlockSize
+{
+   typedef IF<EQUAL<Format::id, Format::BSR_id>::RET &&
+            !(EQUAL<BlockSize::id, BlockSize::int_number_id>::RET),
+                  DSL_FEATURE_ERROR,
+                  DSL_FEATURE_OK>::RET::WRONG_BLOCK_SIZE RET;
+};
+
+template<class Format, class SliceSize>
+struct CheckSliceSize
+{
+   typedef IF<EQUAL<Format::id, Format::SELL_id>::RET &&
+            !(EQUAL<SliceSize::id, SliceSize::int_number_id>::RET),
+                  DSL_FEATURE_ERROR,
+                  DSL_FEATURE_OK>::RET::WRONG_SLICE_SIZE RET;
+};
+
 template<class ArrOrder>
 struct CheckArrOrder
 {
@@ -330,6 +384,51 @@ struct CheckCompatChecking
                DSL_FEATURE_ERROR>::RET::WRONG_COMPAT_CHECKING RET;
 };
 
+template<class ErrorPolicy>
+struct CheckErrorPolicy
+{
+   typedef
+      IF<EQUAL<ErrorPolicy::id, ErrorPolicy::throw_on_error_id>::RET ||
+         EQUAL<ErrorPolicy::id, ErrorPolicy::    error_code_id>::RET ||
+         EQUAL<ErrorPolicy::id, ErrorPolicy::abort_on_error_id>::RET ||
+         EQUAL<ErrorPolicy::id, ErrorPolicy::error_callback_id>::RET,
+               DSL_FEATURE_OK,
+               DSL_FEATURE_ERROR>::RET::WRONG_ERROR_POLICY RET;
+};
+
+template<class Instrumentation>
+struct CheckInstrumentation
+{
+   typedef
+      IF<EQUAL<Instrumentation::id,
+                              Instrumentation::        instrument_id>::RET ||
+         EQUAL<Instrumentation::id,
+                              Instrumentation::no_instrumentation_id>::RET,
+               DSL_FEATURE_OK,
+               DSL_FEATURE_ERROR>::RET::WRONG_INSTRUMENTATION RET;
+};
+
+// offsets must be able to address every index
+template<class OffsetType, class IndexType>
+struct CheckOffsetType
+{
+   typedef IF<(sizeof(OffsetType) >= sizeof(IndexType)),
+                  DSL_FEATURE_OK,
+                  DSL_FEATURE_ERROR>::RET::WRONG_OFFSET_TYPE RET;
+};
+
+// the elements must be representable in the accumulation type
+template<class AccumulationType, class ElementType>
+struct CheckAccumulationType
+{
+   typedef IF<(numeric_limits<AccumulationType>::max_exponent10 >=
+                              numeric_limits<ElementType>::max_exponent10 &&
+               numeric_limits<AccumulationType>::digits >=
+                              numeric_limits<ElementType>::digits),
+                  DSL_FEATURE_OK,
+                  DSL_FEATURE_ERROR>::RET::WRONG_ACCUMULATION_TYPE RET;
+};
+
 template<class Rows>
 struct CheckRows
 {
@@ -463,6 +562,30 @@ template<          > struct IS_INT_TYPE<         long  int> {enum{RET=  true};};
 template<          > struct IS_INT_TYPE<unsigned long  int> {enum{RET=  true};};
 
 
+//*************************** format lookup by ID ******************************
+
+template<int id> struct FORMAT_OF_ID {typedef unspecified_DSL_feature RET;};
+
+template<> struct FORMAT_OF_ID<unspecified_DSL_feature::array_id >
+   {typedef array<>  RET;};
+template<> struct FORMAT_OF_ID<unspecified_DSL_feature::vector_id>
+   {typedef vector<> RET;};
+template<> struct FORMAT_OF_ID<unspecified_DSL_feature::CSR_id   >
+   {typedef CSR<>    RET;};
+template<> struct FORMAT_OF_ID<unspecified_DSL_feature::CSC_id   >
+   {typedef CSC<>    RET;};
+template<> struct FORMAT_OF_ID<unspecified_DSL_feature::COO_id   >
+   {typedef COO<>    RET;};
+template<> struct FORMAT_OF_ID<unspecified_DSL_feature::BSR_id   >
+   {typedef BSR<>    RET;};
+template<> struct FORMAT_OF_ID<unspecified_DSL_feature::SELL_id  >
+   {typedef SELL<>   RET;};
+template<> struct FORMAT_OF_ID<unspecified_DSL_feature::DIA_id   >
+   {typedef DIA<>    RET;};
+template<> struct FORMAT_OF_ID<unspecified_DSL_feature::SKY_id   >
+   {typedef SKY<>    RET;};
+
+
 //************************ MATRIX_DSL_ASSIGN_DEFAULTS **************************
 
 template<class ParsedDSLDescription>
@@ -480,6 +603,19 @@ class MATRIX_DSL_ASSIGN_DEFAULTS
                   DSLFeatureDefaults::IndexType,
                   ParsedDSL::IndexType>::RET IndexType;
 
+   // OffsetType
+   typedef IF<IsUnspecifiedDSLFeature<ParsedDSL::OffsetType>::RET,
+                  IndexType,
+                  ParsedDSL::OffsetType>::RET OffsetType;
+   typedef CheckOffsetType<OffsetType, IndexType>::RET CheckOffsetType_;
+
+   // AccumulationType
+   typedef IF<IsUnspecifiedDSLFeature<ParsedDSL::AccumulationType>::RET,
+                  ElementType,
+                  ParsedDSL::AccumulationType>::RET AccumulationType;
+   typedef CheckAccumulationType<AccumulationType, ElementType>::RET
+                                                      CheckAccumulationType_;
+
    // Structure
    typedef IF<IsUnspecifiedDSLFeature<ParsedDSL::Structure>::RET,
                   DSLFeatureDefaults::Structure,
@@ -494,16 +630,24 @@ class MATRIX_DSL_ASSIGN_DEFAULTS
    typedef CheckShape<Shape_>::RET CheckShape_;
 
    // Density
+   // (the feature IDs are compared by plain constant expressions here and
+   // below, which avoids an EQUAL and an IF instantiation per alternative)
+   typedef unspecified_DSL_feature S;
+   enum { parsedFormat= ParsedDSL::Format::id,
+          denseFormat = parsedFormat==S::array_id ||
+                        parsedFormat==S::vector_id,
+          sparseFormat= parsedFormat==S::CSR_id  ||
+                        parsedFormat==S::CSC_id  ||
+                        parsedFormat==S::COO_id  ||
+                        parsedFormat==S::BSR_id  ||
+                        parsedFormat==S::SELL_id ||
+                        parsedFormat==S::DIA_id  ||
+                        parsedFormat==S::SKY_id };
    typedef
       IF<IsUnspecifiedDSLFeature<ParsedDSL::Density>::RET,
-         IF<EQUAL<ParsedDSL::Format::id, ParsedDSL::Format::array_id >::RET ||
-            EQUAL<ParsedDSL::Format::id, ParsedDSL::Format::vector_id>::RET,
+         IF<denseFormat,
                dense<>,
-         IF<EQUAL<ParsedDSL::Format::id, ParsedDSL::Format::CSR_id>::RET ||
-            EQUAL<ParsedDSL::Format::id, ParsedDSL::Format::CSC_id>::RET ||
-            EQUAL<ParsedDSL::Format::id, ParsedDSL::Format::COO_id>::RET ||
-            EQUAL<ParsedDSL::Format::id, ParsedDSL::Format::DIA_id>::RET ||
-            EQUAL<ParsedDSL::Format::id, ParsedDSL::Format::SKY_id>::RET,
+         IF<sparseFormat,
                sparse<>,
                DSLFeatureDefaults::Density>::RET>::RET,
          ParsedDSL::Density>::RET Density;
@@ -543,6 +687,18 @@ class MATRIX_DSL_ASSIGN_DEFAULTS
                ParsedDSL::CompatChecking>::RET CompatChecking;
    typedef CheckCompatChecking<CompatChecking>::RET CheckCompatChecking_;
 
+   // ErrorPolicy
+   typedef IF<IsUnspecifiedDSLFeature<ParsedDSL::ErrorPolicy>::RET,
+                  DSLFeatureDefaults::ErrorPolicy,
+                  ParsedDSL::ErrorPolicy>::RET ErrorPolicy;
+   typedef CheckErrorPolicy<ErrorPolicy>::RET CheckErrorPolicy_;
+
+   // Instrumentation
+   typedef IF<IsUnspecifiedDSLFeature<ParsedDSL::Instrumentation>::RET,
+                  DSLFeatureDefaults::Instrumentation,
+                  ParsedDSL::Instrumentation>::RET Instrumentation;
+   typedef CheckInstrumentation<Instrumentation>::RET CheckInstrumentation_;
+
    // MallocErrChecking
    typedef IF<IsUnspecifiedDSLFeature<ParsedDSL::MallocErrChecking>::RET,
                IF<EQUAL<ErrFlag::id, ErrFlag::check_as_default_id>::RET,
@@ -552,50 +708,81 @@ class MATRIX_DSL_ASSIGN_DEFAULTS
    typedef CheckMallocErrChecking<MallocErrChecking>::RET CheckMallocErrChecking_;
 
    // Format
-   typedef IF<EQUAL<Shape_::id, Shape_::rect_id>::RET,
-               IF<EQUAL<Density::id, Density::dense_id>::RET,
-                  array<>,
-                  COO<> >::RET,
-               IF<EQUAL<Shape_::id, Shape_::lower_triang_id>::RET ||
-                  EQUAL<Shape_::id, Shape_::upper_triang_id>::RET,
-                     IF<EQUAL<Density::id, Density::dense_id>::RET,
-                        IF<EQUAL<OptFlag::id, OptFlag::speed_id>::RET,
-                           array<>,
-                           vector<> >::RET,
-                        IF<EQUAL<OptFlag::id, OptFlag::speed_id>::RET,
-                            DIA<>,
-                            SKY<> >::RET>::RET,
-               IF<EQUAL<Shape_::id, Shape_::symm_id>::RET,
-                  IF<EQUAL<Density::id, Density::dense_id>::RET,
-                     IF<EQUAL<OptFlag::id, OptFlag::speed_id>::RET,
-                        array<>,
-                        vector<> >::RET,
-                     SKY<> >::RET,
-                  IF<EQUAL<Shape_::id, Shape_::band_diag_id>::RET,
-                     IF<EQUAL<Density::id, Density::dense_id>::RET,
-                        vector<>,
-                        DIA<> >::RET,
-                     IF<EQUAL<Shape_::id, Shape_::lower_band_triang_id>::RET ||
-                        EQUAL<Shape_::id, Shape_::upper_band_triang_id>::RET,
-                        IF<EQUAL<Density::id, Density::dense_id>::RET,
-                           vector<>,
-                           IF<EQUAL<OptFlag::id, OptFlag::speed_id>::RET,
-                              DIA<>,
-                              SKY<> >::RET
-                           >::RET,
-                     unspecified_DSL_feature>::RET>::RET>::RET>::RET>::RET
-                                                                ComputedFormat_;
+   enum { shapeId= Shape_::id,
+          isDense= Density::id==S::dense_id,
+          isSpeed= OptFlag::id==S::speed_id,
+          computedFormat=
+             shapeId==S::rect_id
+                ? (isDense ? S::array_id : S::COO_id) :
+             shapeId==S::lower_triang_id || shapeId==S::upper_triang_id
+                ? (isDense ? (isSpeed ? S::array_id : S::vector_id)
+                           : (isSpeed ? S::DIA_id   : S::SKY_id)) :
+             shapeId==S::symm_id
+                ? (isDense ? (isSpeed ? S::array_id : S::vector_id)
+                           : S::SKY_id) :
+             shapeId==S::band_diag_id
+                ? (isDense ? S::vector_id : S::DIA_id) :
+             shapeId==S::lower_band_triang_id ||
+             shapeId==S::upper_band_triang_id
+                ? (isDense ? S::vector_id : (isSpeed ? S::DIA_id : S::SKY_id))
+                : S::unspecified_DSL_feature_id };
+   typedef FORMAT_OF_ID<computedFormat>::RET ComputedFormat_;
 
    typedef IF<IsUnspecifiedDSLFeature<ParsedDSL::Format>::RET,
                   ComputedFormat_,
-                  ParsedDSL::Format>::RET Format;
-   typedef CheckFormat<Format>::RET CheckFormat_;
+                  ParsedDSL::Format>::RET Format_;
+   typedef CheckFormat<Format_>::RET CheckFormat_;
+
+   // BSR block sizes; the Format is completed by them
+   typedef IF<EQUAL<Format_::id, Format_::BSR_id>::RET,
+                  Format_,
+                  BSR<> >::RET BSRFormat_;
+   typedef IF<IsUnspecifiedDSLFeature<BSRFormat_::block_rows>::RET,
+                  int_number<IndexType, DSLFeatureDefaults::BSRBlockSizeValue>,
+                  BSRFormat_::block_rows>::RET BlockRows_;
+   typedef IF<IsUnspecifiedDSLFeature<BSRFormat_::block_cols>::RET,
+                  BlockRows_,
+                  BSRFormat_::block_cols>::RET BlockCols_;
+   typedef CheckBlockSize<Format_, BlockRows_>::RET CheckBlockRows_;
+   typedef CheckBlockSize<Format_, BlockCols_>::RET CheckBlockCols_;
+
+   // SELL slice sizes; the Format is completed by them
+   typedef IF<EQUAL<Format_::id, Format_::SELL_id>::RET,
+                  Format_,
+                  SELL<> >::RET SELLFormat_;
+   typedef IF<IsUnspecifiedDSLFeature<SELLFormat_::chunk_size>::RET,
+                  int_number<IndexType, DSLFeatureDefaults::SELLChunkSizeValue>,
+                  SELLFormat_::chunk_size>::RET ChunkSize_;
+   typedef IF<IsUnspecifiedDSLFeature<SELLFormat_::sort_window>::RET,
+               int_number<IndexType, DSLFeatureDefaults::SELLSortWindowValue>,
+                  SELLFormat_::sort_window>::RET SortWindow_;
+   typedef CheckSliceSize<Format_, ChunkSize_ >::RET CheckChunkSize_;
+   typedef CheckSliceSize<Format_, SortWindow_>::RET CheckSortWindow_;
+
+   typedef IF<EQUAL<Format_::id, Format_::BSR_id>::RET,
+                  BSR<BlockRows_, BlockCols_>,
+           IF<EQUAL<Format_::id, Format_::SELL_id>::RET,
+                  SELL<ChunkSize_, SortWindow_>,
+                  Format_>::RET>::RET Format;
 
    // DictFormat
    typedef IF<IsUnspecifiedDSLFeature<ParsedDSL::DictFormat>::RET,
                   DSLFeatureDefaults::DictFormat,
-                  ParsedDSL::DictFormat>::RET DictFormat;
-   typedef CheckDictFormat<DictFormat>::RET CheckDictFormat_;
+                  ParsedDSL::DictFormat>::RET DictFormat_;
+   typedef CheckDictFormat<DictFormat_>::RET CheckDictFormat_;
+
+   // key order of sorted dictionaries; the DictFormat is completed by it
+   typedef IF<EQUAL<DictFormat_::id, DictFormat_::sorted_dict_id>::RET,
+                  DictFormat_,
+                  sorted_dict<> >::RET SortedDict_;
+   typedef IF<IsUnspecifiedDSLFeature<SortedDict_::key_order>::RET,
+                  DSLFeatureDefaults::KeyOrder,
+                  SortedDict_::key_order>::RET KeyOrder_;
+   typedef CheckKeyOrder<DictFormat_, KeyOrder_>::RET CheckKeyOrder_;
+
+   typedef IF<EQUAL<DictFormat_::id, DictFormat_::sorted_dict_id>::RET,
+                  sorted_dict<KeyOrder_>,
+                  DictFormat_>::RET DictFormat;
 
    // HashWidth
    typedef IF<IsUnspecifiedDSLFeature<ParsedDSL::HashWidth>::RET,
@@ -742,6 +929,8 @@ public:
       typedef OptFlag            OptFlag;
       typedef ErrFlag            ErrFlag;
       typedef IndexType          IndexType;
+      typedef OffsetType         OffsetType;
+      typedef AccumulationType   AccumulationType;
       typedef Rows               Rows;
       typedef Cols               Cols;
       typedef Order              Order;
@@ -758,6 +947,8 @@ public:
       typedef MallocErrChecking  MallocErrChecking;
       typedef BoundsChecking     BoundsChecking;
       typedef CompatChecking     CompatChecking;
+      typedef ErrorPolicy        ErrorPolicy;
+      typedef Instrumentation    Instrumentation;
       typedef Format             Format;
    };
    typedef DSLConfig RET;
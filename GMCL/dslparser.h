@@ -47,6 +47,12 @@ class MATRIX_DSL_PARSER
    // IndexType
    typedef typename DSLDescription::indexType IndexType;
 
+   // OffsetType
+   typedef typename DSLDescription::offsetType OffsetType;
+
+   // AccumulationType
+   typedef typename DSLDescription::accumulationType AccumulationType;
+
    // Structure
    typedef typename DSLDescription::structure Structure;
 
@@ -80,6 +86,12 @@ class MATRIX_DSL_PARSER
    // CompatChecking
    typedef typename DSLDescription::compatChecking CompatChecking;
 
+   // ErrorPolicy
+   typedef typename DSLDescription::errorPolicy ErrorPolicy;
+
+   // Instrumentation
+   typedef typename DSLDescription::instrumentation Instrumentation;
+
    // MallocErrChecking
    typedef typename IF<IsUnspecifiedDSLFeature<Malloc>::RET,
                   dyn<>,
@@ -237,6 +249,8 @@ public:
       typedef MATRIX_DSL_PARSER:: OptFlag            OptFlag;
       typedef MATRIX_DSL_PARSER:: ErrFlag            ErrFlag;
       typedef MATRIX_DSL_PARSER:: IndexType          IndexType;
+      typedef MATRIX_DSL_PARSER:: OffsetType         OffsetType;
+      typedef MATRIX_DSL_PARSER:: AccumulationType   AccumulationType;
       typedef MATRIX_DSL_PARSER:: Rows               Rows;
       typedef MATRIX_DSL_PARSER:: Cols               Cols;
       typedef MATRIX_DSL_PARSER:: Order              Order;
@@ -254,6 +268,8 @@ public:
       typedef MATRIX_DSL_PARSER:: MallocErrChecking  MallocErrChecking;
       typedef MATRIX_DSL_PARSER:: BoundsChecking     BoundsChecking;
       typedef MATRIX_DSL_PARSER:: CompatChecking     CompatChecking;
+      typedef MATRIX_DSL_PARSER:: ErrorPolicy        ErrorPolicy;
+      typedef MATRIX_DSL_PARSER:: Instrumentation    Instrumentation;
       typedef MATRIX_DSL_PARSER:: Format             Format;
    };
    typedef DSLConfig RET;
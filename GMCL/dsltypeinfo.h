@@ -8,6 +8,7 @@
 /*  Operations:                                                               */
 /*  - operator<<()                                                            */
 /*  - PrintDSLFeaturesInfo                                                    */
+/*  - PrintMatrixCostInfo                                                     */
 /*                                                                            */
 /*  This file can be used to retrieve the DSL information from a matrix       */
 /*  variable (use PrintDSLFeaturesInfo) or from a DSL description (use        */
@@ -18,6 +19,8 @@
 /*                                                                            */
 /*  cout << DSLFeaturesInfo<MyMatrixType::Config::DSLFeatures>() << endl;     */
 /*  PrintDSLFeaturesInfo(cout, MyMatrix);                                     */
+/*  cout << MatrixCostInfo<MyMatrixType::Config::Cost>() << endl;             */
+/*  PrintMatrixCostInfo(cout, MyMatrix);                                      */
 /*                                                                            */
 /*                                                                            */
 /*  (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                */
@@ -64,6 +67,8 @@ struct DSLFeatureInfo
          case DSLFeature::CSR_id:    out << "CSR";    break;
          case DSLFeature::CSC_id:    out << "CSC";    break;
          case DSLFeature::COO_id:    out << "COO";    break;
+         case DSLFeature::BSR_id:    out << "BSR";    break;
+         case DSLFeature::SELL_id:   out << "SELL";   break;
          case DSLFeature::DIA_id:    out << "DIA";    break;
          case DSLFeature::SKY_id:    out << "SKY";    break;
 
@@ -74,6 +79,11 @@ struct DSLFeatureInfo
          // Dictionary IDs
          case DSLFeature::hash_dict_id: out << "hash_dict"; break;
          case DSLFeature::list_dict_id: out << "list_dict"; break;
+         case DSLFeature::sorted_dict_id: out << "sorted_dict"; break;
+
+         // KeyOrder IDs
+         case DSLFeature::row_major_key_id: out << "row_major_key"; break;
+         case DSLFeature::morton_key_id:    out << "morton_key";    break;
 
          // Density IDs
          case DSLFeature::dense_id:  out << "dense";  break;
@@ -106,6 +116,17 @@ struct DSLFeatureInfo
          case DSLFeature::no_compat_checking_id:
                                      out << "no_compat_checking"; break;
 
+         // Instrumentation IDs
+         case DSLFeature::instrument_id: out << "instrument"; break;
+         case DSLFeature::no_instrumentation_id:
+                                     out << "no_instrumentation"; break;
+
+         // ErrorPolicy IDs
+         case DSLFeature::throw_on_error_id: out << "throw_on_error"; break;
+         case DSLFeature::    error_code_id: out << "error_code";     break;
+         case DSLFeature::abort_on_error_id: out << "abort_on_error"; break;
+         case DSLFeature::error_callback_id: out << "error_callback"; break;
+
          // Rows, Cols, Order, Diags and ScalarValue IDs
          case DSLFeature::stat_val_id: out << "stat_val"; break;
          case DSLFeature::dyn_val_id:  out << "dyn_val";  break;
@@ -176,6 +197,8 @@ struct DSLFeaturesInfo
       out << "OptFlag:           " << DSLFeatureInfo<DSLFeatures::OptFlag>() << endl;
       out << "ErrFlag:           " << DSLFeatureInfo<DSLFeatures::ErrFlag>() << endl;
       out << "IndexType:         " << typeid(DSLFeatures::IndexType).name() << endl;
+      out << "OffsetType:        " << typeid(DSLFeatures::OffsetType).name() << endl;
+      out << "AccumulationType:  " << typeid(DSLFeatures::AccumulationType).name() << endl;
       out << "Rows:              " << DSLFeatureInfo<DSLFeatures::Rows>() << endl;
       out << "Cols:              " << DSLFeatureInfo<DSLFeatures::Cols>() << endl;
       out << "Order:             " << DSLFeatureInfo<DSLFeatures::Order>() << endl;
@@ -192,6 +215,8 @@ struct DSLFeaturesInfo
       out << "MallocErrChecking: " << DSLFeatureInfo<DSLFeatures::MallocErrChecking>() << endl;
       out << "BoundsChecking:    " << DSLFeatureInfo<DSLFeatures::BoundsChecking>() << endl;
       out << "CompatChecking:    " << DSLFeatureInfo<DSLFeatures::CompatChecking>() << endl;
+      out << "ErrorPolicy:       " << DSLFeatureInfo<DSLFeatures::ErrorPolicy>() << endl;
+      out << "Instrumentation:   " << DSLFeatureInfo<DSLFeatures::Instrumentation>() << endl;
       out << "Format:            " << DSLFeatureInfo<DSLFeatures::Format>() << endl;
       return out;
    }
@@ -211,4 +236,46 @@ void PrintDSLFeaturesInfo(ostream& out, const A& a)
 };
 
 
+template<class Cost>
+struct MatrixCostInfo
+{
+   static const char* complexity(int c)
+   {
+      switch (c)
+      {
+         case access_complexity::constant_id: return "O(1)";
+         case access_complexity::  hashed_id: return "O(1) average";
+         case access_complexity::logarithmic_id: return "O(log nnz)";
+         case access_complexity::    line_id: return "O(entries per line)";
+         case access_complexity::     nnz_id: return "O(nnz)";
+         default:                             return "unknown";
+      }
+   }
+
+   static ostream& display(ostream& out)
+   {
+      out << "BytesPerElement:   " << int(Cost::bytes_per_element) << endl;
+      out << "GetElement:        " << complexity(Cost::get_complexity) << endl;
+      out << "SetElement:        " << complexity(Cost::set_complexity) << endl;
+      out << "Iteration:         "
+          << (Cost::iteration_is_nnz ? "O(nnz)" : "O(extent)") << endl;
+      out << "Vectorizable:      " << (Cost::vectorizable ? "yes" : "no") << endl;
+      return out;
+   }
+};
+
+template<class A>
+ostream& operator<<(ostream& out, const MatrixCostInfo<A>& c)
+{
+   return c.display(out);
+}
+
+
+template<class A>
+void PrintMatrixCostInfo(ostream& out, const A& a)
+{
+   out << MatrixCostInfo<A::Config::Cost>();
+};
+
+
 #endif   // DB_MATRIX_DSLTYPEINFO_H
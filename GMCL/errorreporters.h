@@ -0,0 +1,161 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "ErrorReporters.h"                   */
+/*                                                                            */
+/*                                                                            */
+/*  Category:   ICCL Components                                               */
+/*                                                                            */
+/*  Classes:                                                                  */
+/*  - matrix_errors                                                           */
+/*  - ThrowingErrorReporter                                                   */
+/*  - ErrorCodeReporter                                                       */
+/*  - AbortingErrorReporter                                                   */
+/*  - CallbackErrorReporter                                                   */
+/*                                                                            */
+/*  Macros:                                                                   */
+/*  - DB_MATRIX_NOEXCEPT, DB_MATRIX_NOEXCEPT_IF                               */
+/*                                                                            */
+/*                                                                            */
+/*  The checkers (BoundsChecker, RangeChecker, CompatChecker and              */
+/*  MallocErrChecker) and the sparse formats with a frozen pattern do not     */
+/*  report errors themselves but pass an error code to the error reporter     */
+/*  selected by the ErrorPolicy DSL feature:                                  */
+/*  ThrowingErrorReporter throws the error message (the original behaviour),  */
+/*  AbortingErrorReporter prints it to cerr and calls abort(),                */
+/*  ErrorCodeReporter records the code, and CallbackErrorReporter passes it   */
+/*  to a user defined handler and records it as well.                         */
+/*  Only the throwing reporter contains a throw expression, so that matrices  */
+/*  configured with any other policy can be used where exceptions are         */
+/*  disabled. If report() returns, the checkers return false and the          */
+/*  operation is skipped; the code can be read with lastError() and reset     */
+/*  with clearError(). The code is kept per matrix type.                      */
+/*  Every reporter states whether it throws; the checkers and the unchecked   */
+/*  element access of a matrix are declared DB_MATRIX_NOEXCEPT_IF(!throws),   */
+/*  i.e. noexcept unless the throwing reporter is selected. A handler of      */
+/*  CallbackErrorReporter must therefore not throw. DB_MATRIX_NOEXCEPT is     */
+/*  noexcept for C++11 compilers and throw() for the older ones, which have   */
+/*  no conditional form, so DB_MATRIX_NOEXCEPT_IF is empty for them.          */
+/*                                                                            */
+/*                                                                            */
+/*  (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                */
+/*                        Ulrich Eisenecker, Johannes Knaupp                  */
+/*                                                                            */
+/******************************************************************************/
+
+#ifndef DB_MATRIX_ERRORREPORTERS_H
+#define DB_MATRIX_ERRORREPORTERS_H
+
+#include <stdlib.h>
+
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900)
+#define DB_MATRIX_NOEXCEPT          noexcept
+#define DB_MATRIX_NOEXCEPT_IF(cond) noexcept(cond)
+#else
+#define DB_MATRIX_NOEXCEPT          throw()
+#define DB_MATRIX_NOEXCEPT_IF(cond)
+#endif
+
+
+//******************************** error codes *********************************
+
+struct matrix_errors
+{
+   enum { no_error,
+          subscripts_out_of_bounds,
+          incompatible_arguments,             // operands of an operation
+          incompatible_result,                // result of a multiplication
+          incompatible_argument_and_result,   // result of an addition
+          memory_allocation_failed,
+          pattern_frozen };                   // write outside the pattern
+
+   static const char* message(const int& code)
+   {
+      switch (code)
+      {
+         case no_error:                 return "no error";
+         case subscripts_out_of_bounds: return "subscripts out of bounds";
+         case incompatible_arguments:
+                                  return "argument matrices are incompatible";
+         case incompatible_result:      return "result matrix is incompatible";
+         case incompatible_argument_and_result:
+                        return "argument and result matrices are incompatible";
+         case memory_allocation_failed: return "memory allocation failed";
+         case pattern_frozen:
+                        return "element is outside the frozen sparsity pattern";
+         default:                       return "unknown error";
+      }
+   }
+};
+
+
+//****************************** error reporters *******************************
+
+namespace MatrixICCL{
+
+template<class Generator>
+struct ThrowingErrorReporter
+{
+   enum { throws= true };
+
+   static void report(const int& code)
+   {
+      throw matrix_errors::message(code);
+   }
+
+   static int lastError() {return matrix_errors::no_error;}
+   static void clearError() {}
+};
+
+
+template<class Generator>
+struct AbortingErrorReporter
+{
+   enum { throws= false };
+
+   static void report(const int& code)
+   {
+      cerr << "matrix error: " << matrix_errors::message(code) << endl;
+      abort();
+   }
+
+   static int lastError() {return matrix_errors::no_error;}
+   static void clearError() {}
+};
+
+
+template<class Generator>
+struct ErrorCodeReporter
+{
+   enum { throws= false };
+
+   static void report(const int& code) {error_= code;}
+
+   static int lastError() {return error_;}
+   static void clearError() {error_= matrix_errors::no_error;}
+
+   private:
+      static int error_;
+};
+
+template<class Generator>
+int ErrorCodeReporter<Generator>::error_= matrix_errors::no_error;
+
+
+// Handler must provide static void handle(int code, const char* message),
+// which must not throw
+template<class Generator>
+struct CallbackErrorReporter : ErrorCodeReporter<Generator>
+{
+   typedef Generator::Config::DSLFeatures::ErrorPolicy::handler Handler;
+
+   static void report(const int& code)
+   {
+      ErrorCodeReporter<Generator>::report(code);
+      Handler::handle(code, matrix_errors::message(code));
+   }
+};
+
+
+}  // namespace MatrixICCL
+
+#endif   // DB_MATRIX_ERRORREPORTERS_H
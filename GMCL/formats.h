@@ -14,6 +14,8 @@
 /*  - ScalarFormat                                                            */
 /*  - CSCFormat                                                               */
 /*  - CSRFormat                                                               */
+/*  - BSRFormat                                                               */
+/*  - SELLFormat                                                              */
 /*  - COOFormat                                                               */
 /*  - DIAFormat                                                               */
 /*  - LoSKYFormat                                                             */
@@ -154,6 +156,20 @@ class VecFormat
          else assert(v == zero());
       }
 
+      // adds v to the element (i, j); all elements of the band are stored,
+      // so keepZero has no effect
+      void addToElement(const IndexType & i, const IndexType & j,
+                              const ElementType & v, bool keepZero= false)
+      {
+         checkBounds(i, j);
+         if (validIndices(i, j))
+         {
+            const IndexType k= getIndex(i, j);
+            elements_.setElement(k, elements_.getElement(k) + v);
+         }
+         else assert(v == zero());
+      }
+
       ElementType getElement(const IndexType & i, const IndexType & j) const
       {
          checkBounds(i, j);
@@ -235,6 +251,16 @@ class ArrFormat
          else assert(v == zero());
       }
 
+      // adds v to the element (i, j); keepZero has no effect
+      void addToElement(const IndexType & i, const IndexType & j,
+                              const ElementType & v, bool keepZero= false)
+      {
+         checkBounds(i, j);
+         if (validIndices(i, j))
+            elements_.setElement(i, j, elements_.getElement(i, j) + v);
+         else assert(v == zero());
+      }
+
       ElementType getElement(const IndexType & i, const IndexType & j) const
       {
          checkBounds(i, j);
@@ -246,6 +272,12 @@ class ArrFormat
          elements_.initElements(v);
       }
 
+      // raw access to the storage lines of the element array
+      IndexType      lines() const {return elements_.lines();}
+      IndexType lineLength() const {return elements_.lineLength();}
+      ElementType*       line(const IndexType& l)       {return elements_.line(l);}
+      const ElementType* line(const IndexType& l) const {return elements_.line(l);}
+
    protected:
       void checkBounds(const IndexType & i, const IndexType & j) const
       {
@@ -295,6 +327,15 @@ class ScalarFormat : public ScalarValue
          else assert(v == zero());
       }
 
+      // adds v to the element (i, j); keepZero has no effect
+      void addToElement(const IndexType& i, const IndexType& j,
+                               const ElementType& v, bool keepZero= false)
+      {
+         checkBounds(i, j);
+         if (i==j) setValue(getValue() + v);
+         else assert(v == zero());
+      }
+
       ElementType getElement(const IndexType& i, const IndexType& j) const
       {
          checkBounds(i, j);
@@ -330,6 +371,7 @@ class CSRIterator
       typedef CSRFormat_            Format;
       typedef Format::ElementType   ElementType;
       typedef Format::IndexType     IndexType;
+      typedef Format::OffsetType    OffsetType;
 
       CSRIterator(const Format& c) : format_(c), indx(0),  pindx(0) {}
 
@@ -353,10 +395,11 @@ class CSRIterator
 
    private:
       const Format& format_;
-      IndexType indx, pindx;
+      OffsetType indx;
+      IndexType  pindx;
 };
 
-template<class Ext, class IndexVec, class ElemVec>
+template<class Ext, class IndexVec, class OffsetVec, class ElemVec>
 class CSRFormat
 {
    public:
@@ -364,13 +407,17 @@ class CSRFormat
       typedef Config::ElementType      ElementType;
       typedef Config::IndexType        IndexType;
       typedef Config::SignedIndexType  SignedIndexType;
-      typedef CSRIterator<CSRFormat<Ext, IndexVec, ElemVec> > IteratorType;
+      typedef Config::OffsetType       OffsetType;
+      typedef CSRIterator<CSRFormat<Ext, IndexVec, OffsetVec, ElemVec> >
+                                                                   IteratorType;
       friend IteratorType;
 
       CSRFormat(const IndexType & r, const IndexType & c, const IndexType&,
                                                     const ElementType& initElem)
          : ext_(r, c), diags_(lastDiag()-firstDiag()+1),
-           m_Val(0, rows()*cols()), m_Jndx(0, rows()*cols()), m_pntr(rows()+1)
+           m_Val(0, OffsetType(rows())*cols()),
+           m_Jndx(0, OffsetType(rows())*cols()), m_pntr(rows()+1),
+           frozen_(false)
       {
          assert(rows()>0);
          assert(cols()>0); 
@@ -388,53 +435,49 @@ class CSRFormat
                                                           const ElementType & v)
       {
          checkBounds(i, j);
-         IndexType indx= getIndex(i, j);
+         OffsetType indx= getIndex(i, j);
 
-         if (v != zero())
-            if (validIndex(indx))
+         if (validIndex(indx))
+            if (v != zero() || frozen_)
                // change element
                m_Val.setElement(indx, v);
-            else
-            {  // insert element
-               assert(!m_Val .full());
-               assert(!m_Jndx.full());
-               indx= m_pntr.getElement(i);
-               while (indx<m_pntr.getElement(i+1) && m_Jndx.getElement(indx)<j)
-                  ++indx;
-               IndexType ii= m_Val.count();
-               m_Val .addElement();
-               m_Jndx.addElement();
-               for (IndexType ii_= ii; ii-->indx; ii_= ii)
-               {
-                  m_Val .setElement(ii_, m_Val .getElement(ii));
-                  m_Jndx.setElement(ii_, m_Jndx.getElement(ii));
-               }
-               for (ii= i; ii++<rows();)
-                  m_pntr.setElement(ii, m_pntr.getElement(ii)+1);
-               m_Val .setElement(indx, v);
-               m_Jndx.setElement(indx, j);
-            }
-         else if (validIndex(indx))
-         {  // clear element
-            IndexType ii = indx;
-            for (IndexType ii_= ii; ++ii<m_pntr.getElement(rows());)
-            {
-               m_Val .setElement(ii_, m_Val .getElement(ii));
-               m_Jndx.setElement(ii_, m_Jndx.getElement(ii));
-            }
-            m_Val .removeLastElement();
-            m_Jndx.removeLastElement();
+            else removeElement(i, indx);
+         else if (v != zero())
+         {
+            if (frozen_)
+               Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+            else insertElement(i, j, v, findPosition(i, j));
+         }
+      }
 
-            // adjust row indices
-            for (ii= i; ii++<rows();)
-               m_pntr.setElement(ii, m_pntr.getElement(ii)-1);
+      // adds v to the element (i, j) with a single search of row i; an
+      // element whose sum is zero is removed, and a zero v is not inserted,
+      // unless keepZero is set or the pattern is frozen
+      void addToElement(const IndexType & i, const IndexType & j,
+                              const ElementType & v, bool keepZero= false)
+      {
+         checkBounds(i, j);
+         const OffsetType indx= findPosition(i, j);
+
+         if (indx<m_pntr.getElement(i+1) && m_Jndx.getElement(indx)==j)
+         {
+            const ElementType sum= m_Val.getElement(indx) + v;
+            if (sum != zero() || keepZero || frozen_)
+               m_Val.setElement(indx, sum);
+            else removeElement(i, indx);
+         }
+         else if (v != zero() || (keepZero && !frozen_))
+         {
+            if (frozen_)
+               Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+            else insertElement(i, j, v, indx);
          }
       }
 
       ElementType getElement(const IndexType & i, const IndexType & j) const
       {
          checkBounds(i, j);
-         IndexType indx= getIndex(i, j);
+         OffsetType indx= getIndex(i, j);
          return validIndex(indx) ? m_Val.getElement(indx) : zero();
      }
 
@@ -446,33 +489,156 @@ class CSRFormat
          m_pntr.initElements();
       }
 
+      // While the pattern is frozen, no entry is inserted or removed: a zero
+      // written to a stored entry is kept as an explicit zero, and a nonzero
+      // written outside the pattern (also by refillValues()) is reported to
+      // Config::ErrorReporter and dropped. The structure stays valid for a
+      // symbolic factorization, and refillValues() updates the values in
+      // place. Assignments replace the pattern nevertheless.
+      void freezePattern(bool frozen= true) {frozen_= frozen;}
+      bool patternFrozen() const {return frozen_;}
+
+      // sets the stored values to zero and keeps the pattern
+      void clearValues()
+      {
+         for (OffsetType k= 0; k<m_Val.count(); ++k)
+            m_Val.setElement(k, zero());
+      }
+
+      // replaces the values by the sums of the triplets read from s, which
+      // provides end() and getNext(i, j, v) like the matrix iterators; the
+      // stored entries without a triplet become zero. Each triplet is looked
+      // for at and behind the position of the previous one first, so that a
+      // stream in the order of the rows (e.g. the iterator of a matrix with
+      // the same pattern, or ParallelAssembler::refill()) takes O(nnz).
+      template<class Stream>
+      void refillValues(Stream& s)
+      {
+         IndexType   i, j;
+         ElementType v;
+         OffsetType  pos= 0;
+
+         clearValues();
+         while (!s.end())
+         {
+            s.getNext(i, j, v);
+            checkBounds(i, j);
+            if (!stored(pos, i, j) && !stored(++pos, i, j))
+               pos= getIndex(i, j);
+            if (validIndex(pos))
+               m_Val.setElement(pos, m_Val.getElement(pos) + v);
+            else addToElement(i, j, v);
+         }
+      }
+
+      // read access to the compressed storage (used by the SpMV kernels)
+      const ElemVec&     values() const {return m_Val;}
+      const IndexVec&   indices() const {return m_Jndx;}
+      const OffsetVec& pointers() const {return m_pntr;}
+
+      // replaces the contents by nnz= pntr[rows()] entries given in com-
+      // pressed form (the column indices of a row ascend); used by the
+      // conversions between the compressed formats
+      template<class PntrArray, class IndxArray, class ValArray>
+      void setCompressed(const PntrArray& pntr, const IndxArray& indx,
+                                                            const ValArray& val)
+      {
+         OffsetType k, nnz= pntr[rows()];
+
+         initElements();
+         for (k= 0; k<nnz; ++k)
+         {
+            assert(!m_Val .full());
+            assert(!m_Jndx.full());
+            m_Val .addElement(val [k]);
+            m_Jndx.addElement(indx[k]);
+         }
+         for (k= 0; k<=rows(); ++k)
+            m_pntr.setElement(k, pntr[k]);
+      }
+
    protected:
       void checkBounds(const IndexType & i, const IndexType & j) const
       {
          assert(i<rows()); assert(j<cols());
       }
 
-      bool validIndex(const IndexType& i) const
+      bool validIndex(const OffsetType& i) const
       {
          return i<m_Val.count();
       }
 
-      IndexType getIndex(const IndexType& i, const IndexType& j) const
+      OffsetType getIndex(const IndexType& i, const IndexType& j) const
       {
-         IndexType pos= m_pntr.getElement(i);
-         const IndexType & posNextRow= m_pntr.getElement(i+1);
+         OffsetType pos= m_pntr.getElement(i);
+         const OffsetType & posNextRow= m_pntr.getElement(i+1);
          while (pos<posNextRow && m_Jndx.getElement(pos)<j)
             ++pos;
          return (pos==posNextRow || m_Jndx.getElement(pos)>j)
                 ? m_pntr.getElement(rows()) : pos;
       }
 
+      // true if (i, j) is stored at pos
+      bool stored(const OffsetType& pos, const IndexType& i,
+                                                     const IndexType& j) const
+      {
+         return validIndex(pos) && m_Jndx.getElement(pos)==j &&
+                m_pntr.getElement(i)<=pos && pos<m_pntr.getElement(i+1);
+      }
+
+      // the position of the first entry of row i with a column index >= j
+      OffsetType findPosition(const IndexType& i, const IndexType& j) const
+      {
+         OffsetType pos= m_pntr.getElement(i);
+         while (pos<m_pntr.getElement(i+1) && m_Jndx.getElement(pos)<j)
+            ++pos;
+         return pos;
+      }
+
+      // inserts v at (i, j), whose place in row i is indx
+      void insertElement(const IndexType& i, const IndexType& j,
+                                const ElementType& v, const OffsetType& indx)
+      {
+         assert(!m_Val .full());
+         assert(!m_Jndx.full());
+         OffsetType ii= m_Val.count();
+         m_Val .addElement();
+         m_Jndx.addElement();
+         for (OffsetType ii_= ii; ii-->indx; ii_= ii)
+         {
+            m_Val .setElement(ii_, m_Val .getElement(ii));
+            m_Jndx.setElement(ii_, m_Jndx.getElement(ii));
+         }
+         for (ii= i; ii++<rows();)
+            m_pntr.setElement(ii, m_pntr.getElement(ii)+1);
+         m_Val .setElement(indx, v);
+         m_Jndx.setElement(indx, j);
+      }
+
+      // removes the entry at indx of row i
+      void removeElement(const IndexType& i, const OffsetType& indx)
+      {
+         OffsetType ii= indx;
+         for (OffsetType ii_= ii; ++ii<m_pntr.getElement(rows()); ii_= ii)
+         {
+            m_Val .setElement(ii_, m_Val .getElement(ii));
+            m_Jndx.setElement(ii_, m_Jndx.getElement(ii));
+         }
+         m_Val .removeLastElement();
+         m_Jndx.removeLastElement();
+
+         // adjust row indices
+         for (ii= i; ii++<rows();)
+            m_pntr.setElement(ii, m_pntr.getElement(ii)-1);
+      }
+
    private:
       const Ext         ext_;
       const IndexType   diags_;
       ElemVec     m_Val;  // explicitly stored values
       IndexVec    m_Jndx; // m_Jndx[pos] is the column index of m_Val[pos]
-      IndexVec    m_pntr; // m_pntr[i] is the position of the 1st entry in row i
+      OffsetVec   m_pntr; // m_pntr[i] is the position of the 1st entry in row i
+      bool        frozen_;// no entry is inserted or removed
 };
 
 template<class CSCFormat_>
@@ -482,6 +648,7 @@ class CSCIterator
       typedef CSCFormat_            Format;
       typedef Format::ElementType   ElementType;
       typedef Format::IndexType     IndexType;
+      typedef Format::OffsetType    OffsetType;
 
       CSCIterator(const Format& c) :format_(c), indx(0),  pindx(0) {}
 
@@ -505,11 +672,12 @@ class CSCIterator
 
    private:
       const Format& format_;
-      IndexType indx, pindx;
+      OffsetType indx;
+      IndexType  pindx;
 };
 
 
-template<class Ext, class IndexVec, class ElemVec>
+template<class Ext, class IndexVec, class OffsetVec, class ElemVec>
 class CSCFormat
 {
    public:
@@ -517,14 +685,18 @@ class CSCFormat
       typedef Config::ElementType      ElementType;
       typedef Config::IndexType        IndexType;
       typedef Config::SignedIndexType  SignedIndexType;
-      typedef CSCIterator<CSCFormat<Ext, IndexVec, ElemVec> > IteratorType;
+      typedef Config::OffsetType       OffsetType;
+      typedef CSCIterator<CSCFormat<Ext, IndexVec, OffsetVec, ElemVec> >
+                                                                   IteratorType;
       friend IteratorType;
 
    public:
       CSCFormat(const IndexType & r, const IndexType & c, const IndexType&,
                                                     const ElementType& initElem)
          : ext_(r, c), diags_(lastDiag()-firstDiag()+1),
-           m_Val(0, rows()*cols()), m_Indx(0, rows()*cols()), m_pntr(cols()+1)
+           m_Val(0, OffsetType(rows())*cols()),
+           m_Indx(0, OffsetType(rows())*cols()), m_pntr(cols()+1),
+           frozen_(false)
       {
          assert(rows()>0); assert(cols()>0);
          m_pntr.initElements();
@@ -541,57 +713,53 @@ class CSCFormat
                                                           const ElementType & v)
       {
          checkBounds(i, j);
-         IndexType indx= getIndex(i, j);
+         OffsetType indx= getIndex(i, j);
 
-         if (v != zero())
-            if (validIndex(indx))
+         if (validIndex(indx))
+            if (v != zero() || frozen_)
                // change element
                m_Val.setElement(indx, v);
-            else
-            {  // insert element
-               assert(!m_Val. full());
-               assert(!m_Indx.full());
-               indx= m_pntr.getElement(j);
-               while (indx<m_pntr.getElement(j+1) && m_Indx.getElement(indx)<i)
-                  ++indx;
-               IndexType ii= m_Val.count();
-               m_Val .addElement();
-               m_Indx.addElement();
-               for (IndexType ii_= ii; ii-->indx; ii_= ii)
-               {
-                  m_Val .setElement(ii_, m_Val .getElement(ii));
-                  m_Indx.setElement(ii_, m_Indx.getElement(ii));
-               }
-               for (ii= j; ++ii<=cols();) 
-                  m_pntr.setElement(ii, m_pntr.getElement(ii)+1);
-               m_Val .setElement(indx, v);
-               m_Indx.setElement(indx, i);
-            }
-         else if (validIndex(indx))
-         {  // clear element
-            IndexType ii= indx;
-            for (IndexType ii_= ii; ++ii<m_pntr.getElement(cols()); ii_= ii)
-            {
-               m_Val .setElement(ii_, m_Val .getElement(ii));
-               m_Indx.setElement(ii_, m_Indx.getElement(ii));
-            }
-            m_Val .removeLastElement();
-            m_Indx.removeLastElement();
+            else removeElement(j, indx);
+         else if (v != zero())
+         {
+            if (frozen_)
+               Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+            else insertElement(i, j, v, findPosition(i, j));
+         }
+      }
 
-            // adjust column indices
-            for (ii= j; ii++<cols();)
-               m_pntr.setElement(ii, m_pntr.getElement(ii)-1);
+      // adds v to the element (i, j) with a single search of column j; an
+      // element whose sum is zero is removed, and a zero v is not inserted,
+      // unless keepZero is set or the pattern is frozen
+      void addToElement(const IndexType & i, const IndexType & j,
+                              const ElementType & v, bool keepZero= false)
+      {
+         checkBounds(i, j);
+         const OffsetType indx= findPosition(i, j);
+
+         if (indx<m_pntr.getElement(j+1) && m_Indx.getElement(indx)==i)
+         {
+            const ElementType sum= m_Val.getElement(indx) + v;
+            if (sum != zero() || keepZero || frozen_)
+               m_Val.setElement(indx, sum);
+            else removeElement(j, indx);
+         }
+         else if (v != zero() || (keepZero && !frozen_))
+         {
+            if (frozen_)
+               Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+            else insertElement(i, j, v, indx);
          }
       }
 
       ElementType getElement(const IndexType & i, const IndexType & j) const
       {
          checkBounds(i, j);
-         IndexType indx= getIndex(i, j);
+         OffsetType indx= getIndex(i, j);
          return validIndex(indx) ? m_Val.getElement(indx) : zero();
       }
 
-      void initElements()
+      void initElements(const ElementType & v= zero())
       {
          assert(v == zero());
          m_Val .clear();
@@ -599,6 +767,71 @@ class CSCFormat
          m_pntr.initElements();
       }
 
+      // While the pattern is frozen, no entry is inserted or removed: a zero
+      // written to a stored entry is kept as an explicit zero, and a nonzero
+      // written outside the pattern (also by refillValues()) is reported to
+      // Config::ErrorReporter and dropped. The structure stays valid for a
+      // symbolic factorization, and refillValues() updates the values in
+      // place. Assignments replace the pattern nevertheless.
+      void freezePattern(bool frozen= true) {frozen_= frozen;}
+      bool patternFrozen() const {return frozen_;}
+
+      // sets the stored values to zero and keeps the pattern
+      void clearValues()
+      {
+         for (OffsetType k= 0; k<m_Val.count(); ++k)
+            m_Val.setElement(k, zero());
+      }
+
+      // replaces the values by the sums of the triplets read from s (see
+      // CSRFormat::refillValues()); a stream in the order of the columns
+      // takes O(nnz)
+      template<class Stream>
+      void refillValues(Stream& s)
+      {
+         IndexType   i, j;
+         ElementType v;
+         OffsetType  pos= 0;
+
+         clearValues();
+         while (!s.end())
+         {
+            s.getNext(i, j, v);
+            checkBounds(i, j);
+            if (!stored(pos, i, j) && !stored(++pos, i, j))
+               pos= getIndex(i, j);
+            if (validIndex(pos))
+               m_Val.setElement(pos, m_Val.getElement(pos) + v);
+            else addToElement(i, j, v);
+         }
+      }
+
+      // read access to the compressed storage (used by the SpMV kernels)
+      const ElemVec&     values() const {return m_Val;}
+      const IndexVec&   indices() const {return m_Indx;}
+      const OffsetVec& pointers() const {return m_pntr;}
+
+      // replaces the contents by nnz= pntr[cols()] entries given in com-
+      // pressed form (the row indices of a column ascend); used by the
+      // conversions between the compressed formats
+      template<class PntrArray, class IndxArray, class ValArray>
+      void setCompressed(const PntrArray& pntr, const IndxArray& indx,
+                                                            const ValArray& val)
+      {
+         OffsetType k, nnz= pntr[cols()];
+
+         initElements();
+         for (k= 0; k<nnz; ++k)
+         {
+            assert(!m_Val .full());
+            assert(!m_Indx.full());
+            m_Val .addElement(val [k]);
+            m_Indx.addElement(indx[k]);
+         }
+         for (k= 0; k<=cols(); ++k)
+            m_pntr.setElement(k, pntr[k]);
+      }
+
    protected:
       void checkBounds(const IndexType & i, const IndexType & j) const
       {
@@ -606,27 +839,755 @@ class CSCFormat
       }
 
 
-      bool validIndex(const IndexType& i) const
+      bool validIndex(const OffsetType& i) const
       {
          return i<m_Val.count();
       }
 
-      IndexType getIndex(const IndexType& i, const IndexType& j) const
+      OffsetType getIndex(const IndexType& i, const IndexType& j) const
       {
-         IndexType pos= m_pntr.getElement(j);
-         const IndexType & posNextCol= m_pntr.getElement(j+1);
+         OffsetType pos= m_pntr.getElement(j);
+         const OffsetType & posNextCol= m_pntr.getElement(j+1);
          while (pos<posNextCol && m_Indx.getElement(pos)<i)
             ++pos;
          return (pos==posNextCol || m_Indx.getElement(pos)>i)
                 ? m_pntr.getElement(cols()) : pos;
       }
 
+      // true if (i, j) is stored at pos
+      bool stored(const OffsetType& pos, const IndexType& i,
+                                                     const IndexType& j) const
+      {
+         return validIndex(pos) && m_Indx.getElement(pos)==i &&
+                m_pntr.getElement(j)<=pos && pos<m_pntr.getElement(j+1);
+      }
+
+      // the position of the first entry of column j with a row index >= i
+      OffsetType findPosition(const IndexType& i, const IndexType& j) const
+      {
+         OffsetType pos= m_pntr.getElement(j);
+         while (pos<m_pntr.getElement(j+1) && m_Indx.getElement(pos)<i)
+            ++pos;
+         return pos;
+      }
+
+      // inserts v at (i, j), whose place in column j is indx
+      void insertElement(const IndexType& i, const IndexType& j,
+                                const ElementType& v, const OffsetType& indx)
+      {
+         assert(!m_Val. full());
+         assert(!m_Indx.full());
+         OffsetType ii= m_Val.count();
+         m_Val .addElement();
+         m_Indx.addElement();
+         for (OffsetType ii_= ii; ii-->indx; ii_= ii)
+         {
+            m_Val .setElement(ii_, m_Val .getElement(ii));
+            m_Indx.setElement(ii_, m_Indx.getElement(ii));
+         }
+         for (ii= j; ++ii<=cols();)
+            m_pntr.setElement(ii, m_pntr.getElement(ii)+1);
+         m_Val .setElement(indx, v);
+         m_Indx.setElement(indx, i);
+      }
+
+      // removes the entry at indx of column j
+      void removeElement(const IndexType& j, const OffsetType& indx)
+      {
+         OffsetType ii= indx;
+         for (OffsetType ii_= ii; ++ii<m_pntr.getElement(cols()); ii_= ii)
+         {
+            m_Val .setElement(ii_, m_Val .getElement(ii));
+            m_Indx.setElement(ii_, m_Indx.getElement(ii));
+         }
+         m_Val .removeLastElement();
+         m_Indx.removeLastElement();
+
+         // adjust column indices
+         for (ii= j; ii++<cols();)
+            m_pntr.setElement(ii, m_pntr.getElement(ii)-1);
+      }
+
    private:
       const Ext         ext_;
       const IndexType   diags_;
       ElemVec     m_Val;  // explicitly stored values
       IndexVec    m_Indx; // m_Indx[pos] is the row-index of m_Val[pos]
-      IndexVec    m_pntr; // m_pntr[j] is the position of the 1st entry in col j
+      OffsetVec   m_pntr; // m_pntr[j] is the position of the 1st entry in col j
+      bool        frozen_;// no entry is inserted or removed
+};
+
+template<class BSRFormat_>
+class BSRIterator
+{
+   public:
+      typedef BSRFormat_            Format;
+      typedef Format::ElementType   ElementType;
+      typedef Format::IndexType     IndexType;
+      typedef Format::OffsetType    OffsetType;
+
+      BSRIterator(const Format& b) : format_(b), blk(0), pblk(0), e(0) {}
+
+      // yields all elements of the stored blocks, including explicit zeros
+      void getNext(IndexType& i, IndexType& j, ElementType& v)
+      {
+         assert(!end());
+         while (format_.m_pntr.getElement(pblk+1) == blk)
+            ++pblk;
+         i= pblk*Format::block_rows + e/Format::block_cols;
+         j= format_.m_Jndx.getElement(blk)*Format::block_cols
+                                                      + e%Format::block_cols;
+         v= format_.m_Val.getElement(blk*Format::block_size + e);
+         if (++e == Format::block_size)
+         {
+            e= 0;
+            ++blk;
+         }
+      }
+
+      void reset()
+      {
+         blk= pblk= e= 0;
+      }
+
+      bool end() const {return blk >= format_.m_Jndx.count();}
+
+   private:
+      const Format& format_;
+      OffsetType blk;
+      IndexType  pblk, e;
+};
+
+// BSR stores dense blocks of BlockRows x BlockCols elements (BlockRows and
+// BlockCols are int_numbers); the numbers of rows and columns must be
+// multiples of the block size. The block rows are compressed like the rows of
+// CSRFormat, and the elements of a block are stored row by row.
+template<class Ext, class BlockRows, class BlockCols, class IndexVec,
+                                                 class OffsetVec, class ElemVec>
+class BSRFormat
+{
+   public:
+      typedef ElemVec::Config          Config;
+      typedef Config::ElementType      ElementType;
+      typedef Config::IndexType        IndexType;
+      typedef Config::SignedIndexType  SignedIndexType;
+      typedef Config::OffsetType       OffsetType;
+      typedef BSRIterator<BSRFormat<Ext, BlockRows, BlockCols, IndexVec,
+                                          OffsetVec, ElemVec> > IteratorType;
+      friend IteratorType;
+
+      enum { block_rows= BlockRows::value,
+             block_cols= BlockCols::value,
+             block_size= block_rows*block_cols };
+
+      BSRFormat(const IndexType & r, const IndexType & c, const IndexType&,
+                                                    const ElementType& initElem)
+         : ext_(r, c), diags_(lastDiag()-firstDiag()+1),
+           m_Val(0, OffsetType(rows())*cols()),
+           m_Jndx(0, OffsetType(blockRows())*blockCols()),
+           m_pntr(blockRows()+1), frozen_(false)
+      {
+         assert(rows()>0);
+         assert(cols()>0);
+         assert(rows()%block_rows == 0);
+         assert(cols()%block_cols == 0);
+         m_pntr.initElements();
+      }
+
+      IndexType            rows() const {return ext_.rows();}
+      IndexType            cols() const {return ext_.cols();}
+      const IndexType &   diags() const {return diags_;}
+      SignedIndexType firstDiag() const {return -rows();}
+      SignedIndexType  lastDiag() const {return  cols();}
+      static const ElementType & zero() {return ElemVec::zero();}
+
+      IndexType blockRows() const {return rows()/block_rows;}
+      IndexType blockCols() const {return cols()/block_cols;}
+
+      // Setting a nonzero element outside the stored blocks inserts a zero
+      // block; stored blocks are kept when their elements become zero.
+      void setElement(const IndexType & i, const IndexType & j,
+                                                          const ElementType & v)
+      {
+         checkBounds(i, j);
+         OffsetType blk= getBlock(i/block_rows, j/block_cols);
+
+         if (!validBlock(blk))
+            if (v == zero()) return;
+            else
+            {
+               if (frozen_)
+               {
+                  Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+                  return;
+               }
+               blk= insertBlock(i/block_rows, j/block_cols);
+            }
+         m_Val.setElement(blk*block_size + offset(i, j), v);
+      }
+
+      // adds v to the element (i, j) with a single search of the block row;
+      // a zero v only inserts a block if keepZero is set and the pattern is
+      // not frozen
+      void addToElement(const IndexType & i, const IndexType & j,
+                              const ElementType & v, bool keepZero= false)
+      {
+         checkBounds(i, j);
+         OffsetType blk= getBlock(i/block_rows, j/block_cols);
+
+         if (!validBlock(blk))
+            if (v == zero() && (!keepZero || frozen_)) return;
+            else
+            {
+               if (frozen_)
+               {
+                  Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+                  return;
+               }
+               blk= insertBlock(i/block_rows, j/block_cols);
+            }
+         const OffsetType k= blk*block_size + offset(i, j);
+         m_Val.setElement(k, m_Val.getElement(k) + v);
+      }
+
+      ElementType getElement(const IndexType & i, const IndexType & j) const
+      {
+         checkBounds(i, j);
+         OffsetType blk= getBlock(i/block_rows, j/block_cols);
+         return validBlock(blk)
+                ? m_Val.getElement(blk*block_size + offset(i, j)) : zero();
+      }
+
+      void initElements(const ElementType & v= zero())
+      {
+         assert(v == zero());
+         m_Val .clear();
+         m_Jndx.clear();
+         m_pntr.initElements();
+      }
+
+      // While the pattern is frozen, no block is inserted; a nonzero element
+      // set outside the stored blocks is reported to Config::ErrorReporter
+      // and dropped. Assignments replace the blocks nevertheless.
+      void freezePattern(bool frozen= true) {frozen_= frozen;}
+      bool patternFrozen() const {return frozen_;}
+
+      // sets the elements of the stored blocks to zero and keeps the blocks
+      void clearValues()
+      {
+         for (OffsetType k= 0; k<m_Val.count(); ++k)
+            m_Val.setElement(k, zero());
+      }
+
+      // replaces the values by the sums of the triplets read from s (see
+      // CSRFormat::refillValues()); each triplet is looked for in the block
+      // of the previous one and the block behind it first, so that a stream
+      // in the order of the block rows takes O(nnz)
+      template<class Stream>
+      void refillValues(Stream& s)
+      {
+         IndexType   i, j;
+         ElementType v;
+         OffsetType  blk= 0;
+
+         clearValues();
+         while (!s.end())
+         {
+            s.getNext(i, j, v);
+            checkBounds(i, j);
+            const IndexType bi= i/block_rows, bj= j/block_cols;
+            if (!storedBlock(blk, bi, bj) && !storedBlock(++blk, bi, bj))
+               blk= getBlock(bi, bj);
+            if (validBlock(blk))
+            {
+               const OffsetType k= blk*block_size + offset(i, j);
+               m_Val.setElement(k, m_Val.getElement(k) + v);
+            }
+            else addToElement(i, j, v);
+         }
+      }
+
+      // read access to the block storage (used by the block kernels); block
+      // k occupies values()[k*block_size, (k+1)*block_size)
+      const ElemVec&     values() const {return m_Val;}
+      const IndexVec&   indices() const {return m_Jndx;}
+      const OffsetVec& pointers() const {return m_pntr;}
+
+      // replaces the contents by nb= pntr[blockRows()] blocks; indx holds
+      // the block column of each block (ascending within a block row) and
+      // val the nb*block_size elements of the blocks
+      template<class PntrArray, class IndxArray, class ValArray>
+      void setBlocks(const PntrArray& pntr, const IndxArray& indx,
+                                                            const ValArray& val)
+      {
+         OffsetType k, nb= pntr[blockRows()];
+
+         initElements();
+         for (k= 0; k<nb; ++k)
+         {
+            assert(!m_Jndx.full());
+            m_Jndx.addElement(indx[k]);
+         }
+         for (k= 0; k<nb*block_size; ++k)
+         {
+            assert(!m_Val.full());
+            m_Val.addElement(val[k]);
+         }
+         for (k= 0; k<=blockRows(); ++k)
+            m_pntr.setElement(k, pntr[k]);
+      }
+
+   protected:
+      void checkBounds(const IndexType & i, const IndexType & j) const
+      {
+         assert(i<rows()); assert(j<cols());
+      }
+
+      static IndexType offset(const IndexType& i, const IndexType& j)
+      {
+         return (i%block_rows)*block_cols + j%block_cols;
+      }
+
+      bool validBlock(const OffsetType& k) const
+      {
+         return k<m_Jndx.count();
+      }
+
+      // true if the block (bi, bj) is stored at k
+      bool storedBlock(const OffsetType& k, const IndexType& bi,
+                                                    const IndexType& bj) const
+      {
+         return validBlock(k) && m_Jndx.getElement(k)==bj &&
+                m_pntr.getElement(bi)<=k && k<m_pntr.getElement(bi+1);
+      }
+
+      OffsetType getBlock(const IndexType& bi, const IndexType& bj) const
+      {
+         OffsetType pos= m_pntr.getElement(bi);
+         const OffsetType & posNextRow= m_pntr.getElement(bi+1);
+         while (pos<posNextRow && m_Jndx.getElement(pos)<bj)
+            ++pos;
+         return (pos==posNextRow || m_Jndx.getElement(pos)>bj)
+                ? m_Jndx.count() : pos;
+      }
+
+      // inserts a zero block at (bi, bj) and returns its position
+      OffsetType insertBlock(const IndexType& bi, const IndexType& bj)
+      {
+         OffsetType k, e, pos= m_pntr.getElement(bi);
+         while (pos<m_pntr.getElement(bi+1) && m_Jndx.getElement(pos)<bj)
+            ++pos;
+
+         assert(!m_Jndx.full());
+         k= m_Jndx.count();
+         m_Jndx.addElement();
+         for (OffsetType k_= k; k-->pos; k_= k)
+            m_Jndx.setElement(k_, m_Jndx.getElement(k));
+         m_Jndx.setElement(pos, bj);
+
+         k= m_Val.count();
+         for (e= 0; e<block_size; ++e)
+         {
+            assert(!m_Val.full());
+            m_Val.addElement();
+         }
+         while (k-- > pos*block_size)
+            m_Val.setElement(k+block_size, m_Val.getElement(k));
+         for (e= 0; e<block_size; ++e)
+            m_Val.setElement(pos*block_size + e, zero());
+
+         for (k= bi; k++<blockRows();)
+            m_pntr.setElement(k, m_pntr.getElement(k)+1);
+         return pos;
+      }
+
+   private:
+      const Ext         ext_;
+      const IndexType   diags_;
+      ElemVec     m_Val;  // the blocks, each stored row by row
+      IndexVec    m_Jndx; // m_Jndx[k] is the block column of block k
+      OffsetVec   m_pntr; // m_pntr[bi] is the position of the 1st block in
+                          // block row bi
+      bool        frozen_;// no block is inserted
+};
+
+template<class SELLFormat_>
+class SELLIterator
+{
+   public:
+      typedef SELLFormat_           Format;
+      typedef Format::ElementType   ElementType;
+      typedef Format::IndexType     IndexType;
+      typedef Format::OffsetType    OffsetType;
+
+      SELLIterator(const Format& s) : format_(s), p(0), k(0) {skip();}
+
+      // visits the rows in the order of the slices
+      void getNext(IndexType& i, IndexType& j, ElementType& v)
+      {
+         assert(!end());
+         const OffsetType pos= format_.position(p, k);
+         i= format_.m_perm.getElement(p);
+         j= format_.m_Jndx.getElement(pos);
+         v= format_.m_Val .getElement(pos);
+         ++k;
+         skip();
+      }
+
+      void reset()
+      {
+         p= k= 0;
+         skip();
+      }
+
+      bool end() const {return p >= format_.rows();}
+
+   private:
+      // moves to the next row with an entry not visited yet
+      void skip()
+      {
+         while (p<format_.rows() && k>=format_.m_len.getElement(p))
+         {
+            ++p;
+            k= 0;
+         }
+      }
+
+      const Format& format_;
+      IndexType p, k;
+};
+
+// Sliced ELLPACK (SELL-C-sigma): the rows are grouped into slices of
+// ChunkSize rows, and each slice is padded to the length of its longest row
+// and stored column by column, so that a kernel processes ChunkSize rows in
+// lockstep. Within windows of SortWindow rows (a multiple of ChunkSize), the
+// rows are sorted by descending length to keep the padding small. The sort
+// is established by setCompressed(); setElement() keeps the row order and
+// widens a slice if necessary.
+template<class Ext, class ChunkSize, class SortWindow, class IndexVec,
+                                                 class OffsetVec, class ElemVec>
+class SELLFormat
+{
+   public:
+      typedef ElemVec::Config          Config;
+      typedef Config::ElementType      ElementType;
+      typedef Config::IndexType        IndexType;
+      typedef Config::SignedIndexType  SignedIndexType;
+      typedef Config::OffsetType       OffsetType;
+      typedef SELLIterator<SELLFormat<Ext, ChunkSize, SortWindow, IndexVec,
+                                          OffsetVec, ElemVec> > IteratorType;
+      friend IteratorType;
+
+      enum { chunk_size = ChunkSize::value,
+             sort_window= SortWindow::value };
+
+      SELLFormat(const IndexType & r, const IndexType & c, const IndexType&,
+                                                    const ElementType& initElem)
+         : ext_(r, c), diags_(lastDiag()-firstDiag()+1),
+           m_Val(0, OffsetType(chunks())*chunk_size*cols()),
+           m_Jndx(0, OffsetType(chunks())*chunk_size*cols()),
+           m_perm(rows()), m_pos(rows()), m_len(rows()), m_cptr(chunks()+1),
+           frozen_(false)
+      {
+         assert(rows()>0);
+         assert(cols()>0);
+         assert(sort_window%chunk_size == 0);
+         initElements();
+      }
+
+      IndexType            rows() const {return ext_.rows();}
+      IndexType            cols() const {return ext_.cols();}
+      const IndexType &   diags() const {return diags_;}
+      SignedIndexType firstDiag() const {return -rows();}
+      SignedIndexType  lastDiag() const {return  cols();}
+      static const ElementType & zero() {return ElemVec::zero();}
+
+      // number of slices; the last one may contain padding rows
+      IndexType chunks() const {return (rows()+chunk_size-1)/chunk_size;}
+
+      void setElement(const IndexType & i, const IndexType & j,
+                                                          const ElementType & v)
+      {
+         checkBounds(i, j);
+         const IndexType p  = m_pos.getElement(i);
+         const IndexType len= m_len.getElement(p);
+         IndexType k= 0;
+         while (k<len && m_Jndx.getElement(position(p, k))<j)
+            ++k;
+
+         if (k<len && m_Jndx.getElement(position(p, k))==j)
+            if (v != zero() || frozen_)
+               // change element
+               m_Val.setElement(position(p, k), v);
+            else removeElement(p, k);
+         else if (v != zero())
+         {
+            if (frozen_)
+               Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+            else insertElement(p, k, j, v);
+         }
+      }
+
+      // adds v to the element (i, j) with a single search of row i; an
+      // element whose sum is zero is removed, and a zero v is not inserted,
+      // unless keepZero is set or the pattern is frozen
+      void addToElement(const IndexType & i, const IndexType & j,
+                              const ElementType & v, bool keepZero= false)
+      {
+         checkBounds(i, j);
+         const IndexType p  = m_pos.getElement(i);
+         const IndexType len= m_len.getElement(p);
+         IndexType k= 0;
+         while (k<len && m_Jndx.getElement(position(p, k))<j)
+            ++k;
+
+         if (k<len && m_Jndx.getElement(position(p, k))==j)
+         {
+            const OffsetType  pos= position(p, k);
+            const ElementType sum= m_Val.getElement(pos) + v;
+            if (sum != zero() || keepZero || frozen_)
+               m_Val.setElement(pos, sum);
+            else removeElement(p, k);
+         }
+         else if (v != zero() || (keepZero && !frozen_))
+         {
+            if (frozen_)
+               Config::ErrorReporter::report(matrix_errors::pattern_frozen);
+            else insertElement(p, k, j, v);
+         }
+      }
+
+      ElementType getElement(const IndexType & i, const IndexType & j) const
+      {
+         checkBounds(i, j);
+         const IndexType p  = m_pos.getElement(i);
+         const IndexType len= m_len.getElement(p);
+         IndexType k= 0;
+         while (k<len && m_Jndx.getElement(position(p, k))<j)
+            ++k;
+         return k<len && m_Jndx.getElement(position(p, k))==j
+                ? m_Val.getElement(position(p, k)) : zero();
+      }
+
+      void initElements(const ElementType & v= zero())
+      {
+         assert(v == zero());
+         m_Val .clear();
+         m_Jndx.clear();
+         m_len .initElements();
+         m_cptr.initElements();
+         for (IndexType i= 0; i<rows(); ++i)
+         {
+            m_perm.setElement(i, i);
+            m_pos .setElement(i, i);
+         }
+      }
+
+      // While the pattern is frozen, no entry is inserted or removed and the
+      // slices keep their width (see CSRFormat::freezePattern()).
+      void freezePattern(bool frozen= true) {frozen_= frozen;}
+      bool patternFrozen() const {return frozen_;}
+
+      // sets the stored values (and the padding) to zero and keeps the
+      // pattern
+      void clearValues()
+      {
+         for (OffsetType k= 0; k<m_Val.count(); ++k)
+            m_Val.setElement(k, zero());
+      }
+
+      // replaces the values by the sums of the triplets read from s (see
+      // CSRFormat::refillValues()); each triplet is looked for at and behind
+      // the entry of the previous one first, so that a stream in the order
+      // of the iterator takes O(nnz)
+      template<class Stream>
+      void refillValues(Stream& s)
+      {
+         IndexType   i, j, p= 0, k= 0;
+         ElementType v;
+
+         clearValues();
+         while (!s.end())
+         {
+            s.getNext(i, j, v);
+            checkBounds(i, j);
+            if (!stored(p, k, i, j) && !stored(p, ++k, i, j))
+            {
+               p= m_pos.getElement(i);
+               k= 0;
+               while (k<m_len.getElement(p) &&
+                      m_Jndx.getElement(position(p, k))<j)
+                  ++k;
+            }
+            if (stored(p, k, i, j))
+            {
+               const OffsetType pos= position(p, k);
+               m_Val.setElement(pos, m_Val.getElement(pos) + v);
+            }
+            else addToElement(i, j, v);
+         }
+      }
+
+      // read access to the sliced storage (used by the SpMV kernel): entry k
+      // of the row at position p is stored at
+      // pointers()[p/chunk_size] + k*chunk_size + p%chunk_size, and
+      // permutation()[p] is the row at position p
+      const ElemVec&        values() const {return m_Val;}
+      const IndexVec&      indices() const {return m_Jndx;}
+      const OffsetVec&    pointers() const {return m_cptr;}
+      const IndexVec&  permutation() const {return m_perm;}
+      const IndexVec&   rowLengths() const {return m_len;}
+
+      // replaces the contents by nnz= pntr[rows()] entries given in CSR form
+      // (the column indices of a row ascend); the rows are sorted within
+      // the sort windows and packed into slices
+      template<class PntrArray, class IndxArray, class ValArray>
+      void setCompressed(const PntrArray& pntr, const IndxArray& indx,
+                                                            const ValArray& val)
+      {
+         IndexType p, q, k, t, ch, row, w;
+
+         initElements();
+
+         // stable insertion sort of each window by descending row length
+         for (w= 0; w<rows(); w+= sort_window)
+            for (p= w+1; p<Min(w+sort_window, rows()); ++p)
+            {
+               row= m_perm.getElement(p);
+               const IndexType len= pntr[row+1]-pntr[row];
+               for (q= p; q>w && pntr[m_perm.getElement(q-1)+1] -
+                                 pntr[m_perm.getElement(q-1)] < len; --q)
+                  m_perm.setElement(q, m_perm.getElement(q-1));
+               m_perm.setElement(q, row);
+            }
+         for (p= 0; p<rows(); ++p)
+         {
+            row= m_perm.getElement(p);
+            m_pos.setElement(row, p);
+            m_len.setElement(p, pntr[row+1]-pntr[row]);
+         }
+
+         // pack the slices column by column
+         for (ch= 0; ch<chunks(); ++ch)
+         {
+            IndexType wd= 0;
+            for (t= 0; t<chunk_size && ch*chunk_size+t<rows(); ++t)
+               wd= Max(wd, m_len.getElement(ch*chunk_size+t));
+            m_cptr.setElement(ch+1, m_cptr.getElement(ch) +
+                                                OffsetType(wd)*chunk_size);
+
+            for (k= 0; k<wd; ++k)
+               for (t= 0; t<chunk_size; ++t)
+               {
+                  p= ch*chunk_size + t;
+                  assert(!m_Val .full());
+                  assert(!m_Jndx.full());
+                  if (p<rows() && k<m_len.getElement(p))
+                  {
+                     row= m_perm.getElement(p);
+                     m_Val .addElement(val [pntr[row]+k]);
+                     m_Jndx.addElement(indx[pntr[row]+k]);
+                  }
+                  else
+                  {
+                     m_Val .addElement(zero());
+                     m_Jndx.addElement(0);
+                  }
+               }
+         }
+      }
+
+   protected:
+      void checkBounds(const IndexType & i, const IndexType & j) const
+      {
+         assert(i<rows()); assert(j<cols());
+      }
+
+      OffsetType position(const IndexType& p, const IndexType& k) const
+      {
+         return m_cptr.getElement(p/chunk_size) + OffsetType(k)*chunk_size
+                                                + p%chunk_size;
+      }
+
+      // true if (i, j) is entry k of the row at position p
+      bool stored(const IndexType& p, const IndexType& k, const IndexType& i,
+                                                     const IndexType& j) const
+      {
+         return m_pos.getElement(i)==p && k<m_len.getElement(p) &&
+                m_Jndx.getElement(position(p, k))==j;
+      }
+
+      IndexType width(const IndexType& ch) const
+      {
+         return (m_cptr.getElement(ch+1)-m_cptr.getElement(ch))/chunk_size;
+      }
+
+      void move(const OffsetType& from, const OffsetType& to)
+      {
+         m_Val .setElement(to, m_Val .getElement(from));
+         m_Jndx.setElement(to, m_Jndx.getElement(from));
+      }
+
+      // inserts v at column j as entry k of the row at position p
+      void insertElement(const IndexType& p, const IndexType& k,
+                                      const IndexType& j, const ElementType& v)
+      {
+         const IndexType len= m_len.getElement(p);
+         if (len == width(p/chunk_size)) widen(p/chunk_size);
+         for (IndexType kk= len; kk>k; --kk)
+            move(position(p, kk-1), position(p, kk));
+         m_Val .setElement(position(p, k), v);
+         m_Jndx.setElement(position(p, k), j);
+         m_len .setElement(p, len+1);
+      }
+
+      // removes entry k of the row at position p; the freed place becomes
+      // padding
+      void removeElement(const IndexType& p, const IndexType& k)
+      {
+         const IndexType len= m_len.getElement(p);
+         for (IndexType kk= k+1; kk<len; ++kk)
+            move(position(p, kk), position(p, kk-1));
+         m_Val .setElement(position(p, len-1), zero());
+         m_Jndx.setElement(position(p, len-1), 0);
+         m_len .setElement(p, len-1);
+      }
+
+      // appends a padding column to slice ch
+      void widen(const IndexType& ch)
+      {
+         const OffsetType end= m_cptr.getElement(ch+1);
+         OffsetType k;
+
+         for (k= 0; k<chunk_size; ++k)
+         {
+            assert(!m_Val .full());
+            assert(!m_Jndx.full());
+            m_Val .addElement();
+            m_Jndx.addElement();
+         }
+         for (k= m_Val.count()-chunk_size; k-->end;)
+            move(k, k+chunk_size);
+         for (k= end; k<end+chunk_size; ++k)
+         {
+            m_Val .setElement(k, zero());
+            m_Jndx.setElement(k, 0);
+         }
+         for (k= ch+1; k<=chunks(); ++k)
+            m_cptr.setElement(k, m_cptr.getElement(k)+chunk_size);
+      }
+
+   private:
+      const Ext         ext_;
+      const IndexType   diags_;
+      ElemVec     m_Val;  // the slices, each stored column by column
+      IndexVec    m_Jndx; // m_Jndx[pos] is the column index of m_Val[pos]
+      IndexVec    m_perm; // m_perm[p] is the row at position p
+      IndexVec    m_pos;  // m_pos[i] is the position of row i
+      IndexVec    m_len;  // m_len[p] is the length of the row at position p
+      OffsetVec   m_cptr; // m_cptr[ch] is the position of the 1st entry of
+                          // slice ch
+      bool        frozen_;// no entry is inserted or removed
 };
 
 template<class COOFormat_>
@@ -637,7 +1598,7 @@ class COOIterator
       typedef Format::ElementType   ElementType;
       typedef Format::IndexType     IndexType;
 
-      COOIterator(const Format& c) : dictIter_(c._dict) {}
+      COOIterator(const Format& c) : dictIter_(c.dict_) {}
 
       void getNext(IndexType& i, IndexType& j, ElementType& v)
       {
@@ -695,6 +1656,16 @@ class COOFormat
          dict_.setElement(i, j, v);
       }
 
+      // adds v to the element (i, j) with a single lookup in the dictionary;
+      // an element whose sum is zero is removed, and a zero v is not
+      // inserted, unless keepZero is set
+      void addToElement(const IndexType & i, const IndexType & j,
+                              const ElementType & v, bool keepZero= false)
+      {
+         checkBounds(i, j);
+         dict_.addToElement(i, j, v, keepZero);
+      }
+
       ElementType getElement(const IndexType & i, const IndexType & j) const
       {
          checkBounds(i, j);
@@ -707,6 +1678,35 @@ class COOFormat
          dict_.initElements();
       }
 
+      // stores v (!= zero()) at (i, j), which must not be stored yet, without
+      // looking it up; used by the conversions
+      void appendElement(const IndexType & i, const IndexType & j,
+                                                          const ElementType & v)
+      {
+         checkBounds(i, j);
+         dict_.appendElement(i, j, v);
+      }
+
+      // see CSRFormat::freezePattern() and CSRFormat::refillValues(); the
+      // hash dictionaries refill in O(nnz) in any order, ListDictionary for
+      // a stream in the order of its iterator
+      void freezePattern(bool frozen= true) {dict_.freezePattern(frozen);}
+      bool patternFrozen() const {return dict_.patternFrozen();}
+      void clearValues() {dict_.clearValues();}
+
+      template<class Stream>
+      void refillValues(Stream& s)
+      {
+         dict_.refillValues(s);
+      }
+
+      // adds a batch of triplets by a merge (SortedListDictionary only)
+      template<class Stream>
+      void addElements(Stream& s)
+      {
+         dict_.addElements(s);
+      }
+
    protected:
       void checkBounds(const IndexType & i, const IndexType & j) const
       {
@@ -733,9 +1733,9 @@ class DIAIterator
       {
          assert(!end());
          i= i_;
-         j+= i_+ format_.minDiag_;
+         j= i_ + diag(j_);
          v= format_.m_Val.getElement(i_, j_);
-         if (++i_>=format_.m_Val.rows()-Max(j_+format_.minDiag_, 0))
+         if (++i_>=format_.m_Val.rows()-Max(diag(j_), SignedIndexType(0)))
             i_= min_i(++j_);
       }
 
@@ -748,9 +1748,17 @@ class DIAIterator
       bool end() const {return j_>=format_.m_Val.cols();}
 
    protected:
+      typedef Format::SignedIndexType SignedIndexType;
+
+      // the number of the diagonal stored in column j of m_Val
+      SignedIndexType diag(const IndexType& j) const
+      {
+         return SignedIndexType(j) + format_.minDiag_;
+      }
+
       IndexType min_i(const IndexType& j) const
       {
-         return -Min(j+format_.minDiag_, 0);
+         return -Min(diag(j), SignedIndexType(0));
       }
 
    private:
@@ -766,18 +1774,18 @@ class DIAFormat
       typedef Config::ElementType         ElementType;
       typedef Config::IndexType           IndexType;
       typedef Config::SignedIndexType     SignedIndexType;
-      typedef DIAIterator<DIAFormat<Ext, Diags, Arr, Config> > IteratorType;
+      typedef DIAIterator<DIAFormat<Ext, Diags, Arr> > IteratorType;
       friend  IteratorType;
 
       DIAFormat(const IndexType & r,const IndexType & c, const IndexType& d,
                                                     const ElementType& initElem)
          : ext_(r, c), diags_(rows(), cols(), d),
            minDiag_(Max(firstDiag(), -SignedIndexType(rows())+1)),
-           maxDiag_(Min( lastDiag(),  SignedIndexType(cols())-1))
+           maxDiag_(Min( lastDiag(),  SignedIndexType(cols())-1)),
+           m_Val(rows(), maxDiag_-minDiag_+1)
       {
          assert(rows()==cols());
-         SignedIndexType      diag= minDiag_;
-         SignedIndexType stop_diag= maxDiag_;
+         initElements(initElem);
       }
 
       IndexType           rows () const {return   ext_. rows();}
@@ -796,6 +1804,17 @@ class DIAFormat
          else assert(v == zero());
       }
 
+      // adds v to the element (i, j); keepZero has no effect
+      void addToElement(const IndexType & i, const IndexType & j,
+                              const ElementType & v, bool keepZero= false)
+      {
+         checkBounds(i, j);
+         IndexType indx= getIndex(i, j);
+         if (validIndex(indx))
+            m_Val.setElement(i, indx, m_Val.getElement(i, indx) + v);
+         else assert(v == zero());
+      }
+
       ElementType getElement(const IndexType & i, const IndexType & j) const
       {
          checkBounds(i, j);
@@ -843,6 +1862,7 @@ class LoSKYIterator
       typedef LoSKYFormat_          Format;
       typedef Format::ElementType   ElementType;
       typedef Format::IndexType     IndexType;
+      typedef Format::OffsetType    OffsetType;
 
       LoSKYIterator(const Format& f) : format_(f), indx(0),  pindx(0), c_(0) {}
 
@@ -869,10 +1889,11 @@ class LoSKYIterator
 
    private:
       const Format& format_;
-      IndexType indx, pindx, c_;
+      OffsetType indx;
+      IndexType  pindx, c_;
 };
 
-template<class Ext, class Diags, class IndexVec, class ElemVec>
+template<class Ext, class Diags, class OffsetVec, class ElemVec>
 class LoSKYFormat
 {
    public:
@@ -880,14 +1901,15 @@ class LoSKYFormat
       typedef Config::ElementType      ElementType;
       typedef Config::IndexType        IndexType;
       typedef Config::SignedIndexType  SignedIndexType;
-      typedef LoSKYIterator<LoSKYFormat<Ext, Diags, IndexVec, ElemVec> >
+      typedef Config::OffsetType       OffsetType;
+      typedef LoSKYIterator<LoSKYFormat<Ext, Diags, OffsetVec, ElemVec> >
                                                                    IteratorType;
       friend IteratorType;
 
       LoSKYFormat(const IndexType & r,const IndexType & c, const IndexType& d,
                                                     const ElementType& initElem)
          : ext_(r, c), diags_(rows(), cols(), d),
-           m_pntr(rows()+1), m_Val(0, rows()*cols())
+           m_pntr(rows()+1), m_Val(0, OffsetType(rows())*cols())
       {
          assert(rows()==cols());
          assert(firstDiag()<=0); assert(lastDiag()==0);
@@ -907,30 +1929,35 @@ class LoSKYFormat
          checkBounds(i, j);
          if (validIndices(i, j))
          {
-            IndexType indx= getIndex(i, j);
+            OffsetType indx= getIndex(i, j);
             if (validIndex(indx))
                 // change element
                 m_Val.setElement(indx, v);
 
             else if (v!=zero())
-            {  // insert row
-               const IndexType delta= i+1;      // # of elements to insert
-               IndexType ii;
-               for (ii= delta; ii--;)
-               {
-                  assert(!m_Val.full());
-                  m_Val.addElement();
-               }
-               indx= m_pntr.getElement(i);
-               IndexType ii_= m_Val.count();
-               ii= ii_-delta;
-               while (ii>indx)
-                  m_Val.setElement(--ii_, m_Val.getElement(--ii));
-               while (ii_>ii)
-                  m_Val.setElement(--ii_, zero());
-               // adjust row indices
-               for (ii= rows(); ii>=delta; --ii)
-                  m_pntr.setElement(ii, m_pntr.getElement(ii)+delta);
+            {
+               insertRow(i);
+               m_Val.setElement(getIndex(i, j), v);
+            }
+         }
+         else assert(v == zero());
+      }
+
+      // adds v to the element (i, j) with a single lookup; the zeros within
+      // a stored row are kept, and a zero v only inserts row i if keepZero
+      // is set
+      void addToElement(const IndexType & i, const IndexType & j,
+                              const ElementType & v, bool keepZero= false)
+      {
+         checkBounds(i, j);
+         if (validIndices(i, j))
+         {
+            OffsetType indx= getIndex(i, j);
+            if (validIndex(indx))
+               m_Val.setElement(indx, m_Val.getElement(indx) + v);
+            else if (v!=zero() || keepZero)
+            {
+               insertRow(i);
                m_Val.setElement(getIndex(i, j), v);
             }
          }
@@ -940,7 +1967,7 @@ class LoSKYFormat
       ElementType getElement(const IndexType & i, const IndexType & j) const
       {
          checkBounds(i, j);
-         IndexType indx= getIndex(i, j);
+         OffsetType indx= getIndex(i, j);
          return validIndices(i, j) ? validIndex(indx) ? m_Val.getElement(indx)
                                                       : zero()
                                    : zero();
@@ -953,6 +1980,27 @@ class LoSKYFormat
          m_pntr.initElements();
       }
 
+      // read access to the skyline storage (used by the triangular solves);
+      // a stored row i occupies values()[pointers()[i] + j], j = 0..i
+      const ElemVec&     values() const {return m_Val;}
+      const OffsetVec& pointers() const {return m_pntr;}
+
+      // replaces the contents by the rows given in skyline form (pntr[i+1]-
+      // pntr[i] is 0 or i+1); used by the conversions
+      template<class PntrArray, class ValArray>
+      void setProfile(const PntrArray& pntr, const ValArray& val)
+      {
+         OffsetType k, n= pntr[rows()];
+
+         initElements();
+         for (k= 0; k<n; ++k)
+         {
+            assert(!m_Val.full());
+            m_Val.addElement(val[k]);
+         }
+         for (k= 0; k<=rows(); ++k)
+            m_pntr.setElement(k, pntr[k]);
+      }
 
    protected:
       void checkBounds(const IndexType & i, const IndexType & j) const
@@ -966,22 +2014,44 @@ class LoSKYFormat
                                                        validIndices(this, i, j);
       }
 
-      bool validIndex(const IndexType& i) const
+      bool validIndex(const OffsetType& i) const
       {
          return i<m_Val.count();
       }
 
-      IndexType getIndex(const IndexType& i, const IndexType& j) const
+      OffsetType getIndex(const IndexType& i, const IndexType& j) const
       {
-         register IndexType ii= m_pntr.getElement(i);
+         register OffsetType ii= m_pntr.getElement(i);
          return ii < m_pntr.getElement(i+1) ? ii+j : m_Val.count();
       }
 
+      // inserts row i (i+1 zeros)
+      void insertRow(const IndexType& i)
+      {
+         const IndexType delta= i+1;      // # of elements to insert
+         OffsetType ii;
+         for (ii= delta; ii--;)
+         {
+            assert(!m_Val.full());
+            m_Val.addElement();
+         }
+         OffsetType indx= m_pntr.getElement(i);
+         OffsetType ii_= m_Val.count();
+         ii= ii_-delta;
+         while (ii>indx)
+            m_Val.setElement(--ii_, m_Val.getElement(--ii));
+         while (ii_>ii)
+            m_Val.setElement(--ii_, zero());
+         // adjust row indices
+         for (ii= rows(); ii>=delta; --ii)
+            m_pntr.setElement(ii, m_pntr.getElement(ii)+delta);
+      }
+
    private:
       const Ext   ext_;
       const Diags diags_;
       ElemVec     m_Val;
-      IndexVec    m_pntr;
+      OffsetVec   m_pntr;
 };
 
 //* to flip between the 2 implement's ins/del 2nd slash in front of the asterisk
@@ -992,6 +2062,7 @@ class UpSKYIterator
       typedef UpSKYFormat_          Format;
       typedef Format::ElementType   ElementType;
       typedef Format::IndexType     IndexType;
+      typedef Format::OffsetType    OffsetType;
 
       UpSKYIterator(const Format& c) :format_(c), indx(0),  pindx(0), r_(0) {}
 
@@ -1018,10 +2089,11 @@ class UpSKYIterator
 
    private:
       const Format& format_;
-      IndexType indx, pindx, r_;
+      OffsetType indx;
+      IndexType  pindx, r_;
 };
 
-template<class Ext, class Diags, class IndexVec, class ElemVec>
+template<class Ext, class Diags, class OffsetVec, class ElemVec>
 class UpSKYFormat
 {
    public:
@@ -1029,14 +2101,15 @@ class UpSKYFormat
       typedef Config::ElementType      ElementType;
       typedef Config::IndexType        IndexType;
       typedef Config::SignedIndexType  SignedIndexType;
-      typedef UpSKYIterator<UpSKYFormat<Ext, Diags, IndexVec, ElemVec> >
+      typedef Config::OffsetType       OffsetType;
+      typedef UpSKYIterator<UpSKYFormat<Ext, Diags, OffsetVec, ElemVec> >
                                                                    IteratorType;
       friend IteratorType;
 
       UpSKYFormat(const IndexType & r,const IndexType & c, const IndexType& d,
                                                     const ElementType& initElem)
          : ext_(r, c), diags_(rows(), cols(), d),
-           m_pntr(rows()+1), m_Val(0, rows()*cols())
+           m_pntr(rows()+1), m_Val(0, OffsetType(rows())*cols())
       {
          assert(rows()==cols());
          assert(firstDiag()==0); assert(lastDiag()>=0);
@@ -1056,29 +2129,34 @@ class UpSKYFormat
          checkBounds(i, j);
          if (validIndices(i, j))
          {
-            IndexType indx= getIndex(i, j);
+            OffsetType indx= getIndex(i, j);
             if (validIndex(indx))
                // change element
                m_Val.setElement(indx, v);
             else if (v!=zero())
-            {  // insert column
-               const IndexType delta= j+1;      // # of elements to insert
-               IndexType ii;
-               for (ii= delta; ii--;)
-               {
-                  assert(!m_Val.full());
-                  m_Val.addElement();
-               }
-               indx= m_pntr.getElement(j);
-               IndexType ii_= m_Val.count();
-               ii= ii_-delta;
-               while (ii>indx)
-                  m_Val.setElement(--ii_, m_Val.getElement(--ii));
-               while (ii_>ii)
-                  m_Val.setElement(--ii_, zero());
-               // adjust row indices
-               for (ii= cols(); ii>=delta; --ii)
-                  m_pntr.setElement(ii, m_pntr.getElement(ii)+delta);
+            {
+               insertColumn(j);
+               m_Val.setElement(getIndex(i, j), v);
+            }
+         }
+         else assert(v == zero());
+      }
+
+      // adds v to the element (i, j) with a single lookup; the zeros within
+      // a stored column are kept, and a zero v only inserts column j if
+      // keepZero is set
+      void addToElement(const IndexType & i, const IndexType & j,
+                              const ElementType & v, bool keepZero= false)
+      {
+         checkBounds(i, j);
+         if (validIndices(i, j))
+         {
+            OffsetType indx= getIndex(i, j);
+            if (validIndex(indx))
+               m_Val.setElement(indx, m_Val.getElement(indx) + v);
+            else if (v!=zero() || keepZero)
+            {
+               insertColumn(j);
                m_Val.setElement(getIndex(i, j), v);
             }
          }
@@ -1088,7 +2166,7 @@ class UpSKYFormat
       ElementType getElement(const IndexType & i, const IndexType & j) const
       {
          checkBounds(i, j);
-         IndexType indx= getIndex(i, j);
+         OffsetType indx= getIndex(i, j);
          return validIndices(i, j) ? validIndex(indx) ? m_Val.getElement(indx)
                                                       : zero()
                                    : zero();
@@ -1101,6 +2179,27 @@ class UpSKYFormat
          m_pntr.initElements();
       }
 
+      // read access to the skyline storage (used by the triangular solves);
+      // a stored column j occupies values()[pointers()[j] + i], i = 0..j
+      const ElemVec&     values() const {return m_Val;}
+      const OffsetVec& pointers() const {return m_pntr;}
+
+      // replaces the contents by the columns given in skyline form (pntr[j+1]-
+      // pntr[j] is 0 or j+1); used by the conversions
+      template<class PntrArray, class ValArray>
+      void setProfile(const PntrArray& pntr, const ValArray& val)
+      {
+         OffsetType k, n= pntr[cols()];
+
+         initElements();
+         for (k= 0; k<n; ++k)
+         {
+            assert(!m_Val.full());
+            m_Val.addElement(val[k]);
+         }
+         for (k= 0; k<=cols(); ++k)
+            m_pntr.setElement(k, pntr[k]);
+      }
 
    protected:
       void checkBounds(const IndexType & i, const IndexType & j) const
@@ -1114,22 +2213,44 @@ class UpSKYFormat
                                                        validIndices(this, i, j);
       }
 
-      bool validIndex(const IndexType& i) const
+      bool validIndex(const OffsetType& i) const
       {
          return i<m_Val.count();
       }
 
-      IndexType getIndex(const IndexType& i, const IndexType& j) const
+      OffsetType getIndex(const IndexType& i, const IndexType& j) const
       {
-         register IndexType jj = m_pntr.getElement(j);
+         register OffsetType jj = m_pntr.getElement(j);
          return jj < m_pntr.getElement(j+1) ? jj+i : m_Val.count();
       }
 
+      // inserts column j (j+1 zeros)
+      void insertColumn(const IndexType& j)
+      {
+         const IndexType delta= j+1;      // # of elements to insert
+         OffsetType ii;
+         for (ii= delta; ii--;)
+         {
+            assert(!m_Val.full());
+            m_Val.addElement();
+         }
+         OffsetType indx= m_pntr.getElement(j);
+         OffsetType ii_= m_Val.count();
+         ii= ii_-delta;
+         while (ii>indx)
+            m_Val.setElement(--ii_, m_Val.getElement(--ii));
+         while (ii_>ii)
+            m_Val.setElement(--ii_, zero());
+         // adjust column indices
+         for (ii= cols(); ii>=delta; --ii)
+            m_pntr.setElement(ii, m_pntr.getElement(ii)+delta);
+      }
+
    private:
       const Ext   ext_;
       const Diags diags_;
       ElemVec     m_Val;
-      IndexVec    m_pntr;
+      OffsetVec   m_pntr;
 };
 
 /*/   // this line is used for easy flipping of the commenting
@@ -1153,17 +2274,18 @@ class UpSKYIterator : public UpSKYFormat_::BaseClass::IteratorType
       }
 };
 
-template<class Ext, class Diags, class IndexVec, class ElemVec>
-class UpSKYFormat : public LoSKYFormat<Ext, Diags, IndexVec, ElemVec>
+template<class Ext, class Diags, class OffsetVec, class ElemVec>
+class UpSKYFormat : public LoSKYFormat<Ext, Diags, OffsetVec, ElemVec>
 {
-      typedef LoSKYFormat<Ext, Diags, IndexVec, ElemVec> BaseClass;
+      typedef LoSKYFormat<Ext, Diags, OffsetVec, ElemVec> BaseClass;
 
    public:
       typedef ElemVec::Config          Config;
       typedef Config::ElementType      ElementType;
       typedef Config::IndexType        IndexType;
       typedef Config::SignedIndexType  SignedIndexType;
-      typedef UpSKYIterator<UpSKYFormat<Ext, Diags, IndexVec, ElemVec> >
+      typedef Config::OffsetType       OffsetType;
+      typedef UpSKYIterator<UpSKYFormat<Ext, Diags, OffsetVec, ElemVec> >
                                                                    IteratorType;
       friend IteratorType;
 
@@ -1210,6 +2332,13 @@ class Symm : public Format
             else   Format::setElement(j, i, v);
       }
 
+      void addToElement(const IndexType & i, const IndexType & j,
+                              const ElementType & v, bool keepZero= false)
+      {
+         if (i>=j) Format::addToElement(i, j, v, keepZero);
+            else   Format::addToElement(j, i, v, keepZero);
+      }
+
       ElementType getElement(const IndexType & i, const IndexType & j) const
       {
          return (i>=j) ? Format::getElement(i, j)
@@ -37,9 +37,11 @@
 // helper classes
 #include <iostream>
 #include <assert.h>
+#include <new>
 #include "IF.h"
 #include "equal.h"
 #include "promote.h"
+#include "ReducedPrecision.h"
 #include "MaxMin.h"
 
 
@@ -57,6 +59,7 @@
 // DSL to ICCL and MatrixGenerator) ...
 #include "DSLParser.h"
 #include "DSLAssignDefaults.h"
+#include "MatrixCost.h"
 #include "DSL to ICCL.h"
 #include "MatrixGenerator.h"
 
@@ -65,6 +68,8 @@
 
 
 // ICCL components
+#include "ErrorReporters.h"
+#include "Instrumentation.h"
 #include "MemoryAllocErrorNotifier.h"
 #include "Containers.h"
 #include "ScalarValue.h"
@@ -86,3 +91,19 @@
 #include "MatrixLazyOperations.h"
 // #include "NotLazy/MatrixOperations.h"
 // #include "SimpleLazy/MatrixSimpleLazyOperations.h"
+
+// compound assignment
+#include "MatrixUpdate.h"
+
+
+// solvers
+#include "IterativeSolvers.h"
+#include "TriangularSolve.h"
+
+
+// assembly
+#include "ParallelAssembly.h"
+
+
+// runtime handle
+#include "AnyMatrix.h"
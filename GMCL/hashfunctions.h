@@ -7,12 +7,16 @@
 /*                                                                            */
 /*  Classes:                                                                  */
 /*  - SimpleHashFunction                                                      */
+/*  - RowMajorOrder                                                           */
+/*  - MortonOrder                                                             */
 /*                                                                            */
 /*                                                                            */
 /*  SimpleHashFunction is a simple hash function that calculates a hash value */
 /*  based on row and column indices. The function may or may not be a good    */
 /*  choice - it should be sufficient for the sake of this sample implementa-  */
 /*  tion.                                                                     */
+/*  RowMajorOrder and MortonOrder are the orders of the entries of            */
+/*  SortedListDictionary (DSL features row_major_key and morton_key).         */
 /*                                                                            */
 /*                                                                            */
 /*  (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                */
@@ -37,6 +41,37 @@ class SimpleHashFunction
       }
 };
 
+// orders (i, j) by rows, and within a row by columns
+template<class IndexType>
+struct RowMajorOrder
+{
+   static bool less(const IndexType& i1, const IndexType& j1,
+                    const IndexType& i2, const IndexType& j2)
+   {
+      return i1<i2 || (i1==i2 && j1<j2);
+   }
+};
+
+// orders (i, j) along the Z-order curve, i.e. by the Morton key which
+// interleaves the bits of i and j, the bit of i being the higher one of each
+// pair. The key is not computed (it would need twice the bits of IndexType):
+// the index whose highest differing bit is the higher one decides.
+template<class IndexType>
+struct MortonOrder
+{
+   static bool less(const IndexType& i1, const IndexType& j1,
+                    const IndexType& i2, const IndexType& j2)
+   {
+      return lessMSB(i1^i2, j1^j2) ? j1<j2 : i1<i2;
+   }
+
+   // true if the highest set bit of a is lower than that of b
+   static bool lessMSB(const IndexType& a, const IndexType& b)
+   {
+      return a<b && a<(a^b);
+   }
+};
+
 
 }  // namespace MatrixICCL
 
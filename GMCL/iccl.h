@@ -28,27 +28,48 @@ namespace MatrixICCL {
 // Matrix :      Matrix [OptBoundsCheckedMatrix]
 template<class OptBoundsCheckedMatrix>struct Matrix;
 
-// OptBoundsCheckedMatrix: OptSymmetricMatrix | BoundsChecker[OptSymmetricMatrix]
-template<class OptSymmetricMatrix>class BoundsChecker;
+// OptBoundsCheckedMatrix: OptInstrumentedMatrix |
+//                         BoundsChecker[OptInstrumentedMatrix]
+template<class OptInstrumentedMatrix>class BoundsChecker;
+
+// OptInstrumentedMatrix: OptSymmetricMatrix | Instrumenter[OptSymmetricMatrix]
+template<class OptSymmetricMatrix>class Instrumenter;
+
+// RangeChecker:         EmptyRangeChecker[Config] | RangeChecker[Config]
+template<class Generator>struct EmptyRangeChecker;
+template<class Generator>struct RangeChecker;
 
 // OptSymmetricMatrix:   MatrixContainer | Symm[MatrixContainer]
 template<class MatrixContainer>class Symm;
 
 // Format:          ArrFormat[Ext, Diags, Arr] | VecFormat[Ext, Diags, ElemVec] |
 //                  ScalarFormat[Ext, ScalarValue, Config] |
-//                  CSR[Ext, IndexVec, ElemVec] | CSC[Ext, IndexVec, ElemVec] |
+//                  CSR[Ext, IndexVec, OffsetVec, ElemVec] |
+//                  CSC[Ext, IndexVec, OffsetVec, ElemVec] |
 //                  COO[Ext, Dict] | DIA[Ext, Diags, Arr] |
-//                  LoSKY[Ext, Diags, IndexVec, ElemVec] |
-//                  UpSKY[Ext, Diags, IndexVec, ElemVec]
+//                  BSR[Ext, BlockRows, BlockCols, IndexVec, OffsetVec,
+//                                                                  ElemVec] |
+//                  SELL[Ext, ChunkSize, SortWindow, IndexVec, OffsetVec,
+//                                                                  ElemVec] |
+//                  LoSKY[Ext, Diags, OffsetVec, ElemVec] |
+//                  UpSKY[Ext, Diags, OffsetVec, ElemVec]
 template<class Ext, class Diags,       class Arr              >class ArrFormat;
 template<class Ext, class Diags,       class ElemVec          >class VecFormat;
 template<class Ext, class ScalarValue, class Generator        >class ScalarFormat;
-template<class Ext, class IndexVector, class ElemVec          >class CSRFormat;
-template<class Ext, class IndexVector, class ElemVec          >class CSCFormat;
+template<class Ext, class IndexVector, class OffsetVector, class ElemVec>
+                                                                class CSRFormat;
+template<class Ext, class IndexVector, class OffsetVector, class ElemVec>
+                                                                class CSCFormat;
 template<class Ext, class Diags,       class Arr              >class DIAFormat;
 template<class Ext, class Dict                                >class COOFormat;
-template<class Ext, class Diags, class IndexVec, class ElemVec>class LoSKYFormat;
-template<class Ext, class Diags, class IndexVec, class ElemVec>class UpSKYFormat;
+template<class Ext, class BlockRows, class BlockCols, class IndexVec,
+                                 class OffsetVec, class ElemVec>class BSRFormat;
+template<class Ext, class ChunkSize, class SortWindow, class IndexVec,
+                                class OffsetVec, class ElemVec>class SELLFormat;
+template<class Ext, class Diags, class OffsetVec, class ElemVec>
+                                                              class LoSKYFormat;
+template<class Ext, class Diags, class OffsetVec, class ElemVec>
+                                                              class UpSKYFormat;
 
 
 // Arr:         Dyn2DCContainer[Config] | Fix2DCContainer[Size, Config] |
@@ -58,24 +79,37 @@ template<            class Generator>class Dyn2DCContainer;
 template<class Size, class Generator>class Fix2DFContainer;
 template<            class Generator>class Dyn2DFContainer;
 
-// IndexVec, ElemVec, VerticalContainer:
+// IndexVec, OffsetVec, ElemVec, VerticalContainer:
 //               Dyn1DContainer[ValueType, Ratio, Growing, Config] |
 //               Fix1DContainer[ValueType, Size, Config]
+// (the positions in the containers have the OffsetType of Config)
 template<class ValueType, class Ratio, class Growing, class Generator>
 class Dyn1DContainer;
 template<class ValueType, class Size, class Generator>
 class Fix1DContainer;
 
-// Dictionaries: HashDictionary | ListDictionary
+// Dictionaries: HashDictionary | ListDictionary |
+//               SortedListDictionary[IndexVector, ElementVector, EntryOrder] |
+//               FixHashDictionary[HeadVector, IndexVector, OffsetVector,
+//                                 ElementVector, HashFunction]
 template<class VerticalContainer, class HorizontalContainer, class HashFunction>
 class HashDictionary;
+template<class HeadVector, class IndexVector, class OffsetVector,
+                                  class ElementVector, class HashFunction>
+class FixHashDictionary;
 template<class IndexVector, class ElementVector>
 class ListDictionary;
+template<class IndexVector, class ElementVector, class EntryOrder>
+class SortedListDictionary;
 
 // HorizontalContainer:  ListDictionary[IndexVector, ElementVector]
 // HashFunction:         SimpleHashFunction[HashWidth]
 template<class HashWidth>class SimpleHashFunction;
 
+// EntryOrder:           RowMajorOrder[IndexType] | MortonOrder[IndexType]
+template<class IndexType>struct RowMajorOrder;
+template<class IndexType>struct MortonOrder;
+
 // Ext:      DynExt[IndexType] | StatExt[Rows, Cols] | DynSquare[IndexType] |
 //           StatSquare[Rows] | StatRows[Rows] | StatCols[Cols]
 template<class IndexType>class DynExt;
@@ -115,6 +149,17 @@ template<class Generator>struct MallocErrChecker;
 template<class Generator>struct EmptyCompatChecker;
 template<class Generator>struct CompatChecker;
 
+// ErrorReporter:        ThrowingErrorReporter[Config] | ErrorCodeReporter[Config] |
+//                       AbortingErrorReporter[Config] | CallbackErrorReporter[Config]
+template<class Generator>struct ThrowingErrorReporter;
+template<class Generator>struct ErrorCodeReporter;
+template<class Generator>struct AbortingErrorReporter;
+template<class Generator>struct CallbackErrorReporter;
+
+// Instrumentation:      EmptyInstrumentation[Config] | Instrumentation[Config]
+template<class Generator>struct EmptyInstrumentation;
+template<class Generator>struct Instrumentation;
+
 // CommaInitializer:     DenseCCommaInitializer | DenseFCommaInitializer |
 //                       SparseCommaInitializer
 template<class MatrixType>class DenseCCommaInitializer;
@@ -10,7 +10,9 @@
 /*                                                                            */
 /*                                                                            */
 /*  IF provides an if-then-else metafunction which works with VC++5.0. Some   */
-/*  additional classes are needed to avoid some compiler problems.            */
+/*  additional classes are needed to avoid some compiler problems. Compilers  */
+/*  supporting partial specialization use a plain specialization of IF, since */
+/*  IF is instantiated for every alternative of every feature computation.    */
 /*                                                                            */
 /*                                                                            */
 /*  (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                */
@@ -21,6 +23,11 @@
 #ifndef IF_H
 #define IF_H
 
+#if defined(_MSC_VER) && _MSC_VER < 1310
+
+// VC++ before 7.1 does not support partial specialization; the selection is
+// done by a member template of the selector.
+
 template<int condition, class A, class B>struct IF;
 template<int condition>struct SlectSelector;
 struct SelectFirstType;
@@ -67,5 +74,24 @@ struct IF
    typedef typename selector::Template<A, B>::RET RET;
 };
 
+#else
+
+// Every other compiler selects by partial specialization, which costs one
+// instantiation per IF instead of two.
+
+template<int condition, class A, class B>
+struct IF
+{
+   typedef A RET;
+};
+
+template<class A, class B>
+struct IF<0, A, B>
+{
+   typedef B RET;
+};
+
+#endif
+
 
 #endif   // IF_H
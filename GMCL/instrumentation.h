@@ -0,0 +1,352 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "Instrumentation.h"                  */
+/*                                                                            */
+/*                                                                            */
+/*  Category:   ICCL Components                                               */
+/*                                                                            */
+/*  Classes:                                                                  */
+/*  - InstrumentationLog                                                      */
+/*  - Instrumentation                                                         */
+/*  - EmptyInstrumentation                                                    */
+/*  - AccessCounters                                                          */
+/*  - Instrumenter                                                            */
+/*                                                                            */
+/*                                                                            */
+/*  A matrix configured with the DSL feature instrument<> reports what the    */
+/*  library does with it. The layer Instrumenter is wrapped around the        */
+/*  format (between Symm and the bounds checker) and counts the element       */
+/*  accesses of each matrix; the counters are read with counters() and        */
+/*  written by writeJSON(). The policy Config::Instrumentation is called by   */
+/*  the operations and the containers: the assignments, updates and scalings  */
+/*  time themselves with a Scope naming the algorithm selected by             */
+/*  MATRIX_ASSIGNMENT, MATRIX_EXPRESSION_ASSIGNMENT, MATRIX_UPDATE etc., a    */
+/*  product counts the MATRIX_MULTIPLY_GET_ELEMENT algorithm of every         */
+/*  element it computes, the product caches count their hits and misses, and  */
+/*  Dyn1DContainer and Dyn2DCContainer count their allocations, grow()        */
+/*  events and allocated bytes. Containers and caches do not know the matrix  */
+/*  they belong to, so these events are collected in the single               */
+/*  InstrumentationLog, which is written as JSON by                           */
+/*                                                                            */
+/*     InstrumentationLog::instance().writeJSON(cout);                        */
+/*                                                                            */
+/*  Times are measured by clock(). The counters are updated atomically, so    */
+/*  the parallel kernels may be instrumented, too.                            */
+/*  Without instrument<> (the default) EmptyInstrumentation is selected and   */
+/*  no Instrumenter is generated; all calls are empty inline functions and    */
+/*  the matrix types are the same as before.                                  */
+/*                                                                            */
+/*                                                                            */
+/*  (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                */
+/*                        Ulrich Eisenecker, Johannes Knaupp                  */
+/*                                                                            */
+/******************************************************************************/
+
+#ifndef DB_MATRIX_INSTRUMENTATION_H
+#define DB_MATRIX_INSTRUMENTATION_H
+
+#include <time.h>
+#include <string.h>
+#include <typeinfo.h>
+
+
+//**************************** instrumentation log *****************************
+
+// The paths are identified by the kind of the operation and the name of the
+// selected algorithm. There is only a limited number of algorithm classes,
+// so the paths are kept in a table of fixed size; paths beyond its end are
+// counted in the last entry.
+class InstrumentationLog
+{
+   public:
+      enum { max_paths= 256 };
+
+      struct Path
+      {
+         const char*   kind;
+         const char*   algorithm;
+         unsigned long count;
+         double        seconds;
+      };
+
+      static InstrumentationLog& instance()
+      {
+         static InstrumentationLog log;
+         return log;
+      }
+
+      // index of the path (kind, algorithm); the path is added if necessary
+      int path(const char* kind, const char* algorithm)
+      {
+         int p;
+         #pragma omp critical (db_matrix_instrumentation_log)
+         {
+            for (p= 0; p<paths_; ++p)
+               if (strcmp(path_[p].kind, kind)==0 &&
+                   strcmp(path_[p].algorithm, algorithm)==0) break;
+            if (p==max_paths) p= max_paths-1;
+            else if (p==paths_)
+            {
+               path_[p].kind= kind;
+               path_[p].algorithm= algorithm;
+               ++paths_;
+            }
+         }
+         return p;
+      }
+
+      void record(const int& p)
+      {
+         #pragma omp atomic
+         ++path_[p].count;
+      }
+
+      void record(const int& p, const clock_t& ticks)
+      {
+         record(p);
+         #pragma omp atomic
+         path_[p].seconds+= double(ticks)/CLOCKS_PER_SEC;
+      }
+
+      void cacheAccess(bool hit)
+      {
+         if (hit)
+         {
+            #pragma omp atomic
+            ++cacheHits_;
+         }
+         else
+         {
+            #pragma omp atomic
+            ++cacheMisses_;
+         }
+      }
+
+      void allocate(const unsigned long& bytes)
+      {
+         #pragma omp atomic
+         ++allocations_;
+         #pragma omp atomic
+         bytesAllocated_+= bytes;
+      }
+
+      void grow(const unsigned long& bytes)
+      {
+         #pragma omp atomic
+         ++grows_;
+         allocate(bytes);
+      }
+
+      int           paths         () const {return paths_;}
+      const Path&   getPath(int p)   const {return path_[p];}
+      unsigned long cacheHits     () const {return cacheHits_;}
+      unsigned long cacheMisses   () const {return cacheMisses_;}
+      unsigned long allocations   () const {return allocations_;}
+      unsigned long grows         () const {return grows_;}
+      unsigned long bytesAllocated() const {return bytesAllocated_;}
+
+      // clears the counters; the paths keep their indices
+      void reset()
+      {
+         for (int p= 0; p<paths_; ++p)
+         {
+            path_[p].count= 0;
+            path_[p].seconds= 0;
+         }
+         cacheHits_= cacheMisses_= allocations_= grows_= bytesAllocated_= 0;
+      }
+
+      ostream& writeJSON(ostream& out) const
+      {
+         out << "{" << endl << "   \"paths\": [";
+         for (int p= 0; p<paths_; ++p)
+         {
+            out << (p ? "," : "") << endl << "      {\"kind\": ";
+            writeString(out, path_[p].kind) << ", \"algorithm\": ";
+            writeString(out, path_[p].algorithm)
+               << ", \"count\": " << path_[p].count
+               << ", \"seconds\": " << path_[p].seconds << "}";
+         }
+         out << endl << "   ]," << endl
+             << "   \"cache\": {\"hits\": " << cacheHits_
+             << ", \"misses\": " << cacheMisses_ << "}," << endl
+             << "   \"containers\": {\"allocations\": " << allocations_
+             << ", \"grows\": " << grows_
+             << ", \"bytes_allocated\": " << bytesAllocated_ << "}" << endl
+             << "}" << endl;
+         return out;
+      }
+
+   private:
+      InstrumentationLog()
+         : paths_(0), cacheHits_(0), cacheMisses_(0), allocations_(0),
+           grows_(0), bytesAllocated_(0)
+      {}
+
+      // the names are produced by typeid and may contain any character
+      static ostream& writeString(ostream& out, const char* s)
+      {
+         out << '"';
+         for (; *s; ++s)
+            if (*s=='"' || *s=='\\') out << '\\' << *s;
+            else if ((unsigned char)*s >= ' ') out << *s;
+         return out << '"';
+      }
+
+      Path          path_[max_paths];
+      int           paths_;
+      unsigned long cacheHits_, cacheMisses_;
+      unsigned long allocations_, grows_, bytesAllocated_;
+};
+
+
+//************************** instrumentation policies **************************
+
+namespace MatrixICCL{
+
+template<class Generator>
+struct Instrumentation
+{
+   // times an operation from its construction to its destruction; the
+   // algorithm is passed as a null pointer of its type, e.g.
+   // Scope scope("assignment", (Algorithm*)NULL);
+   class Scope
+   {
+      public:
+         template<class Algorithm>
+         Scope(const char* kind, const Algorithm* algorithm)
+            : path_(pathOf(kind, algorithm)), start_(clock())
+         {}
+
+         ~Scope()
+         {
+            InstrumentationLog::instance().record(path_, clock()-start_);
+         }
+
+      private:
+         int     path_;
+         clock_t start_;
+   };
+
+   // counts a path without timing it (used per element)
+   template<class Algorithm>
+   static void path(const char* kind, const Algorithm* algorithm)
+   {
+      InstrumentationLog::instance().record(pathOf(kind, algorithm));
+   }
+
+   static void cacheAccess(bool hit)
+   {
+      InstrumentationLog::instance().cacheAccess(hit);
+   }
+
+   static void allocate(const unsigned long& bytes)
+   {
+      InstrumentationLog::instance().allocate(bytes);
+   }
+
+   static void grow(const unsigned long& bytes)
+   {
+      InstrumentationLog::instance().grow(bytes);
+   }
+
+   private:
+      // every algorithm is used for one kind of operation only, so its path
+      // is looked up once
+      template<class Algorithm>
+      static int pathOf(const char* kind, const Algorithm*)
+      {
+         static const int p= InstrumentationLog::instance().
+                                       path(kind, typeid(Algorithm).name());
+         return p;
+      }
+};
+
+template<class Generator>
+struct EmptyInstrumentation
+{
+   struct Scope
+   {
+      template<class Algorithm>
+      Scope(const char*, const Algorithm*) {}
+   };
+
+   template<class Algorithm>
+   static void path(const char*, const Algorithm*) {}
+
+   static void cacheAccess(bool) {}
+   static void allocate(const unsigned long&) {}
+   static void grow(const unsigned long&) {}
+};
+
+
+//************************** element access counters ***************************
+
+struct AccessCounters
+{
+   unsigned long gets, sets, adds, inits;
+
+   AccessCounters() : gets(0), sets(0), adds(0), inits(0) {}
+
+   ostream& writeJSON(ostream& out) const
+   {
+      return out << "{\"gets\": " << gets << ", \"sets\": " << sets
+                 << ", \"adds\": " << adds << ", \"inits\": " << inits << "}";
+   }
+};
+
+template<class OptSymmetricMatrix>
+class Instrumenter : public OptSymmetricMatrix
+{
+   public:
+      typedef OptSymmetricMatrix::Config  Config;
+      typedef Config::ElementType         ElementType;
+      typedef Config::IndexType           IndexType;
+
+      Instrumenter(const IndexType& r, const IndexType& c, const IndexType& d,
+                   const ElementType& initElem)
+         : OptSymmetricMatrix(r, c, d, initElem)
+      {}
+
+      void setElement(const IndexType& i, const IndexType& j,
+                                                           const ElementType& v)
+      {
+         #pragma omp atomic
+         ++counters_.sets;
+         OptSymmetricMatrix::setElement(i, j, v);
+      }
+
+      void addToElement(const IndexType& i, const IndexType& j,
+                        const ElementType& v, bool keepZero= false)
+      {
+         #pragma omp atomic
+         ++counters_.adds;
+         OptSymmetricMatrix::addToElement(i, j, v, keepZero);
+      }
+
+      ElementType getElement(const IndexType& i, const IndexType& j) const
+      {
+         #pragma omp atomic
+         ++counters_.gets;
+         return OptSymmetricMatrix::getElement(i, j);
+      }
+
+      void initElements(const ElementType& v= OptSymmetricMatrix::zero())
+      {
+         ++counters_.inits;
+         OptSymmetricMatrix::initElements(v);
+      }
+
+      const AccessCounters& counters() const {return counters_;}
+      void resetCounters() {counters_= AccessCounters();}
+
+      ostream& writeJSON(ostream& out) const {return counters_.writeJSON(out);}
+
+   private:
+      mutable AccessCounters counters_;
+};
+
+
+}  // namespace MatrixICCL
+
+#endif   // DB_MATRIX_INSTRUMENTATION_H
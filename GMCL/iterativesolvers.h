@@ -0,0 +1,1392 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "IterativeSolvers.h"                 */
+/*                                                                            */
+/*                                                                            */
+/*  Category:   Operations                                                    */
+/*                                                                            */
+/*  Meta-Functions:                                                           */
+/*  - MATRIX_SPMV                                                             */
+/*  - MATRIX_SPMM                                                             */
+/*  - MATRIX_ROWS_EXTRACTION                                                  */
+/*                                                                            */
+/*  Classes:                                                                  */
+/*  - SolverVector                                                            */
+/*  - UnrolledDot, UnrolledBlockRows, BlockKernel                             */
+/*  - CompressedRows                                                          */
+/*  - SolverControl                                                           */
+/*  - SolverStats                                                             */
+/*  - IdentityPreconditioner                                                  */
+/*  - JacobiPreconditioner                                                    */
+/*  - ILU0Preconditioner                                                      */
+/*  - ConjugateGradient                                                       */
+/*  - BiCGSTAB                                                                */
+/*  - GMRES                                                                   */
+/*                                                                            */
+/*                                                                            */
+/*  This file provides Krylov subspace solvers for linear systems A*x = b,    */
+/*  where A may be any matrix produced by the matrix generator. The solvers   */
+/*  access A only through the sparse matrix-vector product, which is chosen   */
+/*  by MATRIX_SPMV according to the DSL features of A (in the same way        */
+/*  MATRIX_ASSIGNMENT chooses an assignment algorithm). The vector updates    */
+/*  of the solvers are fused into single loops, so that no temporary vectors  */
+/*  are created during the iteration.                                         */
+/*  If the package is compiled with OpenMP, the row-oriented SpMV kernels     */
+/*  run in parallel whenever SolverControl::parallel() is set.                */
+/*  The kernels for BSR matrices multiply each block by a loop nest which is  */
+/*  unrolled at compile time for the static block size, and the kernel for    */
+/*  SELL matrices processes the rows of a slice in SIMD lockstep. MATRIX_SPMM */
+/*  selects the product of A and several vectors (the columns of a dense      */
+/*  matrix).                                                                  */
+/*  The kernels form their sums in the AccumulationType of A, and the solver  */
+/*  vectors (SOLVER_VECTOR) have it as well, so that a matrix stored in a     */
+/*  small element type (e.g. float or bfloat16) is solved in double.          */
+/*  Preconditioners are passed as template parameters; any class providing    */
+/*  apply(r, z) (i.e. z= inv(M)*r) can be used.                               */
+/*                                                                            */
+/*                                                                            */
+/*  (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                */
+/*                        Ulrich Eisenecker, Johannes Knaupp                  */
+/*                                                                            */
+/******************************************************************************/
+
+#ifndef DB_MATRIX_ITERATIVESOLVERS_H
+#define DB_MATRIX_ITERATIVESOLVERS_H
+
+#include <math.h>
+#include <time.h>
+
+//******************************* solver vector ********************************
+
+template<class ElementType, class IndexType>
+class SolverVector
+{
+   public:
+      typedef ElementType ElementType;
+      typedef IndexType   IndexType;
+
+      SolverVector(const IndexType& n= 0, const ElementType& initElem=
+                                                                ElementType(0))
+         : n_(n), elements_(n>0 ? new ElementType[n] : NULL)
+      {
+         initElements(initElem);
+      }
+
+      SolverVector(const SolverVector& v)
+         : n_(v.size()), elements_(v.size()>0 ? new ElementType[v.size()] : NULL)
+      {
+         for (IndexType i= 0; i<n_; ++i) elements_[i]= v.elements_[i];
+      }
+
+      ~SolverVector() {delete [] elements_;}
+
+      SolverVector& operator=(const SolverVector& v)
+      {
+         assert(size()==v.size());
+         for (IndexType i= 0; i<n_; ++i) elements_[i]= v.elements_[i];
+         return *this;
+      }
+
+      IndexType size() const {return n_;}
+
+      void setElement(const IndexType& i, const ElementType& v)
+      {
+         assert(i<size());
+         elements_[i]= v;
+      }
+
+      const ElementType& getElement(const IndexType& i) const
+      {
+         assert(i<size());
+         return elements_[i];
+      }
+
+      ElementType&       operator[](const IndexType& i)       {return elements_[i];}
+      const ElementType& operator[](const IndexType& i) const {return elements_[i];}
+
+      ElementType*       data()       {return elements_;}
+      const ElementType* data() const {return elements_;}
+
+      void initElements(const ElementType& v= ElementType(0))
+      {
+         for (IndexType i= n_; i--;) elements_[i]= v;
+      }
+
+   private:
+      IndexType     n_;
+      ElementType * elements_;
+};
+
+
+//****************************** vector kernels ********************************
+
+// All loops of the solvers are collected here. Each kernel performs one pass
+// over its vectors; the updates needed by an iteration are fused, e.g. the CG
+// step x+= alpha*p; r-= alpha*q; returns ||r||^2 in the same loop.
+
+struct KrylovKernels
+{
+   template<class Vector>
+   static Vector::ElementType dot(const Vector& x, const Vector& y)
+   {
+      Vector::ElementType result= Vector::ElementType(0);
+      const Vector::ElementType* px= x.data();
+      const Vector::ElementType* py= y.data();
+      for (Vector::IndexType i= x.size(); i--;)
+         result+= px[i]*py[i];
+      return result;
+   }
+
+   template<class Vector>
+   static Vector::ElementType norm2(const Vector& x)
+   {
+      return sqrt(dot(x, x));
+   }
+
+   // y+= a*x
+   template<class Vector>
+   static void axpy(const Vector::ElementType& a, const Vector& x, Vector& y)
+   {
+      const Vector::ElementType* px= x.data();
+      Vector::ElementType* py= y.data();
+      for (Vector::IndexType i= x.size(); i--;)
+         py[i]+= a*px[i];
+   }
+
+   // y= x + a*y
+   template<class Vector>
+   static void xpay(const Vector& x, const Vector::ElementType& a, Vector& y)
+   {
+      const Vector::ElementType* px= x.data();
+      Vector::ElementType* py= y.data();
+      for (Vector::IndexType i= x.size(); i--;)
+         py[i]= px[i] + a*py[i];
+   }
+
+   // r= b - r (r holds A*x on entry); returns ||r||^2
+   template<class Vector>
+   static Vector::ElementType residual(const Vector& b, Vector& r)
+   {
+      Vector::ElementType result= Vector::ElementType(0);
+      const Vector::ElementType* pb= b.data();
+      Vector::ElementType* pr= r.data();
+      for (Vector::IndexType i= b.size(); i--;)
+      {
+         pr[i]= pb[i] - pr[i];
+         result+= pr[i]*pr[i];
+      }
+      return result;
+   }
+
+   // x+= a*p; r-= a*q; returns ||r||^2
+   template<class Vector>
+   static Vector::ElementType
+   cgUpdate(const Vector::ElementType& a, const Vector& p, const Vector& q,
+                                                           Vector& x, Vector& r)
+   {
+      Vector::ElementType result= Vector::ElementType(0);
+      const Vector::ElementType* pp= p.data();
+      const Vector::ElementType* pq= q.data();
+      Vector::ElementType* px= x.data();
+      Vector::ElementType* pr= r.data();
+      for (Vector::IndexType i= x.size(); i--;)
+      {
+         px[i]+= a*pp[i];
+         pr[i]-= a*pq[i];
+         result+= pr[i]*pr[i];
+      }
+      return result;
+   }
+
+   // p= r + beta*(p - omega*v)
+   template<class Vector>
+   static void bicgDirection(const Vector& r, const Vector::ElementType& beta,
+                          const Vector::ElementType& omega, const Vector& v,
+                                                                      Vector& p)
+   {
+      const Vector::ElementType* pr= r.data();
+      const Vector::ElementType* pv= v.data();
+      Vector::ElementType* pp= p.data();
+      for (Vector::IndexType i= p.size(); i--;)
+         pp[i]= pr[i] + beta*(pp[i] - omega*pv[i]);
+   }
+
+   // r+= a*v; returns ||r||^2
+   template<class Vector>
+   static Vector::ElementType
+   axpyNorm(const Vector::ElementType& a, const Vector& v, Vector& r)
+   {
+      Vector::ElementType result= Vector::ElementType(0);
+      const Vector::ElementType* pv= v.data();
+      Vector::ElementType* pr= r.data();
+      for (Vector::IndexType i= r.size(); i--;)
+      {
+         pr[i]+= a*pv[i];
+         result+= pr[i]*pr[i];
+      }
+      return result;
+   }
+
+   // tt= t*t; ts= t*s (one pass)
+   template<class Vector>
+   static void dot2(const Vector& t, const Vector& s, Vector::ElementType& tt,
+                                                        Vector::ElementType& ts)
+   {
+      const Vector::ElementType* pt= t.data();
+      const Vector::ElementType* ps= s.data();
+      tt= ts= Vector::ElementType(0);
+      for (Vector::IndexType i= t.size(); i--;)
+      {
+         tt+= pt[i]*pt[i];
+         ts+= pt[i]*ps[i];
+      }
+   }
+
+   // x+= a*p + b*s
+   template<class Vector>
+   static void axpbypz(const Vector::ElementType& a, const Vector& p,
+                       const Vector::ElementType& b, const Vector& s, Vector& x)
+   {
+      const Vector::ElementType* pp= p.data();
+      const Vector::ElementType* ps= s.data();
+      Vector::ElementType* px= x.data();
+      for (Vector::IndexType i= x.size(); i--;)
+         px[i]+= a*pp[i] + b*ps[i];
+   }
+};
+
+
+//**************************** unrolled block kernels **************************
+
+// UnrolledDot<n>::dot(a, x, s) computes s + a[0]*x[0] + ... + a[n-1]*x[n-1]
+// in the type of s; the recursion is expanded at compile time.
+template<int n>
+struct UnrolledDot
+{
+   enum { length= n };
+
+   template<class ElementType, class VectorElementType, class SumType>
+   static SumType dot(const ElementType* a, const VectorElementType* x,
+                                                                   SumType s)
+   {
+      return UnrolledDot<n-1>::dot(a, x, s) + a[n-1]*x[n-1];
+   }
+};
+
+template<>
+struct UnrolledDot<0>
+{
+   enum { length= 0 };
+
+   template<class ElementType, class VectorElementType, class SumType>
+   static SumType dot(const ElementType*, const VectorElementType*, SumType s)
+   {
+      return s;
+   }
+};
+
+// UnrolledBlockRows<n>::multiplyAdd(dot, b, x, y) adds the product of the
+// block b with n rows of Dot::length elements each and x to y.
+template<int n>
+struct UnrolledBlockRows
+{
+   template<class Dot, class ElementType, class VectorElementType,
+                                                               class SumType>
+   static void multiplyAdd(const Dot& dot, const ElementType* b,
+                                     const VectorElementType* x, SumType* y)
+   {
+      UnrolledBlockRows<n-1>::multiplyAdd(dot, b, x, y);
+      y[n-1]= dot.dot(b + (n-1)*Dot::length, x, y[n-1]);
+   }
+};
+
+template<>
+struct UnrolledBlockRows<0>
+{
+   template<class Dot, class ElementType, class VectorElementType,
+                                                               class SumType>
+   static void multiplyAdd(const Dot&, const ElementType*,
+                                          const VectorElementType*, SumType*)
+   {}
+};
+
+// y+= b*x for a rows x cols block b stored row by row; the sums are formed
+// in the element type of y
+template<int rows, int cols>
+struct BlockKernel
+{
+   template<class ElementType, class VectorElementType, class SumType>
+   static void multiplyAdd(const ElementType* b, const VectorElementType* x,
+                                                                    SumType* y)
+   {
+      UnrolledBlockRows<rows>::multiplyAdd(UnrolledDot<cols>(), b, x, y);
+   }
+};
+
+
+//***************************** SpMV algorithms ********************************
+
+// The following implementations compute y= A*x. The row-oriented kernels can
+// be executed in parallel; the loop variables are signed because OpenMP 2.0
+// requires signed loop counters.
+
+struct ZeroSpMV
+{
+   template<class MatrixType, class Vector>
+   static void multiply(const MatrixType& A, const Vector& x, Vector& y,
+                                                                  bool parallel)
+   {
+      y.initElements();
+   }
+};
+
+struct DiagSpMV
+{
+   template<class MatrixType, class Vector>
+   static void multiply(const MatrixType& A, const Vector& x, Vector& y,
+                                                                  bool parallel)
+   {
+      for (MatrixType::Config::IndexType i= A.rows(); i--;)
+         y[i]= A.getElementUnchecked(i, i)*x[i];
+   }
+};
+
+struct RectSpMV
+{
+   template<class MatrixType, class Vector>
+   static void multiply(const MatrixType& A, const Vector& x, Vector& y,
+                                                                  bool parallel)
+   {
+      typedef MatrixType::Config::SignedIndexType SignedIndexType;
+      typedef MatrixType::Config::IndexType       IndexType;
+      typedef MatrixType::Config::AccumulationType AccumulationType;
+
+      const SignedIndexType r= A.rows();
+      const IndexType       c= A.cols();
+
+#pragma omp parallel for if(parallel)
+      for (SignedIndexType i= 0; i<r; ++i)
+      {
+         AccumulationType sum= AccumulationType(0);
+         for (IndexType j= 0; j<c; ++j)
+            sum+= A.getElementUnchecked(i, j)*x[j];
+         y[i]= sum;
+      }
+   }
+};
+
+struct BandSpMV
+{
+   template<class MatrixType, class Vector>
+   static void multiply(const MatrixType& A, const Vector& x, Vector& y,
+                                                                  bool parallel)
+   {
+      typedef MatrixType::Config::SignedIndexType SignedIndexType;
+      typedef MatrixType::Config::AccumulationType AccumulationType;
+
+      const SignedIndexType r= A.rows();
+      const SignedIndexType maxColsIndex= A.cols()-1;
+
+#pragma omp parallel for if(parallel)
+      for (SignedIndexType i= 0; i<r; ++i)
+      {
+         AccumulationType sum= AccumulationType(0);
+         const SignedIndexType stop_j= Min(i + A.lastDiag(), maxColsIndex);
+         for (SignedIndexType j= Max(SignedIndexType(i + A.firstDiag()), 0);
+                                                                 j<=stop_j; ++j)
+            sum+= A.getElementUnchecked(i, j)*x[j];
+         y[i]= sum;
+      }
+   }
+};
+
+// SYMV: every stored element of the lower triangle is read once and
+// contributes to two rows. The scattered updates of y are not independent,
+// so this kernel runs serially.
+struct SymmSpMV
+{
+   template<class MatrixType, class Vector>
+   static void multiply(const MatrixType& A, const Vector& x, Vector& y,
+                                                                  bool parallel)
+   {
+      typedef MatrixType::Config::SignedIndexType SignedIndexType;
+      typedef MatrixType::Config::IndexType       IndexType;
+      typedef MatrixType::Config::ElementType     ElementType;
+      typedef MatrixType::Config::AccumulationType AccumulationType;
+
+      y.initElements();
+      for (IndexType i= 0; i<A.rows(); ++i)
+      {
+         AccumulationType sum= AccumulationType(0);
+         for (IndexType j= Max(SignedIndexType(i + A.firstDiag()), 0); j<i; ++j)
+         {
+            const ElementType v= A.getElementUnchecked(i, j);
+            sum+= v*x[j];
+            y[j]+= v*x[i];
+         }
+         y[i]+= sum + A.getElementUnchecked(i, i)*x[i];
+      }
+   }
+};
+
+struct SparseSpMV
+{
+   template<class MatrixType, class Vector>
+   static void multiply(const MatrixType& A, const Vector& x, Vector& y,
+                                                                  bool parallel)
+   {
+      MatrixType::IteratorType iter(A);
+      MatrixType::Config::ElementType v;
+      MatrixType::Config::IndexType   i;
+      MatrixType::Config::IndexType   j;
+
+      y.initElements();
+      while (!iter.end())
+      {
+         iter.getNext(i, j, v);
+         y[i]+= v*x[j];
+      }
+   }
+};
+
+// The iterator of a symmetric sparse matrix visits the stored (lower) triangle
+// only, so every off-diagonal element contributes to two rows.
+struct SparseSymmSpMV
+{
+   template<class MatrixType, class Vector>
+   static void multiply(const MatrixType& A, const Vector& x, Vector& y,
+                                                                  bool parallel)
+   {
+      MatrixType::IteratorType iter(A);
+      MatrixType::Config::ElementType v;
+      MatrixType::Config::IndexType   i;
+      MatrixType::Config::IndexType   j;
+
+      y.initElements();
+      while (!iter.end())
+      {
+         iter.getNext(i, j, v);
+         y[i]+= v*x[j];
+         if (i!=j) y[j]+= v*x[i];
+      }
+   }
+};
+
+struct CSRSpMV
+{
+   template<class MatrixType, class Vector>
+   static void multiply(const MatrixType& A, const Vector& x, Vector& y,
+                                                                  bool parallel)
+   {
+      typedef MatrixType::Config::SignedIndexType SignedIndexType;
+      typedef MatrixType::Config::OffsetType      OffsetType;
+      typedef MatrixType::Config::AccumulationType AccumulationType;
+
+      const SignedIndexType r= A.rows();
+
+#pragma omp parallel for if(parallel)
+      for (SignedIndexType i= 0; i<r; ++i)
+      {
+         AccumulationType sum= AccumulationType(0);
+         const OffsetType stop= A.pointers().getElement(i+1);
+         for (OffsetType k= A.pointers().getElement(i); k<stop; ++k)
+            sum+= A.values().getElement(k)*x[A.indices().getElement(k)];
+         y[i]= sum;
+      }
+   }
+};
+
+// The block rows are independent; each block is multiplied by the unrolled
+// kernel for the static block size of A.
+struct BSRSpMV
+{
+   template<class MatrixType, class Vector>
+   static void multiply(const MatrixType& A, const Vector& x, Vector& y,
+                                                                  bool parallel)
+   {
+      typedef MatrixType::Config::SignedIndexType SignedIndexType;
+      typedef MatrixType::Config::IndexType       IndexType;
+      typedef MatrixType::Config::OffsetType      OffsetType;
+      typedef MatrixType::Config::AccumulationType AccumulationType;
+      enum { br= MatrixType::block_rows,
+             bc= MatrixType::block_cols,
+             bs= MatrixType::block_size };
+      typedef BlockKernel<br, bc> Kernel;
+
+      const SignedIndexType nbr= A.blockRows();
+
+#pragma omp parallel for if(parallel)
+      for (SignedIndexType bi= 0; bi<nbr; ++bi)
+      {
+         AccumulationType sum[br];
+         IndexType t;
+         for (t= 0; t<br; ++t) sum[t]= AccumulationType(0);
+
+         const OffsetType stop= A.pointers().getElement(bi+1);
+         for (OffsetType k= A.pointers().getElement(bi); k<stop; ++k)
+            Kernel::multiplyAdd(&A.values().getElement(k*bs),
+                                &x[A.indices().getElement(k)*bc], sum);
+         for (t= 0; t<br; ++t) y[bi*br + t]= sum[t];
+      }
+   }
+};
+
+// The rows of a slice are processed in lockstep: the inner loop runs over
+// the chunk_size rows of the slice with unit stride and has a static trip
+// count, so that it is vectorized. The padding entries are zero.
+struct SELLSpMV
+{
+   template<class MatrixType, class Vector>
+   static void multiply(const MatrixType& A, const Vector& x, Vector& y,
+                                                                  bool parallel)
+   {
+      typedef MatrixType::Config::SignedIndexType SignedIndexType;
+      typedef MatrixType::Config::IndexType       IndexType;
+      typedef MatrixType::Config::OffsetType      OffsetType;
+      typedef MatrixType::Config::ElementType     ElementType;
+      typedef MatrixType::Config::AccumulationType AccumulationType;
+      enum { C= MatrixType::chunk_size };
+
+      const SignedIndexType chunks= A.chunks();
+      const IndexType       r     = A.rows();
+
+#pragma omp parallel for if(parallel)
+      for (SignedIndexType ch= 0; ch<chunks; ++ch)
+      {
+         AccumulationType sum[C];
+         IndexType t;
+         for (t= 0; t<C; ++t) sum[t]= AccumulationType(0);
+
+         const OffsetType stop= A.pointers().getElement(ch+1);
+         for (OffsetType k= A.pointers().getElement(ch); k<stop; k+= C)
+         {
+            const ElementType* val= &A.values ().getElement(k);
+            const IndexType*   col= &A.indices().getElement(k);
+            for (t= 0; t<C; ++t)
+               sum[t]+= val[t]*x[col[t]];
+         }
+         for (t= 0; t<C && ch*C+t<r; ++t)
+            y[A.permutation().getElement(ch*C+t)]= sum[t];
+      }
+   }
+};
+
+
+//***************************** computing SpMV type ****************************
+
+template<class MatrixType>
+struct MATRIX_SPMV
+{
+   typedef MatrixType::Config::DSLFeatures DSLFeatures;
+   typedef DSLFeatures::Density            Density;
+   typedef DSLFeatures::Shape              Shape;
+   typedef DSLFeatures::Format             Format;
+
+   typedef IF<EQUAL<Shape::id, Shape::zero_id>::RET,
+                  ZeroSpMV,
+
+           IF<EQUAL<Shape::id, Shape:: ident_id>::RET ||
+              EQUAL<Shape::id, Shape::scalar_id>::RET ||
+              EQUAL<Shape::id, Shape::  diag_id>::RET,
+                  DiagSpMV,
+
+           IF<EQUAL<Density::id, Density::sparse_id>::RET,
+               IF<EQUAL<Shape::id, Shape::symm_id>::RET,
+                  SparseSymmSpMV,
+               IF<EQUAL<Format::id, Format::CSR_id>::RET,
+                  CSRSpMV,
+               IF<EQUAL<Format::id, Format::BSR_id>::RET,
+                  BSRSpMV,
+               IF<EQUAL<Format::id, Format::SELL_id>::RET,
+                  SELLSpMV,
+                  SparseSpMV>::RET>::RET>::RET>::RET,
+
+           IF<EQUAL<Shape::id, Shape::rect_id>::RET,
+                  RectSpMV,
+
+           IF<EQUAL<Shape::id, Shape::symm_id>::RET,
+                  SymmSpMV,
+                  BandSpMV>::RET>::RET>::RET>::RET>::RET RET;
+};
+
+template<class MatrixType, class Vector>
+inline void multiply(const MatrixType& A, const Vector& x, Vector& y,
+                                                           bool parallel= false)
+{
+   assert(x.size()==A.cols()); assert(y.size()==A.rows());
+   MATRIX_SPMV<MatrixType>::RET::multiply(A, x, y, parallel);
+}
+
+//************************ multiplication of several vectors *******************
+
+// The following implementations compute Y= A*X for dense matrices X and Y,
+// whose columns are the vectors.
+
+// multiplies the columns one by one by the SpMV kernel of A
+struct ColumnwiseSpMM
+{
+   template<class MatrixType, class MatrixX, class MatrixY>
+   static void multiply(const MatrixType& A, const MatrixX& X, MatrixY& Y,
+                                                                  bool parallel)
+   {
+      typedef MatrixType::Config::IndexType        IndexType;
+      typedef MatrixType::Config::AccumulationType AccumulationType;
+      typedef SolverVector<AccumulationType, IndexType> Vector;
+
+      Vector x(A.cols()), y(A.rows());
+      IndexType i;
+      for (IndexType c= 0; c<X.cols(); ++c)
+      {
+         for (i= 0; i<A.cols(); ++i) x[i]= X.getElementUnchecked(i, c);
+         MATRIX_SPMV<MatrixType>::RET::multiply(A, x, y, parallel);
+         for (i= 0; i<A.rows(); ++i) Y.setElementUnchecked(i, c, y[i]);
+      }
+   }
+};
+
+// Every block is applied to all columns while it is in the cache; the
+// segment of a column it is multiplied with is gathered first.
+struct BSRSpMM
+{
+   template<class MatrixType, class MatrixX, class MatrixY>
+   static void multiply(const MatrixType& A, const MatrixX& X, MatrixY& Y,
+                                                                  bool parallel)
+   {
+      typedef MatrixType::Config::SignedIndexType SignedIndexType;
+      typedef MatrixType::Config::IndexType       IndexType;
+      typedef MatrixType::Config::OffsetType      OffsetType;
+      typedef MatrixType::Config::ElementType     ElementType;
+      typedef MatrixType::Config::AccumulationType AccumulationType;
+      enum { br= MatrixType::block_rows,
+             bc= MatrixType::block_cols,
+             bs= MatrixType::block_size };
+      typedef BlockKernel<br, bc> Kernel;
+
+      const SignedIndexType nbr= A.blockRows();
+      const IndexType       m  = X.cols();
+
+#pragma omp parallel for if(parallel)
+      for (SignedIndexType bi= 0; bi<nbr; ++bi)
+      {
+         AccumulationType xb[bc], yb[br];
+         IndexType c, t;
+         for (c= 0; c<m; ++c)
+            for (t= 0; t<br; ++t) Y.setElementUnchecked(bi*br + t, c,
+                                                            ElementType(0));
+
+         const OffsetType stop= A.pointers().getElement(bi+1);
+         for (OffsetType k= A.pointers().getElement(bi); k<stop; ++k)
+         {
+            const ElementType* b= &A.values().getElement(k*bs);
+            const IndexType    j= A.indices().getElement(k)*bc;
+            for (c= 0; c<m; ++c)
+            {
+               for (t= 0; t<bc; ++t) xb[t]= X.getElementUnchecked(j + t, c);
+               for (t= 0; t<br; ++t) yb[t]= AccumulationType(0);
+               Kernel::multiplyAdd(b, xb, yb);
+               for (t= 0; t<br; ++t)
+                  Y.setElementUnchecked(bi*br + t, c,
+                               Y.getElementUnchecked(bi*br + t, c) + yb[t]);
+            }
+         }
+      }
+   }
+};
+
+template<class MatrixType>
+struct MATRIX_SPMM
+{
+   typedef MatrixType::Config::DSLFeatures::Format Format;
+
+   typedef IF<EQUAL<Format::id, Format::BSR_id>::RET,
+                  BSRSpMM,
+                  ColumnwiseSpMM>::RET RET;
+};
+
+// Y= A*X; the columns of X and Y are the vectors
+template<class MatrixType, class MatrixX, class MatrixY>
+inline void multiplyMultiple(const MatrixType& A, const MatrixX& X, MatrixY& Y,
+                                                           bool parallel= false)
+{
+   assert(X.rows()==A.cols()); assert(Y.rows()==A.rows());
+   assert(Y.cols()==X.cols());
+   MATRIX_SPMM<MatrixType>::RET::multiply(A, X, Y, parallel);
+}
+
+
+//************************** compressed row extraction *************************
+
+// CompressedRows holds a copy of a matrix in compressed row storage with the
+// column indices of each row in ascending order. It is used by preconditioners
+// which need structured access to the rows of any matrix. The positions of
+// the rows (pntr) have the OffsetType of the matrix, as nnz may exceed the
+// range of the IndexType.
+
+template<class ElementType_, class IndexType_, class OffsetType_>
+class CompressedRows
+{
+   public:
+      typedef ElementType_ ElementType;
+      typedef IndexType_   IndexType;
+      typedef OffsetType_  OffsetType;
+
+      CompressedRows() : r_(0), nnz_(0), pntr_(NULL), indx_(NULL), val_(NULL)
+      {}
+
+      ~CompressedRows() {clear();}
+
+      void allocate(const IndexType& r, const OffsetType& nnz)
+      {
+         clear();
+         r_= r; nnz_= nnz;
+         pntr_= new OffsetType[r+1];
+         indx_= new IndexType[nnz>0 ? nnz : 1];
+         val_ = new ElementType[nnz>0 ? nnz : 1];
+      }
+
+      void clear()
+      {
+         delete [] pntr_;
+         delete [] indx_;
+         delete [] val_;
+         pntr_= NULL;
+         indx_= NULL;
+         val_= NULL;
+         r_= nnz_= 0;
+      }
+
+      IndexType      rows() const {return r_;}
+      OffsetType nonZeros() const {return nnz_;}
+
+      OffsetType*  pntr() const {return pntr_;}
+      IndexType*   indx() const {return indx_;}
+      ElementType*  val() const {return val_;}
+
+      // sorts the column indices within each row (rows are short, so insertion
+      // sort is used)
+      void sortRows()
+      {
+         for (IndexType i= 0; i<r_; ++i)
+            for (OffsetType k= pntr_[i]+1; k<pntr_[i+1]; ++k)
+            {
+               const IndexType   j= indx_[k];
+               const ElementType v= val_[k];
+               OffsetType kk= k;
+               for (; kk>pntr_[i] && indx_[kk-1]>j; --kk)
+               {
+                  indx_[kk]= indx_[kk-1];
+                  val_ [kk]= val_ [kk-1];
+               }
+               indx_[kk]= j;
+               val_ [kk]= v;
+            }
+      }
+
+   private:
+      CompressedRows(const CompressedRows&);
+      CompressedRows& operator=(const CompressedRows&);
+
+      IndexType     r_;
+      OffsetType    nnz_;
+      OffsetType  * pntr_;
+      IndexType   * indx_;
+      ElementType * val_;
+};
+
+
+// extraction using the iterator of a sparse matrix; the iterator of a
+// symmetric matrix yields the lower triangle only, which is mirrored
+struct SparseRowsExtraction
+{
+   template<class MatrixType, class Rows>
+   static void extract(const MatrixType& A, Rows& rows)
+   {
+      typedef MatrixType::Config::DSLFeatures::Shape Shape;
+      typedef MatrixType::Config::IndexType          IndexType;
+      typedef MatrixType::Config::ElementType        ElementType;
+      typedef Rows::OffsetType                       OffsetType;
+      enum {mirror= EQUAL<Shape::id, Shape::symm_id>::RET};
+
+      MatrixType::IteratorType iter(A);
+      ElementType v;
+      IndexType   i, j;
+      OffsetType  nnz= 0;
+
+      OffsetType* count= new OffsetType[A.rows()+1];
+      for (i= A.rows()+1; i--;) count[i]= 0;
+      while (!iter.end())
+      {
+         iter.getNext(i, j, v);
+         ++count[i+1]; ++nnz;
+         if (mirror && i!=j) {++count[j+1]; ++nnz;}
+      }
+
+      rows.allocate(A.rows(), nnz);
+      OffsetType* pntr= rows.pntr();
+      pntr[0]= 0;
+      for (i= 0; i<A.rows(); ++i)
+      {
+         pntr[i+1]= pntr[i] + count[i+1];
+         count[i]= pntr[i];
+      }
+
+      iter.reset();
+      while (!iter.end())
+      {
+         iter.getNext(i, j, v);
+         rows.indx()[count[i]]= j; rows.val()[count[i]++]= v;
+         if (mirror && i!=j)
+         {
+            rows.indx()[count[j]]= i; rows.val()[count[j]++]= v;
+         }
+      }
+      delete [] count;
+
+      rows.sortRows();
+   }
+};
+
+// extraction of the nonzero elements within the band of any matrix (the main
+// diagonal is always stored)
+struct BandRowsExtraction
+{
+   template<class MatrixType, class Rows>
+   static void extract(const MatrixType& A, Rows& rows)
+   {
+      typedef MatrixType::Config::SignedIndexType SignedIndexType;
+      typedef MatrixType::Config::IndexType       IndexType;
+      typedef MatrixType::Config::ElementType     ElementType;
+      typedef Rows::OffsetType                    OffsetType;
+
+      const SignedIndexType maxColsIndex= A.cols()-1;
+      SignedIndexType i, j, stop_j;
+      OffsetType nnz= 0;
+
+      for (i= 0; i<SignedIndexType(A.rows()); ++i)
+      {
+         stop_j= Min(i + A.lastDiag(), maxColsIndex);
+         for (j= Max(SignedIndexType(i + A.firstDiag()), 0); j<=stop_j; ++j)
+            if (i==j || A.getElementUnchecked(i, j)!=ElementType(0)) ++nnz;
+      }
+
+      rows.allocate(A.rows(), nnz);
+      nnz= 0;
+      for (i= 0; i<SignedIndexType(A.rows()); ++i)
+      {
+         rows.pntr()[i]= nnz;
+         stop_j= Min(i + A.lastDiag(), maxColsIndex);
+         for (j= Max(SignedIndexType(i + A.firstDiag()), 0); j<=stop_j; ++j)
+         {
+            const ElementType v= A.getElementUnchecked(i, j);
+            if (i==j || v!=ElementType(0))
+            {
+               rows.indx()[nnz]= j; rows.val()[nnz++]= v;
+            }
+         }
+      }
+      rows.pntr()[A.rows()]= nnz;
+   }
+};
+
+template<class MatrixType>
+struct MATRIX_ROWS_EXTRACTION
+{
+   typedef MatrixType::Config::DSLFeatures::Density Density;
+
+   typedef IF<EQUAL<Density::id, Density::sparse_id>::RET,
+                  SparseRowsExtraction,
+                  BandRowsExtraction>::RET RET;
+};
+
+
+//****************************** preconditioners *******************************
+
+struct IdentityPreconditioner
+{
+   template<class Vector>
+   void apply(const Vector& r, Vector& z) const
+   {
+      z= r;
+   }
+};
+
+template<class MatrixType>
+class JacobiPreconditioner
+{
+   public:
+      typedef MatrixType::Config::AccumulationType ElementType;
+      typedef MatrixType::Config::IndexType        IndexType;
+
+      JacobiPreconditioner(const MatrixType& A)
+         : invDiag_(A.rows())
+      {
+         for (IndexType i= A.rows(); i--;)
+         {
+            const ElementType d= A.getElement(i, i);
+            invDiag_[i]= d!=ElementType(0) ? ElementType(1)/d : ElementType(1);
+         }
+      }
+
+      template<class Vector>
+      void apply(const Vector& r, Vector& z) const
+      {
+         const Vector::ElementType* pr= r.data();
+         Vector::ElementType* pz= z.data();
+         const ElementType* pd= invDiag_.data();
+         for (IndexType i= r.size(); i--;)
+            pz[i]= pd[i]*pr[i];
+      }
+
+   private:
+      SolverVector<ElementType, IndexType> invDiag_;
+};
+
+// Incomplete LU factorization with the sparsity pattern of A (no fill-in).
+// L (unit lower triangular) and U are stored together in one compressed row
+// structure; diag_[i] is the position of the diagonal element of row i.
+template<class MatrixType>
+class ILU0Preconditioner
+{
+   public:
+      typedef MatrixType::Config::ElementType      ElementType;
+      typedef MatrixType::Config::AccumulationType AccumulationType;
+      typedef MatrixType::Config::IndexType        IndexType;
+      typedef MatrixType::Config::OffsetType       OffsetType;
+
+      ILU0Preconditioner(const MatrixType& A)
+         : diag_(new OffsetType[A.rows()])
+      {
+         assert(A.rows()==A.cols());
+         MATRIX_ROWS_EXTRACTION<MatrixType>::RET::extract(A, lu_);
+         factorize();
+      }
+
+      ~ILU0Preconditioner() {delete [] diag_;}
+
+      template<class Vector>
+      void apply(const Vector& r, Vector& z) const
+      {
+         const OffsetType*  pntr= lu_.pntr();
+         const IndexType*   indx= lu_.indx();
+         const ElementType* val = lu_.val();
+         const IndexType    n= lu_.rows();
+         IndexType  i;
+         OffsetType k;
+
+         // forward substitution with L
+         for (i= 0; i<n; ++i)
+         {
+            AccumulationType sum= r[i];
+            for (k= pntr[i]; k<diag_[i]; ++k)
+               sum-= val[k]*z[indx[k]];
+            z[i]= sum;
+         }
+
+         // backward substitution with U
+         for (i= n; i--;)
+         {
+            AccumulationType sum= z[i];
+            for (k= diag_[i]+1; k<pntr[i+1]; ++k)
+               sum-= val[k]*z[indx[k]];
+            z[i]= sum/val[diag_[i]];
+         }
+      }
+
+   private:
+      ILU0Preconditioner(const ILU0Preconditioner&);
+      ILU0Preconditioner& operator=(const ILU0Preconditioner&);
+
+      void factorize()
+      {
+         const OffsetType* pntr= lu_.pntr();
+         const IndexType*  indx= lu_.indx();
+         ElementType*      val = lu_.val();
+         const IndexType   n= lu_.rows();
+         const OffsetType  none= lu_.nonZeros();
+         IndexType  i;
+         OffsetType k, kk;
+
+         for (i= 0; i<n; ++i)
+         {
+            for (diag_[i]= pntr[i]; diag_[i]<pntr[i+1] && indx[diag_[i]]<i;)
+               ++diag_[i];
+            assert(diag_[i]<pntr[i+1] && indx[diag_[i]]==i);
+         }
+
+         // position of each column of the current row (none means "not
+         // stored")
+         OffsetType* pos= new OffsetType[n];
+         for (i= n; i--;) pos[i]= none;
+
+         for (i= 1; i<n; ++i)
+         {
+            for (k= pntr[i]; k<pntr[i+1]; ++k) pos[indx[k]]= k;
+
+            for (k= pntr[i]; k<diag_[i]; ++k)
+            {
+               const IndexType row= indx[k];
+               val[k]/= val[diag_[row]];
+               for (kk= diag_[row]+1; kk<pntr[row+1]; ++kk)
+                  if (pos[indx[kk]]!=none)
+                     val[pos[indx[kk]]]-= val[k]*val[kk];
+            }
+
+            for (k= pntr[i]; k<pntr[i+1]; ++k) pos[indx[k]]= none;
+         }
+         delete [] pos;
+      }
+
+      CompressedRows<ElementType, IndexType, OffsetType> lu_;
+      OffsetType* diag_;
+};
+
+
+//**************************** control and statistics **************************
+
+class SolverControl
+{
+   public:
+      SolverControl(unsigned maxIterations= 1000, double relTolerance= 1e-8,
+                    double absTolerance= 0.0, unsigned restart= 30,
+                    bool parallel= false)
+         : maxIterations_(maxIterations), relTolerance_(relTolerance),
+           absTolerance_(absTolerance), restart_(restart), parallel_(parallel)
+      {}
+
+      unsigned maxIterations() const {return maxIterations_;}
+      double    relTolerance() const {return relTolerance_;}
+      double    absTolerance() const {return absTolerance_;}
+      unsigned       restart() const {return restart_;}
+      bool          parallel() const {return parallel_;}
+
+      // the residual norm below which the iteration is regarded as converged
+      double tolerance(double normB) const
+      {
+         return Max(relTolerance_*normB, absTolerance_);
+      }
+
+   private:
+      unsigned maxIterations_;
+      double   relTolerance_, absTolerance_;
+      unsigned restart_;
+      bool     parallel_;
+};
+
+// SolverStats records the residual norm and the elapsed time of each
+// iteration. Index 0 holds the initial residual.
+class SolverStats
+{
+   public:
+      SolverStats(unsigned maxIterations= 1000)
+         : capacity_(maxIterations+1), iterations_(0), converged_(false),
+           residuals_(new double[maxIterations+1]),
+           times_(new double[maxIterations+1]), start_(0), last_(0)
+      {}
+
+      ~SolverStats()
+      {
+         delete [] residuals_;
+         delete [] times_;
+      }
+
+      void start(double initialResidual)
+      {
+         iterations_= 0;
+         converged_= false;
+         start_= last_= clock();
+         residuals_[0]= initialResidual;
+         times_[0]= 0.0;
+      }
+
+      void record(double residual)
+      {
+         clock_t now= clock();
+         if (++iterations_ < capacity_)
+         {
+            residuals_[iterations_]= residual;
+            times_[iterations_]= double(now-last_)/CLOCKS_PER_SEC;
+         }
+         last_= now;
+      }
+
+      void finish(bool converged) {converged_= converged;}
+
+      unsigned      iterations() const {return iterations_;}
+      bool           converged() const {return converged_;}
+      double   initialResidual() const {return residuals_[0];}
+      double     finalResidual() const {return residual(iterations_);}
+      double         totalTime() const {return double(last_-start_)/CLOCKS_PER_SEC;}
+
+      double residual(unsigned it) const
+      {
+         return residuals_[Min(it, capacity_-1)];
+      }
+
+      double iterationTime(unsigned it) const
+      {
+         return times_[Min(it, capacity_-1)];
+      }
+
+      ostream& display(ostream& out) const
+      {
+         out << (converged_ ? "converged" : "not converged") << " after "
+             << iterations_ << " iterations (" << totalTime() << " s)" << endl;
+         out << "initial residual: " << initialResidual()
+             << "   final residual: " << finalResidual() << endl;
+         for (unsigned it= 1; it<=iterations_ && it<capacity_; ++it)
+            out << it << "   " << residuals_[it] << "   " << times_[it] << endl;
+         return out;
+      }
+
+   private:
+      SolverStats(const SolverStats&);
+      SolverStats& operator=(const SolverStats&);
+
+      unsigned capacity_, iterations_;
+      bool     converged_;
+      double * residuals_;
+      double * times_;
+      clock_t  start_, last_;
+};
+
+inline ostream& operator<<(ostream& out, const SolverStats& stats)
+{
+   return stats.display(out);
+}
+
+
+//********************************** solvers ***********************************
+
+// All solvers take the start vector in x and return true if the iteration
+// converged within SolverControl::maxIterations() iterations.
+
+struct ConjugateGradient
+{
+   template<class MatrixType, class Vector, class Preconditioner>
+   static bool solve(const MatrixType& A, const Vector& b, Vector& x,
+                     const Preconditioner& M, const SolverControl& control,
+                                                             SolverStats& stats)
+   {
+      typedef Vector::ElementType ElementType;
+      const Vector::IndexType n= b.size();
+      Vector r(n), z(n), p(n), q(n);
+
+      multiply(A, x, r, control.parallel());
+      ElementType rr= KrylovKernels::residual(b, r);
+      const double tol= control.tolerance(KrylovKernels::norm2(b));
+      stats.start(sqrt(rr));
+      if (sqrt(rr) <= tol) {stats.finish(true); return true;}
+
+      M.apply(r, z);
+      p= z;
+      ElementType rz= KrylovKernels::dot(r, z);
+
+      for (unsigned it= 0; it<control.maxIterations(); ++it)
+      {
+         multiply(A, p, q, control.parallel());
+         const ElementType alpha= rz/KrylovKernels::dot(p, q);
+         rr= KrylovKernels::cgUpdate(alpha, p, q, x, r);
+         stats.record(sqrt(rr));
+         if (sqrt(rr) <= tol) {stats.finish(true); return true;}
+
+         M.apply(r, z);
+         const ElementType rzNew= KrylovKernels::dot(r, z);
+         KrylovKernels::xpay(z, rzNew/rz, p);
+         rz= rzNew;
+      }
+      stats.finish(false);
+      return false;
+   }
+};
+
+struct BiCGSTAB
+{
+   template<class MatrixType, class Vector, class Preconditioner>
+   static bool solve(const MatrixType& A, const Vector& b, Vector& x,
+                     const Preconditioner& M, const SolverControl& control,
+                                                             SolverStats& stats)
+   {
+      typedef Vector::ElementType ElementType;
+      const Vector::IndexType n= b.size();
+      Vector r(n), rHat(n), p(n), pHat(n), v(n), sHat(n), t(n);
+
+      multiply(A, x, r, control.parallel());
+      ElementType rr= KrylovKernels::residual(b, r);
+      const double tol= control.tolerance(KrylovKernels::norm2(b));
+      stats.start(sqrt(rr));
+      if (sqrt(rr) <= tol) {stats.finish(true); return true;}
+
+      rHat= r;
+      ElementType rho= 1, alpha= 1, omega= 1, tt, ts;
+
+      for (unsigned it= 0; it<control.maxIterations(); ++it)
+      {
+         const ElementType rhoNew= KrylovKernels::dot(rHat, r);
+         if (rhoNew==ElementType(0)) break;   // breakdown
+
+         KrylovKernels::bicgDirection(r, (rhoNew/rho)*(alpha/omega), omega, v, p);
+         M.apply(p, pHat);
+         multiply(A, pHat, v, control.parallel());
+         alpha= rhoNew/KrylovKernels::dot(rHat, v);
+
+         // r now holds s= r - alpha*v
+         rr= KrylovKernels::axpyNorm(-alpha, v, r);
+         if (sqrt(rr) <= tol)
+         {
+            KrylovKernels::axpy(alpha, pHat, x);
+            stats.record(sqrt(rr));
+            stats.finish(true);
+            return true;
+         }
+
+         M.apply(r, sHat);
+         multiply(A, sHat, t, control.parallel());
+         KrylovKernels::dot2(t, r, tt, ts);
+         omega= tt!=ElementType(0) ? ts/tt : ElementType(0);
+
+         KrylovKernels::axpbypz(alpha, pHat, omega, sHat, x);
+         rr= KrylovKernels::axpyNorm(-omega, t, r);
+         stats.record(sqrt(rr));
+         if (sqrt(rr) <= tol) {stats.finish(true); return true;}
+         if (omega==ElementType(0)) break;    // breakdown
+
+         rho= rhoNew;
+      }
+      stats.finish(false);
+      return false;
+   }
+};
+
+// restarted GMRES(m) with right preconditioning, so that the residual norm
+// computed by the Givens rotations is the true residual norm
+struct GMRES
+{
+   template<class MatrixType, class Vector, class Preconditioner>
+   static bool solve(const MatrixType& A, const Vector& b, Vector& x,
+                     const Preconditioner& M, const SolverControl& control,
+                                                             SolverStats& stats)
+   {
+      typedef Vector::ElementType ElementType;
+      typedef Vector::IndexType   IndexType;
+      const IndexType n= b.size();
+      const unsigned  m= Max(control.restart(), 1u);
+      unsigned i, k, it= 0;
+
+      // Krylov basis (m+1 vectors of length n), Hessenberg matrix (column-
+      // wise, (m+1) x m), Givens rotations and right-hand side of the
+      // least squares problem
+      ElementType* V = new ElementType[(m+1)*n];
+      ElementType* H = new ElementType[(m+1)*m];
+      ElementType* cs= new ElementType[m];
+      ElementType* sn= new ElementType[m];
+      ElementType* g = new ElementType[m+1];
+      Vector r(n), z(n), w(n);
+
+      multiply(A, x, r, control.parallel());
+      ElementType beta= sqrt(KrylovKernels::residual(b, r));
+      const double tol= control.tolerance(KrylovKernels::norm2(b));
+      stats.start(beta);
+      bool converged= beta <= tol;
+
+      while (!converged && it<control.maxIterations())
+      {
+         for (IndexType l= n; l--;) V[l]= r[l]/beta;
+         g[0]= beta;
+         for (i= 1; i<=m; ++i) g[i]= ElementType(0);
+
+         for (k= 0; k<m && it<control.maxIterations(); ++k)
+         {
+            ElementType* hk= H + k*(m+1);
+            ElementType* vk= V + k*n;
+
+            // w= A*inv(M)*v_k
+            for (IndexType l= n; l--;) r[l]= vk[l];
+            M.apply(r, z);
+            multiply(A, z, w, control.parallel());
+
+            // modified Gram-Schmidt
+            for (i= 0; i<=k; ++i)
+            {
+               const ElementType* vi= V + i*n;
+               ElementType h= ElementType(0);
+               IndexType l;
+               for (l= n; l--;) h+= w[l]*vi[l];
+               for (l= n; l--;) w[l]-= h*vi[l];
+               hk[i]= h;
+            }
+            hk[k+1]= KrylovKernels::norm2(w);
+
+            ElementType* vk1= V + (k+1)*n;
+            if (hk[k+1]!=ElementType(0))
+               for (IndexType l= n; l--;) vk1[l]= w[l]/hk[k+1];
+
+            // apply previous rotations and compute a new one
+            for (i= 0; i<k; ++i)
+            {
+               const ElementType tmp= cs[i]*hk[i] + sn[i]*hk[i+1];
+               hk[i+1]= -sn[i]*hk[i] + cs[i]*hk[i+1];
+               hk[i]= tmp;
+            }
+            const ElementType d= sqrt(hk[k]*hk[k] + hk[k+1]*hk[k+1]);
+            cs[k]= d!=ElementType(0) ? hk[k]/d : ElementType(1);
+            sn[k]= d!=ElementType(0) ? hk[k+1]/d : ElementType(0);
+            hk[k]= d;
+            hk[k+1]= ElementType(0);
+            g[k+1]= -sn[k]*g[k];
+            g[k]  =  cs[k]*g[k];
+
+            ++it;
+            stats.record(fabs(g[k+1]));
+            if (fabs(g[k+1]) <= tol) {converged= true; ++k; break;}
+         }
+
+         // solve the triangular system H*y= g (y overwrites g) and update
+         // x+= inv(M)*(V*y)
+         for (i= k; i--;)
+         {
+            for (unsigned j= i+1; j<k; ++j) g[i]-= H[j*(m+1)+i]*g[j];
+            g[i]/= H[i*(m+1)+i];
+         }
+         w.initElements();
+         for (i= 0; i<k; ++i)
+         {
+            const ElementType* vi= V + i*n;
+            for (IndexType l= n; l--;) w[l]+= g[i]*vi[l];
+         }
+         M.apply(w, z);
+         KrylovKernels::axpy(ElementType(1), z, x);
+
+         if (!converged)
+         {
+            multiply(A, x, r, control.parallel());
+            beta= sqrt(KrylovKernels::residual(b, r));
+            converged= beta <= tol;
+         }
+      }
+
+      delete [] V;
+      delete [] H;
+      delete [] cs;
+      delete [] sn;
+      delete [] g;
+
+      stats.finish(converged);
+      return converged;
+   }
+};
+
+
+//**************************** solver vector type ******************************
+
+// the solver vectors have the AccumulationType of the matrix, so that the
+// iteration is carried out in that precision even if the elements of the
+// matrix are stored in a smaller type
+template<class MatrixType>
+struct SOLVER_VECTOR
+{
+   typedef SolverVector<MatrixType::Config::AccumulationType,
+                        MatrixType::Config::IndexType> RET;
+};
+
+
+#endif   // DB_MATRIX_ITERATIVESOLVERS_H
@@ -7,15 +7,59 @@
 /*                                                                            */
 /*  Meta-Functions:                                                           */
 /*  - MATRIX_ASSIGNMENT                                                       */
+/*  - IS_SYMM_MATRIX                                                          */
+/*  - IS_COMPRESSED_MATRIX                                                    */
+/*  - IS_BSR_MATRIX                                                           */
+/*  - IS_SELL_MATRIX                                                          */
+/*  - IS_COO_MATRIX                                                           */
+/*  - IS_SKY_MATRIX, IS_UPPER_SKY_MATRIX                                      */
+/*  - IS_SUBMATRIX_VIEW                                                       */
+/*  - IS_MORTON_COO_MATRIX                                                    */
+/*  - SCRATCH_ARRAY                                                           */
+/*  - TEMPORARY                                                               */
+/*                                                                            */
+/*  Classes:                                                                  */
+/*  - EntryStream, EntryBatch                                                 */
+/*  - FixScratchArray, DynScratchArray                                        */
+/*  - TemporaryPool                                                           */
+/*  - PooledTemporary                                                         */
+/*  - StaticTemporary                                                         */
 /*                                                                            */
 /*  MATRIX_ASSIGNMENT chooses an appropriate assignment algorithm based on    */
 /*  the DSL features of the source matrix.                                    */
 /*  The available algorithms are: ZeroAssignment (for zero matrices),         */
 /*  DiagAssignment   (for identity, scalar and diagonal matrices),            */
 /*  SparseAssignment (for sparse matrices, works with iterators),             */
+/*  CompressedAssignment (for CSR and CSC matrices; copies the storage if the */
+/*                    result has the same format, and redistributes it by a   */
+/*                    counting sort in O(nnz) if it has the other one),       */
+/*  SparseConversion (for the other sparse sources; chooses a conversion by   */
+/*                    the format of the result, each linear in nnz:           */
+/*                    BSRConversion assembles the blocks from the bucketed    */
+/*                    elements, SELLConversion and CompressedGathering-       */
+/*                    Conversion gather the entries into compressed lines by  */
+/*                    two counting sorts, COOConversion appends them to the   */
+/*                    dictionary (or merges them into a Morton-ordered list   */
+/*                    in O(nnz log(nnz))), and SKYConversion computes the     */
+/*                    profile first; DIA results and blocks of a matrix are   */
+/*                    filled by SparseAssignment),                            */
 /*  RectAssignment   (for dense rectangular matrices),                        */
+/*  SymmAssignment   (for dense symmetric matrices, reads only the stored     */
+/*                    lower triangle),                                        */
 /*  BandAssignment   (for all the rest; however, this algorithm works with    */
 /*                    any matrix).                                            */
+/*  Every algorithm states whether it may write the result while the result   */
+/*  is still being read elementwise (in_place_safe); the algorithms which     */
+/*  clear the result first may not. If the result aliases an operand in an    */
+/*  unsafe way, the expression is evaluated into a pooled temporary instead.  */
+/*  For matrices with static memory allocation (fix<>) the temporaries and    */
+/*  the scratch arrays of the compressed conversions are members of objects   */
+/*  on the stack (StaticTemporary, FixScratchArray), sized by the static      */
+/*  size of the configuration, so that no assignment touches the heap.        */
+/*  The algorithms check the range of the result once (checkRange()) and use  */
+/*  unchecked element access in their loops.                                  */
+/*  The symmetric algorithms write the mirrored element only if the result    */
+/*  is not symmetric itself, since Symm stores both halves in one place.      */
 /*                                                                            */
 /*                                                                            */
 /*  (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                */
@@ -26,10 +70,103 @@
 #ifndef DB_MATRIX_ASSIGNMENT_H
 #define DB_MATRIX_ASSIGNMENT_H
 
+template<class MatrixType>
+struct IS_SYMM_MATRIX
+{
+   typedef MatrixType::Config::DSLFeatures::Shape Shape;
+
+   enum { RET= EQUAL<Shape::id, Shape::symm_id>::RET };
+};
+
+template<class MatrixType>
+struct IS_COMPRESSED_MATRIX
+{
+   typedef MatrixType::Config::DSLFeatures::Format Format;
+
+   enum { RET= EQUAL<Format::id, Format::CSR_id>::RET ||
+               EQUAL<Format::id, Format::CSC_id>::RET };
+};
+
+template<class MatrixType>
+struct IS_BSR_MATRIX
+{
+   typedef MatrixType::Config::DSLFeatures::Format Format;
+
+   enum { RET= EQUAL<Format::id, Format::BSR_id>::RET };
+};
+
+template<class MatrixType>
+struct IS_SELL_MATRIX
+{
+   typedef MatrixType::Config::DSLFeatures::Format Format;
+
+   enum { RET= EQUAL<Format::id, Format::SELL_id>::RET };
+};
+
+template<class MatrixType>
+struct IS_COO_MATRIX
+{
+   typedef MatrixType::Config::DSLFeatures::Format Format;
+
+   enum { RET= EQUAL<Format::id, Format::COO_id>::RET };
+};
+
+template<class MatrixType>
+struct IS_SKY_MATRIX
+{
+   typedef MatrixType::Config::DSLFeatures::Format Format;
+
+   enum { RET= EQUAL<Format::id, Format::SKY_id>::RET };
+};
+
+// true for the skyline matrices which store columns (UpSKYFormat)
+template<class MatrixType>
+struct IS_UPPER_SKY_MATRIX
+{
+   typedef MatrixType::Config::DSLFeatures::Shape Shape;
+
+   enum { RET= IS_SKY_MATRIX<MatrixType>::RET &&
+               (EQUAL<Shape::id, Shape::upper_triang_id>::RET ||
+                EQUAL<Shape::id, Shape::upper_band_triang_id>::RET) };
+};
+
+// true for the assignable blocks (SubMatrixView): their format is the one of
+// the block's result type, but they store nothing and write to the parent
+template<class MatrixType>
+struct IS_SUBMATRIX_VIEW
+{
+   enum { RET= EQUAL<MatrixType::kind, expression_kinds::submatrix_kind>::RET };
+};
+
+// true for the COO matrices whose sorted dictionary keeps the entries in
+// Morton order (the key order of the other dictionaries is the one of rows)
+template<class MatrixType>
+struct IS_MORTON_COO_MATRIX
+{
+   typedef MatrixType::Config::DSLFeatures::DictFormat DictFormat;
+   typedef IF<EQUAL<DictFormat::id, DictFormat::sorted_dict_id>::RET,
+                  DictFormat,
+                  sorted_dict<row_major_key<> > >::RET SortedDict_;
+   typedef SortedDict_::key_order KeyOrder;
+
+   enum { RET= IS_COO_MATRIX<MatrixType>::RET &&
+               EQUAL<KeyOrder::id, KeyOrder::morton_key_id>::RET };
+};
+
+template<class MatrixType1, class MatrixType2>
+struct SAME_FORMAT
+{
+   enum { RET= EQUAL<MatrixType1::Config::DSLFeatures::Format::id,
+                     MatrixType2::Config::DSLFeatures::Format::id>::RET };
+};
+
+
 //************************** assignment procedures *****************************
 
 struct ZeroAssignment
 {
+   enum { in_place_safe= true };
+
    template<class Res, class M>
    static void assign(Res* res, M* m)
    {
@@ -39,33 +176,42 @@ struct ZeroAssignment
 
 struct DiagAssignment
 {
+   enum { in_place_safe= false };
+
    template<class Res, class M>
    static void assign(Res* res, M* m)
    {
+      if (!res->checkRange(m->rows(), m->cols())) return;
       res->initElements();
       for (Res::Config::IndexType i= m->rows(); i--;)
-         res->setElement(i, i, m->getElement(i, i));
+         res->setElementUnchecked(i, i, m->getElementUnchecked(i, i));
    }
 };
 
 struct RectAssignment
 {
+   enum { in_place_safe= true };
+
    template<class Res, class M>
    static void assign(Res* res, M* m)
    {
+      if (!res->checkRange(m->rows(), m->cols())) return;
       for (Res::Config::IndexType i= m->rows(); i--;)
          for (Res::Config::IndexType j= m->cols(); j--;)
-            res->setElement(i, j, m->getElement(i, j));
+            res->setElementUnchecked(i, j, m->getElementUnchecked(i, j));
    }
 };
 
 struct BandAssignment
 {
+   enum { in_place_safe= false };
+
    template<class Res, class M>
    static void assign(Res* res, M* m)
    {
       Res::Config::IndexType stop_j, maxColsIndex= m->cols()-1;
 
+      if (!res->checkRange(m->rows(), m->cols())) return;
       res->initElements();
       for (Res::Config::IndexType i= m->rows(); i--;)
       {
@@ -73,13 +219,15 @@ struct BandAssignment
           for (Res::Config::IndexType j=
                      Max(Res::Config::SignedIndexType(i + m->firstDiag()), 0);
                                                                  j<=stop_j; ++j)
-              res->setElement(i, j, m->getElement(i, j));
+              res->setElementUnchecked(i, j, m->getElementUnchecked(i, j));
       }
    }
 };
 
 struct SparseAssignment
 {
+    enum { in_place_safe= false };
+
     template<class Res, class M>
     static void assign(Res* res, M* m)
     {
@@ -88,12 +236,13 @@ struct SparseAssignment
         Res::Config::IndexType   i;
         Res::Config::IndexType   j;
 
+        if (!res->checkRange(m->rows(), m->cols())) return;
         res->initElements();
 
         while (!iter.end())
         {
             iter.getNext(i, j, v);
-            res->setElement(i, j, v);
+            res->setElementUnchecked(i, j, v);
         }
     }
 };
@@ -101,6 +250,8 @@ struct SparseAssignment
 
 struct SparseSymmAssignment
 {
+    enum { in_place_safe= false };
+
     template<class Res, class M>
     static void assign(Res* res, M* m)
     {
@@ -109,18 +260,683 @@ struct SparseSymmAssignment
         Res::Config::IndexType   i;
         Res::Config::IndexType   j;
 
+        if (!res->checkRange(m->rows(), m->cols())) return;
         res->initElements();
 
         while (!iter.end())
         {
             iter.getNext(i, j, v);
-            res->setElement(i, j, v);
-            res->setElement(j, i, v);
+            res->setElementUnchecked(i, j, v);
+            if (!IS_SYMM_MATRIX<Res>::RET && i!=j)
+               res->setElementUnchecked(j, i, v);
         }
     }
 };
 
 
+// reads the lower triangle of the band only
+struct SymmAssignment
+{
+   enum { in_place_safe= false };
+
+   template<class Res, class M>
+   static void assign(Res* res, M* m)
+   {
+      typedef Res::Config::SignedIndexType SignedIndexType;
+      Res::Config::ElementType v;
+
+      if (!res->checkRange(m->rows(), m->cols())) return;
+      res->initElements();
+
+      for (Res::Config::IndexType i= m->rows(); i--;)
+         for (Res::Config::IndexType j=
+                        Max(SignedIndexType(i + m->firstDiag()), 0); j<=i; ++j)
+         {
+            v= m->getElementUnchecked(i, j);
+            res->setElementUnchecked(i, j, v);
+            if (!IS_SYMM_MATRIX<Res>::RET && i!=j)
+               res->setElementUnchecked(j, i, v);
+         }
+   }
+};
+
+
+//******************************* sparse entries *******************************
+
+// EntryStream iterates over the entries of a sparse matrix or expression M
+// like its iterator, but skips the stored zeros (of DIA and SKY, e.g.). A
+// symmetric source delivers its lower triangle only; if mirror is set, the
+// entry (j, i) follows every entry (i, j) off the diagonal.
+template<class M, int mirror>
+class EntryStream
+{
+   public:
+      typedef M::Config::IndexType   IndexType;
+      typedef M::Config::ElementType ElementType;
+
+      EntryStream(const M& m) : iter_(m), valid_(false), mirrored_(false)
+      {
+         advance();
+      }
+
+      void getNext(IndexType& i, IndexType& j, ElementType& v)
+      {
+         assert(!end());
+         i= i_;
+         j= j_;
+         v= v_;
+         advance();
+      }
+
+      bool end() const {return !valid_;}
+
+   private:
+      void advance()
+      {
+         if (mirror && valid_ && !mirrored_ && i_!=j_)
+         {
+            const IndexType t= i_;
+            i_= j_;
+            j_= t;
+            mirrored_= true;
+            return;
+         }
+         valid_= mirrored_= false;
+         while (!valid_ && !iter_.end())
+         {
+            iter_.getNext(i_, j_, v_);
+            valid_= v_ != ElementType(0);
+         }
+      }
+
+      M::IteratorType iter_;
+      IndexType       i_, j_;
+      ElementType     v_;
+      bool            valid_, mirrored_;
+};
+
+
+//******************************* scratch arrays *******************************
+
+// The compressed conversions need scratch arrays for the lines, indices and
+// values of the result. They are held by the following classes, which are
+// indexed like arrays and can be passed to setCompressed() and setBlocks().
+
+// the array is a member; n must not exceed the static size of the result
+template<class ValueType, class Size, class OffsetType>
+class FixScratchArray
+{
+   public:
+      FixScratchArray(const OffsetType& n) {assert(n<=Size::value);}
+
+      ValueType&       operator[](const OffsetType& i)       {return a_[i];}
+      const ValueType& operator[](const OffsetType& i) const {return a_[i];}
+
+   private:
+      FixScratchArray(const FixScratchArray&);
+      FixScratchArray& operator=(const FixScratchArray&);
+
+      ValueType a_[Size::value];
+};
+
+template<class ValueType, class OffsetType, class MatrixType>
+class DynScratchArray
+{
+      typedef CheckHeapAllocation<MatrixType>::RET CheckHeapAllocation_;
+
+   public:
+      DynScratchArray(const OffsetType& n) : a_(new ValueType[n]) {}
+      ~DynScratchArray() {delete [] a_;}
+
+      ValueType&       operator[](const OffsetType& i)       {return a_[i];}
+      const ValueType& operator[](const OffsetType& i) const {return a_[i];}
+
+   private:
+      DynScratchArray(const DynScratchArray&);
+      DynScratchArray& operator=(const DynScratchArray&);
+
+      ValueType* a_;
+};
+
+// scratch array of values of type ValueType for the result MatrixType
+template<class MatrixType, class ValueType>
+struct SCRATCH_ARRAY
+{
+   typedef MatrixType::Config Config;
+
+   typedef IF<IS_STATIC_MEMORY<MatrixType>::RET,
+                  FixScratchArray<ValueType, Config::DSLFeatures::Size,
+                                                           Config::OffsetType>,
+                  DynScratchArray<ValueType, Config::OffsetType, MatrixType>
+             >::RET RET;
+};
+
+
+// EntryBatch holds the entries of an EntryStream in arrays of the result
+// MatrixType; it is a stream as well, which can be read again after reset()
+// (see SortedListDictionary::addElements())
+template<class MatrixType>
+class EntryBatch
+{
+   public:
+      typedef MatrixType::Config::IndexType   IndexType;
+      typedef MatrixType::Config::OffsetType  OffsetType;
+      typedef MatrixType::Config::ElementType ElementType;
+
+      // n is the number of the entries of s
+      template<class Stream>
+      EntryBatch(Stream& s, const OffsetType& n)
+         : i_(n>0 ? n : 1), j_(n>0 ? n : 1), v_(n>0 ? n : 1), n_(0), k_(0)
+      {
+         while (!s.end())
+         {
+            s.getNext(i_[n_], j_[n_], v_[n_]);
+            ++n_;
+         }
+         assert(n_ == n);
+      }
+
+      void getNext(IndexType& i, IndexType& j, ElementType& v)
+      {
+         assert(!end());
+         i= i_[k_];
+         j= j_[k_];
+         v= v_[k_++];
+      }
+
+      void reset() {k_= 0;}
+
+      bool end() const {return k_ >= n_;}
+
+   private:
+      SCRATCH_ARRAY<MatrixType, IndexType>::RET   i_, j_;
+      SCRATCH_ARRAY<MatrixType, ElementType>::RET v_;
+      OffsetType                                  n_, k_;
+};
+
+
+//************************** compressed storage copies *************************
+
+// array view of a container of a format
+template<class Container>
+class ContainerArray
+{
+   public:
+      typedef Container::IndexType   IndexType;
+      typedef Container::ElementType ElementType;
+
+      ContainerArray(const Container& c) : c_(c) {}
+
+      const ElementType& operator[](const IndexType& i) const
+      {
+         return c_.getElement(i);
+      }
+
+   private:
+      const Container& c_;
+};
+
+template<class Container>
+inline ContainerArray<Container> containerArray(const Container& c)
+{
+   return ContainerArray<Container>(c);
+}
+
+// res takes over the lines of m as they are (both CSR, both CSC, or res is
+// the transpose of m in the other format)
+struct CompressedCopy
+{
+   template<class Res, class M>
+   static void copy(Res* res, const M& m)
+   {
+      res->setCompressed(containerArray(m.pointers()),
+                         containerArray(m.indices()),
+                         containerArray(m.values()));
+   }
+};
+
+// The lines of m (rows of CSR, columns of CSC) become the cross lines of
+// res: the entries are counted per cross line, and then distributed in the
+// order of their lines, so that the indices within a line of res ascend.
+struct CompressedRedistribution
+{
+   template<class Res, class M>
+   static void copy(Res* res, const M& m)
+   {
+      typedef M::Config::IndexType   IndexType;
+      typedef M::Config::OffsetType  OffsetType;
+      typedef M::Config::ElementType ElementType;
+
+      const IndexType  lines = m.pointers().count()-1;
+      const IndexType  cross = res->pointers().count()-1;
+      const OffsetType nnz   = m.values().count();
+
+      SCRATCH_ARRAY<Res, OffsetType >::RET pntr(cross+1);
+      SCRATCH_ARRAY<Res, IndexType  >::RET indx(nnz>0 ? nnz : 1);
+      SCRATCH_ARRAY<Res, ElementType>::RET val (nnz>0 ? nnz : 1);
+      IndexType    l;
+      OffsetType   k;
+
+      for (l= cross+1; l--;) pntr[l]= 0;
+      for (k= 0; k<nnz; ++k) ++pntr[m.indices().getElement(k)+1];
+      for (l= 0; l<cross; ++l) pntr[l+1]+= pntr[l];
+
+      for (l= 0; l<lines; ++l)
+         for (k= m.pointers().getElement(l);
+                                       k<m.pointers().getElement(l+1); ++k)
+         {
+            const OffsetType pos= pntr[m.indices().getElement(k)]++;
+            indx[pos]= l;
+            val [pos]= m.values().getElement(k);
+         }
+
+      // pntr[l] now is the end of cross line l
+      for (l= cross; l>0; --l) pntr[l]= pntr[l-1];
+      pntr[0]= 0;
+
+      res->setCompressed(pntr, indx, val);
+   }
+};
+
+// res= m (or res= transpose(m)) for compressed matrices res and m
+template<int transposed>
+struct CompressedConversion
+{
+   enum { in_place_safe= false };
+
+   template<class Res, class M>
+   static void assign(Res* res, const M* m)
+   {
+      if (!(transposed ? res->checkRange(m->cols(), m->rows())
+                       : res->checkRange(m->rows(), m->cols()))) return;
+
+      IF<SAME_FORMAT<Res, M>::RET != transposed,
+            CompressedCopy,
+            CompressedRedistribution>::RET::copy(res, *m);
+   }
+};
+
+// res= m for a BSR matrix res and a sparse source m: the elements of m are
+// bucketed by block row, the distinct block columns of each block row are
+// collected and sorted, and then the blocks are filled. Setting the elements
+// one by one would move all following blocks for each new block.
+template<int mirror>
+struct BSRConversion
+{
+   enum { in_place_safe= false };
+
+   template<class Res, class M>
+   static void assign(Res* res, M* m)
+   {
+      typedef Res::Config::IndexType   IndexType;
+      typedef Res::Config::OffsetType  OffsetType;
+      typedef Res::Config::ElementType ElementType;
+      enum { br= Res::block_rows,
+             bc= Res::block_cols,
+             bs= Res::block_size };
+
+      if (!res->checkRange(m->rows(), m->cols())) return;
+
+      const IndexType nbr= m->rows()/br;
+      const IndexType nbc= m->cols()/bc;
+      IndexType   i, j, l;
+      OffsetType  k, s, nb, n= 0;
+      ElementType v;
+
+      // bucket the elements by block row
+      SCRATCH_ARRAY<Res, OffsetType>::RET start(nbr+1);
+      for (l= nbr+1; l--;) start[l]= 0;
+      EntryStream<M, mirror> count(*m);
+      while (!count.end())
+      {
+         count.getNext(i, j, v);
+         ++start[i/br+1];
+         ++n;
+      }
+      for (l= 0; l<nbr; ++l) start[l+1]+= start[l];
+
+      SCRATCH_ARRAY<Res, IndexType  >::RET ei(n>0 ? n : 1);
+      SCRATCH_ARRAY<Res, IndexType  >::RET ej(n>0 ? n : 1);
+      SCRATCH_ARRAY<Res, ElementType>::RET ev(n>0 ? n : 1);
+      EntryStream<M, mirror> iter(*m);
+      while (!iter.end())
+      {
+         iter.getNext(i, j, v);
+         const OffsetType pos= start[i/br]++;
+         ei[pos]= i;
+         ej[pos]= j;
+         ev[pos]= v;
+      }
+      // start[l] now is the end of block row l
+      for (l= nbr; l>0; --l) start[l]= start[l-1];
+      start[0]= 0;
+
+      // the block columns of each block row, ascending; slot[bj] is nbc
+      // for the block columns not seen yet
+      SCRATCH_ARRAY<Res, OffsetType>::RET pntr(nbr+1);
+      SCRATCH_ARRAY<Res, IndexType >::RET indx(n>0 ? n : 1);
+      SCRATCH_ARRAY<Res, OffsetType>::RET slot(nbc);
+      for (l= nbc; l--;) slot[l]= nbc;
+      pntr[0]= 0;
+      for (l= 0; l<nbr; ++l)
+      {
+         nb= pntr[l];
+         for (k= start[l]; k<start[l+1]; ++k)
+            if (slot[ej[k]/bc] == nbc)
+            {
+               slot[ej[k]/bc]= 0;
+               indx[nb++]= ej[k]/bc;
+            }
+         for (k= pntr[l]+1; k<nb; ++k)
+         {
+            const IndexType b= indx[k];
+            for (s= k; s>pntr[l] && indx[s-1]>b; --s) indx[s]= indx[s-1];
+            indx[s]= b;
+         }
+         for (k= pntr[l]; k<nb; ++k) slot[indx[k]]= nbc;
+         pntr[l+1]= nb;
+      }
+
+      // fill the blocks
+      nb= pntr[nbr];
+      SCRATCH_ARRAY<Res, ElementType>::RET val(nb>0 ? nb*bs : 1);
+      for (k= nb*bs; k--;) val[k]= ElementType(0);
+      for (l= 0; l<nbr; ++l)
+      {
+         for (k= pntr[l]; k<pntr[l+1]; ++k) slot[indx[k]]= k;
+         for (k= start[l]; k<start[l+1]; ++k)
+            val[slot[ej[k]/bc]*bs + (ei[k]%br)*bc + ej[k]%bc]= ev[k];
+         for (k= pntr[l]; k<pntr[l+1]; ++k) slot[indx[k]]= nbc;
+      }
+
+      res->setBlocks(pntr, indx, val);
+   }
+};
+
+// The entries of m are gathered into the compressed lines of res (rows of
+// CSR and SELL, columns of CSC if byCols is set) by two counting sorts: first
+// by their cross lines, and then, stably, by their lines, so that the cross
+// indices within a line ascend in whatever order m delivers its entries.
+template<int byCols, int mirror>
+struct CompressedGathering
+{
+   template<class Res, class M>
+   static void copy(Res* res, const M& m)
+   {
+      typedef Res::Config::IndexType   IndexType;
+      typedef Res::Config::OffsetType  OffsetType;
+      typedef Res::Config::ElementType ElementType;
+
+      const IndexType lines= byCols ? m.cols() : m.rows();
+      const IndexType cross= byCols ? m.rows() : m.cols();
+      IndexType   i, j, l;
+      OffsetType  k, n= 0;
+      ElementType v;
+
+      // count the entries per line and per cross line
+      SCRATCH_ARRAY<Res, OffsetType>::RET pntr (lines+1);
+      SCRATCH_ARRAY<Res, OffsetType>::RET cpntr(cross+1);
+      for (l= lines+1; l--;) pntr [l]= 0;
+      for (l= cross+1; l--;) cpntr[l]= 0;
+      EntryStream<M, mirror> count(m);
+      while (!count.end())
+      {
+         count.getNext(i, j, v);
+         ++pntr [(byCols ? j : i)+1];
+         ++cpntr[(byCols ? i : j)+1];
+         ++n;
+      }
+      for (l= 0; l<lines; ++l) pntr [l+1]+= pntr [l];
+      for (l= 0; l<cross; ++l) cpntr[l+1]+= cpntr[l];
+
+      // sort by cross line, keeping the line of each entry
+      SCRATCH_ARRAY<Res, IndexType  >::RET cline(n>0 ? n : 1);
+      SCRATCH_ARRAY<Res, ElementType>::RET cval (n>0 ? n : 1);
+      EntryStream<M, mirror> iter(m);
+      while (!iter.end())
+      {
+         iter.getNext(i, j, v);
+         const OffsetType pos= cpntr[byCols ? i : j]++;
+         cline[pos]= byCols ? j : i;
+         cval [pos]= v;
+      }
+
+      // cpntr[l] now is the end of cross line l; sort by line
+      SCRATCH_ARRAY<Res, IndexType  >::RET indx(n>0 ? n : 1);
+      SCRATCH_ARRAY<Res, ElementType>::RET val (n>0 ? n : 1);
+      for (k= 0, l= 0; l<cross; ++l)
+         for (; k<cpntr[l]; ++k)
+         {
+            const OffsetType pos= pntr[cline[k]]++;
+            indx[pos]= l;
+            val [pos]= cval[k];
+         }
+
+      // pntr[l] now is the end of line l
+      for (l= lines; l>0; --l) pntr[l]= pntr[l-1];
+      pntr[0]= 0;
+
+      res->setCompressed(pntr, indx, val);
+   }
+};
+
+// res= m for a SELL matrix res; a CSR matrix m passes on its rows directly
+template<int mirror>
+struct SELLConversion
+{
+   enum { in_place_safe= false };
+
+   template<class Res, class M>
+   static void assign(Res* res, M* m)
+   {
+      typedef M::Config::DSLFeatures::Format Format;
+
+      if (!res->checkRange(m->rows(), m->cols())) return;
+
+      IF<EQUAL<M::kind, expression_kinds::matrix_kind>::RET &&
+         EQUAL<Format::id, Format::CSR_id>::RET,
+            CompressedCopy,
+            CompressedGathering<false, mirror> >::RET::copy(res, *m);
+   }
+};
+
+// res= m for a CSR or CSC matrix res and a sparse source m which is not a
+// compressed matrix (COO, DIA, SKY, or an expression)
+template<int mirror>
+struct CompressedGatheringConversion
+{
+   enum { in_place_safe= false };
+
+   template<class Res, class M>
+   static void assign(Res* res, M* m)
+   {
+      typedef Res::Config::DSLFeatures::Format Format;
+
+      if (!res->checkRange(m->rows(), m->cols())) return;
+
+      CompressedGathering<EQUAL<Format::id, Format::CSC_id>::RET, mirror>::
+                                                                copy(res, *m);
+   }
+};
+
+// res= m for a COO matrix res: the entries of m are distinct, so they are
+// appended to the cleared dictionary without being looked up. The entries
+// come in the order of the lines of m, which a Morton-ordered list would
+// have to insert one by one in the middle (O(nnz^2)); it gets them as one
+// batch instead, which addElements() sorts and merges in O(nnz log(nnz)).
+template<int mirror>
+struct COOConversion
+{
+   enum { in_place_safe= false };
+
+   template<class Res, class M>
+   static void assign(Res* res, M* m)
+   {
+      if (!res->checkRange(m->rows(), m->cols())) return;
+      res->initElements();
+      IF<IS_MORTON_COO_MATRIX<Res>::RET,
+            BatchInsertion,
+            Appending>::RET::insert(res, m);
+   }
+
+   struct Appending
+   {
+      template<class Res, class M>
+      static void insert(Res* res, M* m)
+      {
+         Res::Config::ElementType v;
+         Res::Config::IndexType   i;
+         Res::Config::IndexType   j;
+
+         EntryStream<M, mirror> iter(*m);
+         while (!iter.end())
+         {
+            iter.getNext(i, j, v);
+            res->appendElement(i, j, v);
+         }
+      }
+   };
+
+   struct BatchInsertion
+   {
+      template<class Res, class M>
+      static void insert(Res* res, M* m)
+      {
+         Res::Config::ElementType v;
+         Res::Config::IndexType   i;
+         Res::Config::IndexType   j;
+         Res::Config::OffsetType  n= 0;
+
+         EntryStream<M, mirror> count(*m);
+         for (; !count.end(); ++n) count.getNext(i, j, v);
+
+         EntryStream<M, mirror> iter(*m);
+         EntryBatch<Res> batch(iter, n);
+         res->addElements(batch);
+      }
+   };
+};
+
+// res= m for a skyline matrix res: the lines of res holding an entry of m
+// are marked (rows of LoSKYFormat, columns of UpSKYFormat), their positions
+// follow from the profile (a stored line l has l+1 elements), and then the
+// entries are placed. A symmetric res stores the entry (i, j) at (j, i) if
+// i<j. Entries outside the triangle of res are dropped in both passes, as
+// the skyline formats drop them in setElement().
+template<int mirror>
+struct SKYConversion
+{
+   enum { in_place_safe= false };
+
+   template<class Res, class M>
+   static void assign(Res* res, M* m)
+   {
+      typedef Res::Config::IndexType   IndexType;
+      typedef Res::Config::OffsetType  OffsetType;
+      typedef Res::Config::ElementType ElementType;
+      enum { upper= IS_UPPER_SKY_MATRIX<Res>::RET,
+             symm = IS_SYMM_MATRIX<Res>::RET };
+
+      if (!res->checkRange(m->rows(), m->cols())) return;
+
+      const IndexType n= m->rows();
+      IndexType   i, j, l;
+      OffsetType  k;
+      ElementType v;
+
+      // pntr[l+1] is set if line l is stored
+      SCRATCH_ARRAY<Res, OffsetType>::RET pntr(n+1);
+      for (l= n+1; l--;) pntr[l]= 0;
+      EntryStream<M, mirror> mark(*m);
+      while (!mark.end())
+      {
+         mark.getNext(i, j, v);
+         if (symm && i<j) swap(i, j);
+         if (upper ? i>j : j>i) continue;
+         pntr[(upper ? j : i)+1]= 1;
+      }
+      for (l= 0; l<n; ++l) pntr[l+1]= pntr[l] + (pntr[l+1] ? l+1 : 0);
+
+      const OffsetType size= pntr[n];
+      SCRATCH_ARRAY<Res, ElementType>::RET val(size>0 ? size : 1);
+      for (k= size; k--;) val[k]= ElementType(0);
+      EntryStream<M, mirror> iter(*m);
+      while (!iter.end())
+      {
+         iter.getNext(i, j, v);
+         if (symm && i<j) swap(i, j);
+         if (upper ? i>j : j>i) continue;
+         val[upper ? pntr[j]+i : pntr[i]+j]= v;
+      }
+
+      res->setProfile(pntr, val);
+   }
+
+   template<class IndexType>
+   static void swap(IndexType& i, IndexType& j)
+   {
+      const IndexType t= i;
+      i= j;
+      j= t;
+   }
+};
+
+// selected for the sparse sources which are not compressed matrices (and for
+// CSR and CSC sources if the result is not compressed); the result format
+// decides on the conversion. DIA and the dense formats set their elements in
+// constant time, so SparseAssignment is linear for them. symmSource is set
+// for sources with symmetric shape, whose mirrored entries are needed unless
+// the result is symmetric itself. A block of a matrix is filled element by
+// element, as the conversions build the storage of the whole result.
+template<int symmSource>
+struct SparseConversion
+{
+   enum { in_place_safe= false };
+
+   template<class Res, class M>
+   static void assign(Res* res, M* m)
+   {
+      IF<IS_SUBMATRIX_VIEW<Res>::RET,
+            IF<symmSource,
+                  SparseSymmAssignment,
+                  SparseAssignment>::RET,
+      IF<IS_BSR_MATRIX<Res>::RET,
+            BSRConversion<symmSource && !IS_SYMM_MATRIX<Res>::RET>,
+      IF<IS_SELL_MATRIX<Res>::RET,
+            SELLConversion<symmSource && !IS_SYMM_MATRIX<Res>::RET>,
+      IF<IS_COMPRESSED_MATRIX<Res>::RET,
+            CompressedGatheringConversion<
+                               symmSource && !IS_SYMM_MATRIX<Res>::RET>,
+      IF<IS_COO_MATRIX<Res>::RET,
+            COOConversion<symmSource && !IS_SYMM_MATRIX<Res>::RET>,
+      IF<IS_SKY_MATRIX<Res>::RET,
+            SKYConversion<symmSource && !IS_SYMM_MATRIX<Res>::RET>,
+      IF<symmSource,
+            SparseSymmAssignment,
+            SparseAssignment>::RET>::RET>::RET>::RET>::RET>::RET>::RET::
+                                                               assign(res, m);
+   }
+};
+
+// selected for CSR and CSC sources; the source may also be an expression
+// with a compressed result type, whose elements are only reachable by its
+// iterator. A block of a CSR or CSC matrix has no storage of its own, so it
+// is assigned to by SparseConversion.
+struct CompressedAssignment
+{
+   enum { in_place_safe= false };
+
+   template<class Res, class M>
+   static void assign(Res* res, M* m)
+   {
+      IF<EQUAL<M::kind, expression_kinds::matrix_kind>::RET &&
+         IS_COMPRESSED_MATRIX<Res>::RET && !IS_SUBMATRIX_VIEW<Res>::RET,
+            CompressedConversion<false>,
+            SparseConversion<false> >::RET::assign(res, m);
+   }
+};
+
+
 //************************ computing assignment type ***************************
 
 template<class RightMatrixType>
@@ -138,13 +954,152 @@ struct MATRIX_ASSIGNMENT
                   DiagAssignment,
 
            IF<EQUAL<Density::id, Density::sparse_id>::RET,
-               IF<EQUAL<Shape::id, Shape::symm_id>::RET,
-                  SparseSymmAssignment,
-                  SparseAssignment      >::RET,
+               IF<IS_COMPRESSED_MATRIX<RightMatrixType>::RET,
+                  CompressedAssignment,
+                  SparseConversion<EQUAL<Shape::id, Shape::symm_id>::RET>
+               >::RET,
 
            IF<EQUAL<Shape::id, Shape::rect_id>::RET,
                   RectAssignment,
-                  BandAssignment>::RET>::RET>::RET>::RET RET;
+
+           IF<EQUAL<Shape::id, Shape::symm_id>::RET,
+                  SymmAssignment,
+                  BandAssignment>::RET>::RET>::RET>::RET>::RET RET;
+};
+
+
+//******************************** temporaries *********************************
+
+// TemporaryPool keeps one matrix per type, which is handed out again as long
+// as the requested extent matches; nested requests get a matrix of their own.
+// The assignment algorithms overwrite every element, so a recycled matrix
+// needn't be cleared.
+// The pool is shared by all threads: the slot is taken and given back in a
+// critical section, and while one thread holds it the others get matrices of
+// their own, so concurrent evaluations of the same expression type allocate
+// as if there were no pool. The pooled matrix of every type that has needed
+// a temporary stays allocated until the program ends.
+template<class MatrixType>
+class TemporaryPool
+{
+      typedef CheckHeapAllocation<MatrixType>::RET CheckHeapAllocation_;
+
+   public:
+      typedef MatrixType::Config::IndexType IndexType;
+
+      static MatrixType* acquire(const IndexType& r, const IndexType& c,
+                                                           const IndexType& d)
+      {
+         MatrixType* m= NULL;
+         bool taken= false;
+         #pragma omp critical (db_matrix_temporary_pool)
+         {
+            if (!slot_.inUse)
+            {
+               slot_.inUse= taken= true;
+               if (slot_.matrix != NULL &&
+                   (slot_.matrix->rows() != r || slot_.matrix->cols() != c ||
+                                                            slot_.diags != d))
+               {
+                  delete slot_.matrix;
+                  slot_.matrix= NULL;
+               }
+               m= slot_.matrix;
+            }
+         }
+         if (m != NULL) return m;
+
+         m= new MatrixType(r, c, d);
+         if (taken)
+         {
+            // only the holder of the slot writes it
+            #pragma omp critical (db_matrix_temporary_pool)
+            {
+               slot_.matrix= m;
+               slot_.diags= d;
+            }
+         }
+         return m;
+      }
+
+      static void release(MatrixType* m)
+      {
+         bool pooled;
+         #pragma omp critical (db_matrix_temporary_pool)
+         {
+            pooled= m == slot_.matrix;
+            if (pooled) slot_.inUse= false;
+         }
+         if (!pooled) delete m;
+      }
+
+   private:
+      // frees the pooled matrix at program exit
+      struct Slot
+      {
+         MatrixType* matrix;
+         IndexType   diags;
+         bool        inUse;
+
+         Slot() : matrix(NULL), diags(0), inUse(false) {}
+         ~Slot() {delete matrix;}
+      };
+
+      static Slot slot_;
+};
+
+template<class MatrixType>
+TemporaryPool<MatrixType>::Slot TemporaryPool<MatrixType>::slot_;
+
+
+// returns its matrix to the pool when going out of scope
+template<class MatrixType>
+class PooledTemporary
+{
+   public:
+      typedef MatrixType::Config::IndexType IndexType;
+
+      PooledTemporary(const IndexType& r, const IndexType& c,
+                                                           const IndexType& d)
+         : matrix_(TemporaryPool<MatrixType>::acquire(r, c, d))
+      {}
+
+      ~PooledTemporary()
+      {
+         TemporaryPool<MatrixType>::release(matrix_);
+      }
+
+      MatrixType* get() const {return matrix_;}
+
+   private:
+      MatrixType* matrix_;
+};
+
+
+// the temporary of a matrix with static memory allocation is a member
+template<class MatrixType>
+class StaticTemporary
+{
+   public:
+      typedef MatrixType::Config::IndexType IndexType;
+
+      StaticTemporary(const IndexType& r, const IndexType& c,
+                                                           const IndexType& d)
+         : matrix_(r, c, d)
+      {}
+
+      MatrixType* get() const {return &matrix_;}
+
+   private:
+      mutable MatrixType matrix_;
+};
+
+template<class MatrixType>
+struct TEMPORARY
+{
+   typedef IF<IS_STATIC_MEMORY<MatrixType>::RET,
+                  StaticTemporary<MatrixType>,
+                  PooledTemporary<MatrixType> >::RET RET;
 };
 
 
@@ -0,0 +1,128 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "MatrixCost.h"                       */
+/*                                                                            */
+/*                                                                            */
+/*  Category:   Meta-Functions                                                */
+/*                                                                            */
+/*  Meta-Functions:                                                           */
+/*  - MATRIX_COST                                                             */
+/*  - CHEAPER_FORMAT                                                          */
+/*                                                                            */
+/*  MATRIX_COST describes at compile time what the storage format chosen by   */
+/*  a complete DSL description costs: the bytes per stored element, the       */
+/*  complexity of getElement() and setElement(), whether iterating over the   */
+/*  matrix is proportional to the number of stored elements, and whether the  */
+/*  elements are stored contiguously, so that loops over them vectorize.      */
+/*  The generator exports it as Config::Cost. CHEAPER_FORMAT is used by the   */
+/*  type promotion to choose the cheaper of the operand formats.              */
+/*                                                                            */
+/*                                                                            */
+/*  (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                */
+/*                        Ulrich Eisenecker, Johannes Knaupp                  */
+/*                                                                            */
+/******************************************************************************/
+
+#ifndef DB_MATRIX_COST_H
+#define DB_MATRIX_COST_H
+
+using namespace MatrixDSL;
+
+
+// complexity classes of the element access, ordered by cost
+struct access_complexity
+{
+   enum { constant_id,     // O(1)
+          hashed_id,       // O(1) on average
+          logarithmic_id,  // O(log(number of stored entries))
+          line_id,         // O(number of entries in a row or column)
+          nnz_id           // O(number of stored entries)
+        };
+};
+
+
+template<class DSLFeatures>
+struct MATRIX_COST
+{
+   typedef DSLFeatures::Shape       Shape;
+   typedef DSLFeatures::Format      Format;
+   typedef DSLFeatures::DictFormat  DictFormat;
+   typedef DSLFeatures::ElementType ElementType;
+   typedef DSLFeatures::IndexType   IndexType;
+
+   // the formats, in the same order as they are chosen by the generator
+   enum { scalarFormat= EQUAL<Shape::id, Shape::scalar_id>::RET ||
+                        EQUAL<Shape::id, Shape:: ident_id>::RET ||
+                        EQUAL<Shape::id, Shape::  zero_id>::RET,
+          vecFormat=    EQUAL<Shape::id, Shape::  diag_id>::RET ||
+                        EQUAL<Format::id, Format::vector_id>::RET,
+          csrFormat=    EQUAL<Format::id, Format::CSR_id>::RET ||
+                        EQUAL<Format::id, Format::CSC_id>::RET,
+          cooFormat=    EQUAL<Format::id, Format::COO_id>::RET,
+          bsrFormat=    EQUAL<Format::id, Format::BSR_id>::RET,
+          sellFormat=   EQUAL<Format::id, Format::SELL_id>::RET,
+          skyFormat=    EQUAL<Format::id, Format::SKY_id>::RET,
+          hashDict=     EQUAL<DictFormat::id, DictFormat::hash_dict_id>::RET,
+          sortedDict=   EQUAL<DictFormat::id,
+                              DictFormat::sorted_dict_id>::RET };
+
+   enum { bytes_per_element=
+             scalarFormat ? 0 :
+             vecFormat    ? sizeof(ElementType) :
+             csrFormat ||
+             sellFormat   ? sizeof(ElementType) + sizeof(IndexType) :
+             cooFormat    ? sizeof(ElementType) + 2*sizeof(IndexType) :
+                            sizeof(ElementType) };   // BSR: one index per block
+
+   enum { get_complexity=
+             scalarFormat || vecFormat ? access_complexity::constant_id :
+             csrFormat || bsrFormat ||
+             sellFormat                ? access_complexity::line_id :
+             cooFormat && hashDict     ? access_complexity::hashed_id :
+             cooFormat && sortedDict   ? access_complexity::logarithmic_id :
+             cooFormat                 ? access_complexity::nnz_id :
+                                         access_complexity::constant_id };
+
+   enum { set_complexity=
+             scalarFormat || vecFormat ? access_complexity::constant_id :
+             csrFormat || bsrFormat ||
+             sellFormat || skyFormat   ? access_complexity::nnz_id :
+             cooFormat                 ? hashDict ? access_complexity::hashed_id
+                                                  : access_complexity::nnz_id :
+                                         access_complexity::constant_id };
+
+   // arrays and DIA iterate over all positions of their extent or band
+   enum { iteration_is_nnz= scalarFormat || vecFormat || csrFormat ||
+                            cooFormat || skyFormat || bsrFormat ||
+                            sellFormat };
+
+   // the elements of a BSR block and the rows of a SELL slice are processed
+   // in contiguous runs
+   enum { vectorizable= !scalarFormat && !csrFormat && !cooFormat };
+
+   // used to compare formats: access first, then memory
+   enum { access_rank= get_complexity + set_complexity };
+};
+
+
+template<class DSLFeatures1, class DSLFeatures2>
+struct CHEAPER_FORMAT
+{
+   typedef MATRIX_COST<DSLFeatures1> Cost1;
+   typedef MATRIX_COST<DSLFeatures2> Cost2;
+
+   // BSR is not taken for the other operand, whose extent needn't be a
+   // multiple of the block size
+   typedef IF<Cost2::bsrFormat,
+                  DSLFeatures1::Format,
+           IF<Cost1::bsrFormat,
+                  DSLFeatures2::Format,
+           IF<(Cost2::access_rank <  Cost1::access_rank) ||
+              (Cost2::access_rank == Cost1::access_rank &&
+               Cost2::bytes_per_element < Cost1::bytes_per_element),
+                  DSLFeatures2::Format,
+                  DSLFeatures1::Format>::RET>::RET>::RET RET;
+};
+
+
+#endif   // DB_MATRIX_COST_H
@@ -9,12 +9,24 @@
 /*  - operator*()                                                             */
 /*  - operator+()                                                             */
 /*  - operator-()                                                             */
+/*  - operator*() with a scalar                                               */
+/*  - transpose()                                                             */
+/*  - transposeInPlace()                                                      */
+/*  - block(), row(), column()                                                */
+/*                                                                            */
+/*  Classes:                                                                  */
+/*  - SubMatrixView                                                           */
 /*                                                                            */
 /*  Meta-Functions:                                                           */
 /*  - MATRIX_MULTIPLY_GET_ELEMENT                                             */
 /*  - MATRIX_ADD_GET_ELEMENT                                                  */
 /*  - MATRIX_SUBTRACT_GET_ELEMENT                                             */
+/*  - IS_FUSABLE_TERM                                                         */
+/*  - IS_PRODUCT_TERM                                                         */
+/*  - IS_SYMM_TERM                                                            */
 /*  - CACHE_MATRIX_TYPE                                                       */
+/*  - CACHE_STORAGE                                                           */
+/*  - MATRIX_EXPRESSION_ASSIGNMENT                                            */
 /*                                                                            */
 /*                                                                            */
 /*  The implementation of addition and multiplication operators uses the      */
@@ -28,7 +40,34 @@
 /*  Since multiplication accesses every element of the participating matrices */
 /*  more than once, a different algorithm is used. If a factor is an expres-  */
 /*  sion (rather than a simple matrix), any element of it, once computed, is  */
-/*  stored in a cache matrix, so that it needn't be recomputed.               */
+/*  stored in a cache matrix, so that it needn't be recomputed. The cache     */
+/*  matrix of a matrix with static memory allocation (fix<>) is constructed   */
+/*  inside the expression object; otherwise it is allocated on the heap.      */
+/*  Scalar coefficients are expression nodes of their own. Expressions of the */
+/*  form alpha*A*B + beta*C and alpha*A + beta*B over dense rectangular       */
+/*  matrices are recognized at compile time and assigned by fused kernels,    */
+/*  which write every element of the result exactly once and allocate no      */
+/*  cache matrices. Products of a dense symmetric and a dense rectangular     */
+/*  matrix are assigned by a SYMM kernel, which reads only the stored         */
+/*  triangle of the symmetric factor.                                         */
+/*  transpose() is a view which swaps the subscripts; its result type stores  */
+/*  the operand's storage unchanged (see TRANSPOSE_RESULT_TYPE). Assigning    */
+/*  it copies the storage of a CSR or CSC matrix into a matrix of the other   */
+/*  compressed format, redistributes it in O(nnz) into one of the same        */
+/*  format, and transposes dense matrices by cache-oblivious recursive        */
+/*  blocking. transposeInPlace() transposes dense square matrices without a   */
+/*  temporary.                                                                */
+/*  block(), row() and column() return views of a part of a matrix or an      */
+/*  expression, which can be used as operands; views of matrices can also be  */
+/*  assigned to. Blocks of dense rectangular matrices are copied line by line */
+/*  in the order of the storage, and the iterator of a block of a CSR (CSC)   */
+/*  matrix visits only the rows (columns) crossing the block.                 */
+/*  Every expression can tell whether a matrix is one of its operands         */
+/*  (aliases) and whether that matrix is read at other positions than the one */
+/*  being computed (aliasesOutOfPlace, true for factors of a product). When   */
+/*  assigning, a temporary is only used if the result is an operand and the   */
+/*  assignment algorithm cannot be run in place. The temporary of a matrix    */
+/*  with static memory allocation is on the stack (see TEMPORARY).            */
 /*                                                                            */
 /*                                                                            */
 /*  (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                */
@@ -42,8 +81,18 @@
 
 #define BinaryExpression LazyBinaryExpression
 
+// defined in MatrixUpdate.h
+template<class ResultMatrixType, class RightMatrixType> struct MATRIX_UPDATE;
+template<class ResultMatrixType, class ExpressionType>
+                                                 struct MATRIX_EXPRESSION_UPDATE;
+
 //********************* implementations of getElement() ************************
 
+// The expressions check the subscripts once in getElement() and call these
+// algorithms from getElementUnchecked(); for valid subscripts of a product
+// or a sum every element read from the operands and the caches lies inside
+// their extent, so the algorithms access them unchecked.
+
 // multiplication
 struct ZeroMultiplyGetElement
 {
@@ -82,7 +131,7 @@ struct MultiplyGetRightElement
                                   const LeftType& left, const RightType& right,
                          LeftCacheType* left_cache, RightCacheType* right_cache)
    {
-      return right.getElement(i, j);
+      return right.getElementUnchecked(i, j);
    }
 };
 
@@ -96,7 +145,7 @@ struct MultiplyGetLeftElement
                                   const LeftType& left, const RightType& right,
                          LeftCacheType* left_cache, RightCacheType* right_cache)
    {
-      return left.getElement(i, j);
+      return left.getElementUnchecked(i, j);
    }
 };
 
@@ -110,8 +159,9 @@ struct DiagMultiplyGetElement
                                   const LeftType& left, const RightType& right,
                          LeftCacheType* left_cache, RightCacheType* right_cache)
    {
-      return i==j ? left.getElement(i, j) * right.getElement(i, j)
-                  : ResultType::zero();
+      return i==j
+           ? left.getElementUnchecked(i, j) * right.getElementUnchecked(i, j)
+           : ResultType::zero();
    }
 };
 
@@ -125,7 +175,7 @@ struct DiagXMultiplyGetElement
                                   const LeftType& left, const RightType& right,
                          LeftCacheType* left_cache, RightCacheType* right_cache)
    {
-      return left.getElement(i, i) * right.getElement(i, j);
+      return left.getElementUnchecked(i, i) * right.getElementUnchecked(i, j);
    }
 };
 
@@ -139,7 +189,7 @@ struct XDiagMultiplyGetElement
                                   const LeftType& left, const RightType& right,
                          LeftCacheType* left_cache, RightCacheType* right_cache)
    {
-      return left.getElement(i, j) * right.getElement(j, j);
+      return left.getElementUnchecked(i, j) * right.getElementUnchecked(j, j);
    }
 };
 
@@ -161,7 +211,7 @@ class BandMultiplyGetElement
                   Min(ResultType::Config::SignedIndexType(i+ left. lastDiag()), 
                       ResultType::Config::SignedIndexType(j-right.firstDiag()),
                       left.cols()-1);
-         ResultType::Config::ElementType result= ResultType::zero();
+         ResultType::Config::AccumulationType result= ResultType::zero();
          for(ResultType::Config::IndexType k= start; k<=stop; ++k)
             result+= getCachedElement(i, k,  left,  left_cache)
                    * getCachedElement(k, j, right, right_cache);
@@ -174,15 +224,17 @@ class BandMultiplyGetElement
       getCachedElement(const IndexType& i, const IndexType& j,
                                      const MatrixType& matrix, CacheType* cache)
       {
-         if (cache == NULL) return matrix.getElement(i, j);
+         if (cache == NULL) return matrix.getElementUnchecked(i, j);
          else
          {
-            CacheType::Config::ElementType tmpCacheElem= cache->getElement(i, j);
+            CacheType::Config::ElementType tmpCacheElem=
+                                              cache->getElementUnchecked(i, j);
+            CacheType::Config::Instrumentation::cacheAccess(tmpCacheElem.valid);
             if (!tmpCacheElem.valid)
             {
-               tmpCacheElem.element= matrix.getElement(i, j);
+               tmpCacheElem.element= matrix.getElementUnchecked(i, j);
                tmpCacheElem.valid= true;
-               cache->setElement(i, j, tmpCacheElem);
+               cache->setElementUnchecked(i, j, tmpCacheElem);
             }
                
             return tmpCacheElem.element;
@@ -201,7 +253,7 @@ class RectMultiplyGetElement
                                      const LeftType& left, const RightType& right,
                          LeftCacheType* left_cache, RightCacheType* right_cache)
       {
-         ResultType::Config::ElementType result= ResultType::zero();
+         ResultType::Config::AccumulationType result= ResultType::zero();
       
          for(ResultType::Config::IndexType k= left.cols(); k--;)
             result+= getCachedElement(i, k,  left,  left_cache)
@@ -215,15 +267,17 @@ class RectMultiplyGetElement
       getCachedElement(const IndexType& i, const IndexType& j,
                        const MatrixType& matrix, CacheType* cache)
       {
-         if (cache == NULL) return matrix.getElement(i, j);
+         if (cache == NULL) return matrix.getElementUnchecked(i, j);
          else
          {
-            CacheType::Config::ElementType tmpCacheElem= cache->getElement(i, j);
+            CacheType::Config::ElementType tmpCacheElem=
+                                              cache->getElementUnchecked(i, j);
+            CacheType::Config::Instrumentation::cacheAccess(tmpCacheElem.valid);
             if (!tmpCacheElem.valid)
             {
-               tmpCacheElem.element= matrix.getElement(i, j);
+               tmpCacheElem.element= matrix.getElementUnchecked(i, j);
                tmpCacheElem.valid= true;
-               cache->setElement(i, j, tmpCacheElem);
+               cache->setElementUnchecked(i, j, tmpCacheElem);
             }
                
             return tmpCacheElem.element;
@@ -264,7 +318,7 @@ struct AddSubGetLeftElement
    getElement(const IndexType& i, const IndexType& j,   const ResultType* res, 
                                   const LeftType& left, const RightType& right)
    {
-      return left.getElement(i, j);
+      return left.getElementUnchecked(i, j);
    }
 };
 
@@ -277,7 +331,7 @@ struct AddGetRightElement
    getElement(const IndexType& i, const IndexType& j,   const ResultType* res, 
                                   const LeftType& left, const RightType& right)
    {
-      return right.getElement(i, j);
+      return right.getElementUnchecked(i, j);
    }
 };
 
@@ -303,8 +357,8 @@ struct BandAddGetElement
                                   const LeftType& left, const RightType& right)
    {
       return FORMAT_VALID_INDICES<ResultType>::RET::validIndices(res, i, j)
-                              ? left.getElement(i, j) + right.getElement(i, j)
-                              : ResultType::zero();
+           ? left.getElementUnchecked(i, j) + right.getElementUnchecked(i, j)
+           : ResultType::zero();
    }
 };
 
@@ -316,7 +370,7 @@ struct RectAddGetElement
    getElement(const IndexType& i, const IndexType& j,   const ResultType* res,
                                   const LeftType& left, const RightType& right)
    {
-      return left.getElement(i, j) + right.getElement(i, j);
+      return left.getElementUnchecked(i, j) + right.getElementUnchecked(i, j);
    }
 };
 
@@ -329,7 +383,7 @@ struct SubGetRightElement
    getElement(const IndexType& i, const IndexType& j,   const ResultType* res, 
                                   const LeftType& left, const RightType& right)
    {
-      return -right.getElement(i, j);
+      return -right.getElementUnchecked(i, j);
    }
 };
 
@@ -355,8 +409,8 @@ struct BandSubGetElement
                                   const LeftType& left, const RightType& right)
    {
       return FORMAT_VALID_INDICES<ResultType>::RET::validIndices(res, i, j)
-                              ? left.getElement(i, j) - right.getElement(i, j)
-                              : ResultType::zero();
+           ? left.getElementUnchecked(i, j) - right.getElementUnchecked(i, j)
+           : ResultType::zero();
    }
 };
 
@@ -368,7 +422,7 @@ struct RectSubGetElement
    getElement(const IndexType& i, const IndexType& j,   const ResultType* res,
                                   const LeftType& left, const RightType& right)
    {
-      return left.getElement(i, j) - right.getElement(i, j);
+      return left.getElementUnchecked(i, j) - right.getElementUnchecked(i, j);
    }
 };
 
@@ -491,6 +545,47 @@ struct MATRIX_SUBTRACT_GET_ELEMENT
 };
 
 
+// A term is a matrix or a scaled matrix. Only dense rectangular terms are
+// evaluated by the fused kernels.
+template<class MatrixType>
+struct IS_FUSABLE_TERM
+{
+   typedef MatrixType::Config::DSLFeatures::Density Density;
+   typedef MatrixType::Config::DSLFeatures::Shape   Shape;
+
+   enum { RET= (EQUAL<MatrixType::kind, expression_kinds::matrix_kind>::RET ||
+                EQUAL<MatrixType::kind,
+                                   expression_kinds::scaled_matrix_kind>::RET) &&
+               EQUAL<Density::id, Density::dense_id>::RET &&
+               EQUAL<Shape::id, Shape::rect_id>::RET };
+};
+
+
+// A symmetric term is a (scaled) dense symmetric matrix.
+template<class MatrixType>
+struct IS_SYMM_TERM
+{
+   typedef MatrixType::Config::DSLFeatures::Density Density;
+   typedef MatrixType::Config::DSLFeatures::Shape   Shape;
+
+   enum { RET= (EQUAL<MatrixType::kind, expression_kinds::matrix_kind>::RET ||
+                EQUAL<MatrixType::kind,
+                                   expression_kinds::scaled_matrix_kind>::RET) &&
+               EQUAL<Density::id, Density::dense_id>::RET &&
+               EQUAL<Shape::id, Shape::symm_id>::RET };
+};
+
+
+// A product term is a (scaled) product of two fusable terms.
+template<class MatrixType>
+struct IS_PRODUCT_TERM
+{
+   enum { RET= EQUAL<MatrixType::kind, expression_kinds::product_kind>::RET ||
+               EQUAL<MatrixType::kind,
+                                 expression_kinds::scaled_product_kind>::RET };
+};
+
+
 //********************** cache matrix type computation *************************
 
 // It is impossible to derive a class directly from a typename defined by a
@@ -574,6 +669,91 @@ public:
 };
 
 
+// holds the cache matrix of a factor on the heap; the copy constructor takes
+// the cache over (expressions are copied only when returned by an operator)
+template<class CacheMatrixType>
+class HeapCache
+{
+      typedef CheckHeapAllocation<CacheMatrixType>::RET CheckHeapAllocation_;
+
+   public:
+      typedef CacheMatrixType::Config::IndexType IndexType;
+
+      HeapCache() : matrix_(NULL) {}
+
+      HeapCache(HeapCache& old) : matrix_(old.matrix_)
+      {
+         old.matrix_= NULL;
+      }
+
+      ~HeapCache() {delete matrix_;}
+
+      void create(const IndexType& r, const IndexType& c, const IndexType& d)
+      {
+         matrix_= new CacheMatrixType(r, c, d);
+      }
+
+      CacheMatrixType* get() const {return matrix_;}
+
+   private:
+      CacheMatrixType* matrix_;
+};
+
+// holds the cache matrix of a factor in place, for matrices with static
+// memory allocation; it is constructed only if the factor needs a cache. The
+// copy constructor creates an empty cache of the same extent (the cache of
+// an expression being returned holds no elements yet).
+template<class CacheMatrixType>
+class InPlaceCache
+{
+   public:
+      typedef CacheMatrixType::Config::IndexType IndexType;
+
+      InPlaceCache() : valid_(false) {}
+
+      InPlaceCache(InPlaceCache& old) : valid_(false)
+      {
+         if (old.valid_)
+            create(old.get()->rows(), old.get()->cols(), old.get()->diags());
+      }
+
+      ~InPlaceCache()
+      {
+         if (valid_) get()->~CacheMatrixType();
+      }
+
+      void create(const IndexType& r, const IndexType& c, const IndexType& d)
+      {
+         assert(!valid_);
+         new(storage_.bytes) CacheMatrixType(r, c, d);
+         valid_= true;
+      }
+
+      CacheMatrixType* get() const
+      {
+         return valid_ ? (CacheMatrixType*)storage_.bytes : NULL;
+      }
+
+   private:
+      mutable union
+      {
+         double      alignDouble;
+         long        alignLong;
+         void*       alignPointer;
+         char        bytes[sizeof(CacheMatrixType)];
+      } storage_;
+      bool valid_;
+};
+
+template<class CacheMatrixType>
+struct CACHE_STORAGE
+{
+   typedef IF<IS_STATIC_MEMORY<CacheMatrixType>::RET,
+                  InPlaceCache<CacheMatrixType>,
+                  HeapCache<CacheMatrixType> >::RET RET;
+};
+
+
 //************************** binary operation types ****************************
 
 template<class LeftType, class RightType>
@@ -591,86 +771,108 @@ class MultiplicationExpression
       typedef Config::IndexType              IndexType;
       typedef Config::SignedIndexType        SignedIndexType;
 
+      enum { kind= IS_FUSABLE_TERM<LeftType>::RET &&
+                   IS_FUSABLE_TERM<RightType>::RET
+                                           ? expression_kinds::product_kind :
+                   IS_SYMM_TERM<LeftType>::RET &&
+                   IS_FUSABLE_TERM<RightType>::RET ||
+                   IS_FUSABLE_TERM<LeftType>::RET &&
+                   IS_SYMM_TERM<RightType>::RET
+                                           ? expression_kinds::symm_product_kind
+                                           : expression_kinds::other_kind };
+      enum { needs_cache= true };
+      enum { elementwise= false };
+
    private:
       typedef Config::Ext                    Ext;
       typedef Config::Diags                  Diags;
       typedef Config::CompatibilityChecker   CompatibilityChecker;
       typedef CACHE_MATRIX_TYPE< LeftMatrixType>::RET  LeftCacheMatrixType;
       typedef CACHE_MATRIX_TYPE<RightMatrixType>::RET RightCacheMatrixType;
+      typedef CACHE_STORAGE< LeftCacheMatrixType>::RET  LeftCacheStorage;
+      typedef CACHE_STORAGE<RightCacheMatrixType>::RET RightCacheStorage;
 
    public:
       template<class M1, class M2>
       MultiplicationExpression(const Matrix<M1>& m1, const Matrix<M2>& m2)
-         : left_(m1), right_(m2), left_cache_matrix_(NULL), 
-         right_cache_matrix_(NULL), ext_(m1.rows(), m2.cols()),
+         : left_(m1), right_(m2), ext_(m1.rows(), m2.cols()),
          diags_(rows(), cols(), 
             Min(m1.lastDiag() + m2.lastDiag(), cols()-1) -
             Max(m1.firstDiag() + m2.firstDiag(), 1-SignedIndexType(rows())) + 1)
       {
-         CompatibilityChecker::MultiplicationParameterCheck(m1, m2);
+         compatible_=
+            CompatibilityChecker::MultiplicationParameterCheck(m1, m2);
       }
 
       template<class Expr, class M2>
       MultiplicationExpression(const BinaryExpression<Expr>& expr, 
                                                             const Matrix<M2>& m)
-         : left_(expr), right_(m),
-         left_cache_matrix_(new LeftCacheMatrixType(expr.rows(), expr.cols(), 
-         expr.diags())), right_cache_matrix_(NULL), ext_(expr.rows(), m.cols()),
+         : left_(expr), right_(m), ext_(expr.rows(), m.cols()),
          diags_(rows(), cols(),
             Min(expr.lastDiag() + m.lastDiag(), cols()-1) -
             Max(expr.firstDiag() + m.firstDiag(), 1-SignedIndexType(rows())) + 1)
       {
-         CompatibilityChecker::MultiplicationParameterCheck(expr, m);
+         compatible_=
+            CompatibilityChecker::MultiplicationParameterCheck(expr, m);
+         if (compatible_ && Expr::needs_cache)
+            left_cache_.create(expr.rows(), expr.cols(), expr.diags());
       }
 
       template<class M, class Expr>
       MultiplicationExpression(const Matrix<M>& m, 
                                              const BinaryExpression<Expr>& expr)
-         :left_(m),  right_(expr), left_cache_matrix_(NULL),
-         right_cache_matrix_(new RightCacheMatrixType(expr.rows(), expr.cols(), 
-         expr.diags())), ext_(m.rows(), expr.cols()), diags_(rows(), cols(),
+         :left_(m),  right_(expr), ext_(m.rows(), expr.cols()),
+         diags_(rows(), cols(),
             Min(m.lastDiag() + expr.lastDiag(), cols()-1) -
             Max(m.firstDiag() + expr.firstDiag(), 1-SignedIndexType(rows())) + 1)
       {
-         CompatibilityChecker::MultiplicationParameterCheck(m, expr);
+         compatible_=
+            CompatibilityChecker::MultiplicationParameterCheck(m, expr);
+         if (compatible_ && Expr::needs_cache)
+            right_cache_.create(expr.rows(), expr.cols(), expr.diags());
       }
 
       template<class Expr1, class Expr2>
       MultiplicationExpression(const BinaryExpression<Expr1>& expr1, 
                                            const BinaryExpression<Expr2>& expr2)
-         :left_(expr1), right_(expr2),
-         left_cache_matrix_(new LeftCacheMatrixType(expr1.rows(), expr1.cols(), 
-         expr1.diags())), right_cache_matrix_(new RightCacheMatrixType(expr2.rows(),
-         expr2.cols(), expr2.diags())), ext_(expr1.rows(), expr2.cols()),
+         :left_(expr1), right_(expr2), ext_(expr1.rows(), expr2.cols()),
          diags_(rows(), cols(),
             Min(expr1. lastDiag() + expr2. lastDiag(), cols()-1) -
             Max(expr1.firstDiag() + expr2.firstDiag(), 
             1-SignedIndexType(rows())) + 1)
       {
-         CompatibilityChecker::MultiplicationParameterCheck(expr1, expr2);
+         compatible_=
+            CompatibilityChecker::MultiplicationParameterCheck(expr1, expr2);
+         if (compatible_ && Expr1::needs_cache)
+            left_cache_.create(expr1.rows(), expr1.cols(), expr1.diags());
+         if (compatible_ && Expr2::needs_cache)
+            right_cache_.create(expr2.rows(), expr2.cols(), expr2.diags());
       }
 
       MultiplicationExpression(MultiplicationExpression& old)
          : left_(old.left_), right_(old.right_),
-         left_cache_matrix_ (old. left_cache_matrix_),
-         right_cache_matrix_(old.right_cache_matrix_),
-         ext_(old.ext_), diags_(old.diags_)
-      {
-         old. left_cache_matrix_= NULL;
-         old.right_cache_matrix_= NULL;
-      }
+         left_cache_(old.left_cache_), right_cache_(old.right_cache_),
+         ext_(old.ext_), diags_(old.diags_), compatible_(old.compatible_)
+      {}
 
-      ~MultiplicationExpression()
+      ElementType getElement(const IndexType & i, const IndexType & j) const
       {
-         delete  left_cache_matrix_;
-         delete right_cache_matrix_;
+         if (!compatible() ||
+             !Config::RangeChecker::checkRange(*this, i+1, j+1)) return zero();
+         return getElementUnchecked(i, j);
       }
 
-      ElementType getElement(const IndexType & i, const IndexType & j) const
+      // the operands are compatible, so (i, k) and (k, j) are valid for all k
+      ElementType getElementUnchecked(const IndexType& i,
+                                      const IndexType& j) const
       {
-         return MATRIX_MULTIPLY_GET_ELEMENT<LeftType, RightType>::RET::
-         getElement(i, j, this, left_, right_, left_cache_matrix_, 
-                                                           right_cache_matrix_);
+         typedef MATRIX_MULTIPLY_GET_ELEMENT<LeftType, RightType>::RET
+                                                                    GetElement;
+         Config::Instrumentation::path("multiply_get_element",
+                                                           (GetElement*)NULL);
+         return GetElement::
+         getElement(i, j, this, left_, right_, left_cache_.get(),
+                                                           right_cache_.get());
       }
 
       IndexType            rows() const {return   ext_. rows();}
@@ -680,6 +882,23 @@ class MultiplicationExpression
       SignedIndexType  lastDiag() const {return diags_. lastDiag();}
       static const ElementType & zero() {return Config::MatrixType::zero();}
 
+      const LeftType&   left() const {return  left_;}
+      const RightType& right() const {return right_;}
+
+      // false if the operands or the operands of a subexpression failed the
+      // compatibility check; the expression is not evaluated then
+      bool compatible() const
+      {
+         return compatible_ && left_.compatible() && right_.compatible();
+      }
+
+      bool aliases(const void* p) const
+      {
+         return left_.aliases(p) || right_.aliases(p);
+      }
+
+      bool aliasesOutOfPlace(const void* p) const {return aliases(p);}
+
    protected:
       const Ext   ext_;
       const Diags diags_;
@@ -687,8 +906,9 @@ class MultiplicationExpression
    private:
       const LeftType&   left_;
       const RightType&  right_;
-      LeftCacheMatrixType *  left_cache_matrix_;
-      RightCacheMatrixType* right_cache_matrix_;
+      LeftCacheStorage    left_cache_;
+      RightCacheStorage  right_cache_;
+      bool               compatible_;
 };
 
 
@@ -705,6 +925,9 @@ class AdditionOrSubtractionExpression
       typedef Config::IndexType              IndexType;
       typedef Config::SignedIndexType        SignedIndexType;
 
+      enum { needs_cache= true };
+      enum { elementwise= LeftType::elementwise && RightType::elementwise };
+
    protected:
       typedef Config::Ext     Ext;
       typedef Config::Diags   Diags;
@@ -716,7 +939,7 @@ class AdditionOrSubtractionExpression
          diags_(rows(), cols(), Max(m1.lastDiag(),  m2.lastDiag() ) -
                                 Min(m1.firstDiag(), m2.firstDiag()) + 1)
       {
-         CompatibilityChecker::AdditionParameterCheck(m1, m2);
+         compatible_= CompatibilityChecker::AdditionParameterCheck(m1, m2);
       }
 
       ElementType getElement( const IndexType & i, const IndexType & j ) const
@@ -732,11 +955,31 @@ class AdditionOrSubtractionExpression
       SignedIndexType  lastDiag() const {return diags_. lastDiag();}
       static const ElementType & zero() {return Config::MatrixType::zero();}
 
+      const LeftType&   left() const {return  left_;}
+      const RightType& right() const {return right_;}
+
+      bool aliases(const void* p) const
+      {
+         return left_.aliases(p) || right_.aliases(p);
+      }
+
+      bool aliasesOutOfPlace(const void* p) const
+      {
+         return left_.aliasesOutOfPlace(p) || right_.aliasesOutOfPlace(p);
+      }
+
+      // see MultiplicationExpression::compatible()
+      bool compatible() const
+      {
+         return compatible_ && left_.compatible() && right_.compatible();
+      }
+
    protected:
       const Ext         ext_;
       const Diags       diags_;
       const LeftType&   left_;
       const RightType&  right_;
+      bool              compatible_;
 };
 
 
@@ -749,12 +992,22 @@ class AdditionExpression
       typedef
          AdditionOrSubtractionExpression<LeftType, RightType, Config> BaseClass;
 
+      enum { kind= expression_kinds::sum_kind };
+
       AdditionExpression(const LeftType& m1, const RightType& m2)
          : BaseClass(m1, m2)
       {
       }
 
       ElementType getElement( const IndexType & i, const IndexType & j ) const
+      {
+         if (!compatible() ||
+             !Config::RangeChecker::checkRange(*this, i+1, j+1)) return zero();
+         return getElementUnchecked(i, j);
+      }
+
+      ElementType getElementUnchecked(const IndexType& i,
+                                      const IndexType& j) const
       {
          return MATRIX_ADD_GET_ELEMENT<LeftType, RightType>::RET::
                                           getElement(i, j, this, left_, right_);
@@ -771,12 +1024,22 @@ class SubtractionExpression
       typedef
          AdditionOrSubtractionExpression<LeftType, RightType, Config> BaseClass;
 
+      enum { kind= expression_kinds::difference_kind };
+
       SubtractionExpression(const LeftType& m1, const RightType& m2)
          : BaseClass(m1, m2)
       {
       }
 
       ElementType getElement( const IndexType & i, const IndexType & j ) const
+      {
+         if (!compatible() ||
+             !Config::RangeChecker::checkRange(*this, i+1, j+1)) return zero();
+         return getElementUnchecked(i, j);
+      }
+
+      ElementType getElementUnchecked(const IndexType& i,
+                                      const IndexType& j) const
       {
          return MATRIX_SUBTRACT_GET_ELEMENT<LeftType, RightType>::RET::
                                           getElement(i, j, this, left_, right_);
@@ -784,184 +1047,1551 @@ class SubtractionExpression
 };
 
 
-//*************************** expression templates *****************************
 
-// base class
+// iterates over the stored elements of a scaled sparse matrix
 template<class ExpressionType>
-struct BinaryExpression : ExpressionType
+class ScalingIterator
 {
-   typedef ExpressionType::LeftType             LeftType;
-   typedef ExpressionType::RightType            RightType;
-   typedef ExpressionType::Config::MatrixType   MatrixType;
-   typedef ExpressionType::IndexType            IndexType;
-
-   BinaryExpression(const LeftType& op1_, const RightType& op2_)
-      : ExpressionType(op1_, op2_)
-   {}
+   public:
+      typedef ExpressionType::ElementType ElementType;
+      typedef ExpressionType::IndexType   IndexType;
 
-   template<class Res>
-   Matrix<Res>* Assign(Matrix<Res>* const result) const
-   {
-      MATRIX_ASSIGNMENT<MatrixType>::RET::assign(result, this);
-      return result;
-   }
+      ScalingIterator(const ExpressionType& e)
+         : scalar_(e.scalar()), iter_(e.operand())
+      {}
 
-   ostream& display(ostream& out) const
-   {
-      IndexType r= rows(), c= cols();
-      for( IndexType i = 0; i < r; ++i )
+      void getNext(IndexType& i, IndexType& j, ElementType& v)
       {
-         for( IndexType j = 0; j < c; ++j )
-            out << getElement( i, j ) << "   ";
-         out << endl;
+         iter_.getNext(i, j, v);
+         v*= scalar_;
       }
-      return out;
-   }
+
+      void reset()     {iter_.reset();}
+      bool end()       {return iter_.end();}
+
+   private:
+      const ElementType scalar_;
+      ExpressionType::RightType::IteratorType iter_;
 };
 
 
-template<class Expr>
-ostream& operator<<(ostream& out, const BinaryExpression<Expr>& expr)
+// Multiplication of a matrix or an expression by a scalar. The left operand
+// is the scalar, so that the class fits into BinaryExpression. Scaling a
+// matrix is cheap, thus the operand is never cached.
+template<class OperandType>
+class ScalingExpression
 {
-   return expr.display(out);
-}
+   public:
+      typedef OperandType::Config            Config;
+      typedef Config::ElementType            ElementType;
+      typedef Config::IndexType              IndexType;
+      typedef Config::SignedIndexType        SignedIndexType;
 
+      typedef ElementType                    LeftType;
+      typedef OperandType                    RightType;
+      typedef ScalingIterator<ScalingExpression<OperandType> > IteratorType;
 
-//************************* operator implementations ***************************
+      enum { kind= EQUAL<OperandType::kind, expression_kinds::matrix_kind>::RET
+                      ? expression_kinds::scaled_matrix_kind
+                      : EQUAL<OperandType::kind, 
+                                       expression_kinds::product_kind>::RET
+                         ? expression_kinds::scaled_product_kind
+                         : expression_kinds::other_kind };
+      enum { needs_cache= !EQUAL<OperandType::kind, 
+                                          expression_kinds::matrix_kind>::RET };
+      enum { elementwise= OperandType::elementwise };
 
-//*** Multiplication ***
+      ScalingExpression(const ElementType& s, const OperandType& m)
+         : scalar_(s), operand_(m)
+      {}
 
-// matrix * matrix
-template<class M1, class M2>
-inline BinaryExpression<MultiplicationExpression<Matrix<M1>, Matrix<M2> > >
-operator*(const Matrix<M1>& m1, const Matrix<M2>& m2)
-{
-   return BinaryExpression<MultiplicationExpression<Matrix<M1>, Matrix<M2> > >
-                                                                       (m1, m2);
-}
+      ElementType getElement(const IndexType & i, const IndexType & j) const
+      {
+         return scalar_ * operand_.getElement(i, j);
+      }
 
+      ElementType getElementUnchecked(const IndexType& i,
+                                      const IndexType& j) const
+      {
+         return scalar_ * operand_.getElementUnchecked(i, j);
+      }
 
-// expression * matrix
-template<class Expr, class M>
-inline BinaryExpression<MultiplicationExpression<BinaryExpression<Expr>,
-                                                                   Matrix<M> > >
-operator*(const BinaryExpression<Expr>& expr, const Matrix<M>& m)
-{
-   return BinaryExpression<MultiplicationExpression<BinaryExpression<Expr>, 
-                                                         Matrix<M> > >(expr, m);
-}
+      IndexType            rows() const {return operand_.rows();}
+      IndexType            cols() const {return operand_.cols();}
+      IndexType           diags() const {return operand_.diags();}
+      SignedIndexType firstDiag() const {return operand_.firstDiag();}
+      SignedIndexType  lastDiag() const {return operand_. lastDiag();}
+      static const ElementType & zero() {return Config::MatrixType::zero();}
 
+      const ElementType&  scalar() const {return scalar_;}
+      const OperandType& operand() const {return operand_;}
 
-// matrix * expression
-template<class M, class Expr>
-inline BinaryExpression<MultiplicationExpression<Matrix<M>,
-                                                      BinaryExpression<Expr> > >
-operator*(const Matrix<M>& m, const BinaryExpression<Expr>& expr)
-{
-   return BinaryExpression<MultiplicationExpression<Matrix<M>,
-                                            BinaryExpression<Expr> > >(m, expr);
-}
+      bool aliases(const void* p) const {return operand_.aliases(p);}
+      bool aliasesOutOfPlace(const void* p) const
+      {
+         return operand_.aliasesOutOfPlace(p);
+      }
 
+      bool compatible() const {return operand_.compatible();}
 
-// expression * expression
-template<class Expr1, class Expr2>
-inline BinaryExpression<MultiplicationExpression<BinaryExpression<Expr1>, 
-                                                     BinaryExpression<Expr2> > >
-operator*(const BinaryExpression<Expr1>& expr1,
-                                           const BinaryExpression<Expr2>& expr2)
-{
-   return BinaryExpression<MultiplicationExpression<BinaryExpression<Expr1>, 
-                                      BinaryExpression<Expr2> > >(expr1, expr2);
-}
+   private:
+      const ElementType  scalar_;
+      const OperandType& operand_;
+};
 
 
-//*** Addition ***
 
-// matrix + matrix
-template<class M1, class M2>
-inline BinaryExpression<AdditionExpression<Matrix<M1>, Matrix<M2> > >
-operator+(const Matrix<M1>& m1, const Matrix<M2>& m2)
+// iterates over the stored elements of a transposed sparse matrix
+template<class ExpressionType>
+class TransposeIterator
 {
-   return BinaryExpression<AdditionExpression<Matrix<M1>, Matrix<M2> > >(m1, m2);
-}
+   public:
+      typedef ExpressionType::ElementType ElementType;
+      typedef ExpressionType::IndexType   IndexType;
 
+      TransposeIterator(const ExpressionType& e)
+         : iter_(e.operand())
+      {}
 
-// expression + matrix
-template<class Expr, class M>
-inline BinaryExpression<AdditionExpression<BinaryExpression<Expr>, Matrix<M> > >
-operator+(const BinaryExpression<Expr>& expr, const Matrix<M>& m)
-{
-   return BinaryExpression<AdditionExpression<BinaryExpression<Expr>,
-                                                         Matrix<M> > >(expr, m);
-}
+      void getNext(IndexType& i, IndexType& j, ElementType& v)
+      {
+         iter_.getNext(j, i, v);
+      }
 
+      void reset()     {iter_.reset();}
+      bool end()       {return iter_.end();}
 
-// matrix + expression
-template<class M, class Expr>
-inline BinaryExpression<AdditionExpression<Matrix<M>, BinaryExpression<Expr> > >
-operator+(const Matrix<M>& m, const BinaryExpression<Expr>& expr)
-{
-   return BinaryExpression<AdditionExpression<Matrix<M>,
-                                            BinaryExpression<Expr> > >(m, expr);
-}
+   private:
+      ExpressionType::RightType::IteratorType iter_;
+};
 
 
-// expression + expression
-template<class Expr1, class Expr2>
-inline BinaryExpression<AdditionExpression<BinaryExpression<Expr1>,
-                                                     BinaryExpression<Expr2> > >
-operator+(const BinaryExpression<Expr1>& expr1,
-                                           const BinaryExpression<Expr2>& expr2)
+// Transposition of a matrix or an expression. Nothing is copied; element
+// (i, j) is element (j, i) of the operand. Both operand types name the
+// operand, and BinaryExpression provides a constructor with one argument.
+template<class OperandType>
+class TransposeExpression
 {
-   return BinaryExpression<AdditionExpression<BinaryExpression<Expr1>,
-                                      BinaryExpression<Expr2> > >(expr1, expr2);
-}
+   public:
+      typedef TRANSPOSE_RESULT_TYPE<OperandType>::RET::Config Config;
+      typedef Config::ElementType            ElementType;
+      typedef Config::IndexType              IndexType;
+      typedef Config::SignedIndexType        SignedIndexType;
 
+      typedef OperandType                    LeftType;
+      typedef OperandType                    RightType;
+      typedef TransposeIterator<TransposeExpression<OperandType> > IteratorType;
 
-//*** Subtraction ***
+      enum { kind= expression_kinds::transpose_kind };
+      enum { needs_cache= !EQUAL<OperandType::kind, 
+                                          expression_kinds::matrix_kind>::RET };
+      enum { elementwise= false };
 
-// matrix - matrix
-template<class M1, class M2>
-inline BinaryExpression<SubtractionExpression<Matrix<M1>, Matrix<M2> > >
-operator-(const Matrix<M1>& m1, const Matrix<M2>& m2)
-{
-   return BinaryExpression<SubtractionExpression<Matrix<M1>, Matrix<M2> > >
-                                                                       (m1, m2);
-}
+      TransposeExpression(const OperandType& m)
+         : operand_(m)
+      {}
 
+      ElementType getElement(const IndexType & i, const IndexType & j) const
+      {
+         return operand_.getElement(j, i);
+      }
 
-// expression - matrix
-template<class Expr, class M>
-inline BinaryExpression<SubtractionExpression<BinaryExpression<Expr>, Matrix<M> > >
-operator-(const BinaryExpression<Expr>& expr, const Matrix<M>& m)
-{
-   return BinaryExpression<SubtractionExpression<BinaryExpression<Expr>,
-                                                         Matrix<M> > >(expr, m);
-}
+      ElementType getElementUnchecked(const IndexType& i,
+                                      const IndexType& j) const
+      {
+         return operand_.getElementUnchecked(j, i);
+      }
 
+      IndexType            rows() const {return  operand_.cols();}
+      IndexType            cols() const {return  operand_.rows();}
+      IndexType           diags() const {return  operand_.diags();}
+      SignedIndexType firstDiag() const {return -operand_. lastDiag();}
+      SignedIndexType  lastDiag() const {return -operand_.firstDiag();}
+      static const ElementType & zero() {return Config::MatrixType::zero();}
 
-// matrix - expression
-template<class M, class Expr>
-inline BinaryExpression<SubtractionExpression<Matrix<M>, BinaryExpression<Expr> > >
-operator-(const Matrix<M>& m, const BinaryExpression<Expr>& expr)
-{
-   return BinaryExpression<SubtractionExpression<Matrix<M>,
-                                            BinaryExpression<Expr> > >(m, expr);
-}
+      const OperandType& operand() const {return operand_;}
 
+      bool aliases(const void* p) const {return operand_.aliases(p);}
+      bool aliasesOutOfPlace(const void* p) const {return aliases(p);}
 
-// expression - expression
-template<class Expr1, class Expr2>
-inline BinaryExpression<SubtractionExpression<BinaryExpression<Expr1>,
-                                                     BinaryExpression<Expr2> > >
-operator-(const BinaryExpression<Expr1>& expr1,
-                                           const BinaryExpression<Expr2>& expr2)
+      bool compatible() const {return operand_.compatible();}
+
+   private:
+      const OperandType& operand_;
+};
+
+
+
+// iterates over the stored elements of a block of a sparse matrix by skip-
+// ping the elements of the operand outside the block
+template<class ExpressionType>
+class SubMatrixIterator
+{
+   public:
+      typedef ExpressionType::ElementType ElementType;
+      typedef ExpressionType::IndexType   IndexType;
+
+      SubMatrixIterator(const ExpressionType& e)
+         : iter_(e.operand()), r0_(e.row0()), c0_(e.col0()),
+           r1_(e.row0()+e.rows()), c1_(e.col0()+e.cols())
+      {
+         seek();
+      }
+
+      void getNext(IndexType& i, IndexType& j, ElementType& v)
+      {
+         assert(!end());
+         i= i_-r0_; j= j_-c0_; v= v_;
+         seek();
+      }
+
+      void reset()     {iter_.reset(); seek();}
+      bool end()       {return end_;}
+
+   private:
+      // fetches the next element inside the block
+      void seek()
+      {
+         while (!iter_.end())
+         {
+            iter_.getNext(i_, j_, v_);
+            if (r0_<=i_ && i_<r1_ && c0_<=j_ && j_<c1_) {end_= false; return;}
+         }
+         end_= true;
+      }
+
+      ExpressionType::RightType::IteratorType iter_;
+      const IndexType r0_, c0_, r1_, c1_;
+      IndexType   i_, j_;
+      ElementType v_;
+      bool        end_;
+};
+
+
+// Iterates over the stored elements of a block of a CSR (byRows) or CSC
+// matrix. Only the lines (rows of CSR, columns of CSC) crossing the block are
+// visited, and each of them up to the end of the block only, since the
+// indices within a line ascend.
+template<class ExpressionType, int byRows>
+class CompressedBlockIterator
+{
+   public:
+      typedef ExpressionType::ElementType ElementType;
+      typedef ExpressionType::IndexType   IndexType;
+      typedef ExpressionType::RightType::Config::OffsetType OffsetType;
+
+      CompressedBlockIterator(const ExpressionType& e)
+         : m_(e.operand()),
+           line0_ (byRows ? e.row0() : e.col0()),
+           lines_ (byRows ? e.rows() : e.cols()),
+           cross0_(byRows ? e.col0() : e.row0()),
+           cross1_(cross0_ + (byRows ? e.cols() : e.rows()))
+      {
+         reset();
+      }
+
+      void getNext(IndexType& i, IndexType& j, ElementType& v)
+      {
+         assert(!end());
+         const IndexType cross= m_.indices().getElement(pos_) - cross0_;
+         if (byRows) {i= line_; j= cross;}
+         else        {i= cross; j= line_;}
+         v= m_.values().getElement(pos_);
+         ++pos_;
+         seek();
+      }
+
+      void reset()
+      {
+         line_= 0;
+         pos_= m_.pointers().getElement(line0_);
+         seek();
+      }
+
+      bool end() const {return line_>=lines_;}
+
+   private:
+      // moves pos_ to the next element inside the block
+      void seek()
+      {
+         for (; line_<lines_;
+                       ++line_, pos_= m_.pointers().getElement(line0_+line_))
+         {
+            const OffsetType stop= m_.pointers().getElement(line0_+line_+1);
+            while (pos_<stop && m_.indices().getElement(pos_)<cross0_) ++pos_;
+            if (pos_<stop && m_.indices().getElement(pos_)<cross1_) return;
+         }
+      }
+
+      const ExpressionType::RightType& m_;
+      const IndexType line0_, lines_, cross0_, cross1_;
+      IndexType  line_;
+      OffsetType pos_;
+};
+
+
+// (the operand type is passed separately, since the expression type is
+// still incomplete when its iterator type is computed)
+template<class ExpressionType, class OperandType>
+struct SUBMATRIX_ITERATOR
+{
+   typedef OperandType::Config::DSLFeatures::Format Format;
+
+   enum { matrix= EQUAL<OperandType::kind, expression_kinds::matrix_kind>::RET };
+
+   typedef IF<matrix && EQUAL<Format::id, Format::CSR_id>::RET,
+                  CompressedBlockIterator<ExpressionType, true>,
+
+           IF<matrix && EQUAL<Format::id, Format::CSC_id>::RET,
+                  CompressedBlockIterator<ExpressionType, false>,
+
+                  SubMatrixIterator<ExpressionType> >::RET>::RET RET;
+};
+
+
+// The block [r0, r0+r) x [c0, c0+c) of a matrix or an expression; element
+// (i, j) is element (r0+i, c0+j) of the operand, nothing is copied. Ext and
+// the diagonal range are computed from the parent: diagonal d of the block
+// is diagonal d + c0 - r0 of the parent.
+template<class OperandType>
+class SubMatrixExpression
+{
+   public:
+      typedef SUBMATRIX_RESULT_TYPE<OperandType>::RET::Config Config;
+      typedef Config::ElementType            ElementType;
+      typedef Config::IndexType              IndexType;
+      typedef Config::SignedIndexType        SignedIndexType;
+
+      typedef OperandType                    LeftType;
+      typedef OperandType                    RightType;
+      typedef SUBMATRIX_ITERATOR<SubMatrixExpression<OperandType>,
+                                 OperandType>::RET IteratorType;
+
+      enum { kind= expression_kinds::submatrix_kind };
+      enum { needs_cache= !EQUAL<OperandType::kind, 
+                                          expression_kinds::matrix_kind>::RET };
+      enum { elementwise= false };
+
+   private:
+      typedef Config::Ext                    Ext;
+
+   public:
+      SubMatrixExpression(const OperandType& m, const IndexType& r0,
+                  const IndexType& c0, const IndexType& r, const IndexType& c)
+         : operand_(m), r0_(r0), c0_(c0), ext_(r, c),
+           firstDiag_(Max(SignedIndexType(m.firstDiag() + r0 - c0),
+                                                      1-SignedIndexType(r))),
+           lastDiag_ (Min(SignedIndexType(m. lastDiag() + r0 - c0),
+                                                        SignedIndexType(c)-1))
+      {
+         assert(r0+r <= m.rows()); assert(c0+c <= m.cols());
+         if (lastDiag_ < firstDiag_) lastDiag_= firstDiag_-1;   // no diagonal
+      }
+
+      ElementType getElement(const IndexType & i, const IndexType & j) const
+      {
+         assert(i<rows()); assert(j<cols());
+         return operand_.getElement(r0_+i, c0_+j);
+      }
+
+      ElementType getElementUnchecked(const IndexType& i,
+                                      const IndexType& j) const
+      {
+         return operand_.getElementUnchecked(r0_+i, c0_+j);
+      }
+
+      IndexType            rows() const {return ext_.rows();}
+      IndexType            cols() const {return ext_.cols();}
+      IndexType           diags() const {return lastDiag_-firstDiag_+1;}
+      SignedIndexType firstDiag() const {return firstDiag_;}
+      SignedIndexType  lastDiag() const {return  lastDiag_;}
+      static const ElementType & zero() {return Config::MatrixType::zero();}
+
+      IndexType row0() const {return r0_;}
+      IndexType col0() const {return c0_;}
+      const OperandType& operand() const {return operand_;}
+
+      bool aliases(const void* p) const {return operand_.aliases(p);}
+      bool aliasesOutOfPlace(const void* p) const {return aliases(p);}
+
+      bool compatible() const {return operand_.compatible();}
+
+   private:
+      const OperandType& operand_;
+      const IndexType    r0_, c0_;
+      const Ext          ext_;
+      SignedIndexType    firstDiag_, lastDiag_;
+};
+
+
+//******************************* fused kernels ********************************
+
+// access to the coefficient and the matrix of a term
+struct MatrixTermAccess
+{
+   template<class T>
+   static T::Config::ElementType coefficient(const T& t)
+   {
+      return T::Config::ElementType(1);
+   }
+
+   template<class T>
+   static const T& matrix(const T& t) {return t;}
+};
+
+
+struct ScaledMatrixTermAccess
+{
+   template<class T>
+   static T::Config::ElementType coefficient(const T& t) {return t.scalar();}
+
+   template<class T>
+   static const T::RightType& matrix(const T& t) {return t.operand();}
+};
+
+
+template<class T>
+struct TERM_ACCESS
+{
+   typedef IF<EQUAL<T::kind, expression_kinds::scaled_matrix_kind>::RET,
+                  ScaledMatrixTermAccess,
+                  MatrixTermAccess>::RET RET;
+};
+
+
+// access to the coefficient and the (unscaled) product of a product term
+struct ProductTermAccess
+{
+   template<class T>
+   static T::Config::ElementType coefficient(const T& t)
+   {
+      return TERM_ACCESS<T:: LeftType>::RET::coefficient(t.left()) *
+             TERM_ACCESS<T::RightType>::RET::coefficient(t.right());
+   }
+
+   template<class T>
+   static const T& product(const T& t) {return t;}
+};
+
+
+struct ScaledProductTermAccess
+{
+   template<class T>
+   static T::Config::ElementType coefficient(const T& t)
+   {
+      return t.scalar() * ProductTermAccess::coefficient(t.operand());
+   }
+
+   template<class T>
+   static const T::RightType& product(const T& t) {return t.operand();}
+};
+
+
+template<class T>
+struct PRODUCT_TERM_ACCESS
+{
+   typedef IF<EQUAL<T::kind, expression_kinds::scaled_product_kind>::RET,
+                  ScaledProductTermAccess,
+                  ProductTermAccess>::RET RET;
+};
+
+
+struct LeftOperandAccess
+{
+   template<class T>
+   static const T::LeftType& get(const T& t) {return t.left();}
+};
+
+
+struct RightOperandAccess
+{
+   template<class T>
+   static const T::RightType& get(const T& t) {return t.right();}
+};
+
+
+// The kernels compute every element of the result in a local accumulator and
+// write it once; A, B and C are dense rectangular matrices. The ranges are
+// checked once up front, so that the loops use unchecked element access.
+struct FusedKernels
+{
+   // res= alpha*A*B
+   template<class Res, class A, class B>
+   static void gemm(Res* res, const Res::Config::ElementType& alpha,
+                                                      const A& a, const B& b)
+   {
+      typedef Res::Config::AccumulationType AccumulationType;
+      typedef Res::Config::IndexType        IndexType;
+
+      const IndexType n= a.cols();
+      if (!res->checkRange(a.rows(), b.cols()) ||
+                                         !b.checkRange(n, b.cols())) return;
+      for (IndexType i= a.rows(); i--;)
+         for (IndexType j= b.cols(); j--;)
+         {
+            AccumulationType sum= AccumulationType(0);
+            for (IndexType k= 0; k<n; ++k)
+               sum+= a.getElementUnchecked(i, k) * b.getElementUnchecked(k, j);
+            res->setElementUnchecked(i, j, alpha*sum);
+         }
+   }
+
+   // res= alpha*A*B + beta*C
+   template<class Res, class A, class B, class C>
+   static void gemm(Res* res, const Res::Config::ElementType& alpha,
+                    const A& a, const B& b,
+                    const Res::Config::ElementType& beta, const C& c)
+   {
+      typedef Res::Config::AccumulationType AccumulationType;
+      typedef Res::Config::IndexType        IndexType;
+
+      const IndexType n= a.cols();
+      if (!res->checkRange(a.rows(), b.cols()) ||
+                                          !b.checkRange(n, b.cols()) ||
+                                !c.checkRange(a.rows(), b.cols())) return;
+      for (IndexType i= a.rows(); i--;)
+         for (IndexType j= b.cols(); j--;)
+         {
+            AccumulationType sum= AccumulationType(0);
+            for (IndexType k= 0; k<n; ++k)
+               sum+= a.getElementUnchecked(i, k) * b.getElementUnchecked(k, j);
+            res->setElementUnchecked(i, j, alpha*sum +
+                                           beta*c.getElementUnchecked(i, j));
+         }
+   }
+
+   // res= alpha*A + beta*B
+   template<class Res, class A, class B>
+   static void axpby(Res* res, const Res::Config::ElementType& alpha,
+                     const A& a, const Res::Config::ElementType& beta,
+                                                                   const B& b)
+   {
+      typedef Res::Config::IndexType IndexType;
+
+      if (!res->checkRange(a.rows(), a.cols()) ||
+                                   !b.checkRange(a.rows(), a.cols())) return;
+      for (IndexType i= a.rows(); i--;)
+         for (IndexType j= a.cols(); j--;)
+            res->setElementUnchecked(i, j, alpha*a.getElementUnchecked(i, j) +
+                                           beta *b.getElementUnchecked(i, j));
+   }
+};
+
+
+//************************** fused assignment procedures ***********************
+
+// res= alpha*A*B
+struct FusedProductAssignment
+{
+   enum { in_place_safe= true };
+
+   template<class Res, class E>
+   static void assign(Res* res, E* e)
+   {
+      typedef PRODUCT_TERM_ACCESS<E>::RET Access;
+      assignProduct(res, Access::coefficient(*e), Access::product(*e));
+   }
+
+   template<class Res, class P>
+   static void assignProduct(Res* res, const Res::Config::ElementType& alpha,
+                                                                   const P& p)
+   {
+      typedef TERM_ACCESS<P:: LeftType>::RET  LeftAccess;
+      typedef TERM_ACCESS<P::RightType>::RET RightAccess;
+
+      FusedKernels::gemm(res, alpha,  LeftAccess::matrix(p. left()),
+                                     RightAccess::matrix(p.right()));
+   }
+};
+
+
+// res= alpha*A*B +/- beta*C  or  res= beta*C +/- alpha*A*B
+template<int productOnLeft, int difference>
+struct FusedProductSumAssignment
+{
+   enum { in_place_safe= true };
+
+   template<class Res, class E>
+   static void assign(Res* res, E* e)
+   {
+      typedef IF<productOnLeft, LeftOperandAccess, RightOperandAccess>::RET
+                                                                ProductOperand;
+      typedef IF<productOnLeft, RightOperandAccess, LeftOperandAccess>::RET
+                                                                   TermOperand;
+      typedef Res::Config::ElementType ElementType;
+
+      const ElementType alphaSign(difference && !productOnLeft ? -1 : 1);
+      const ElementType  betaSign(difference &&  productOnLeft ? -1 : 1);
+
+      assignSum(res, alphaSign, ProductOperand::get(*e),
+                      betaSign,    TermOperand::get(*e));
+   }
+
+   template<class Res, class P, class T>
+   static void assignSum(Res* res, const Res::Config::ElementType& alphaSign,
+                         const P& p, const Res::Config::ElementType& betaSign,
+                                                                   const T& t)
+   {
+      typedef PRODUCT_TERM_ACCESS<P>::RET ProductAccess;
+      typedef TERM_ACCESS<T>::RET         TermAccess;
+
+      assignProduct(res, alphaSign*ProductAccess::coefficient(p),
+                    ProductAccess::product(p),
+                    betaSign*TermAccess::coefficient(t), TermAccess::matrix(t));
+   }
+
+   template<class Res, class P, class C>
+   static void assignProduct(Res* res, const Res::Config::ElementType& alpha,
+                             const P& p, const Res::Config::ElementType& beta,
+                                                                   const C& c)
+   {
+      typedef TERM_ACCESS<P:: LeftType>::RET  LeftAccess;
+      typedef TERM_ACCESS<P::RightType>::RET RightAccess;
+
+      FusedKernels::gemm(res, alpha,  LeftAccess::matrix(p. left()),
+                            RightAccess::matrix(p.right()), beta, c);
+   }
+};
+
+
+// res= alpha*A +/- beta*B
+template<int difference>
+struct FusedAxpbyAssignment
+{
+   enum { in_place_safe= true };
+
+   template<class Res, class E>
+   static void assign(Res* res, E* e)
+   {
+      typedef TERM_ACCESS<E:: LeftType>::RET  LeftAccess;
+      typedef TERM_ACCESS<E::RightType>::RET RightAccess;
+      typedef Res::Config::ElementType ElementType;
+
+      const ElementType betaSign(difference ? -1 : 1);
+
+      FusedKernels::axpby(res, LeftAccess::coefficient(e->left()),
+                                LeftAccess::matrix(e->left()),
+                   betaSign*RightAccess::coefficient(e->right()),
+                               RightAccess::matrix(e->right()));
+   }
+};
+
+
+//************************* transposition procedures ***************************
+
+// Cache-oblivious transposition of dense matrices: the longer side of a block
+// is halved until the block has at most leaf_size rows and columns, so that
+// the rows read and the columns written by a leaf stay in every level of the
+// cache, whatever its size.
+struct DenseTransposeAssignment
+{
+   enum { in_place_safe= false };
+   enum { leaf_size= 16 };
+
+   template<class Res, class E>
+   static void assign(Res* res, E* expr)
+   {
+      typedef Res::Config::IndexType IndexType;
+
+      if (!res->checkRange(expr->rows(), expr->cols())) return;
+      transpose(res, expr->operand(), IndexType(0), IndexType(expr->rows()),
+                                      IndexType(0), IndexType(expr->cols()));
+   }
+
+   // m= transpose(m) for a square matrix m
+   template<class M>
+   static void transposeInPlace(M* m)
+   {
+      typedef M::Config::IndexType IndexType;
+
+      assert(m->rows()==m->cols());
+      if (!m->checkRange(m->rows(), m->cols())) return;
+      transposeInPlace(m, IndexType(0), IndexType(m->rows()));
+   }
+
+   // res(i, j)= m(j, i) for i0 <= i < i1, j0 <= j < j1
+   template<class Res, class M, class IndexType>
+   static void transpose(Res* res, const M& m,
+                         const IndexType& i0, const IndexType& i1,
+                         const IndexType& j0, const IndexType& j1)
+   {
+      if (i1-i0 <= leaf_size && j1-j0 <= leaf_size)
+      {
+         for (IndexType i= i0; i<i1; ++i)
+            for (IndexType j= j0; j<j1; ++j)
+               res->setElementUnchecked(i, j, m.getElementUnchecked(j, i));
+      }
+      else if (i1-i0 >= j1-j0)
+      {
+         const IndexType mid= i0 + (i1-i0)/2;
+         transpose(res, m, i0, mid, j0, j1);
+         transpose(res, m, mid, i1, j0, j1);
+      }
+      else
+      {
+         const IndexType mid= j0 + (j1-j0)/2;
+         transpose(res, m, i0, i1, j0, mid);
+         transpose(res, m, i0, i1, mid, j1);
+      }
+   }
+
+   // transposes the diagonal block [i0, i1) x [i0, i1) of m
+   template<class M, class IndexType>
+   static void transposeInPlace(M* m, const IndexType& i0, const IndexType& i1)
+   {
+      if (i1-i0 <= leaf_size)
+      {
+         for (IndexType i= i0; i<i1; ++i)
+            for (IndexType j= i0; j<i; ++j)
+               exchange(m, i, j);
+      }
+      else
+      {
+         const IndexType mid= i0 + (i1-i0)/2;
+         transposeInPlace(m, i0, mid);
+         transposeInPlace(m, mid, i1);
+         swap(m, mid, i1, i0, mid);
+      }
+   }
+
+   // exchanges m(i, j) and m(j, i) for i0 <= i < i1, j0 <= j < j1; the block
+   // lies below the diagonal
+   template<class M, class IndexType>
+   static void swap(M* m, const IndexType& i0, const IndexType& i1,
+                          const IndexType& j0, const IndexType& j1)
+   {
+      if (i1-i0 <= leaf_size && j1-j0 <= leaf_size)
+      {
+         for (IndexType i= i0; i<i1; ++i)
+            for (IndexType j= j0; j<j1; ++j)
+               exchange(m, i, j);
+      }
+      else if (i1-i0 >= j1-j0)
+      {
+         const IndexType mid= i0 + (i1-i0)/2;
+         swap(m, i0, mid, j0, j1);
+         swap(m, mid, i1, j0, j1);
+      }
+      else
+      {
+         const IndexType mid= j0 + (j1-j0)/2;
+         swap(m, i0, i1, j0, mid);
+         swap(m, i0, i1, mid, j1);
+      }
+   }
+
+   template<class M, class IndexType>
+   static void exchange(M* m, const IndexType& i, const IndexType& j)
+   {
+      const M::Config::ElementType v= m->getElementUnchecked(i, j);
+      m->setElementUnchecked(i, j, m->getElementUnchecked(j, i));
+      m->setElementUnchecked(j, i, v);
+   }
+};
+
+
+// transposition of a CSR or CSC matrix into a matrix of the other compressed
+// format (storage copy) or of the same one (redistribution)
+struct CompressedOperandTransposition
+{
+   template<class Res, class E>
+   static void assign(Res* res, E* expr)
+   {
+      CompressedConversion<true>::assign(res, &expr->operand());
+   }
+};
+
+struct CompressedTransposeAssignment
+{
+   enum { in_place_safe= false };
+
+   template<class Res, class E>
+   static void assign(Res* res, E* expr)
+   {
+      IF<IS_COMPRESSED_MATRIX<Res>::RET && !IS_SUBMATRIX_VIEW<Res>::RET,
+            CompressedOperandTransposition,
+            SparseConversion<false> >::RET::assign(res, expr);
+   }
+};
+
+
+// other matrices are transposed in place by assigning their transpose, which
+// is evaluated into a temporary
+struct TemporaryTransposition
+{
+   template<class M>
+   static void transposeInPlace(M* m);   // defined after transpose()
+};
+
+
+//************************* sub-matrix procedures ******************************
+
+// copies a block of a dense rectangular matrix line by line in the order of
+// the storage of the parent (rows of C-like, columns of Fortran-like arrays)
+template<int byColumns>
+struct DenseBlockAssignment
+{
+   enum { in_place_safe= true };
+
+   template<class Res, class E>
+   static void assign(Res* res, E* view)
+   {
+      typedef Res::Config::IndexType IndexType;
+
+      const E::RightType& m= view->operand();
+      const IndexType r0= view->row0(), r= view->rows();
+      const IndexType c0= view->col0(), c= view->cols();
+      IndexType i, j;
+
+      if (!res->checkRange(r, c)) return;
+      if (byColumns)
+         for (j= 0; j<c; ++j)
+            for (i= 0; i<r; ++i)
+               res->setElementUnchecked(i, j,
+                                      m.getElementUnchecked(r0+i, c0+j));
+      else
+         for (i= 0; i<r; ++i)
+            for (j= 0; j<c; ++j)
+               res->setElementUnchecked(i, j,
+                                      m.getElementUnchecked(r0+i, c0+j));
+   }
+};
+
+
+//******************************* SYMM kernels *********************************
+
+// S is a dense symmetric matrix, B a dense rectangular one. A row (or column)
+// of the result is accumulated in a scratch array of AccumulationType and
+// stored once; the elements s(i,j), j>i, of S are read as s(j,i) from the
+// stored lower triangle.
+struct SymmKernels
+{
+   // res= alpha*S*B
+   template<class Res, class S, class B>
+   static void symmLeft(Res* res, const Res::Config::ElementType& alpha,
+                                                      const S& s, const B& b)
+   {
+      typedef Res::Config::AccumulationType AccumulationType;
+      typedef Res::Config::IndexType        IndexType;
+      typedef Res::Config::SignedIndexType  SignedIndexType;
+
+      const IndexType n= s.rows(), m= b.cols();
+      if (!res->checkRange(n, m) || !b.checkRange(n, m)) return;
+      SCRATCH_ARRAY<Res, AccumulationType>::RET sum(m>0 ? m : 1);
+      IndexType j, k;
+      for (IndexType i= 0; i<n; ++i)
+      {
+         for (k= m; k--;) sum[k]= AccumulationType(0);
+         const IndexType stop_j= Min(i + s.lastDiag(), n-1);
+         for (j= Max(SignedIndexType(i + s.firstDiag()), 0); j<=stop_j; ++j)
+         {
+            const AccumulationType a= alpha*(j<=i ? s.getElementUnchecked(i, j)
+                                                : s.getElementUnchecked(j, i));
+            for (k= 0; k<m; ++k) sum[k]+= a*b.getElementUnchecked(j, k);
+         }
+         for (k= m; k--;) res->setElementUnchecked(i, k, sum[k]);
+      }
+   }
+
+   // res= alpha*A*S
+   template<class Res, class A, class S>
+   static void symmRight(Res* res, const Res::Config::ElementType& alpha,
+                                                      const A& a, const S& s)
+   {
+      typedef Res::Config::AccumulationType AccumulationType;
+      typedef Res::Config::IndexType        IndexType;
+      typedef Res::Config::SignedIndexType  SignedIndexType;
+
+      const IndexType m= a.rows(), n= s.rows();
+      if (!res->checkRange(m, n) || !a.checkRange(m, n)) return;
+      SCRATCH_ARRAY<Res, AccumulationType>::RET sum(m>0 ? m : 1);
+      IndexType i, k;
+      for (IndexType j= 0; j<n; ++j)
+      {
+         for (k= m; k--;) sum[k]= AccumulationType(0);
+         const IndexType stop_i= Min(j + s.lastDiag(), n-1);
+         for (i= Max(SignedIndexType(j + s.firstDiag()), 0); i<=stop_i; ++i)
+         {
+            const AccumulationType v= alpha*(i<=j ? s.getElementUnchecked(j, i)
+                                                : s.getElementUnchecked(i, j));
+            for (k= 0; k<m; ++k) sum[k]+= a.getElementUnchecked(k, i)*v;
+         }
+         for (k= m; k--;) res->setElementUnchecked(k, j, sum[k]);
+      }
+   }
+};
+
+
+// res= alpha*S*B or res= alpha*A*S; the rows (columns) of the result are
+// stored while the operands are still read, so it may not be an operand
+template<int symmOnLeft>
+struct SymmProductAssignment
+{
+   enum { in_place_safe= false };
+
+   template<class Res, class E>
+   static void assign(Res* res, E* e)
+   {
+      typedef TERM_ACCESS<E:: LeftType>::RET  LeftAccess;
+      typedef TERM_ACCESS<E::RightType>::RET RightAccess;
+
+      const Res::Config::ElementType alpha=
+                                  LeftAccess::coefficient(e->left()) *
+                                 RightAccess::coefficient(e->right());
+      if (symmOnLeft)
+         SymmKernels::symmLeft (res, alpha,  LeftAccess::matrix(e->left()),
+                                            RightAccess::matrix(e->right()));
+      else
+         SymmKernels::symmRight(res, alpha,  LeftAccess::matrix(e->left()),
+                                            RightAccess::matrix(e->right()));
+   }
+};
+
+
+//********************** computing expression assignment ***********************
+
+// The selectors are evaluated lazily, since the operand types of an expres-
+// sion may only be inspected if it actually is a sum or a difference.
+
+struct ProductAssignmentSelector
+{
+   template<class ExpressionType>
+   struct Select
+   {
+      typedef FusedProductAssignment RET;
+   };
+};
+
+
+struct SymmProductAssignmentSelector
+{
+   template<class ExpressionType>
+   struct Select
+   {
+      typedef SymmProductAssignment<
+                     IS_SYMM_TERM<ExpressionType::LeftType>::RET> RET;
+   };
+};
+
+
+struct SumAssignmentSelector
+{
+   template<class ExpressionType>
+   struct Select
+   {
+      typedef ExpressionType::LeftType  LeftType;
+      typedef ExpressionType::RightType RightType;
+
+      enum { difference= EQUAL<ExpressionType::kind,
+                                     expression_kinds::difference_kind>::RET };
+
+      typedef IF<IS_PRODUCT_TERM<LeftType>::RET &&
+                 IS_FUSABLE_TERM<RightType>::RET,
+                     FusedProductSumAssignment<true, difference>,
+
+              IF<IS_FUSABLE_TERM<LeftType>::RET &&
+                 IS_PRODUCT_TERM<RightType>::RET,
+                     FusedProductSumAssignment<false, difference>,
+
+              IF<IS_FUSABLE_TERM<LeftType>::RET &&
+                 IS_FUSABLE_TERM<RightType>::RET,
+                     FusedAxpbyAssignment<difference>,
+
+                     MATRIX_ASSIGNMENT<ExpressionType::Config::MatrixType>::RET
+              >::RET>::RET>::RET RET;
+   };
+};
+
+
+struct TransposeAssignmentSelector
+{
+   template<class ExpressionType>
+   struct Select
+   {
+      typedef ExpressionType::RightType                OperandType;
+      typedef OperandType::Config::DSLFeatures::Density Density;
+      typedef OperandType::Config::DSLFeatures::Shape   Shape;
+
+      enum { matrix= EQUAL<OperandType::kind,
+                                         expression_kinds::matrix_kind>::RET };
+
+      typedef IF<matrix && IS_COMPRESSED_MATRIX<OperandType>::RET,
+                     CompressedTransposeAssignment,
+
+              IF<matrix && EQUAL<Density::id, Density::dense_id>::RET &&
+                           EQUAL<Shape::id, Shape::rect_id>::RET,
+                     DenseTransposeAssignment,
+
+                     MATRIX_ASSIGNMENT<ExpressionType::Config::MatrixType>::RET
+              >::RET>::RET RET;
+   };
+};
+
+
+struct SubMatrixAssignmentSelector
+{
+   template<class ExpressionType>
+   struct Select
+   {
+      typedef ExpressionType::RightType                 OperandType;
+      typedef OperandType::Config::DSLFeatures          DSLFeatures;
+      typedef DSLFeatures::Density                      Density;
+      typedef DSLFeatures::Shape                        Shape;
+      typedef DSLFeatures::ArrOrder                     ArrOrder;
+
+      typedef IF<EQUAL<OperandType::kind, expression_kinds::matrix_kind>::RET &&
+                 EQUAL<Density::id, Density::dense_id>::RET &&
+                 EQUAL<Shape::id, Shape::rect_id>::RET,
+                     DenseBlockAssignment<
+                        EQUAL<ArrOrder::id, ArrOrder::fortran_like_id>::RET>,
+                     MATRIX_ASSIGNMENT<ExpressionType::Config::MatrixType>::RET
+              >::RET RET;
+   };
+};
+
+
+struct DefaultAssignmentSelector
+{
+   template<class ExpressionType>
+   struct Select
+   {
+      typedef MATRIX_ASSIGNMENT<ExpressionType::Config::MatrixType>::RET RET;
+   };
+};
+
+
+template<class ExpressionType>
+struct MATRIX_EXPRESSION_ASSIGNMENT
+{
+   typedef IF<IS_PRODUCT_TERM<ExpressionType>::RET,
+                  ProductAssignmentSelector,
+
+           IF<EQUAL<ExpressionType::kind,
+                                   expression_kinds::symm_product_kind>::RET,
+                  SymmProductAssignmentSelector,
+
+           IF<EQUAL<ExpressionType::kind, expression_kinds::sum_kind>::RET ||
+              EQUAL<ExpressionType::kind, expression_kinds::difference_kind>::RET,
+                  SumAssignmentSelector,
+
+           IF<EQUAL<ExpressionType::kind, expression_kinds::transpose_kind>::RET,
+                  TransposeAssignmentSelector,
+
+           IF<EQUAL<ExpressionType::kind, expression_kinds::submatrix_kind>::RET,
+                  SubMatrixAssignmentSelector,
+
+                  DefaultAssignmentSelector>::RET>::RET>::RET>::RET>::RET Selector;
+
+   typedef Selector::Select<ExpressionType>::RET RET;
+};
+
+
+//*************************** expression templates *****************************
+
+// base class
+template<class ExpressionType>
+struct BinaryExpression : ExpressionType
+{
+   typedef ExpressionType::LeftType             LeftType;
+   typedef ExpressionType::RightType            RightType;
+   typedef ExpressionType::Config::MatrixType   MatrixType;
+   typedef ExpressionType::IndexType            IndexType;
+   typedef ExpressionType::ElementType          ElementType;
+
+   BinaryExpression(const LeftType& op1_, const RightType& op2_)
+      : ExpressionType(op1_, op2_)
+   {}
+
+   // expressions with one operand (transposition)
+   explicit BinaryExpression(const RightType& op_)
+      : ExpressionType(op_)
+   {}
+
+   // sub-matrix views
+   BinaryExpression(const RightType& op_, const IndexType& r0,
+                  const IndexType& c0, const IndexType& r, const IndexType& c)
+      : ExpressionType(op_, r0, c0, r, c)
+   {}
+
+   // getElement() checks the subscripts against the extent of the expression
+   // once; the bulk algorithms validate their range beforehand and read the
+   // elements through the operands' unchecked access.
+   ElementType getElementUnchecked(const IndexType& i, const IndexType& j) const
+   {
+      return ExpressionType::getElementUnchecked(i, j);
+   }
+
+   bool checkRange(const IndexType& r, const IndexType& c) const {return true;}
+
+   template<class Res>
+   Matrix<Res>* Assign(Matrix<Res>* const result) const
+   {
+      typedef MATRIX_EXPRESSION_ASSIGNMENT<BinaryExpression>::RET Assignment;
+      typedef Matrix<Res>::Config::Instrumentation Instrumentation;
+      Instrumentation::Scope scope("expression_assignment", (Assignment*)NULL);
+
+      // the error has been reported when the expression was built
+      if (!compatible()) return result;
+
+      if (aliases(result) && (!Assignment::in_place_safe ||
+                 (!ExpressionType::elementwise && aliasesOutOfPlace(result))))
+      {
+         TEMPORARY<MatrixType>::RET tmp(rows(), cols(), diags());
+         Assignment::assign(tmp.get(), this);
+         MATRIX_ASSIGNMENT<MatrixType>::RET::assign(result, tmp.get());
+      }
+      else Assignment::assign(result, this);
+      return result;
+   }
+
+   // result+= alpha*this
+   template<class Res>
+   Matrix<Res>* Update(Matrix<Res>* const result, const ElementType& alpha) const
+   {
+      typedef Matrix<Res>::Config::Instrumentation Instrumentation;
+
+      if (!compatible()) return result;
+
+      if (!ExpressionType::elementwise && aliasesOutOfPlace(result))
+      {
+         typedef MATRIX_UPDATE<Matrix<Res>, MatrixType>::RET Update;
+         Instrumentation::Scope scope("update", (Update*)NULL);
+         TEMPORARY<MatrixType>::RET tmp(rows(), cols(), diags());
+         MATRIX_EXPRESSION_ASSIGNMENT<BinaryExpression>::RET::
+                                                      assign(tmp.get(), this);
+         Update::update(result, tmp.get(), alpha);
+      }
+      else
+      {
+         typedef MATRIX_EXPRESSION_UPDATE<Matrix<Res>, BinaryExpression>::RET
+                                                                        Update;
+         Instrumentation::Scope scope("expression_update", (Update*)NULL);
+         Update::update(result, this, alpha);
+      }
+      return result;
+   }
+
+   ostream& display(ostream& out) const
+   {
+      IndexType r= rows(), c= cols();
+      for( IndexType i = 0; i < r; ++i )
+      {
+         for( IndexType j = 0; j < c; ++j )
+            out << getElement( i, j ) << "   ";
+         out << endl;
+      }
+      return out;
+   }
+};
+
+
+template<class Expr>
+ostream& operator<<(ostream& out, const BinaryExpression<Expr>& expr)
+{
+   return expr.display(out);
+}
+
+
+//************************* operator implementations ***************************
+
+//*** Multiplication ***
+
+// matrix * matrix
+template<class M1, class M2>
+inline BinaryExpression<MultiplicationExpression<Matrix<M1>, Matrix<M2> > >
+operator*(const Matrix<M1>& m1, const Matrix<M2>& m2)
+{
+   return BinaryExpression<MultiplicationExpression<Matrix<M1>, Matrix<M2> > >
+                                                                       (m1, m2);
+}
+
+
+// expression * matrix
+template<class Expr, class M>
+inline BinaryExpression<MultiplicationExpression<BinaryExpression<Expr>,
+                                                                   Matrix<M> > >
+operator*(const BinaryExpression<Expr>& expr, const Matrix<M>& m)
+{
+   return BinaryExpression<MultiplicationExpression<BinaryExpression<Expr>, 
+                                                         Matrix<M> > >(expr, m);
+}
+
+
+// matrix * expression
+template<class M, class Expr>
+inline BinaryExpression<MultiplicationExpression<Matrix<M>,
+                                                      BinaryExpression<Expr> > >
+operator*(const Matrix<M>& m, const BinaryExpression<Expr>& expr)
+{
+   return BinaryExpression<MultiplicationExpression<Matrix<M>,
+                                            BinaryExpression<Expr> > >(m, expr);
+}
+
+
+// expression * expression
+template<class Expr1, class Expr2>
+inline BinaryExpression<MultiplicationExpression<BinaryExpression<Expr1>, 
+                                                     BinaryExpression<Expr2> > >
+operator*(const BinaryExpression<Expr1>& expr1,
+                                           const BinaryExpression<Expr2>& expr2)
+{
+   return BinaryExpression<MultiplicationExpression<BinaryExpression<Expr1>, 
+                                      BinaryExpression<Expr2> > >(expr1, expr2);
+}
+
+
+//*** Addition ***
+
+// matrix + matrix
+template<class M1, class M2>
+inline BinaryExpression<AdditionExpression<Matrix<M1>, Matrix<M2> > >
+operator+(const Matrix<M1>& m1, const Matrix<M2>& m2)
+{
+   return BinaryExpression<AdditionExpression<Matrix<M1>, Matrix<M2> > >(m1, m2);
+}
+
+
+// expression + matrix
+template<class Expr, class M>
+inline BinaryExpression<AdditionExpression<BinaryExpression<Expr>, Matrix<M> > >
+operator+(const BinaryExpression<Expr>& expr, const Matrix<M>& m)
+{
+   return BinaryExpression<AdditionExpression<BinaryExpression<Expr>,
+                                                         Matrix<M> > >(expr, m);
+}
+
+
+// matrix + expression
+template<class M, class Expr>
+inline BinaryExpression<AdditionExpression<Matrix<M>, BinaryExpression<Expr> > >
+operator+(const Matrix<M>& m, const BinaryExpression<Expr>& expr)
+{
+   return BinaryExpression<AdditionExpression<Matrix<M>,
+                                            BinaryExpression<Expr> > >(m, expr);
+}
+
+
+// expression + expression
+template<class Expr1, class Expr2>
+inline BinaryExpression<AdditionExpression<BinaryExpression<Expr1>,
+                                                     BinaryExpression<Expr2> > >
+operator+(const BinaryExpression<Expr1>& expr1,
+                                           const BinaryExpression<Expr2>& expr2)
+{
+   return BinaryExpression<AdditionExpression<BinaryExpression<Expr1>,
+                                      BinaryExpression<Expr2> > >(expr1, expr2);
+}
+
+
+//*** Subtraction ***
+
+// matrix - matrix
+template<class M1, class M2>
+inline BinaryExpression<SubtractionExpression<Matrix<M1>, Matrix<M2> > >
+operator-(const Matrix<M1>& m1, const Matrix<M2>& m2)
+{
+   return BinaryExpression<SubtractionExpression<Matrix<M1>, Matrix<M2> > >
+                                                                       (m1, m2);
+}
+
+
+// expression - matrix
+template<class Expr, class M>
+inline BinaryExpression<SubtractionExpression<BinaryExpression<Expr>, Matrix<M> > >
+operator-(const BinaryExpression<Expr>& expr, const Matrix<M>& m)
+{
+   return BinaryExpression<SubtractionExpression<BinaryExpression<Expr>,
+                                                         Matrix<M> > >(expr, m);
+}
+
+
+// matrix - expression
+template<class M, class Expr>
+inline BinaryExpression<SubtractionExpression<Matrix<M>, BinaryExpression<Expr> > >
+operator-(const Matrix<M>& m, const BinaryExpression<Expr>& expr)
+{
+   return BinaryExpression<SubtractionExpression<Matrix<M>,
+                                            BinaryExpression<Expr> > >(m, expr);
+}
+
+
+// expression - expression
+template<class Expr1, class Expr2>
+inline BinaryExpression<SubtractionExpression<BinaryExpression<Expr1>,
+                                                     BinaryExpression<Expr2> > >
+operator-(const BinaryExpression<Expr1>& expr1,
+                                           const BinaryExpression<Expr2>& expr2)
 {
    return BinaryExpression<SubtractionExpression<BinaryExpression<Expr1>,
                                       BinaryExpression<Expr2> > >(expr1, expr2);
 }
 
 
+//*** Scaling ***
+
+// scalar * matrix
+template<class M>
+inline BinaryExpression<ScalingExpression<Matrix<M> > >
+operator*(const Matrix<M>::ElementType& s, const Matrix<M>& m)
+{
+   return BinaryExpression<ScalingExpression<Matrix<M> > >(s, m);
+}
+
+
+// matrix * scalar
+template<class M>
+inline BinaryExpression<ScalingExpression<Matrix<M> > >
+operator*(const Matrix<M>& m, const Matrix<M>::ElementType& s)
+{
+   return BinaryExpression<ScalingExpression<Matrix<M> > >(s, m);
+}
+
+
+// scalar * expression
+template<class Expr>
+inline BinaryExpression<ScalingExpression<BinaryExpression<Expr> > >
+operator*(const BinaryExpression<Expr>::ElementType& s,
+                                            const BinaryExpression<Expr>& expr)
+{
+   return BinaryExpression<ScalingExpression<BinaryExpression<Expr> > >
+                                                                     (s, expr);
+}
+
+
+// expression * scalar
+template<class Expr>
+inline BinaryExpression<ScalingExpression<BinaryExpression<Expr> > >
+operator*(const BinaryExpression<Expr>& expr,
+                                     const BinaryExpression<Expr>::ElementType& s)
+{
+   return BinaryExpression<ScalingExpression<BinaryExpression<Expr> > >
+                                                                     (s, expr);
+}
+
+
+
+//*** Transposition ***
+
+// transpose(matrix)
+template<class M>
+inline BinaryExpression<TransposeExpression<Matrix<M> > >
+transpose(const Matrix<M>& m)
+{
+   return BinaryExpression<TransposeExpression<Matrix<M> > >(m);
+}
+
+
+// transpose(expression)
+template<class Expr>
+inline BinaryExpression<TransposeExpression<BinaryExpression<Expr> > >
+transpose(const BinaryExpression<Expr>& expr)
+{
+   return BinaryExpression<TransposeExpression<BinaryExpression<Expr> > >
+                                                                        (expr);
+}
+
+
+template<class M>
+void TemporaryTransposition::transposeInPlace(M* m)
+{
+   *m= transpose(*m);
+}
+
+
+// m= transpose(m); m must be square
+template<class M>
+inline Matrix<M>& transposeInPlace(Matrix<M>& m)
+{
+   typedef M::Config::DSLFeatures::Density Density;
+   typedef M::Config::DSLFeatures::Shape   Shape;
+
+   IF<EQUAL<Density::id, Density::dense_id>::RET &&
+      EQUAL<Shape::id, Shape::rect_id>::RET,
+         DenseTransposeAssignment,
+         TemporaryTransposition>::RET::transposeInPlace(&m);
+   return m;
+}
+
+
+
+//*** Sub-matrices ***
+
+// A block of a matrix which can also be assigned to: besides being an
+// expression, it provides the interface which the assignment algorithms
+// expect from a result, and writes through to the parent.
+template<class MatrixType>
+class SubMatrixView : public BinaryExpression<SubMatrixExpression<MatrixType> >
+{
+   public:
+      typedef BinaryExpression<SubMatrixExpression<MatrixType> > BaseClass;
+      typedef BaseClass::Config        Config;
+      typedef BaseClass::IndexType     IndexType;
+      typedef BaseClass::ElementType   ElementType;
+
+      SubMatrixView(MatrixType& m, const IndexType& r0, const IndexType& c0,
+                                        const IndexType& r, const IndexType& c)
+         : BaseClass(m, r0, c0, r, c), parent_(m)
+      {}
+
+      void setElement(const IndexType& i, const IndexType& j,
+                                                           const ElementType& v)
+      {
+         assert(i<rows()); assert(j<cols());
+         parent_.setElement(row0()+i, col0()+j, v);
+      }
+
+      ElementType getElementUnchecked(const IndexType& i,
+                                      const IndexType& j) const
+      {
+         return parent_.getElementUnchecked(row0()+i, col0()+j);
+      }
+
+      void setElementUnchecked(const IndexType& i, const IndexType& j,
+                                                          const ElementType& v)
+      {
+         parent_.setElementUnchecked(row0()+i, col0()+j, v);
+      }
+
+      // unlike the one of an expression, this checks the range
+      bool checkRange(const IndexType& r, const IndexType& c) const
+      {
+         return MatrixType::Config::RangeChecker::checkRange(*this, r, c);
+      }
+
+      void initElements(const ElementType& v= ElementType(0))
+      {
+         for (IndexType i= rows(); i--;)
+            for (IndexType j= cols(); j--;)
+               setElementUnchecked(i, j, v);
+      }
+
+      // assignment operators; an operand which reads the parent is evaluated
+      // into a temporary first
+      template<class Expr>
+      SubMatrixView& operator=(const BinaryExpression<Expr>& expr)
+      {
+         typedef MATRIX_EXPRESSION_ASSIGNMENT<BinaryExpression<Expr> >::RET
+                                                                     Assignment;
+         typedef BinaryExpression<Expr>::MatrixType TemporaryType;
+
+         if (expr.aliases(&parent_))
+         {
+            TEMPORARY<TemporaryType>::RET
+                                  tmp(expr.rows(), expr.cols(), expr.diags());
+            Assignment::assign(tmp.get(), &expr);
+            MATRIX_ASSIGNMENT<TemporaryType>::RET::assign(this, tmp.get());
+         }
+         else Assignment::assign(this, &expr);
+         return *this;
+      }
+
+      SubMatrixView& operator=(const SubMatrixView& view)
+      {
+         return *this= static_cast<const BaseClass&>(view);
+      }
+
+      template<class A>
+      SubMatrixView& operator=(const Matrix<A>& m)
+      {
+         if (m.aliases(&parent_))
+         {
+            TEMPORARY<Matrix<A> >::RET tmp(m.rows(), m.cols(), m.diags());
+            MATRIX_ASSIGNMENT<A>::RET::assign(tmp.get(), &m);
+            MATRIX_ASSIGNMENT<A>::RET::assign(this, tmp.get());
+         }
+         else MATRIX_ASSIGNMENT<A>::RET::assign(this, &m);
+         return *this;
+      }
+
+   private:
+      MatrixType& parent_;
+};
+
+
+// block [r0, r0+r) x [c0, c0+c) of a matrix
+template<class M>
+inline SubMatrixView<Matrix<M> >
+block(Matrix<M>& m, const Matrix<M>::IndexType& r0,
+                    const Matrix<M>::IndexType& c0,
+                    const Matrix<M>::IndexType& r, const Matrix<M>::IndexType& c)
+{
+   return SubMatrixView<Matrix<M> >(m, r0, c0, r, c);
+}
+
+
+// block of a constant matrix
+template<class M>
+inline BinaryExpression<SubMatrixExpression<Matrix<M> > >
+block(const Matrix<M>& m, const Matrix<M>::IndexType& r0,
+                          const Matrix<M>::IndexType& c0,
+                    const Matrix<M>::IndexType& r, const Matrix<M>::IndexType& c)
+{
+   return BinaryExpression<SubMatrixExpression<Matrix<M> > >(m, r0, c0, r, c);
+}
+
+
+// block of an expression
+template<class Expr>
+inline BinaryExpression<SubMatrixExpression<BinaryExpression<Expr> > >
+block(const BinaryExpression<Expr>& expr,
+                     const BinaryExpression<Expr>::IndexType& r0,
+                     const BinaryExpression<Expr>::IndexType& c0,
+                     const BinaryExpression<Expr>::IndexType& r,
+                     const BinaryExpression<Expr>::IndexType& c)
+{
+   return BinaryExpression<SubMatrixExpression<BinaryExpression<Expr> > >
+                                                           (expr, r0, c0, r, c);
+}
+
+
+// row i
+template<class M>
+inline SubMatrixView<Matrix<M> >
+row(Matrix<M>& m, const Matrix<M>::IndexType& i)
+{
+   return block(m, i, 0, 1, m.cols());
+}
+
+template<class M>
+inline BinaryExpression<SubMatrixExpression<Matrix<M> > >
+row(const Matrix<M>& m, const Matrix<M>::IndexType& i)
+{
+   return block(m, i, 0, 1, m.cols());
+}
+
+template<class Expr>
+inline BinaryExpression<SubMatrixExpression<BinaryExpression<Expr> > >
+row(const BinaryExpression<Expr>& expr,
+                                   const BinaryExpression<Expr>::IndexType& i)
+{
+   return block(expr, i, 0, 1, expr.cols());
+}
+
+
+// column j
+template<class M>
+inline SubMatrixView<Matrix<M> >
+column(Matrix<M>& m, const Matrix<M>::IndexType& j)
+{
+   return block(m, 0, j, m.rows(), 1);
+}
+
+template<class M>
+inline BinaryExpression<SubMatrixExpression<Matrix<M> > >
+column(const Matrix<M>& m, const Matrix<M>::IndexType& j)
+{
+   return block(m, 0, j, m.rows(), 1);
+}
+
+template<class Expr>
+inline BinaryExpression<SubMatrixExpression<BinaryExpression<Expr> > >
+column(const BinaryExpression<Expr>& expr,
+                                   const BinaryExpression<Expr>::IndexType& j)
+{
+   return block(expr, 0, j, expr.rows(), 1);
+}
+
+
 #undef BinaryExpression
 
 #endif   // DB_MATRIX_LAZYOPERATIONS_H
@@ -9,6 +9,8 @@
 /*  - MULTIPLY_RESULT_TYPE                                                    */
 /*  - ADD_RESULT_TYPE                                                         */
 /*  - SUBTRACT_RESULT_TYPE                                                    */
+/*  - TRANSPOSE_RESULT_TYPE                                                   */
+/*  - SUBMATRIX_RESULT_TYPE                                                   */
 /*                                                                            */
 /*  These metafunctions process the DSL descriptions of the argument matrices */
 /*  of an addition, a subtraction or a multiplication operation, and build    */
@@ -17,6 +19,19 @@
 /*  tions for addition and subtraction. Since the promotion of the shape      */
 /*  feature is more complex it is factored out in separate functions          */
 /*  (MULTIPLY_PROMOTE_SHAPE, ADD_PROMOTE_SHAPE and SUBTRACT_PROMOTE_SHAPE).   */
+/*  They compute the ID of the result shape by one constant expression and    */
+/*  look the shape up in SHAPE_OF_ID, which keeps the number of template      */
+/*  instantiations per operation small.                                       */
+/*  If the operands use different formats which are both valid for the        */
+/*  result, the cheaper one according to MATRIX_COST is taken.                */
+/*  The transpose of a matrix keeps all its features except the ones which    */
+/*  describe the orientation: rows and columns, lower and upper triangular    */
+/*  shapes, CSR and CSC, and C-like and Fortran-like array order are swapped, */
+/*  so that the storage of a matrix is also a valid storage of its transpose. */
+/*  A block of a matrix is rectangular with dynamic extent; dense blocks are  */
+/*  stored as arrays in the order of the parent, sparse blocks as CSR (or as  */
+/*  CSC, if the parent is CSC).                                               */
+/*  The result of an operation is instrumented if one of its operands is.     */
 /*                                                                            */
 /*                                                                            */
 /*  (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                */
@@ -27,66 +42,89 @@
 #ifndef DB_MATRIX_MATRIXTYPEPROMOTION_H
 #define DB_MATRIX_MATRIXTYPEPROMOTION_H
 
-//****************************** multiplication ********************************
-
-template<class Shape1, class Shape2>
-struct MULTIPLY_PROMOTE_SHAPE
-{
-   typedef
-      IF<EQUAL<Shape1::id, Shape1::zero_id>::RET ||
-         EQUAL<Shape2::id, Shape2::zero_id>::RET,
-               zero<>,
-
-        IF<EQUAL<Shape1::id, Shape1::ident_id>::RET,
-               Shape2,
+//****************************** shape promotion *******************************
 
-        IF<EQUAL<Shape2::id, Shape2::ident_id>::RET,
-               Shape1,
+// The shape promotions compute the ID of the resulting shape by a single
+// constant expression and look the shape up in SHAPE_OF_ID, instead of
+// instantiating a chain of IFs with one link per case. Since the shape of
+// an operand may carry parameters (e.g. the rows of rect), the operands
+// themselves are returned for the IDs first_shape and second_shape.
 
-        IF<EQUAL<Shape1::id, Shape1::scalar_id>::RET,
-               Shape2,
-
-        IF<EQUAL<Shape2::id, Shape2::scalar_id>::RET,
-               Shape1,
-
-        IF<(EQUAL<Shape1::id, Shape1::diag_id>::RET &&
-            EQUAL<Shape2::id, Shape2::symm_id>::RET) ||
-           (EQUAL<Shape1::id, Shape1::symm_id>::RET &&
-            EQUAL<Shape2::id, Shape2::diag_id>::RET),
-               rect<>,
-
-        IF<EQUAL<Shape1::id, Shape1::diag_id>::RET,
-               Shape2,
-
-        IF<EQUAL<Shape2::id, Shape2::diag_id>::RET,
-               Shape1,
-
-        IF<EQUAL<Shape1::id, Shape1::lower_band_triang_id>::RET &&
-           EQUAL<Shape2::id, Shape2::lower_band_triang_id>::RET,
-               lower_band_triang<>,
-
-        IF<EQUAL<Shape1::id, Shape1::upper_band_triang_id>::RET &&
-           EQUAL<Shape2::id, Shape2::upper_band_triang_id>::RET,
-               upper_band_triang<>,
+struct shape_promotion
+{
+   enum { first_shape = -2,
+          second_shape= -3 };
+};
 
-        IF<EQUAL<Shape1::id, Shape1::band_diag_id>::RET &&
-           EQUAL<Shape2::id, Shape2::band_diag_id>::RET,
-               band_diag<>,
+template<int id> struct SHAPE_OF_ID {typedef rect<> RET;};
+
+template<> struct SHAPE_OF_ID<unspecified_DSL_feature::diag_id>
+   {typedef diag<> RET;};
+template<> struct SHAPE_OF_ID<unspecified_DSL_feature::scalar_id>
+   {typedef scalar<> RET;};
+template<> struct SHAPE_OF_ID<unspecified_DSL_feature::ident_id>
+   {typedef ident<> RET;};
+template<> struct SHAPE_OF_ID<unspecified_DSL_feature::zero_id>
+   {typedef zero<> RET;};
+template<> struct SHAPE_OF_ID<unspecified_DSL_feature::lower_triang_id>
+   {typedef lower_triang<> RET;};
+template<> struct SHAPE_OF_ID<unspecified_DSL_feature::upper_triang_id>
+   {typedef upper_triang<> RET;};
+template<> struct SHAPE_OF_ID<unspecified_DSL_feature::symm_id>
+   {typedef symm<> RET;};
+template<> struct SHAPE_OF_ID<unspecified_DSL_feature::band_diag_id>
+   {typedef band_diag<> RET;};
+template<> struct SHAPE_OF_ID<unspecified_DSL_feature::lower_band_triang_id>
+   {typedef lower_band_triang<> RET;};
+template<> struct SHAPE_OF_ID<unspecified_DSL_feature::upper_band_triang_id>
+   {typedef upper_band_triang<> RET;};
+
+template<class Shape1, class Shape2, int id>
+struct PROMOTED_SHAPE
+{
+   typedef IF<(id == shape_promotion::first_shape),
+                  Shape1,
+           IF<(id == shape_promotion::second_shape),
+                  Shape2,
+                  SHAPE_OF_ID<id>::RET>::RET>::RET RET;
+};
 
-        IF<(EQUAL<Shape1::id, Shape1::lower_triang_id>::RET ||
-            EQUAL<Shape1::id, Shape1::lower_band_triang_id>::RET) &&
-           (EQUAL<Shape2::id, Shape2::lower_triang_id>::RET ||
-            EQUAL<Shape2::id, Shape2::lower_band_triang_id>::RET),
-               lower_triang<>,
 
-        IF<(EQUAL<Shape1::id, Shape1::upper_triang_id>::RET ||
-            EQUAL<Shape1::id, Shape1::upper_band_triang_id>::RET) &&
-           (EQUAL<Shape2::id, Shape2::upper_triang_id>::RET ||
-            EQUAL<Shape2::id, Shape2::upper_band_triang_id>::RET),
-               upper_triang<>,
+//****************************** multiplication ********************************
 
-        rect<> >::RET>::RET>::RET>::RET>::RET>::RET>::RET>::RET>::RET>::RET
-               >::RET>::RET>::RET RET;
+template<class Shape1, class Shape2>
+struct MULTIPLY_PROMOTE_SHAPE
+{
+   typedef unspecified_DSL_feature S;
+   typedef shape_promotion         P;
+
+   enum { s1= Shape1::id,
+          s2= Shape2::id,
+          lower1= s1==S::lower_triang_id || s1==S::lower_band_triang_id,
+          lower2= s2==S::lower_triang_id || s2==S::lower_band_triang_id,
+          upper1= s1==S::upper_triang_id || s1==S::upper_band_triang_id,
+          upper2= s2==S::upper_triang_id || s2==S::upper_band_triang_id };
+
+   enum { id=
+      s1==S::zero_id || s2==S::zero_id                  ? int(S::zero_id) :
+      s1==S::ident_id                                    ? P::second_shape :
+      s2==S::ident_id                                    ? P::first_shape  :
+      s1==S::scalar_id                                   ? P::second_shape :
+      s2==S::scalar_id                                   ? P::first_shape  :
+      s1==S::diag_id && s2==S::symm_id ||
+      s1==S::symm_id && s2==S::diag_id                   ? int(S::rect_id) :
+      s1==S::diag_id                                     ? P::second_shape :
+      s2==S::diag_id                                     ? P::first_shape  :
+      s1==S::lower_band_triang_id &&
+      s2==S::lower_band_triang_id             ? int(S::lower_band_triang_id) :
+      s1==S::upper_band_triang_id &&
+      s2==S::upper_band_triang_id             ? int(S::upper_band_triang_id) :
+      s1==S::band_diag_id && s2==S::band_diag_id    ? int(S::band_diag_id) :
+      lower1 && lower2                           ? int(S::lower_triang_id) :
+      upper1 && upper2                           ? int(S::upper_triang_id) :
+                                                   int(S::rect_id) };
+
+   typedef PROMOTED_SHAPE<Shape1, Shape2, id>::RET RET;
 };
 
 template<class DSLFeatures1, class DSLFeatures2>
@@ -100,6 +138,14 @@ class MULTIPLY_RESULT_DSL
    typedef PROMOTE_NUMERIC_TYPE<DSLFeatures1::IndexType,
                                     DSLFeatures2::IndexType>::RET IndexType;
 
+   // OffsetType
+   typedef PROMOTE_NUMERIC_TYPE<DSLFeatures1::OffsetType,
+                                   DSLFeatures2::OffsetType>::RET OffsetType;
+
+   // AccumulationType
+   typedef PROMOTE_NUMERIC_TYPE<DSLFeatures1::AccumulationType,
+                     DSLFeatures2::AccumulationType>::RET AccumulationType;
+
    // Structure
    typedef structure<> Structure;
 
@@ -142,6 +188,18 @@ class MULTIPLY_RESULT_DSL
                   DSLFeatures1::CompatChecking,
                   unspecified_DSL_feature>::RET CompatChecking;
 
+   // ErrorPolicy
+   // (the policy of the left operand, so that a callback handler is kept)
+   typedef DSLFeatures1::ErrorPolicy ErrorPolicy;
+
+   // Instrumentation
+   typedef IF<EQUAL<DSLFeatures1::Instrumentation::id,
+                    DSLFeatures1::Instrumentation::instrument_id>::RET ||
+              EQUAL<DSLFeatures2::Instrumentation::id,
+                    DSLFeatures2::Instrumentation::instrument_id>::RET,
+                  instrument<>,
+                  unspecified_DSL_feature>::RET Instrumentation;
+
    // MallocErrChecking
    typedef IF<EQUAL<DSLFeatures1::MallocErrChecking::id,
                                    DSLFeatures2::MallocErrChecking::id>::RET,
@@ -153,6 +211,21 @@ class MULTIPLY_RESULT_DSL
    typedef DSLFeatures2::Format Format2;
    enum { format1 = Format1::id,
           format2 = Format2::id };
+   // The product of BSR matrices has the block rows of the left and the
+   // block columns of the right operand.
+   typedef IF<EQUAL<format1, Format1::BSR_id>::RET,
+                  Format1,
+                  BSR<> >::RET BSRFormat1_;
+   typedef IF<EQUAL<format2, Format2::BSR_id>::RET,
+                  Format2,
+                  BSR<> >::RET BSRFormat2_;
+   // If both operands have the shape and density of the result, either of
+   // their formats is valid for it and the cheaper one is taken.
+   enum { sameStorageKind=
+             EQUAL<DSLFeatures1::Shape::id, Shape::id>::RET &&
+             EQUAL<DSLFeatures2::Shape::id, Shape::id>::RET &&
+             EQUAL<DSLFeatures1::Density::id, Density::id>::RET &&
+             EQUAL<DSLFeatures2::Density::id, Density::id>::RET };
    typedef IF<EQUAL<Shape::id, Shape::  rect_id>::RET &&
              (EQUAL<format1, Format1::vector_id>::RET &&
               EQUAL<format2, Format2::vector_id>::RET ||
@@ -162,8 +235,12 @@ class MULTIPLY_RESULT_DSL
               EQUAL<format2, Format2::   SKY_id>::RET),
                   unspecified_DSL_feature,
            IF<EQUAL<format1, format2>::RET,
-                  Format1,
-                  unspecified_DSL_feature>::RET>::RET Format;
+                  IF<EQUAL<format1, Format1::BSR_id>::RET,
+                        BSR<BSRFormat1_::block_rows, BSRFormat2_::block_cols>,
+                        Format1>::RET,
+           IF<sameStorageKind,
+                  CHEAPER_FORMAT<DSLFeatures1, DSLFeatures2>::RET,
+                  unspecified_DSL_feature>::RET>::RET>::RET Format;
 
    // DictFormat
    typedef IF<EQUAL<DSLFeatures1::DictFormat::id,
@@ -320,6 +397,8 @@ public:
       typedef OptFlag            OptFlag;
       typedef ErrFlag            ErrFlag;
       typedef IndexType          IndexType;
+      typedef OffsetType         OffsetType;
+      typedef AccumulationType   AccumulationType;
       typedef Rows               Rows;
       typedef Cols               Cols;
       typedef Order              Order;
@@ -337,6 +416,8 @@ public:
       typedef MallocErrChecking  MallocErrChecking;
       typedef BoundsChecking     BoundsChecking;
       typedef CompatChecking     CompatChecking;
+      typedef ErrorPolicy        ErrorPolicy;
+      typedef Instrumentation    Instrumentation;
       typedef Format             Format;
    };
    typedef ParsedDSL RET;
@@ -358,72 +439,38 @@ struct MULTIPLY_RESULT_TYPE
 template<class Shape1, class Shape2>
 struct ADD_OR_SUBTRACT_PROMOTE_SHAPE
 {
-   typedef IF<EQUAL<Shape1::id, Shape1::zero_id>::RET,
-                  Shape2,
-
-           IF<EQUAL<Shape2::id, Shape2::zero_id>::RET,
-                  Shape1,
-
-           IF<EQUAL<Shape1::id, Shape1::ident_id>::RET,
-                  Shape2,
-
-           IF<EQUAL<Shape2::id, Shape2::ident_id>::RET,
-                  Shape1,
-
-           IF<EQUAL<Shape1::id, Shape1::scalar_id>::RET,
-                  Shape2,
-
-           IF<EQUAL<Shape2::id, Shape2::scalar_id>::RET,
-                  Shape1,
-
-           IF<EQUAL<Shape1::id, Shape1::diag_id>::RET,
-                  Shape2,
-
-           IF<EQUAL<Shape2::id, Shape2::diag_id>::RET,
-                  Shape1,
-
-           IF<EQUAL<Shape1::id, Shape1::symm_id>::RET &&
-              EQUAL<Shape2::id, Shape2::symm_id>::RET,
-                  symm<>,
-
-           IF<EQUAL<Shape1::id, Shape1::band_diag_id>::RET &&
-              EQUAL<Shape2::id, Shape2::band_diag_id>::RET,
-                  band_diag<>,
-
-           IF<EQUAL<Shape1::id, Shape1::lower_triang_id>::RET &&
-              EQUAL<Shape2::id, Shape2::lower_triang_id>::RET,
-                  lower_triang<>,
-
-           IF<EQUAL<Shape1::id, Shape1::lower_triang_id>::RET &&
-              EQUAL<Shape2::id, Shape2::lower_band_triang_id>::RET,
-                  lower_triang<>,
-
-           IF<EQUAL<Shape1::id, Shape1::lower_band_triang_id>::RET &&
-              EQUAL<Shape2::id, Shape2::lower_triang_id>::RET,
-                  lower_triang<>,
-
-           IF<EQUAL<Shape1::id, Shape1::lower_band_triang_id>::RET &&
-              EQUAL<Shape2::id, Shape2::lower_band_triang_id>::RET,
-                  lower_band_triang<>,
-
-           IF<EQUAL<Shape1::id, Shape1::upper_triang_id>::RET &&
-              EQUAL<Shape2::id, Shape2::upper_triang_id>::RET,
-                  upper_triang<>,
-
-           IF<EQUAL<Shape1::id, Shape1::upper_triang_id>::RET &&
-              EQUAL<Shape2::id, Shape2::upper_band_triang_id>::RET,
-                  upper_triang<>,
-
-           IF<EQUAL<Shape1::id, Shape1::upper_band_triang_id>::RET &&
-              EQUAL<Shape2::id, Shape2::upper_triang_id>::RET,
-                  upper_triang<>,
-
-           IF<EQUAL<Shape1::id, Shape1::upper_band_triang_id>::RET &&
-              EQUAL<Shape2::id, Shape2::upper_band_triang_id>::RET,
-                  upper_band_triang<>,
-
-           rect<> >::RET>::RET>::RET>::RET>::RET>::RET>::RET>::RET>::RET>::RET
-                  >::RET>::RET>::RET>::RET>::RET>::RET>::RET>::RET   RET;
+   typedef unspecified_DSL_feature S;
+   typedef shape_promotion         P;
+
+   enum { s1= Shape1::id,
+          s2= Shape2::id,
+          lower1= s1==S::lower_triang_id || s1==S::lower_band_triang_id,
+          lower2= s2==S::lower_triang_id || s2==S::lower_band_triang_id,
+          upper1= s1==S::upper_triang_id || s1==S::upper_band_triang_id,
+          upper2= s2==S::upper_triang_id || s2==S::upper_band_triang_id };
+
+   enum { id=
+      s1==S::zero_id                                     ? P::second_shape :
+      s2==S::zero_id                                     ? P::first_shape  :
+      s1==S::ident_id                                    ? P::second_shape :
+      s2==S::ident_id                                    ? P::first_shape  :
+      s1==S::scalar_id                                   ? P::second_shape :
+      s2==S::scalar_id                                   ? P::first_shape  :
+      s1==S::diag_id                                     ? P::second_shape :
+      s2==S::diag_id                                     ? P::first_shape  :
+      s1==S::symm_id && s2==S::symm_id                   ? int(S::symm_id) :
+      s1==S::band_diag_id && s2==S::band_diag_id    ? int(S::band_diag_id) :
+      lower1 && lower2 ? (s1==S::lower_band_triang_id &&
+                          s2==S::lower_band_triang_id
+                                        ? int(S::lower_band_triang_id)
+                                        : int(S::lower_triang_id)) :
+      upper1 && upper2 ? (s1==S::upper_band_triang_id &&
+                          s2==S::upper_band_triang_id
+                                        ? int(S::upper_band_triang_id)
+                                        : int(S::upper_triang_id)) :
+                                                   int(S::rect_id) };
+
+   typedef PROMOTED_SHAPE<Shape1, Shape2, id>::RET RET;
 };
 
 
@@ -439,6 +486,14 @@ class ADD_OR_SUBTRACT_RESULT_DSL
       typedef PROMOTE_NUMERIC_TYPE<DSLFeatures1::IndexType,
                                     DSLFeatures2::IndexType>::RET IndexType;
 
+      // OffsetType
+      typedef PROMOTE_NUMERIC_TYPE<DSLFeatures1::OffsetType,
+                                   DSLFeatures2::OffsetType>::RET OffsetType;
+
+      // AccumulationType
+      typedef PROMOTE_NUMERIC_TYPE<DSLFeatures1::AccumulationType,
+                     DSLFeatures2::AccumulationType>::RET AccumulationType;
+
       // Structure
       typedef structure<> Structure;
 
@@ -482,6 +537,18 @@ class ADD_OR_SUBTRACT_RESULT_DSL
                      DSLFeatures1::CompatChecking,
                      unspecified_DSL_feature>::RET CompatChecking;
 
+      // ErrorPolicy
+      // (the policy of the left operand, so that a callback handler is kept)
+      typedef DSLFeatures1::ErrorPolicy ErrorPolicy;
+
+      // Instrumentation
+      typedef IF<EQUAL<DSLFeatures1::Instrumentation::id,
+                       DSLFeatures1::Instrumentation::instrument_id>::RET ||
+                 EQUAL<DSLFeatures2::Instrumentation::id,
+                       DSLFeatures2::Instrumentation::instrument_id>::RET,
+                     instrument<>,
+                     unspecified_DSL_feature>::RET Instrumentation;
+
       // MallocErrChecking
       typedef IF<EQUAL<DSLFeatures1::MallocErrChecking::id,
                                     DSLFeatures2::MallocErrChecking::id>::RET,
@@ -493,6 +560,13 @@ class ADD_OR_SUBTRACT_RESULT_DSL
       typedef DSLFeatures2::Format Format2;
       enum { format1 = Format1::id,
              format2 = Format2::id };
+      // If both operands have the shape and density of the result, either
+      // of their formats is valid for it and the cheaper one is taken.
+      enum { sameStorageKind=
+                EQUAL<DSLFeatures1::Shape::id, Shape::id>::RET &&
+                EQUAL<DSLFeatures2::Shape::id, Shape::id>::RET &&
+                EQUAL<DSLFeatures1::Density::id, Density::id>::RET &&
+                EQUAL<DSLFeatures2::Density::id, Density::id>::RET };
       typedef IF<EQUAL<Shape::id, Shape::  rect_id>::RET &&
                 (EQUAL<format1, Format1::vector_id>::RET &&
                  EQUAL<format2, Format2::vector_id>::RET ||
@@ -503,7 +577,9 @@ class ADD_OR_SUBTRACT_RESULT_DSL
                      unspecified_DSL_feature,
               IF<EQUAL<format1, format2>::RET,
                      Format1,
-                     unspecified_DSL_feature>::RET>::RET Format;
+              IF<sameStorageKind,
+                     CHEAPER_FORMAT<DSLFeatures1, DSLFeatures2>::RET,
+                     unspecified_DSL_feature>::RET>::RET>::RET Format;
 
       // DictFormat
       typedef IF<EQUAL<DSLFeatures1::DictFormat::id,
@@ -678,6 +754,8 @@ class ADD_OR_SUBTRACT_RESULT_DSL
          typedef OptFlag             OptFlag;
          typedef ErrFlag             ErrFlag;
          typedef IndexType           IndexType;
+         typedef OffsetType          OffsetType;
+         typedef AccumulationType    AccumulationType;
          typedef Rows                Rows;
          typedef Cols                Cols;
          typedef Order               Order;
@@ -694,6 +772,8 @@ class ADD_OR_SUBTRACT_RESULT_DSL
          typedef MallocErrChecking   MallocErrChecking;
          typedef BoundsChecking      BoundsChecking;
          typedef CompatChecking      CompatChecking;
+         typedef ErrorPolicy         ErrorPolicy;
+         typedef Instrumentation     Instrumentation;
          typedef Format              Format;
       };
 };
@@ -704,11 +784,13 @@ class ADD_OR_SUBTRACT_RESULT_DSL
 template<class Shape1, class Shape2>
 struct ADD_PROMOTE_SHAPE
 {
-   typedef IF<EQUAL<Shape1::id, Shape1::ident_id>::RET &&
-              EQUAL<Shape2::id, Shape2::ident_id>::RET,
-                  scalar<>,
-                  ADD_OR_SUBTRACT_PROMOTE_SHAPE<Shape1, Shape2>::RET
-             >::RET RET;
+   typedef unspecified_DSL_feature S;
+
+   enum { id= Shape1::id==S::ident_id && Shape2::id==S::ident_id
+                 ? int(S::scalar_id)
+                 : int(ADD_OR_SUBTRACT_PROMOTE_SHAPE<Shape1, Shape2>::id) };
+
+   typedef PROMOTED_SHAPE<Shape1, Shape2, id>::RET RET;
 };
 
 template<class DSLFeatures1, class DSLFeatures2>
@@ -760,15 +842,15 @@ class ADD_RESULT_TYPE
 template<class Shape1, class Shape2>
 struct SUBTRACT_PROMOTE_SHAPE
 {
-   typedef IF<EQUAL<Shape1::id, Shape1:: zero_id>::RET &&
-              EQUAL<Shape2::id, Shape2::ident_id>::RET,
-                  scalar<>,
-
-           IF<EQUAL<Shape1::id, Shape1::ident_id>::RET &&
-              EQUAL<Shape2::id, Shape2::ident_id>::RET,
-                  zero<>,
-                  ADD_OR_SUBTRACT_PROMOTE_SHAPE<Shape1, Shape2>::RET
-             >::RET>::RET RET;
+   typedef unspecified_DSL_feature S;
+
+   enum { id= Shape1::id==S:: zero_id && Shape2::id==S::ident_id
+                 ? int(S::scalar_id) :
+              Shape1::id==S::ident_id && Shape2::id==S::ident_id
+                 ? int(S::zero_id)
+                 : int(ADD_OR_SUBTRACT_PROMOTE_SHAPE<Shape1, Shape2>::id) };
+
+   typedef PROMOTED_SHAPE<Shape1, Shape2, id>::RET RET;
 };
 
 template<class DSLFeatures1, class DSLFeatures2>
@@ -816,4 +898,172 @@ class SUBTRACT_RESULT_TYPE
 };
 
 
+//******************************* transposition ********************************
+
+template<class Shape>
+struct TRANSPOSE_PROMOTE_SHAPE
+{
+   typedef unspecified_DSL_feature S;
+
+   enum { id=
+      Shape::id==S::lower_triang_id      ? int(S::upper_triang_id)      :
+      Shape::id==S::upper_triang_id      ? int(S::lower_triang_id)      :
+      Shape::id==S::lower_band_triang_id ? int(S::upper_band_triang_id) :
+      Shape::id==S::upper_band_triang_id ? int(S::lower_band_triang_id) :
+                                           int(shape_promotion::first_shape) };
+
+   typedef PROMOTED_SHAPE<Shape, Shape, id>::RET RET;
+};
+
+template<class DSLFeatures>
+class TRANSPOSE_RESULT_DSL
+{
+   typedef DSLFeatures::Format   Format_;
+   typedef DSLFeatures::ArrOrder ArrOrder_;
+
+   // Shape
+   typedef TRANSPOSE_PROMOTE_SHAPE<DSLFeatures::Shape>::RET Shape;
+
+   // Format (the blocks of BSR are transposed, too)
+   typedef IF<EQUAL<Format_::id, Format_::BSR_id>::RET,
+                  Format_,
+                  BSR<> >::RET BSRFormat_;
+   typedef IF<EQUAL<Format_::id, Format_::CSR_id>::RET,
+                  CSC<>,
+           IF<EQUAL<Format_::id, Format_::CSC_id>::RET,
+                  CSR<>,
+           IF<EQUAL<Format_::id, Format_::BSR_id>::RET,
+                  BSR<BSRFormat_::block_cols, BSRFormat_::block_rows>,
+                  Format_>::RET>::RET>::RET Format;
+
+   // ArrOrder
+   typedef IF<EQUAL<ArrOrder_::id, ArrOrder_::c_like_id>::RET,
+                  fortran_like<>,
+           IF<EQUAL<ArrOrder_::id, ArrOrder_::fortran_like_id>::RET,
+                  c_like<>,
+                  ArrOrder_>::RET>::RET ArrOrder;
+
+public:
+   struct ParsedDSL
+   {
+      typedef DSLFeatures::ElementType        ElementType;
+      typedef DSLFeatures::Structure          Structure;
+      typedef Shape                           Shape;
+      typedef DSLFeatures::Density            Density;
+      typedef DSLFeatures::Malloc             Malloc;
+      typedef DSLFeatures::DictFormat         DictFormat;
+      typedef ArrOrder                        ArrOrder;
+      typedef DSLFeatures::OptFlag            OptFlag;
+      typedef DSLFeatures::ErrFlag            ErrFlag;
+      typedef DSLFeatures::IndexType          IndexType;
+      typedef DSLFeatures::OffsetType         OffsetType;
+      typedef DSLFeatures::AccumulationType   AccumulationType;
+      typedef DSLFeatures::Cols               Rows;
+      typedef DSLFeatures::Rows               Cols;
+      typedef DSLFeatures::Order              Order;
+      typedef DSLFeatures::Diags              Diags;
+      typedef DSLFeatures::ScalarValue        ScalarValue;
+      typedef DSLFeatures::ColsNumber         RowsNumber;
+      typedef DSLFeatures::RowsNumber         ColsNumber;
+      typedef DSLFeatures::OrderNumber        OrderNumber;
+      typedef DSLFeatures::DiagsNumber        DiagsNumber;
+      typedef DSLFeatures::ScalarValueNumber  ScalarValueNumber;
+      typedef DSLFeatures::Size               Size;
+      typedef DSLFeatures::Ratio              Ratio;
+      typedef DSLFeatures::Growing            Growing;
+      typedef DSLFeatures::HashWidth          HashWidth;
+      typedef DSLFeatures::MallocErrChecking  MallocErrChecking;
+      typedef DSLFeatures::BoundsChecking     BoundsChecking;
+      typedef DSLFeatures::CompatChecking     CompatChecking;
+      typedef DSLFeatures::ErrorPolicy        ErrorPolicy;
+      typedef DSLFeatures::Instrumentation    Instrumentation;
+      typedef Format                          Format;
+   };
+   typedef ParsedDSL RET;
+};
+
+template<class MatrixType>
+struct TRANSPOSE_RESULT_TYPE
+{
+   typedef MATRIX_GENERATOR<TRANSPOSE_RESULT_DSL<MatrixType::Config::DSLFeatures
+                                                >::RET
+                           ,assign_defaults
+                           >::RET RET;
+};
+
+
+//******************************** sub-matrices ********************************
+
+template<class DSLFeatures>
+class SUBMATRIX_RESULT_DSL
+{
+   typedef DSLFeatures::Density Density;
+   typedef DSLFeatures::Format  Format_;
+
+   enum { dense= EQUAL<Density::id, Density::dense_id>::RET };
+
+   // Format (CSR and CSC are kept; the others become CSR, because the
+   // buckets of a hash dictionary have no room for the elements of a small
+   // block)
+   typedef IF<dense,
+                  array<>,
+           IF<EQUAL<Format_::id, Format_::CSR_id>::RET ||
+              EQUAL<Format_::id, Format_::CSC_id>::RET,
+                  Format_,
+                  CSR<> >::RET>::RET Format;
+
+   // ArrOrder
+   typedef IF<EQUAL<Format_::id, Format_::array_id>::RET,
+                  DSLFeatures::ArrOrder,
+                  unspecified_DSL_feature>::RET ArrOrder;
+
+public:
+   struct ParsedDSL
+   {
+      typedef DSLFeatures::ElementType        ElementType;
+      typedef structure<>                     Structure;
+      typedef rect<>                          Shape;
+      typedef Density                         Density;
+      typedef DSLFeatures::Malloc             Malloc;
+      typedef DSLFeatures::DictFormat         DictFormat;
+      typedef ArrOrder                        ArrOrder;
+      typedef DSLFeatures::OptFlag            OptFlag;
+      typedef DSLFeatures::ErrFlag            ErrFlag;
+      typedef DSLFeatures::IndexType          IndexType;
+      typedef DSLFeatures::OffsetType         OffsetType;
+      typedef DSLFeatures::AccumulationType   AccumulationType;
+      typedef dyn_val<>                       Rows;
+      typedef dyn_val<>                       Cols;
+      typedef dyn_val<>                       Order;
+      typedef dyn_val<>                       Diags;
+      typedef dyn_val<>                       ScalarValue;
+      typedef unspecified_DSL_feature         RowsNumber;
+      typedef unspecified_DSL_feature         ColsNumber;
+      typedef unspecified_DSL_feature         OrderNumber;
+      typedef unspecified_DSL_feature         DiagsNumber;
+      typedef unspecified_DSL_feature         ScalarValueNumber;
+      typedef DSLFeatures::Size               Size;
+      typedef unspecified_DSL_feature         Ratio;
+      typedef unspecified_DSL_feature         Growing;
+      typedef DSLFeatures::HashWidth          HashWidth;
+      typedef DSLFeatures::MallocErrChecking  MallocErrChecking;
+      typedef DSLFeatures::BoundsChecking     BoundsChecking;
+      typedef DSLFeatures::CompatChecking     CompatChecking;
+      typedef DSLFeatures::ErrorPolicy        ErrorPolicy;
+      typedef DSLFeatures::Instrumentation    Instrumentation;
+      typedef Format                          Format;
+   };
+   typedef ParsedDSL RET;
+};
+
+template<class MatrixType>
+struct SUBMATRIX_RESULT_TYPE
+{
+   typedef MATRIX_GENERATOR<SUBMATRIX_RESULT_DSL<MatrixType::Config::DSLFeatures
+                                                >::RET
+                           ,assign_defaults
+                           >::RET RET;
+};
+
+
 #endif   // DB_MATRIX_MATRIXTYPEPROMOTION_H
@@ -0,0 +1,573 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "MatrixUpdate.h"                     */
+/*                                                                            */
+/*                                                                            */
+/*  Category:   Operations                                                    */
+/*                                                                            */
+/*  Meta-Functions:                                                           */
+/*  - MATRIX_UPDATE                                                           */
+/*  - MATRIX_EXPRESSION_UPDATE                                                */
+/*  - ELEMENTWISE_UPDATE                                                      */
+/*  - MATRIX_SCALING                                                          */
+/*                                                                            */
+/*                                                                            */
+/*  The compound assignment operators of Matrix (+=, -= and *= with a         */
+/*  scalar) update the storage of the target in place, i. e. res+= alpha*m.   */
+/*  MATRIX_UPDATE chooses an update algorithm based on the shape and density  */
+/*  of the source: sparse sources contribute only their stored entries,       */
+/*  each with a single lookup in the target (addToElementUnchecked), and      */
+/*  dense rectangular arrays with the same element order are added line by    */
+/*  line on the raw storage, so that the inner loop can be vectorized.        */
+/*  Symmetric sources and targets are traversed over the stored triangle, so  */
+/*  that no element is read or written through the mirrored accessor.         */
+/*  MATRIX_EXPRESSION_UPDATE lowers products to the fused kernels and scaled  */
+/*  matrices to MATRIX_UPDATE; any other expression is added element by       */
+/*  element. All loops check the range of the target once and then access     */
+/*  the elements unchecked.                                                   */
+/*  If a product contains the target itself, the expression is                */
+/*  evaluated into a pooled temporary first (see BinaryExpression::Update).   */
+/*                                                                            */
+/*                                                                            */
+/*  (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                */
+/*                        Ulrich Eisenecker, Johannes Knaupp                  */
+/*                                                                            */
+/******************************************************************************/
+
+#ifndef DB_MATRIX_UPDATE_H
+#define DB_MATRIX_UPDATE_H
+
+
+template<class ResultMatrixType, class ExpressionType> struct ELEMENTWISE_UPDATE;
+template<class MatrixType> struct MATRIX_SCALING;
+
+
+//**************************** update procedures *******************************
+
+struct ZeroUpdate
+{
+   template<class Res, class M>
+   static void update(Res* res, const M* m,
+                                        const Res::Config::ElementType& alpha)
+   {}
+};
+
+// the target stores a single value for its diagonal
+struct ScalarUpdate
+{
+   template<class Res, class M>
+   static void update(Res* res, const M* m,
+                                        const Res::Config::ElementType& alpha)
+   {
+      if (!res->checkRange(1, 1)) return;
+      res->setElementUnchecked(0, 0, res->getElementUnchecked(0, 0) +
+                                        alpha*m->getElementUnchecked(0, 0));
+   }
+};
+
+struct DiagUpdate
+{
+   template<class Res, class M>
+   static void update(Res* res, const M* m,
+                                        const Res::Config::ElementType& alpha)
+   {
+      if (!res->checkRange(m->rows(), m->cols())) return;
+      for (Res::Config::IndexType i= m->rows(); i--;)
+         res->setElementUnchecked(i, i, res->getElementUnchecked(i, i) +
+                                           alpha*m->getElementUnchecked(i, i));
+   }
+};
+
+struct RectUpdate
+{
+   template<class Res, class M>
+   static void update(Res* res, const M* m,
+                                        const Res::Config::ElementType& alpha)
+   {
+      if (!res->checkRange(m->rows(), m->cols())) return;
+      for (Res::Config::IndexType i= m->rows(); i--;)
+         for (Res::Config::IndexType j= m->cols(); j--;)
+            res->setElementUnchecked(i, j, res->getElementUnchecked(i, j) +
+                                          alpha*m->getElementUnchecked(i, j));
+   }
+};
+
+struct BandUpdate
+{
+   template<class Res, class M>
+   static void update(Res* res, const M* m,
+                                        const Res::Config::ElementType& alpha)
+   {
+      Res::Config::IndexType stop_j, maxColsIndex= m->cols()-1;
+
+      if (!res->checkRange(m->rows(), m->cols())) return;
+      for (Res::Config::IndexType i= m->rows(); i--;)
+      {
+         stop_j= Min(i + m->lastDiag(), maxColsIndex);
+         for (Res::Config::IndexType j=
+                     Max(Res::Config::SignedIndexType(i + m->firstDiag()), 0);
+                                                                 j<=stop_j; ++j)
+            res->setElementUnchecked(i, j, res->getElementUnchecked(i, j) +
+                                          alpha*m->getElementUnchecked(i, j));
+      }
+   }
+};
+
+struct SparseUpdate
+{
+   template<class Res, class M>
+   static void update(Res* res, const M* m,
+                                        const Res::Config::ElementType& alpha)
+   {
+      M::IteratorType iter(*m);
+      Res::Config::ElementType v;
+      Res::Config::IndexType   i;
+      Res::Config::IndexType   j;
+
+      if (!res->checkRange(m->rows(), m->cols())) return;
+      while (!iter.end())
+      {
+         iter.getNext(i, j, v);
+         res->addToElementUnchecked(i, j, alpha*v);
+      }
+   }
+};
+
+struct SparseSymmUpdate
+{
+   template<class Res, class M>
+   static void update(Res* res, const M* m,
+                                        const Res::Config::ElementType& alpha)
+   {
+      M::IteratorType iter(*m);
+      Res::Config::ElementType v;
+      Res::Config::IndexType   i;
+      Res::Config::IndexType   j;
+
+      if (!res->checkRange(m->rows(), m->cols())) return;
+      while (!iter.end())
+      {
+         iter.getNext(i, j, v);
+         res->addToElementUnchecked(i, j, alpha*v);
+         if (!IS_SYMM_MATRIX<Res>::RET && i!=j)
+            res->addToElementUnchecked(j, i, alpha*v);
+      }
+   }
+};
+
+// Reads the lower triangle of the band only. A symmetric result stores both
+// halves in one place, so the mirrored element is only added to other results.
+struct SymmUpdate
+{
+   template<class Res, class M>
+   static void update(Res* res, const M* m,
+                                        const Res::Config::ElementType& alpha)
+   {
+      typedef Res::Config::SignedIndexType SignedIndexType;
+      Res::Config::ElementType v;
+
+      if (!res->checkRange(m->rows(), m->cols())) return;
+      for (Res::Config::IndexType i= m->rows(); i--;)
+         for (Res::Config::IndexType j=
+                        Max(SignedIndexType(i + m->firstDiag()), 0); j<=i; ++j)
+         {
+            v= alpha*m->getElementUnchecked(i, j);
+            res->setElementUnchecked(i, j, res->getElementUnchecked(i, j) + v);
+            if (!IS_SYMM_MATRIX<Res>::RET && i!=j)
+               res->setElementUnchecked(j, i,
+                                            res->getElementUnchecked(j, i) + v);
+         }
+   }
+};
+
+// both matrices are dense arrays with the same element order
+struct LineUpdate
+{
+   template<class Res, class M>
+   static void update(Res* res, const M* m,
+                                        const Res::Config::ElementType& alpha)
+   {
+      typedef Res::Config::ElementType     ElementType;
+      typedef Res::Config::SignedIndexType SignedIndexType;
+      typedef M::Config::ElementType       SourceElementType;
+
+      const SignedIndexType lines= res->lines(), length= res->lineLength();
+      for (SignedIndexType l= 0; l<lines; ++l)
+      {
+         ElementType*             r= res->line(l);
+         const SourceElementType* s= m->line(l);
+         for (SignedIndexType k= 0; k<length; ++k) r[k]+= alpha*s[k];
+      }
+   }
+};
+
+
+//************************* expression update procedures ***********************
+
+// res+= alpha*A*B
+struct ProductUpdate
+{
+   template<class Res, class E>
+   static void update(Res* res, const E* e,
+                                        const Res::Config::ElementType& alpha)
+   {
+      typedef PRODUCT_TERM_ACCESS<E>::RET Access;
+      updateProduct(res, alpha*Access::coefficient(*e), Access::product(*e));
+   }
+
+   template<class Res, class P>
+   static void updateProduct(Res* res, const Res::Config::ElementType& alpha,
+                                                                   const P& p)
+   {
+      typedef TERM_ACCESS<P:: LeftType>::RET  LeftAccess;
+      typedef TERM_ACCESS<P::RightType>::RET RightAccess;
+      typedef Res::Config::ElementType ElementType;
+
+      FusedKernels::gemm(res, alpha,  LeftAccess::matrix(p. left()),
+                     RightAccess::matrix(p.right()), ElementType(1), *res);
+   }
+};
+
+// res+= alpha*s*A
+struct ScaledMatrixUpdate
+{
+   template<class Res, class E>
+   static void update(Res* res, const E* e,
+                                        const Res::Config::ElementType& alpha)
+   {
+      typedef E::RightType MatrixType;
+      typedef Res::Config::ElementType ElementType;
+
+      // res+= alpha*s*res would iterate over the entries being changed
+      if (e->operand().aliases(res))
+         MATRIX_SCALING<Res>::RET::scale(res, ElementType(1) + alpha*e->scalar());
+      else
+         MATRIX_UPDATE<Res, MatrixType>::RET::update(res, &e->operand(),
+                                                            alpha*e->scalar());
+   }
+};
+
+// res+= alpha*(L +/- R), with each operand being a product or a (scaled)
+// matrix
+template<int difference>
+struct SumUpdate
+{
+   template<class Res, class E>
+   static void update(Res* res, const E* e,
+                                        const Res::Config::ElementType& alpha)
+   {
+      typedef E::LeftType  LeftType;
+      typedef E::RightType RightType;
+      typedef Res::Config::ElementType ElementType;
+
+      // the second pass would read the result of the first one
+      if (e->aliases(res))
+      {
+         ELEMENTWISE_UPDATE<Res, E>::RET::update(res, e, alpha);
+         return;
+      }
+
+      MATRIX_EXPRESSION_UPDATE<Res, LeftType>::RET::
+                                              update(res, &e->left(), alpha);
+      MATRIX_EXPRESSION_UPDATE<Res, RightType>::RET::
+               update(res, &e->right(), difference ? ElementType(-alpha) : alpha);
+   }
+};
+
+
+//************************** scaling procedures ********************************
+
+struct ZeroScaling
+{
+   template<class Res>
+   static void scale(Res* res, const Res::Config::ElementType& s)
+   {}
+};
+
+struct ScalarScaling
+{
+   template<class Res>
+   static void scale(Res* res, const Res::Config::ElementType& s)
+   {
+      res->setElementUnchecked(0, 0, s*res->getElementUnchecked(0, 0));
+   }
+};
+
+struct DiagScaling
+{
+   template<class Res>
+   static void scale(Res* res, const Res::Config::ElementType& s)
+   {
+      for (Res::Config::IndexType i= res->rows(); i--;)
+         res->setElementUnchecked(i, i, s*res->getElementUnchecked(i, i));
+   }
+};
+
+struct LineScaling
+{
+   template<class Res>
+   static void scale(Res* res, const Res::Config::ElementType& s)
+   {
+      typedef Res::Config::ElementType     ElementType;
+      typedef Res::Config::SignedIndexType SignedIndexType;
+
+      const SignedIndexType lines= res->lines(), length= res->lineLength();
+      for (SignedIndexType l= 0; l<lines; ++l)
+      {
+         ElementType* r= res->line(l);
+         for (SignedIndexType k= 0; k<length; ++k) r[k]*= s;
+      }
+   }
+};
+
+struct SparseScaling
+{
+   template<class Res>
+   static void scale(Res* res, const Res::Config::ElementType& s)
+   {
+      // scaling by zero would remove entries while they are iterated
+      if (s == Res::zero())
+      {
+         res->initElements();
+         return;
+      }
+
+      Res::IteratorType iter(*res);
+      Res::Config::ElementType v;
+      Res::Config::IndexType   i;
+      Res::Config::IndexType   j;
+
+      while (!iter.end())
+      {
+         iter.getNext(i, j, v);
+         res->setElementUnchecked(i, j, s*v);
+      }
+   }
+};
+
+struct BandScaling
+{
+   template<class Res>
+   static void scale(Res* res, const Res::Config::ElementType& s)
+   {
+      Res::Config::IndexType stop_j, maxColsIndex= res->cols()-1;
+
+      for (Res::Config::IndexType i= res->rows(); i--;)
+      {
+         stop_j= Min(i + res->lastDiag(), maxColsIndex);
+         for (Res::Config::IndexType j=
+                   Max(Res::Config::SignedIndexType(i + res->firstDiag()), 0);
+                                                                 j<=stop_j; ++j)
+            res->setElementUnchecked(i, j, s*res->getElementUnchecked(i, j));
+      }
+   }
+};
+
+// every stored element of a symmetric matrix is scaled once
+struct SymmScaling
+{
+   template<class Res>
+   static void scale(Res* res, const Res::Config::ElementType& s)
+   {
+      typedef Res::Config::SignedIndexType SignedIndexType;
+
+      for (Res::Config::IndexType i= res->rows(); i--;)
+         for (Res::Config::IndexType j=
+                     Max(SignedIndexType(i + res->firstDiag()), 0); j<=i; ++j)
+            res->setElementUnchecked(i, j, s*res->getElementUnchecked(i, j));
+   }
+};
+
+
+//************************** computing update type *****************************
+
+template<class ResultMatrixType, class RightMatrixType>
+struct MATRIX_UPDATE
+{
+   typedef ResultMatrixType::Config::DSLFeatures ResFeatures;
+   typedef RightMatrixType ::Config::DSLFeatures Features;
+   typedef Features::Density Density;
+   typedef Features::Shape   Shape;
+   typedef Features::Format  Format;
+
+   enum { sameArrays=
+             EQUAL<ResFeatures::Shape::id,   Shape::rect_id>::RET    &&
+             EQUAL<ResFeatures::Format::id,  Format::array_id>::RET  &&
+             EQUAL<Format::id,               Format::array_id>::RET  &&
+             EQUAL<ResFeatures::ArrOrder::id, Features::ArrOrder::id>::RET };
+
+   typedef IF<EQUAL<Shape::id, Shape::zero_id>::RET,
+                  ZeroUpdate,
+
+           IF<EQUAL<ResFeatures::Shape::id, Shape:: ident_id>::RET ||
+              EQUAL<ResFeatures::Shape::id, Shape::scalar_id>::RET,
+                  ScalarUpdate,
+
+           IF<EQUAL<Shape::id, Shape:: ident_id>::RET ||
+              EQUAL<Shape::id, Shape::scalar_id>::RET ||
+              EQUAL<Shape::id, Shape::  diag_id>::RET,
+                  DiagUpdate,
+
+           IF<EQUAL<Density::id, Density::sparse_id>::RET,
+               IF<EQUAL<Shape::id, Shape::symm_id>::RET,
+                  SparseSymmUpdate,
+                  SparseUpdate      >::RET,
+
+           IF<EQUAL<Shape::id, Shape::rect_id>::RET,
+               IF<sameArrays,
+                  LineUpdate,
+                  RectUpdate>::RET,
+
+           IF<EQUAL<Shape::id, Shape::symm_id>::RET,
+                  SymmUpdate,
+                  BandUpdate>::RET>::RET>::RET>::RET>::RET>::RET RET;
+};
+
+
+// Expressions are evaluated element by element, choosing the loop by the shape
+// of their result type.
+template<class ResultMatrixType, class ExpressionType>
+struct ELEMENTWISE_UPDATE
+{
+   typedef ResultMatrixType::Config::DSLFeatures::Shape ResShape;
+   typedef ExpressionType  ::Config::DSLFeatures::Shape Shape;
+
+   typedef IF<EQUAL<Shape::id, Shape::zero_id>::RET,
+                  ZeroUpdate,
+
+           IF<EQUAL<ResShape::id, Shape:: ident_id>::RET ||
+              EQUAL<ResShape::id, Shape::scalar_id>::RET,
+                  ScalarUpdate,
+
+           IF<EQUAL<Shape::id, Shape:: ident_id>::RET ||
+              EQUAL<Shape::id, Shape::scalar_id>::RET ||
+              EQUAL<Shape::id, Shape::  diag_id>::RET,
+                  DiagUpdate,
+
+           IF<EQUAL<Shape::id, Shape::rect_id>::RET,
+                  RectUpdate,
+
+           IF<EQUAL<Shape::id, Shape::symm_id>::RET,
+                  SymmUpdate,
+                  BandUpdate>::RET>::RET>::RET>::RET>::RET RET;
+};
+
+
+// The selectors are evaluated lazily, since only sums and differences have
+// operands that may be inspected.
+
+struct ElementwiseUpdateSelector
+{
+   template<class ResultMatrixType, class ExpressionType>
+   struct Select
+   {
+      typedef ELEMENTWISE_UPDATE<ResultMatrixType, ExpressionType>::RET RET;
+   };
+};
+
+struct MatrixUpdateSelector
+{
+   template<class ResultMatrixType, class MatrixType>
+   struct Select
+   {
+      typedef MATRIX_UPDATE<ResultMatrixType, MatrixType>::RET RET;
+   };
+};
+
+struct ProductUpdateSelector
+{
+   template<class ResultMatrixType, class ExpressionType>
+   struct Select
+   {
+      typedef ProductUpdate RET;
+   };
+};
+
+struct ScaledMatrixUpdateSelector
+{
+   template<class ResultMatrixType, class ExpressionType>
+   struct Select
+   {
+      typedef ScaledMatrixUpdate RET;
+   };
+};
+
+struct SumUpdateSelector
+{
+   template<class ResultMatrixType, class ExpressionType>
+   struct Select
+   {
+      typedef ExpressionType::LeftType  LeftType;
+      typedef ExpressionType::RightType RightType;
+
+      enum { difference= EQUAL<ExpressionType::kind,
+                                     expression_kinds::difference_kind>::RET };
+      enum { termsOnly= (IS_FUSABLE_TERM<LeftType>::RET  ||
+                         IS_PRODUCT_TERM<LeftType>::RET) &&
+                        (IS_FUSABLE_TERM<RightType>::RET ||
+                         IS_PRODUCT_TERM<RightType>::RET) };
+
+      typedef IF<termsOnly,
+                     SumUpdate<difference>,
+                     ELEMENTWISE_UPDATE<ResultMatrixType, ExpressionType>::RET
+                >::RET RET;
+   };
+};
+
+
+template<class ResultMatrixType, class ExpressionType>
+struct MATRIX_EXPRESSION_UPDATE
+{
+   enum { kind= ExpressionType::kind };
+
+   typedef IF<EQUAL<kind, expression_kinds::matrix_kind>::RET,
+                  MatrixUpdateSelector,
+
+           IF<IS_PRODUCT_TERM<ExpressionType>::RET,
+                  ProductUpdateSelector,
+
+           IF<EQUAL<kind, expression_kinds::scaled_matrix_kind>::RET,
+                  ScaledMatrixUpdateSelector,
+
+           IF<EQUAL<kind, expression_kinds::sum_kind>::RET ||
+              EQUAL<kind, expression_kinds::difference_kind>::RET,
+                  SumUpdateSelector,
+
+                  ElementwiseUpdateSelector>::RET>::RET>::RET>::RET Selector;
+
+   typedef Selector::Select<ResultMatrixType, ExpressionType>::RET RET;
+};
+
+
+//************************** computing scaling type ****************************
+
+template<class MatrixType>
+struct MATRIX_SCALING
+{
+   typedef MatrixType::Config::DSLFeatures::Density Density;
+   typedef MatrixType::Config::DSLFeatures::Shape   Shape;
+   typedef MatrixType::Config::DSLFeatures::Format  Format;
+
+   typedef IF<EQUAL<Shape::id, Shape::zero_id>::RET,
+                  ZeroScaling,
+
+           IF<EQUAL<Shape::id, Shape:: ident_id>::RET ||
+              EQUAL<Shape::id, Shape::scalar_id>::RET,
+                  ScalarScaling,
+
+           IF<EQUAL<Shape::id, Shape::diag_id>::RET,
+                  DiagScaling,
+
+           IF<EQUAL<Density::id, Density::sparse_id>::RET,
+                  SparseScaling,
+
+           IF<EQUAL<Format::id, Format::array_id>::RET,
+                  LineScaling,
+
+           IF<EQUAL<Shape::id, Shape::symm_id>::RET,
+                  SymmScaling,
+                  BandScaling>::RET>::RET>::RET>::RET>::RET>::RET RET;
+};
+
+
+#endif   // DB_MATRIX_UPDATE_H
@@ -8,11 +8,22 @@
 /*  Classes:                                                                  */
 /*  - EmptyMallocErrChecker                                                   */
 /*  - MallocErrChecker                                                        */
+/*  - CheckHeapAllocation                                                     */
+/*                                                                            */
+/*  Meta-Functions:                                                           */
+/*  - IS_STATIC_MEMORY                                                        */
 /*                                                                            */
 /*                                                                            */
 /*  These classes provide (MallocErrChecker) or do not provide (Empty-        */
 /*  MallocErrChecker) error checking for memory allocation depending on       */
-/*  the DSL description.                                                      */
+/*  the DSL description. Errors are passed to Config::ErrorReporter.          */
+/*  ensure() returns whether the allocation succeeded; if not, the caller     */
+/*  stops and leaves its container empty or unchanged, so that a reporter     */
+/*  which does not throw never leads to a null pointer being used.            */
+/*  Matrices with static memory allocation (fix<>) must never use the heap,   */
+/*  neither for their storage nor for the temporaries of expressions and      */
+/*  assignments. The components which allocate on the heap contain            */
+/*  CheckHeapAllocation, which does not compile for such a matrix.            */
 /*                                                                            */
 /*                                                                            */
 /* (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                 */
@@ -32,7 +43,8 @@ struct EmptyMallocErrChecker
 {
       typedef Generator::Config Config;
 
-      static void ensure( const int & cond ) {}
+      static bool ensure( const int & cond ) DB_MATRIX_NOEXCEPT
+      {return cond != 0;}
 };
 
 
@@ -41,14 +53,48 @@ struct MallocErrChecker
 {
       typedef Generator::Config Config;
 
-      static void ensure( const int & cond )
+      static bool ensure( const int & cond )
+                       DB_MATRIX_NOEXCEPT_IF(!Config::ErrorReporter::throws)
       {
          if ( !cond )
-            throw "memory allocation failed";
+            Config::ErrorReporter::report(
+                                      matrix_errors::memory_allocation_failed);
+         return cond != 0;
       }
 };
 
 
+
+//**************************** static memory check *****************************
+
+// true if the matrix (or component) T has static memory allocation
+template<class T>
+struct IS_STATIC_MEMORY
+{
+   typedef T::Config::DSLFeatures::Malloc Malloc;
+
+   enum {RET= EQUAL<Malloc::id, Malloc::fix_id>::RET};
+};
+
+struct HEAP_ALLOCATION_OK
+{
+   typedef HEAP_ALLOCATION_OK HEAP_ALLOCATION_IN_STATIC_CONFIGURATION;
+};
+
+struct HEAP_ALLOCATION_ERROR {};
+
+// compile-time error "HEAP_ALLOCATION_IN_STATIC_CONFIGURATION is not a member"
+// if a component allocating on the heap is instantiated for a matrix with
+// static memory allocation
+template<class T>
+struct CheckHeapAllocation
+{
+   typedef IF<IS_STATIC_MEMORY<T>::RET,
+                  HEAP_ALLOCATION_ERROR,
+                  HEAP_ALLOCATION_OK>::RET::
+                              HEAP_ALLOCATION_IN_STATIC_CONFIGURATION RET;
+};
+
 }  // namespace MatrixICCL
 
 #endif   // DB_MATRIX_MEMORYALLOCERRORNOTIFIER_H
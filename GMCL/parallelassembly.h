@@ -0,0 +1,484 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "ParallelAssembly.h"                 */
+/*                                                                            */
+/*                                                                            */
+/*  Category:   Operations                                                    */
+/*                                                                            */
+/*  Classes:                                                                  */
+/*  - TripletBuffer                                                           */
+/*  - AssembledEntries, AssembledEntriesIterator                              */
+/*  - ParallelAssembler                                                       */
+/*                                                                            */
+/*                                                                            */
+/*  ParallelAssembler builds a sparse matrix from triplets (i, j, v) added    */
+/*  by several threads at once, e.g. by the element loop of a finite element  */
+/*  assembly. None of the formats may be written by more than one thread, so  */
+/*  every thread appends its triplets to a TripletBuffer of its own:          */
+/*                                                                            */
+/*     ParallelAssembler<MatrixType> assembler(n, n, threads);                */
+/*     #pragma omp parallel for                                               */
+/*     for (int e= 0; e<elements; ++e)                                        */
+/*        ... assembler.buffer(omp_get_thread_num()).add(i, j, v);            */
+/*     assembler.assemble(A, true);                                           */
+/*                                                                            */
+/*  assemble() merges the buffers by two stable counting sorts, the first by  */
+/*  the cross index and the second by the lines of the result (columns of     */
+/*  CSC, rows otherwise), in O(nnz + threads*(rows+cols)). Every buffer, and  */
+/*  then every part of the first order, scatters its triplets in parallel.    */
+/*  Then the values at the same position are summed, again in parallel, in    */
+/*  the order of the buffers. A CSR or CSC result takes over the merged lines */
+/*  by setCompressed(); any other sparse result (BSR, SELL, COO, SKY) reads   */
+/*  them by the conversions of SparseConversion.                              */
+/*  Values summing up to zero are not stored.                                 */
+/*  If the pattern of the result is known already (e.g. in the iterations of  */
+/*  Newton's method), refill() replaces its values only: the merged entries   */
+/*  are passed in the order of the lines to refillValues() of the format,     */
+/*  which reuses the stored pattern in O(nnz) for CSR and CSC. Together with  */
+/*  freezePattern() the structure of the result never changes.                */
+/*                                                                            */
+/*                                                                            */
+/* (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                 */
+/*                       Ulrich Eisenecker, Johannes Knaupp                   */
+/*                                                                            */
+/******************************************************************************/
+
+#ifndef DB_MATRIX_PARALLELASSEMBLY_H
+#define DB_MATRIX_PARALLELASSEMBLY_H
+
+
+//****************************** triplet buffers *******************************
+
+// the triplets added by one thread; the arrays grow by doubling
+template<class MatrixType>
+class TripletBuffer
+{
+      typedef CheckHeapAllocation<MatrixType>::RET CheckHeapAllocation_;
+
+   public:
+      typedef MatrixType::Config::ElementType ElementType;
+      typedef MatrixType::Config::IndexType   IndexType;
+      typedef MatrixType::Config::OffsetType  OffsetType;
+
+      TripletBuffer() : n_(0), capacity_(0), i_(NULL), j_(NULL), v_(NULL) {}
+
+      ~TripletBuffer()
+      {
+         delete [] i_;
+         delete [] j_;
+         delete [] v_;
+      }
+
+      // the values added at the same position are summed by assemble()
+      void add(const IndexType& i, const IndexType& j, const ElementType& v)
+      {
+         if (n_ == capacity_) reserve(capacity_>0 ? 2*capacity_ : 64);
+         i_[n_]= i;
+         j_[n_]= j;
+         v_[n_]= v;
+         ++n_;
+      }
+
+      void reserve(const OffsetType& capacity)
+      {
+         if (capacity <= capacity_) return;
+
+         IndexType*   i= new IndexType  [capacity];
+         IndexType*   j= new IndexType  [capacity];
+         ElementType* v= new ElementType[capacity];
+         for (OffsetType k= 0; k<n_; ++k)
+         {
+            i[k]= i_[k];
+            j[k]= j_[k];
+            v[k]= v_[k];
+         }
+         delete [] i_;
+         delete [] j_;
+         delete [] v_;
+         i_= i;
+         j_= j;
+         v_= v;
+         capacity_= capacity;
+      }
+
+      void clear() {n_= 0;}
+
+      const OffsetType& count() const {return n_;}
+
+      const IndexType&   row  (const OffsetType& k) const {return i_[k];}
+      const IndexType&   col  (const OffsetType& k) const {return j_[k];}
+      const ElementType& value(const OffsetType& k) const {return v_[k];}
+
+   private:
+      TripletBuffer(const TripletBuffer&);
+      TripletBuffer& operator=(const TripletBuffer&);
+
+      OffsetType   n_, capacity_;
+      IndexType  * i_;
+      IndexType  * j_;
+      ElementType* v_;
+};
+
+
+//****************************** merged entries ********************************
+
+template<class AssembledEntries_>
+class AssembledEntriesIterator
+{
+   public:
+      typedef AssembledEntries_           Entries;
+      typedef Entries::ElementType        ElementType;
+      typedef Entries::IndexType          IndexType;
+      typedef Entries::OffsetType         OffsetType;
+
+      AssembledEntriesIterator(const Entries& e) : entries_(e) {reset();}
+
+      // yields (row, column) also if the lines are columns
+      void getNext(IndexType& i, IndexType& j, ElementType& v)
+      {
+         assert(!end());
+         i= Entries::by_cols ? entries_.indx_[k_] : i_;
+         j= Entries::by_cols ? i_ : entries_.indx_[k_];
+         v= entries_.val_ [k_];
+         ++k_;
+         skipEmptyRows();
+      }
+
+      void reset()
+      {
+         i_= 0;
+         k_= 0;
+         skipEmptyRows();
+      }
+
+      bool end() const {return i_ >= entries_.lines();}
+
+   private:
+      void skipEmptyRows()
+      {
+         while (i_ < entries_.lines() && k_ >= entries_.pntr_[i_+1]) ++i_;
+      }
+
+      const Entries& entries_;
+      IndexType  i_;
+      OffsetType k_;
+};
+
+// AssembledEntries presents the merged lines of a ParallelAssembler as a
+// sparse source to the conversions of SparseConversion and to refillValues().
+template<class MatrixType>
+class AssembledEntries
+{
+   public:
+      typedef MatrixType::Config          Config;
+      typedef Config::ElementType         ElementType;
+      typedef Config::IndexType           IndexType;
+      typedef Config::OffsetType          OffsetType;
+      typedef Config::DSLFeatures::Format Format;
+      typedef AssembledEntriesIterator<AssembledEntries<MatrixType> >
+                                                                   IteratorType;
+      friend IteratorType;
+
+      enum { kind= expression_kinds::other_kind };
+
+      // the lines are columns for CSC results (see ParallelAssembler)
+      enum { by_cols= EQUAL<Format::id, Format::CSC_id>::RET };
+
+      AssembledEntries(const IndexType& r, const IndexType& c,
+                       const OffsetType* pntr, const IndexType* indx,
+                                                       const ElementType* val)
+         : r_(r), c_(c), pntr_(pntr), indx_(indx), val_(val)
+      {}
+
+      IndexType  rows() const {return r_;}
+      IndexType  cols() const {return c_;}
+      IndexType lines() const {return by_cols ? c_ : r_;}
+
+   private:
+      const IndexType    r_, c_;
+      const OffsetType * pntr_;
+      const IndexType  * indx_;
+      const ElementType* val_;
+};
+
+
+//***************************** parallel assembler *****************************
+
+template<class MatrixType>
+class ParallelAssembler
+{
+      typedef CheckHeapAllocation<MatrixType>::RET CheckHeapAllocation_;
+
+   public:
+      typedef MatrixType::Config          Config;
+      typedef Config::ElementType         ElementType;
+      typedef Config::AccumulationType    AccumulationType;
+      typedef Config::IndexType           IndexType;
+      typedef Config::SignedIndexType     SignedIndexType;
+      typedef Config::OffsetType          OffsetType;
+      typedef Config::DSLFeatures::Format Format;
+      typedef TripletBuffer<MatrixType>   BufferType;
+
+      // the triplets are merged into columns for CSC results, into rows
+      // otherwise
+      enum { by_cols= EQUAL<Format::id, Format::CSC_id>::RET };
+
+      ParallelAssembler(const IndexType& r, const IndexType& c,
+                                                     const IndexType& threads)
+         : r_(r), c_(c), threads_(threads), buffers_(new BufferType*[threads]),
+           nnz_(0), pntr_(NULL), indx_(NULL), val_(NULL)
+      {
+         assert(threads>0);
+         for (IndexType t= 0; t<threads_; ++t) buffers_[t]= new BufferType;
+      }
+
+      ~ParallelAssembler()
+      {
+         for (IndexType t= 0; t<threads_; ++t) delete buffers_[t];
+         delete [] buffers_;
+         releaseMerged();
+      }
+
+      IndexType    rows() const {return r_;}
+      IndexType    cols() const {return c_;}
+      IndexType threads() const {return threads_;}
+
+      // the buffer of thread t; it must not be used by any other thread
+      BufferType& buffer(const IndexType& t)
+      {
+         assert(t<threads_);
+         return *buffers_[t];
+      }
+
+      // empties the buffers for the next assembly
+      void clear()
+      {
+         for (IndexType t= 0; t<threads_; ++t) buffers_[t]->clear();
+      }
+
+      // res= the sum of the buffered triplets; the buffers are kept
+      void assemble(MatrixType& res, bool parallel= false)
+      {
+         if (!res.checkRange(r_, c_)) return;
+         merge(parallel);
+         IF<IS_COMPRESSED_MATRIX<MatrixType>::RET,
+               CompressedResult,
+               ConvertedResult>::RET::assign(&res, this);
+      }
+
+      // replaces the values of res by the sum of the buffered triplets and
+      // keeps its pattern; the entries of res without a triplet become zero
+      void refill(MatrixType& res, bool parallel= false)
+      {
+         if (!res.checkRange(r_, c_)) return;
+         merge(parallel);
+         AssembledEntries<MatrixType> entries(r_, c_, pntr_, indx_, val_);
+         AssembledEntries<MatrixType>::IteratorType iter(entries);
+         res.refillValues(iter);
+      }
+
+   private:
+      struct CompressedResult
+      {
+         static void assign(MatrixType* res, const ParallelAssembler* a)
+         {
+            res->setCompressed(a->pntr_, a->indx_, a->val_);
+         }
+      };
+
+      struct ConvertedResult
+      {
+         static void assign(MatrixType* res, const ParallelAssembler* a)
+         {
+            AssembledEntries<MatrixType> entries(a->r_, a->c_, a->pntr_,
+                                                        a->indx_, a->val_);
+            SparseConversion<false>::assign(res, &entries);
+         }
+      };
+      friend struct CompressedResult;
+      friend struct ConvertedResult;
+
+      IndexType lines() const {return by_cols ? c_ : r_;}
+
+      // the first of the triplets [0, total) in part t of threads_ parts
+      OffsetType partBegin(const OffsetType& total, const IndexType& t) const
+      {
+         const OffsetType parts= threads_;
+         return total/parts*t + Min(OffsetType(t), total%parts);
+      }
+
+      // turns the counts pos[t*width + x] of the triplets with key x in part
+      // t into the position of the first of them in the order of (x, t), and
+      // returns the number of all triplets; start[x] (if given) becomes the
+      // position of the first triplet with key x, start[keys] the number
+      OffsetType positions(OffsetType* pos, const IndexType& keys,
+                           const IndexType& width, OffsetType* start) const
+      {
+         OffsetType total= 0;
+         for (IndexType x= 0; x<keys; ++x)
+         {
+            if (start) start[x]= total;
+            for (IndexType t= 0; t<threads_; ++t)
+            {
+               const OffsetType c= pos[t*width + x];
+               pos[t*width + x]= total;
+               total+= c;
+            }
+         }
+         if (start) start[keys]= total;
+         return total;
+      }
+
+      // merges the buffers into compressed lines pntr_, indx_ and val_ by
+      // two stable counting sorts, the first by the cross index (the column
+      // of a row), the second by the line; the parts of each sort are
+      // scattered in parallel. The triplets of a line are then in the order
+      // of the cross index, and those at the same position in the order of
+      // the buffers, so the sums do not depend on the schedule.
+      void merge(bool parallel)
+      {
+         const IndexType       n= lines(), m= by_cols ? r_ : c_;
+         const IndexType       width= Max(n, m);
+         const SignedIndexType threads= threads_;
+         SignedIndexType t, l;
+         IndexType       ll;
+         OffsetType      k, total;
+
+         // pos[t*width + x]: first the number of triplets of part t with
+         // key x, then the position of the next one in the sorted order
+         OffsetType* pos  = new OffsetType[threads_*width > 0 ?
+                                                       threads_*width : 1];
+         OffsetType* start= new OffsetType[n+1];
+
+         // by the cross index; the parts are the buffers
+#pragma omp parallel for if(parallel) private(k)
+         for (t= 0; t<threads; ++t)
+         {
+            OffsetType*       count= pos + t*width;
+            const BufferType& b    = *buffers_[t];
+            for (IndexType x= 0; x<m; ++x) count[x]= 0;
+            for (k= 0; k<b.count(); ++k)
+            {
+               assert(b.row(k)<r_); assert(b.col(k)<c_);
+               ++count[by_cols ? b.row(k) : b.col(k)];
+            }
+         }
+         total= positions(pos, m, width, NULL);
+
+         IndexType*   line0 = new IndexType  [total>0 ? total : 1];
+         IndexType*   cross0= new IndexType  [total>0 ? total : 1];
+         ElementType* value0= new ElementType[total>0 ? total : 1];
+
+#pragma omp parallel for if(parallel) private(k)
+         for (t= 0; t<threads; ++t)
+         {
+            OffsetType*       next= pos + t*width;
+            const BufferType& b   = *buffers_[t];
+            for (k= 0; k<b.count(); ++k)
+            {
+               const OffsetType p= next[by_cols ? b.row(k) : b.col(k)]++;
+               line0 [p]= by_cols ? b.col(k) : b.row(k);
+               cross0[p]= by_cols ? b.row(k) : b.col(k);
+               value0[p]= b.value(k);
+            }
+         }
+
+         // by the line; the parts are threads_ consecutive ranges of the
+         // triplets sorted above
+#pragma omp parallel for if(parallel) private(k)
+         for (t= 0; t<threads; ++t)
+         {
+            OffsetType*      count= pos + t*width;
+            const OffsetType stop = partBegin(total, t+1);
+            for (IndexType x= 0; x<n; ++x) count[x]= 0;
+            for (k= partBegin(total, t); k<stop; ++k) ++count[line0[k]];
+         }
+         positions(pos, n, width, start);
+
+         IndexType*   cross= new IndexType  [total>0 ? total : 1];
+         ElementType* value= new ElementType[total>0 ? total : 1];
+
+#pragma omp parallel for if(parallel) private(k)
+         for (t= 0; t<threads; ++t)
+         {
+            OffsetType*      next= pos + t*width;
+            const OffsetType stop= partBegin(total, t+1);
+            for (k= partBegin(total, t); k<stop; ++k)
+            {
+               const OffsetType p= next[line0[k]]++;
+               cross[p]= cross0[k];
+               value[p]= value0[k];
+            }
+         }
+
+         delete [] line0;
+         delete [] cross0;
+         delete [] value0;
+
+         // sum the values at the same position and drop the zeros; the
+         // number of the entries left in line l is kept in pos[l]
+#pragma omp parallel for if(parallel) private(k)
+         for (l= 0; l<SignedIndexType(n); ++l)
+         {
+            const OffsetType first= start[l], stop= start[l+1];
+            OffsetType       s, last= first;
+
+            for (k= first; k<stop; k= s)
+            {
+               AccumulationType sum= value[k];
+               for (s= k+1; s<stop && cross[s]==cross[k]; ++s) sum+= value[s];
+               if (sum != AccumulationType(0))
+               {
+                  cross[last]  = cross[k];
+                  value[last++]= ElementType(sum);
+               }
+            }
+            pos[l]= last-first;
+         }
+
+         releaseMerged();
+         pntr_= new OffsetType[n+1];
+         pntr_[0]= 0;
+         for (ll= 0; ll<n; ++ll) pntr_[ll+1]= pntr_[ll] + pos[ll];
+         nnz_ = pntr_[n];
+         indx_= new IndexType  [nnz_>0 ? nnz_ : 1];
+         val_ = new ElementType[nnz_>0 ? nnz_ : 1];
+
+#pragma omp parallel for if(parallel) private(k)
+         for (l= 0; l<SignedIndexType(n); ++l)
+            for (k= 0; k<pos[l]; ++k)
+            {
+               indx_[pntr_[l]+k]= cross[start[l]+k];
+               val_ [pntr_[l]+k]= value[start[l]+k];
+            }
+
+         delete [] pos;
+         delete [] start;
+         delete [] cross;
+         delete [] value;
+      }
+
+      void releaseMerged()
+      {
+         delete [] pntr_;
+         delete [] indx_;
+         delete [] val_;
+         pntr_= NULL;
+         indx_= NULL;
+         val_ = NULL;
+         nnz_ = 0;
+      }
+
+      ParallelAssembler(const ParallelAssembler&);
+      ParallelAssembler& operator=(const ParallelAssembler&);
+
+      const IndexType r_, c_, threads_;
+      BufferType**    buffers_;
+      OffsetType      nnz_;
+      OffsetType    * pntr_;
+      IndexType     * indx_;
+      ElementType   * val_;
+};
+
+
+#endif   // DB_MATRIX_PARALLELASSEMBLY_H
@@ -0,0 +1,235 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "ReducedPrecision.h"                 */
+/*                                                                            */
+/*                                                                            */
+/*  Category:   Helper classes                                                */
+/*                                                                            */
+/*  Classes:                                                                  */
+/*  - bfloat16                                                                */
+/*  - half                                                                    */
+/*  - numeric_limits<bfloat16>, numeric_limits<half>                          */
+/*                                                                            */
+/*                                                                            */
+/*  bfloat16 and half are 16 bit floating point types for element storage.   */
+/*  They are emulated: a value is converted to float (rounding to nearest     */
+/*  even) whenever it is read or written, and all arithmetic is done on the   */
+/*  converted values. bfloat16 has the exponent range of float and 8 bits of  */
+/*  precision, half (IEEE 754 binary16) 5 exponent bits and 11 bits of        */
+/*  precision. They are meant to be combined with a wider AccumulationType,   */
+/*  e.g. matrix<bfloat16, ..., float> or matrix<half, ..., double>.           */
+/*  The numeric_limits specializations let PROMOTE_NUMERIC_TYPE and the DSL   */
+/*  checks compare them with the built-in types.                              */
+/*                                                                            */
+/*                                                                            */
+/* (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                 */
+/*                       Ulrich Eisenecker, Johannes Knaupp                   */
+/*                                                                            */
+/******************************************************************************/
+
+#ifndef DB_MATRIX_REDUCEDPRECISION_H
+#define DB_MATRIX_REDUCEDPRECISION_H
+
+#include <limits>
+#include <string.h>
+
+using namespace std;
+
+// access to the bit pattern of a float (float and unsigned int are assumed to
+// have 32 bits)
+struct FloatBits
+{
+   static unsigned int bits(float f)
+   {
+      unsigned int x;
+      memcpy(&x, &f, sizeof(x));
+      return x;
+   }
+
+   static float value(unsigned int x)
+   {
+      float f;
+      memcpy(&f, &x, sizeof(f));
+      return f;
+   }
+};
+
+
+//********************************** bfloat16 **********************************
+
+// the upper half of a float
+class bfloat16
+{
+   public:
+      bfloat16() : bits_(0) {}
+      bfloat16(float f) : bits_(fromFloat(f)) {}
+
+      operator float() const {return FloatBits::value((unsigned int)bits_<<16);}
+
+      bfloat16& operator+=(float v) {return *this= float(*this) + v;}
+      bfloat16& operator-=(float v) {return *this= float(*this) - v;}
+      bfloat16& operator*=(float v) {return *this= float(*this) * v;}
+      bfloat16& operator/=(float v) {return *this= float(*this) / v;}
+
+      unsigned short bits() const {return bits_;}
+
+      static bfloat16 fromBits(unsigned short b)
+      {
+         bfloat16 v;
+         v.bits_= b;
+         return v;
+      }
+
+   private:
+      static unsigned short fromFloat(float f)
+      {
+         const unsigned int x= FloatBits::bits(f);
+         if ((x & 0x7fffffff) > 0x7f800000)                       // NaN
+            return (unsigned short)((x>>16) | 0x40);
+         return (unsigned short)((x + 0x7fff + ((x>>16) & 1)) >> 16);
+      }
+
+      unsigned short bits_;
+};
+
+
+//************************************ half ************************************
+
+// IEEE 754 binary16
+class half
+{
+   public:
+      half() : bits_(0) {}
+      half(float f) : bits_(fromFloat(f)) {}
+
+      operator float() const {return toFloat(bits_);}
+
+      half& operator+=(float v) {return *this= float(*this) + v;}
+      half& operator-=(float v) {return *this= float(*this) - v;}
+      half& operator*=(float v) {return *this= float(*this) * v;}
+      half& operator/=(float v) {return *this= float(*this) / v;}
+
+      unsigned short bits() const {return bits_;}
+
+      static half fromBits(unsigned short b)
+      {
+         half v;
+         v.bits_= b;
+         return v;
+      }
+
+   private:
+      static unsigned short fromFloat(float f)
+      {
+         const unsigned int x   = FloatBits::bits(f);
+         const unsigned int sign= (x>>16) & 0x8000;
+         const int          exp = int((x>>23) & 0xff) - 127 + 15;
+         unsigned int       mant= x & 0x7fffff;
+         unsigned int       h, rest, halfway;
+
+         if (((x>>23) & 0xff) == 0xff)                           // Inf, NaN
+            return (unsigned short)(sign | 0x7c00 | (mant ? 0x200 : 0));
+         if (exp >= 31)                                          // overflow
+            return (unsigned short)(sign | 0x7c00);
+         if (exp <= 0)                                           // subnormal
+         {
+            if (exp < -10) return (unsigned short)sign;
+            mant|= 0x800000;
+            const int shift= 14 - exp;
+            h      = mant >> shift;
+            rest   = mant & ((1u<<shift) - 1);
+            halfway= 1u << (shift-1);
+         }
+         else
+         {
+            h      = (unsigned int)(exp<<10) | (mant>>13);
+            rest   = mant & 0x1fff;
+            halfway= 0x1000;
+         }
+         // a carry out of the mantissa increments the exponent, as it should
+         if (rest > halfway || (rest == halfway && (h & 1))) ++h;
+         return (unsigned short)(sign | h);
+      }
+
+      static float toFloat(unsigned short h)
+      {
+         const unsigned int sign= (unsigned int)(h & 0x8000) << 16;
+         int                exp = (h>>10) & 0x1f;
+         unsigned int       mant= h & 0x3ff;
+
+         if (exp == 0x1f)                                        // Inf, NaN
+            return FloatBits::value(sign | 0x7f800000 | (mant<<13));
+         if (exp == 0)
+         {
+            if (mant == 0) return FloatBits::value(sign);
+            for (exp= 1; !(mant & 0x400); --exp) mant<<= 1;      // normalize
+            mant&= 0x3ff;
+         }
+         return FloatBits::value(sign | (unsigned int)(exp + 127 - 15)<<23 |
+                                                                   (mant<<13));
+      }
+
+      unsigned short bits_;
+};
+
+
+//******************************* numeric limits *******************************
+
+namespace std {
+
+template<>
+class numeric_limits<bfloat16>
+{
+   public:
+      static const bool is_specialized= true;
+      static const int  digits        = 8;
+      static const int  digits10      = 2;
+      static const bool is_signed     = true;
+      static const bool is_integer    = false;
+      static const bool is_exact      = false;
+      static const int  radix         = 2;
+      static const int  min_exponent  = -125;
+      static const int  min_exponent10= -37;
+      static const int  max_exponent  = 128;
+      static const int  max_exponent10= 38;
+      static const bool has_infinity  = true;
+      static const bool has_quiet_NaN = true;
+
+      static bfloat16 min()        {return bfloat16::fromBits(0x0080);}
+      static bfloat16 max()        {return bfloat16::fromBits(0x7f7f);}
+      static bfloat16 epsilon()    {return bfloat16::fromBits(0x3c00);}
+      static bfloat16 infinity()   {return bfloat16::fromBits(0x7f80);}
+      static bfloat16 quiet_NaN()  {return bfloat16::fromBits(0x7fc0);}
+      static bfloat16 denorm_min() {return bfloat16::fromBits(0x0001);}
+};
+
+template<>
+class numeric_limits<half>
+{
+   public:
+      static const bool is_specialized= true;
+      static const int  digits        = 11;
+      static const int  digits10      = 3;
+      static const bool is_signed     = true;
+      static const bool is_integer    = false;
+      static const bool is_exact      = false;
+      static const int  radix         = 2;
+      static const int  min_exponent  = -13;
+      static const int  min_exponent10= -4;
+      static const int  max_exponent  = 16;
+      static const int  max_exponent10= 4;
+      static const bool has_infinity  = true;
+      static const bool has_quiet_NaN = true;
+
+      static half min()        {return half::fromBits(0x0400);}
+      static half max()        {return half::fromBits(0x7bff);}
+      static half epsilon()    {return half::fromBits(0x1400);}
+      static half infinity()   {return half::fromBits(0x7c00);}
+      static half quiet_NaN()  {return half::fromBits(0x7e00);}
+      static half denorm_min() {return half::fromBits(0x0001);}
+};
+
+}  // namespace std
+
+
+#endif   // DB_MATRIX_REDUCEDPRECISION_H
@@ -29,6 +29,23 @@
 template<class ExpressionType> struct LazyBinaryExpression;
 template<class A, class B, class BinaryOperation> class BinaryExpression;
 
+// The kinds of matrix expressions. The operations use them to recognize
+// expression trees which can be evaluated by fused kernels.
+struct expression_kinds
+{
+   enum { matrix_kind,
+          scaled_matrix_kind,
+          product_kind,
+          scaled_product_kind,
+          sum_kind,
+          difference_kind,
+          symm_product_kind,
+          transpose_kind,
+          submatrix_kind,
+          other_kind
+        };
+};
+
 namespace MatrixICCL{
 
 // DynamicArguments is a supplementary tool which allows the specification of
@@ -103,8 +120,12 @@ struct Matrix : OptBoundsCheckedMatrix
    typedef Config::IndexType IndexType;
    typedef Config::ElementType ElementType;
    typedef Config::CommaInitializer CommaInitializer;
+   typedef Config::ErrorReporter ErrorReporter;
    typedef DynamicArguments<IndexType, ElementType> ArgumentType;
 
+   enum {kind= expression_kinds::matrix_kind};
+   enum {elementwise= true};
+
    Matrix(IndexType rows= 0, IndexType cols= 0, IndexType diags= 1,
                                            ElementType initElem= ElementType(0))
       : OptBoundsCheckedMatrix(rows, cols, diags, initElem)
@@ -142,13 +163,120 @@ struct Matrix : OptBoundsCheckedMatrix
    template<class A>
    Matrix& operator=(const Matrix<A>& m)
    {
-      MATRIX_ASSIGNMENT<A>::RET::assign(this, &m);
+      typedef MATRIX_ASSIGNMENT<A>::RET Assignment;
+      Config::Instrumentation::Scope scope("assignment", (Assignment*)NULL);
+      if (!m.aliases(this)) Assignment::assign(this, &m);
+      return *this;
+   }
+
+   // a matrix of the same type; the template above does not replace the
+   // implicit copy assignment, which the formats (with const members) lack
+   Matrix& operator=(const Matrix& m)
+   {
+      typedef MATRIX_ASSIGNMENT<OptBoundsCheckedMatrix>::RET Assignment;
+      Config::Instrumentation::Scope scope("assignment", (Assignment*)NULL);
+      if (!m.aliases(this)) Assignment::assign(this, &m);
+      return *this;
+   }
+
+   // compound assignment operators; the target is updated in place
+   template<class Expr>
+   Matrix& operator+=(const LazyBinaryExpression<Expr>& expr)
+   {
+      if (Config::CompatibilityChecker::AdditionParameterCheck(*this, expr))
+         expr.Update(this, ElementType(1));
+      return *this;
+   }
+
+   template<class Expr>
+   Matrix& operator-=(const LazyBinaryExpression<Expr>& expr)
+   {
+      if (Config::CompatibilityChecker::AdditionParameterCheck(*this, expr))
+         expr.Update(this, ElementType(-1));
+      return *this;
+   }
+
+   template<class A>
+   Matrix& operator+=(const Matrix<A>& m)
+   {
+      if (!Config::CompatibilityChecker::AdditionParameterCheck(*this, m))
+         return *this;
+      if (m.aliases(this)) return *this*= ElementType(2);
+      typedef MATRIX_UPDATE<Matrix, Matrix<A> >::RET Update;
+      Config::Instrumentation::Scope scope("update", (Update*)NULL);
+      Update::update(this, &m, ElementType(1));
+      return *this;
+   }
+
+   template<class A>
+   Matrix& operator-=(const Matrix<A>& m)
+   {
+      if (!Config::CompatibilityChecker::AdditionParameterCheck(*this, m))
+         return *this;
+      if (m.aliases(this)) return *this*= ElementType(0);
+      typedef MATRIX_UPDATE<Matrix, Matrix<A> >::RET Update;
+      Config::Instrumentation::Scope scope("update", (Update*)NULL);
+      Update::update(this, &m, ElementType(-1));
+      return *this;
+   }
+
+   Matrix& operator*=(const ElementType& s)
+   {
+      typedef MATRIX_SCALING<Matrix>::RET Scaling;
+      Config::Instrumentation::Scope scope("scaling", (Scaling*)NULL);
+      Scaling::scale(this, s);
       return *this;
    }
 
    // assignment operators for other expressions
    // ...
 
+   // a matrix is always a valid operand (see BinaryExpression::Assign())
+   bool compatible() const {return true;}
+
+   // Element access without bounds checking. Bulk operations validate their
+   // range once with checkRange() and use these in their inner loops. Only
+   // the sparse formats report errors on writing (allocation, frozen
+   // pattern), so the writes throw only with the throwing reporter.
+   ElementType getElementUnchecked(const IndexType& i, const IndexType& j) const
+                                                             DB_MATRIX_NOEXCEPT
+   {
+      return Config::UncheckedMatrix::getElement(i, j);
+   }
+
+   void setElementUnchecked(const IndexType& i, const IndexType& j,
+                                                          const ElementType& v)
+                               DB_MATRIX_NOEXCEPT_IF(!ErrorReporter::throws)
+   {
+      Config::UncheckedMatrix::setElement(i, j, v);
+   }
+
+   // adds v to the element (i, j) with a single lookup in the format
+   void addToElementUnchecked(const IndexType& i, const IndexType& j,
+                                                          const ElementType& v)
+                               DB_MATRIX_NOEXCEPT_IF(!ErrorReporter::throws)
+   {
+      Config::UncheckedMatrix::addToElement(i, j, v);
+   }
+
+   // [0, r) x [0, c) must lie inside the matrix; false if the error
+   // reporter returned
+   bool checkRange(const IndexType& r, const IndexType& c) const
+                               DB_MATRIX_NOEXCEPT_IF(!ErrorReporter::throws)
+   {
+      return Config::RangeChecker::checkRange(*this, r, c);
+   }
+
+   // last error recorded by the error reporter of this matrix type (only the
+   // error_code and error_callback policies record errors)
+   static int lastError() {return Config::ErrorReporter::lastError();}
+   static void clearError() {Config::ErrorReporter::clearError();}
+
+   // storage identity, used to detect aliasing between the result of an
+   // assignment and the operands of an expression
+   bool aliases(const void* p) const {return p == (const void*)this;}
+   bool aliasesOutOfPlace(const void*) const {return false;}
+
 
    ostream& display(ostream& out) const
    {
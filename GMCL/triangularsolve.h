@@ -0,0 +1,610 @@
+/******************************************************************************/
+/*                                                                            */
+/*  Generative Matrix Package   -   File "TriangularSolve.h"                  */
+/*                                                                            */
+/*                                                                            */
+/*  Category:   Operations                                                    */
+/*                                                                            */
+/*  Operations:                                                               */
+/*  - solveTriangular()                                                       */
+/*  - solveTriangularMultiple()                                               */
+/*                                                                            */
+/*  Meta-Functions:                                                           */
+/*  - IS_LOWER_TRIANG                                                         */
+/*  - IS_UPPER_TRIANG                                                         */
+/*  - MATRIX_TRSV                                                             */
+/*  - MATRIX_TRSM                                                             */
+/*                                                                            */
+/*  Classes:                                                                  */
+/*  - TriangularFactor                                                        */
+/*                                                                            */
+/*                                                                            */
+/*  solveTriangular() computes x= inv(T)*b for a triangular matrix T          */
+/*  (forward substitution for lower_triang and lower_band_triang, backward    */
+/*  substitution for upper_triang and upper_band_triang); solveTriangular-    */
+/*  Multiple() computes X= inv(T)*B for several right-hand sides stored in    */
+/*  the columns of a dense matrix. MATRIX_TRSV and MATRIX_TRSM choose the     */
+/*  algorithm according to the DSL features of T:                             */
+/*  dense storage (vector, array) is processed in blocks of rows: the panel   */
+/*  left of (or right of) the diagonal block is applied first, so that the    */
+/*  solved part of x stays in the cache, and its rows are independent, so     */
+/*  they run in parallel with OpenMP. The diagonal block is substituted       */
+/*  sequentially.                                                             */
+/*  Skyline storage is traversed directly: LoSKY row by row (dot products),   */
+/*  UpSKY column by column (axpy updates).                                    */
+/*  Any other sparse storage (DIA, CSR, CSC, COO) is copied into compressed   */
+/*  rows by a TriangularFactor, which also groups the rows into levels: the   */
+/*  rows of a level depend on rows of earlier levels only and are solved in   */
+/*  parallel. A TriangularFactor can be kept to solve with the same factor    */
+/*  several times.                                                            */
+/*  The multiple right-hand side variants read every element of T once for   */
+/*  all columns of B.                                                         */
+/*                                                                            */
+/*                                                                            */
+/*  (c) Copyright 1998 by Tobias Neubert, Krzysztof Czarnecki,                */
+/*                        Ulrich Eisenecker, Johannes Knaupp                  */
+/*                                                                            */
+/******************************************************************************/
+
+#ifndef DB_MATRIX_TRIANGULARSOLVE_H
+#define DB_MATRIX_TRIANGULARSOLVE_H
+
+
+//************************* triangular shape detection *************************
+
+template<class MatrixType>
+struct IS_LOWER_TRIANG
+{
+   typedef MatrixType::Config::DSLFeatures::Shape Shape;
+
+   enum { RET= EQUAL<Shape::id, Shape::lower_triang_id>::RET ||
+               EQUAL<Shape::id, Shape::lower_band_triang_id>::RET };
+};
+
+template<class MatrixType>
+struct IS_UPPER_TRIANG
+{
+   typedef MatrixType::Config::DSLFeatures::Shape Shape;
+
+   enum { RET= EQUAL<Shape::id, Shape::upper_triang_id>::RET ||
+               EQUAL<Shape::id, Shape::upper_band_triang_id>::RET };
+};
+
+
+//************************** compressed row factors ****************************
+
+template<class MatrixType>
+class TriangularFactor
+{
+   public:
+      typedef MatrixType::Config::ElementType     ElementType;
+      typedef MatrixType::Config::AccumulationType AccumulationType;
+      typedef MatrixType::Config::IndexType       IndexType;
+      typedef MatrixType::Config::SignedIndexType SignedIndexType;
+      typedef MatrixType::Config::OffsetType      OffsetType;
+
+      enum { lower= IS_LOWER_TRIANG<MatrixType>::RET };
+
+      TriangularFactor(const MatrixType& T)
+         : diag_(new OffsetType[T.rows()]), levelRows_(new IndexType[T.rows()]),
+           levelStart_(NULL), levels_(0)
+      {
+         assert(T.rows()==T.cols());
+         MATRIX_ROWS_EXTRACTION<MatrixType>::RET::extract(T, rows_);
+         findDiagonal();
+         schedule();
+      }
+
+      ~TriangularFactor()
+      {
+         delete [] diag_;
+         delete [] levelRows_;
+         delete [] levelStart_;
+      }
+
+      IndexType levels() const {return levels_;}
+
+      // x= inv(T)*b
+      template<class Vector>
+      void solve(const Vector& b, Vector& x, bool parallel= false) const
+      {
+         const IndexType*   indx= rows_.indx();
+         const ElementType* val = rows_.val();
+
+         for (IndexType l= 0; l<levels_; ++l)
+         {
+            const SignedIndexType stop= levelStart_[l+1];
+
+#pragma omp parallel for if(parallel)
+            for (SignedIndexType r= levelStart_[l]; r<stop; ++r)
+            {
+               const IndexType i= levelRows_[r];
+               AccumulationType sum= b[i];
+               for (OffsetType k= first(i); k<last(i); ++k)
+                  if (k!=diag_[i]) sum-= val[k]*x[indx[k]];
+               x[i]= sum/val[diag_[i]];
+            }
+         }
+      }
+
+      // X= inv(T)*B; B and X are dense matrices of the same extent
+      template<class BType, class XType>
+      void solveMultiple(const BType& B, XType& X, bool parallel= false) const
+      {
+         const IndexType*   indx= rows_.indx();
+         const ElementType* val = rows_.val();
+         const IndexType    m= B.cols();
+
+         if (!X.checkRange(B.rows(), m)) return;
+         for (IndexType l= 0; l<levels_; ++l)
+         {
+            const SignedIndexType stop= levelStart_[l+1];
+
+#pragma omp parallel for if(parallel)
+            for (SignedIndexType r= levelStart_[l]; r<stop; ++r)
+            {
+               const IndexType i= levelRows_[r];
+               IndexType c;
+               for (c= 0; c<m; ++c)
+                  X.setElementUnchecked(i, c, B.getElementUnchecked(i, c));
+               for (OffsetType k= first(i); k<last(i); ++k)
+                  if (k!=diag_[i])
+                  {
+                     const ElementType t= val[k];
+                     for (c= 0; c<m; ++c)
+                        X.setElementUnchecked(i, c, X.getElementUnchecked(i, c)
+                                        - t*X.getElementUnchecked(indx[k], c));
+                  }
+               const ElementType d= val[diag_[i]];
+               for (c= 0; c<m; ++c)
+                  X.setElementUnchecked(i, c, X.getElementUnchecked(i, c)/d);
+            }
+         }
+      }
+
+   private:
+      TriangularFactor(const TriangularFactor&);
+      TriangularFactor& operator=(const TriangularFactor&);
+
+      OffsetType first(const IndexType& i) const {return rows_.pntr()[i];}
+      OffsetType  last(const IndexType& i) const {return rows_.pntr()[i+1];}
+
+      void findDiagonal()
+      {
+         const IndexType* indx= rows_.indx();
+
+         for (IndexType i= 0; i<rows_.rows(); ++i)
+         {
+            for (diag_[i]= first(i); diag_[i]<last(i) && indx[diag_[i]]<i;)
+               ++diag_[i];
+            assert(diag_[i]<last(i) && indx[diag_[i]]==i);   // T is singular
+         }
+      }
+
+      // level[i]= 1 + the highest level of the rows i depends on; the rows
+      // are then sorted by level (counting sort)
+      void schedule()
+      {
+         const IndexType* indx= rows_.indx();
+         const IndexType  n= rows_.rows();
+         IndexType* level= new IndexType[n];
+         IndexType  i, l;
+         OffsetType k;
+
+         for (IndexType ii= 0; ii<n; ++ii)
+         {
+            i= lower ? ii : n-1-ii;
+            level[i]= 0;
+            for (k= first(i); k<last(i); ++k)
+               if (k!=diag_[i] && level[indx[k]]+1 > level[i])
+                  level[i]= level[indx[k]]+1;
+            if (level[i]+1 > levels_) levels_= level[i]+1;
+         }
+
+         levelStart_= new IndexType[levels_+1];
+         for (l= levels_+1; l--;) levelStart_[l]= 0;
+         for (i= 0; i<n; ++i) ++levelStart_[level[i]+1];
+         for (l= 0; l<levels_; ++l) levelStart_[l+1]+= levelStart_[l];
+         for (i= 0; i<n; ++i) levelRows_[levelStart_[level[i]]++]= i;
+         for (l= levels_; l>0; --l) levelStart_[l]= levelStart_[l-1];
+         levelStart_[0]= 0;
+
+         delete [] level;
+      }
+
+      CompressedRows<ElementType, IndexType, OffsetType> rows_;
+      OffsetType* diag_;
+      IndexType* levelRows_;
+      IndexType* levelStart_;
+      IndexType  levels_;
+};
+
+
+//*************************** implementations of TRSV **************************
+
+// The following implementations compute x= inv(T)*b.
+
+struct DiagTRSV
+{
+   template<class MatrixType, class Vector>
+   static void solve(const MatrixType& T, const Vector& b, Vector& x,
+                                                                  bool parallel)
+   {
+      for (MatrixType::Config::IndexType i= T.rows(); i--;)
+         x[i]= b[i]/T.getElementUnchecked(i, i);
+   }
+};
+
+struct DenseLowerTRSV
+{
+   enum { block_size= 64 };
+
+   template<class MatrixType, class Vector>
+   static void solve(const MatrixType& T, const Vector& b, Vector& x,
+                                                                  bool parallel)
+   {
+      typedef MatrixType::Config::SignedIndexType SignedIndexType;
+      typedef MatrixType::Config::IndexType       IndexType;
+      typedef MatrixType::Config::AccumulationType AccumulationType;
+
+      const SignedIndexType n= T.rows();
+
+      for (SignedIndexType ib= 0; ib<n; ib+= block_size)
+      {
+         const SignedIndexType ie= Min(ib + block_size, n);
+         SignedIndexType i, j;
+
+         // panel left of the diagonal block
+#pragma omp parallel for if(parallel) private(j)
+         for (i= ib; i<ie; ++i)
+         {
+            AccumulationType sum= b[i];
+            for (j= Max(SignedIndexType(i + T.firstDiag()), 0); j<ib; ++j)
+               sum-= T.getElementUnchecked(i, j)*x[j];
+            x[i]= sum;
+         }
+
+         // diagonal block
+         for (i= ib; i<ie; ++i)
+         {
+            AccumulationType sum= x[i];
+            for (j= Max(SignedIndexType(i + T.firstDiag()), ib); j<i; ++j)
+               sum-= T.getElementUnchecked(i, j)*x[j];
+            x[i]= sum/T.getElementUnchecked(i, i);
+         }
+      }
+   }
+};
+
+struct DenseUpperTRSV
+{
+   enum { block_size= 64 };
+
+   template<class MatrixType, class Vector>
+   static void solve(const MatrixType& T, const Vector& b, Vector& x,
+                                                                  bool parallel)
+   {
+      typedef MatrixType::Config::SignedIndexType SignedIndexType;
+      typedef MatrixType::Config::IndexType       IndexType;
+      typedef MatrixType::Config::AccumulationType AccumulationType;
+
+      const SignedIndexType n= T.rows();
+
+      for (SignedIndexType ie= n; ie>0; ie-= block_size)
+      {
+         const SignedIndexType ib= Max(ie - block_size, 0);
+         SignedIndexType i, j;
+
+         // panel right of the diagonal block
+#pragma omp parallel for if(parallel) private(j)
+         for (i= ib; i<ie; ++i)
+         {
+            AccumulationType sum= b[i];
+            const SignedIndexType stop= Min(i + T.lastDiag(), n-1);
+            for (j= ie; j<=stop; ++j)
+               sum-= T.getElementUnchecked(i, j)*x[j];
+            x[i]= sum;
+         }
+
+         // diagonal block
+         for (i= ie; i-- > ib;)
+         {
+            AccumulationType sum= x[i];
+            const SignedIndexType stop= Min(i + T.lastDiag(), ie-1);
+            for (j= i+1; j<=stop; ++j)
+               sum-= T.getElementUnchecked(i, j)*x[j];
+            x[i]= sum/T.getElementUnchecked(i, i);
+         }
+      }
+   }
+};
+
+// row i is stored in values()[pointers()[i] .. pointers()[i]+i]
+struct LoSKYTRSV
+{
+   template<class MatrixType, class Vector>
+   static void solve(const MatrixType& T, const Vector& b, Vector& x,
+                                                                  bool parallel)
+   {
+      typedef MatrixType::Config::IndexType   IndexType;
+      typedef MatrixType::Config::OffsetType  OffsetType;
+      typedef MatrixType::Config::AccumulationType AccumulationType;
+
+      for (IndexType i= 0; i<T.rows(); ++i)
+      {
+         const OffsetType start= T.pointers().getElement(i);
+         assert(start < T.pointers().getElement(i+1));   // T is singular
+         AccumulationType sum= b[i];
+         for (IndexType j= 0; j<i; ++j)
+            sum-= T.values().getElement(start+j)*x[j];
+         x[i]= sum/T.values().getElement(start+i);
+      }
+   }
+};
+
+// column j is stored in values()[pointers()[j] .. pointers()[j]+j]
+struct UpSKYTRSV
+{
+   template<class MatrixType, class Vector>
+   static void solve(const MatrixType& T, const Vector& b, Vector& x,
+                                                                  bool parallel)
+   {
+      typedef MatrixType::Config::IndexType   IndexType;
+      typedef MatrixType::Config::OffsetType  OffsetType;
+      typedef MatrixType::Config::AccumulationType AccumulationType;
+
+      x= b;
+      for (IndexType j= T.cols(); j--;)
+      {
+         const OffsetType start= T.pointers().getElement(j);
+         assert(start < T.pointers().getElement(j+1));   // T is singular
+         const AccumulationType xj= x[j]/T.values().getElement(start+j);
+         x[j]= xj;
+         for (IndexType i= 0; i<j; ++i)
+            x[i]-= T.values().getElement(start+i)*xj;
+      }
+   }
+};
+
+struct CompressedTRSV
+{
+   template<class MatrixType, class Vector>
+   static void solve(const MatrixType& T, const Vector& b, Vector& x,
+                                                                  bool parallel)
+   {
+      TriangularFactor<MatrixType>(T).solve(b, x, parallel);
+   }
+};
+
+
+//*************************** implementations of TRSM **************************
+
+// The following implementations compute X= inv(T)*B. Every element of T is
+// read once and applied to all the columns of B.
+
+struct DiagTRSM
+{
+   template<class MatrixType, class BType, class XType>
+   static void solve(const MatrixType& T, const BType& B, XType& X,
+                                                                  bool parallel)
+   {
+      typedef MatrixType::Config::IndexType   IndexType;
+      typedef MatrixType::Config::ElementType ElementType;
+
+      if (!X.checkRange(B.rows(), B.cols())) return;
+      for (IndexType i= T.rows(); i--;)
+      {
+         const ElementType d= T.getElementUnchecked(i, i);
+         for (IndexType c= B.cols(); c--;)
+            X.setElementUnchecked(i, c, B.getElementUnchecked(i, c)/d);
+      }
+   }
+};
+
+// the structure of DenseLowerTRSV, with the columns of B as innermost loop
+struct DenseLowerTRSM
+{
+   enum { block_size= 64 };
+
+   template<class MatrixType, class BType, class XType>
+   static void solve(const MatrixType& T, const BType& B, XType& X,
+                                                                  bool parallel)
+   {
+      typedef MatrixType::Config::SignedIndexType SignedIndexType;
+      typedef MatrixType::Config::IndexType       IndexType;
+      typedef MatrixType::Config::ElementType     ElementType;
+
+      const SignedIndexType n= T.rows();
+      const IndexType       m= B.cols();
+
+      if (!X.checkRange(n, m)) return;
+      for (SignedIndexType ib= 0; ib<n; ib+= block_size)
+      {
+         const SignedIndexType ie= Min(ib + block_size, n);
+         SignedIndexType i, j;
+         IndexType c;
+
+         // panel left of the diagonal block
+#pragma omp parallel for if(parallel) private(j, c)
+         for (i= ib; i<ie; ++i)
+         {
+            for (c= 0; c<m; ++c)
+               X.setElementUnchecked(i, c, B.getElementUnchecked(i, c));
+            for (j= Max(SignedIndexType(i + T.firstDiag()), 0); j<ib; ++j)
+               eliminate(X, i, j, T.getElementUnchecked(i, j), m);
+         }
+
+         // diagonal block
+         for (i= ib; i<ie; ++i)
+         {
+            for (j= Max(SignedIndexType(i + T.firstDiag()), ib); j<i; ++j)
+               eliminate(X, i, j, T.getElementUnchecked(i, j), m);
+            divide(X, i, T.getElementUnchecked(i, i), m);
+         }
+      }
+   }
+
+   // row i of X -= t * row j of X
+   template<class XType, class IndexType, class ElementType>
+   static void eliminate(XType& X, const IndexType& i, const IndexType& j,
+                              const ElementType& t, const XType::IndexType& m)
+   {
+      for (XType::IndexType c= 0; c<m; ++c)
+         X.setElementUnchecked(i, c, X.getElementUnchecked(i, c) -
+                                     t*X.getElementUnchecked(j, c));
+   }
+
+   // row i of X /= d
+   template<class XType, class IndexType, class ElementType>
+   static void divide(XType& X, const IndexType& i, const ElementType& d,
+                                                   const XType::IndexType& m)
+   {
+      for (XType::IndexType c= 0; c<m; ++c)
+         X.setElementUnchecked(i, c, X.getElementUnchecked(i, c)/d);
+   }
+};
+
+struct DenseUpperTRSM
+{
+   enum { block_size= 64 };
+
+   template<class MatrixType, class BType, class XType>
+   static void solve(const MatrixType& T, const BType& B, XType& X,
+                                                                  bool parallel)
+   {
+      typedef MatrixType::Config::SignedIndexType SignedIndexType;
+      typedef MatrixType::Config::IndexType       IndexType;
+      typedef MatrixType::Config::ElementType     ElementType;
+
+      const SignedIndexType n= T.rows();
+      const IndexType       m= B.cols();
+
+      if (!X.checkRange(n, m)) return;
+      for (SignedIndexType ie= n; ie>0; ie-= block_size)
+      {
+         const SignedIndexType ib= Max(ie - block_size, 0);
+         SignedIndexType i, j;
+         IndexType c;
+
+         // panel right of the diagonal block
+#pragma omp parallel for if(parallel) private(j, c)
+         for (i= ib; i<ie; ++i)
+         {
+            for (c= 0; c<m; ++c)
+               X.setElementUnchecked(i, c, B.getElementUnchecked(i, c));
+            const SignedIndexType stop= Min(i + T.lastDiag(), n-1);
+            for (j= ie; j<=stop; ++j)
+               DenseLowerTRSM::eliminate(X, i, j, T.getElementUnchecked(i, j), m);
+         }
+
+         // diagonal block
+         for (i= ie; i-- > ib;)
+         {
+            const SignedIndexType stop= Min(i + T.lastDiag(), ie-1);
+            for (j= i+1; j<=stop; ++j)
+               DenseLowerTRSM::eliminate(X, i, j, T.getElementUnchecked(i, j), m);
+            DenseLowerTRSM::divide(X, i, T.getElementUnchecked(i, i), m);
+         }
+      }
+   }
+};
+
+struct CompressedTRSM
+{
+   template<class MatrixType, class BType, class XType>
+   static void solve(const MatrixType& T, const BType& B, XType& X,
+                                                                  bool parallel)
+   {
+      TriangularFactor<MatrixType>(T).solveMultiple(B, X, parallel);
+   }
+};
+
+
+//************************* computing TRSV and TRSM type ***********************
+
+// selected for matrices which are not triangular (solve() is missing)
+struct TRIANGULAR_MATRIX_REQUIRED {};
+
+template<class MatrixType>
+struct MATRIX_TRSV
+{
+   typedef MatrixType::Config::DSLFeatures DSLFeatures;
+   typedef DSLFeatures::Density            Density;
+   typedef DSLFeatures::Shape              Shape;
+   typedef DSLFeatures::Format             Format;
+
+   enum { lower= IS_LOWER_TRIANG<MatrixType>::RET,
+          upper= IS_UPPER_TRIANG<MatrixType>::RET };
+
+   typedef IF<EQUAL<Shape::id, Shape:: ident_id>::RET ||
+              EQUAL<Shape::id, Shape::scalar_id>::RET ||
+              EQUAL<Shape::id, Shape::  diag_id>::RET,
+                  DiagTRSV,
+
+           IF<!lower && !upper,
+                  TRIANGULAR_MATRIX_REQUIRED,
+
+           IF<EQUAL<Format::id, Format::SKY_id>::RET,
+               IF<lower,
+                  LoSKYTRSV,
+                  UpSKYTRSV>::RET,
+
+           IF<EQUAL<Density::id, Density::dense_id>::RET,
+               IF<lower,
+                  DenseLowerTRSV,
+                  DenseUpperTRSV>::RET,
+
+                  CompressedTRSV>::RET>::RET>::RET>::RET RET;
+};
+
+// the skyline formats are solved via compressed rows, too
+template<class MatrixType>
+struct MATRIX_TRSM
+{
+   typedef MatrixType::Config::DSLFeatures DSLFeatures;
+   typedef DSLFeatures::Density            Density;
+   typedef DSLFeatures::Shape              Shape;
+
+   enum { lower= IS_LOWER_TRIANG<MatrixType>::RET,
+          upper= IS_UPPER_TRIANG<MatrixType>::RET };
+
+   typedef IF<EQUAL<Shape::id, Shape:: ident_id>::RET ||
+              EQUAL<Shape::id, Shape::scalar_id>::RET ||
+              EQUAL<Shape::id, Shape::  diag_id>::RET,
+                  DiagTRSM,
+
+           IF<!lower && !upper,
+                  TRIANGULAR_MATRIX_REQUIRED,
+
+           IF<EQUAL<Density::id, Density::dense_id>::RET,
+               IF<lower,
+                  DenseLowerTRSM,
+                  DenseUpperTRSM>::RET,
+
+                  CompressedTRSM>::RET>::RET>::RET RET;
+};
+
+
+//********************************* operations *********************************
+
+// x= inv(T)*b
+template<class MatrixType, class Vector>
+inline void solveTriangular(const MatrixType& T, const Vector& b, Vector& x,
+                                                           bool parallel= false)
+{
+   assert(T.rows()==T.cols());
+   assert(b.size()==T.rows()); assert(x.size()==T.rows());
+   MATRIX_TRSV<MatrixType>::RET::solve(T, b, x, parallel);
+}
+
+// X= inv(T)*B
+template<class MatrixType, class BType, class XType>
+inline void solveTriangularMultiple(const MatrixType& T, const BType& B,
+                                               XType& X, bool parallel= false)
+{
+   assert(T.rows()==T.cols()); assert(B.rows()==T.rows());
+   MATRIX_TRSM<MatrixType>::RET::solve(T, B, X, parallel);
+}
+
+
+#endif   // DB_MATRIX_TRIANGULARSOLVE_H